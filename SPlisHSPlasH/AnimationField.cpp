@@ -45,6 +45,8 @@ void AnimationField::step()
 	TimeManager *tm = TimeManager::getCurrent();
 	const Real t = tm->getTime();
 	const Real dt = tm->getTimeStepSize();
+	// in a 2D simulation animated positions and velocities stay in the xy-plane
+	const bool planar = sim->is2DSimulation() && ((m_particleFieldName == "position") || (m_particleFieldName == "velocity"));
 
 	if (t >= m_startTime && t <= m_endTime)
 	{
@@ -127,6 +129,8 @@ void AnimationField::step()
 						if (err != 0)
 							LOG_ERR << "Animation field: expression for z is wrong.";
 					}
+					if (planar)
+						value[2] = 0.0;
 				}
 			}
 		}
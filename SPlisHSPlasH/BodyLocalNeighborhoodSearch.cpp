@@ -0,0 +1,139 @@
+#include "BodyLocalNeighborhoodSearch.h"
+#include "BoundaryModel.h"
+#include "FluidModel.h"
+#include "Simulation.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
+
+using namespace SPH;
+
+
+void BodyLocalNeighborhoodSearch::clear()
+{
+	m_bodyIndex.clear();
+	m_boundaryModels.clear();
+	m_offsets.clear();
+	m_neighbors.clear();
+}
+
+void BodyLocalNeighborhoodSearch::addBoundaryModel(BoundaryModel *bm)
+{
+	if (!bm->isBodyLocal())
+		return;
+
+	const unsigned int pointSetIndex = bm->getPointSetIndex();
+	if (m_bodyIndex.size() <= pointSetIndex)
+		m_bodyIndex.resize(pointSetIndex + 1, NO_BODY);
+	m_bodyIndex[pointSetIndex] = static_cast<unsigned int>(m_boundaryModels.size());
+	m_boundaryModels.push_back(bm);
+}
+
+void BodyLocalNeighborhoodSearch::findNeighbors()
+{
+	if (m_boundaryModels.size() == 0)
+		return;
+
+	Simulation *sim = Simulation::getCurrent();
+	const unsigned int nFluids = sim->numberOfFluidModels();
+	const unsigned int nBodies = static_cast<unsigned int>(m_boundaryModels.size());
+
+	for (unsigned int b = 0; b < nBodies; b++)
+		m_boundaryModels[b]->prepareBodyLocalSearch();
+
+	m_offsets.resize(nFluids * nBodies);
+	m_neighbors.resize(nFluids * nBodies);
+
+	#ifdef _OPENMP
+	const int maxThreads = omp_get_max_threads();
+	#else
+	const int maxThreads = 1;
+	#endif
+	std::vector<std::vector<std::vector<unsigned int>>> threadNeighbors(maxThreads, std::vector<std::vector<unsigned int>>(nBodies));
+	std::vector<std::vector<std::vector<unsigned int>>> threadNewParticles(maxThreads, std::vector<std::vector<unsigned int>>(nBodies));
+	// neighborOffset[b * (maxThreads + 1) + t]: start of the neighbors of thread t in the list of body b
+	std::vector<unsigned int> neighborOffset(nBodies * (maxThreads + 1));
+
+	for (unsigned int fluidModelIndex = 0; fluidModelIndex < nFluids; fluidModelIndex++)
+	{
+		FluidModel *fm = sim->getFluidModel(fluidModelIndex);
+		const unsigned int numParticles = fm->numActiveParticles();
+		for (unsigned int b = 0; b < nBodies; b++)
+		{
+			std::vector<unsigned int> &offsets = m_offsets[fluidModelIndex * nBodies + b];
+			offsets.resize(numParticles + 1);
+			offsets[0] = 0;
+		}
+
+		#pragma omp parallel default(shared)
+		{
+			#ifdef _OPENMP
+			const int tid = omp_get_thread_num();
+			const int numThreads = omp_get_num_threads();
+			#else
+			const int tid = 0;
+			const int numThreads = 1;
+			#endif
+
+			// Each thread processes a contiguous range of particles, so the
+			// lists are ordered by particles independent of the number of threads.
+			const unsigned int begin = (unsigned int)(((unsigned long long) numParticles * tid) / numThreads);
+			const unsigned int end = (unsigned int)(((unsigned long long) numParticles * (tid + 1)) / numThreads);
+			std::vector<std::vector<unsigned int>> &localNeighbors = threadNeighbors[tid];
+			for (unsigned int b = 0; b < nBodies; b++)
+				localNeighbors[b].clear();
+
+			for (unsigned int i = begin; i < end; i++)
+			{
+				const Vector3r &xi = fm->getPosition(i);
+				for (unsigned int b = 0; b < nBodies; b++)
+				{
+					const unsigned int count = m_boundaryModels[b]->findNeighbors(xi, localNeighbors[b], threadNewParticles[tid][b]);
+					m_offsets[fluidModelIndex * nBodies + b][i + 1] = count;
+				}
+			}
+
+			#pragma omp barrier
+			#pragma omp single
+			{
+				for (unsigned int b = 0; b < nBodies; b++)
+				{
+					unsigned int *offset = &neighborOffset[b * (maxThreads + 1)];
+					offset[0] = 0;
+					for (int t = 0; t < numThreads; t++)
+						offset[t + 1] = offset[t] + static_cast<unsigned int>(threadNeighbors[t][b].size());
+					m_neighbors[fluidModelIndex * nBodies + b].resize(offset[numThreads]);
+				}
+			}
+
+			for (unsigned int b = 0; b < nBodies; b++)
+			{
+				std::vector<unsigned int> &offsets = m_offsets[fluidModelIndex * nBodies + b];
+				std::vector<unsigned int> &neighbors = m_neighbors[fluidModelIndex * nBodies + b];
+				const unsigned int start = neighborOffset[b * (maxThreads + 1) + tid];
+				unsigned int sum = start;
+				for (unsigned int i = begin; i < end; i++)
+				{
+					sum += offsets[i + 1];
+					offsets[i + 1] = sum;
+				}
+				std::copy(localNeighbors[b].begin(), localNeighbors[b].end(), neighbors.begin() + start);
+			}
+
+			// transform the boundary particles which were found by this thread
+			for (unsigned int b = 0; b < nBodies; b++)
+			{
+				std::vector<unsigned int> &newParticles = threadNewParticles[tid][b];
+				for (size_t k = 0; k < newParticles.size(); k++)
+					m_boundaryModels[b]->transformParticle(newParticles[k]);
+				newParticles.clear();
+			}
+		}
+	}
+}
+
+size_t BodyLocalNeighborhoodSearch::getMemoryUsage() const
+{
+	size_t bytes = vectorMemory(m_bodyIndex);
+	for (size_t l = 0; l < m_offsets.size(); l++)
+		bytes += vectorMemory(m_offsets[l]) + vectorMemory(m_neighbors[l]);
+	return bytes;
+}
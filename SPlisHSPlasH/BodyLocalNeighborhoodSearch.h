@@ -0,0 +1,78 @@
+#ifndef __BodyLocalNeighborhoodSearch_h__
+#define __BodyLocalNeighborhoodSearch_h__
+
+#include "Common.h"
+#include <vector>
+
+namespace SPH
+{
+	class BoundaryModel;
+
+	/** \brief Neighborhood search between the fluid particles and the particles of
+	* boundary models with a body-local grid (see BoundaryModel::isBodyLocal()).
+	* The moving bodies are never rehashed: a fluid particle is transformed into
+	* the frame of a body and its neighbors are found in the static grid of the body.
+	* The neighbors are stored for each pair of fluid model and body in CSR format,
+	* so the neighbors of a particle are accessed without a search.
+	*/
+	class BodyLocalNeighborhoodSearch
+	{
+	public:
+		static const unsigned int NO_BODY = 0xffffffff;
+
+	protected:
+		/** Index of the body in m_boundaryModels for each point set (NO_BODY if the
+		* point set does not belong to a body-local boundary model)
+		*/
+		std::vector<unsigned int> m_bodyIndex;
+		std::vector<BoundaryModel*> m_boundaryModels;
+		/** Neighbor offsets of the fluid particles for each fluid model and body
+		* (index fluidModelIndex * numBodies + bodyIndex). The neighbors of particle i
+		* are m_neighbors[...][m_offsets[...][i]], ..., m_neighbors[...][m_offsets[...][i + 1] - 1].
+		*/
+		std::vector<std::vector<unsigned int>> m_offsets;
+		std::vector<std::vector<unsigned int>> m_neighbors;
+
+		FORCE_INLINE unsigned int listIndex(const unsigned int fluidModelIndex, const unsigned int pointSetIndex) const
+		{
+			return fluidModelIndex * static_cast<unsigned int>(m_boundaryModels.size()) + m_bodyIndex[pointSetIndex];
+		}
+
+	public:
+		void clear();
+		void addBoundaryModel(BoundaryModel *bm);
+
+		/** Find the neighbors of all fluid particles in the body-local boundary models
+		* and transform the boundary particles which have fluid neighbors to world space.
+		*/
+		void findNeighbors();
+
+		/** Return the allocated memory in bytes. */
+		size_t getMemoryUsage() const;
+
+		FORCE_INLINE bool isBodyLocal(const unsigned int pointSetIndex) const
+		{
+			return (pointSetIndex < m_bodyIndex.size()) && (m_bodyIndex[pointSetIndex] != NO_BODY);
+		}
+
+		FORCE_INLINE unsigned int numberOfNeighbors(const unsigned int fluidModelIndex, const unsigned int pointSetIndex, const unsigned int index) const
+		{
+			const unsigned int l = listIndex(fluidModelIndex, pointSetIndex);
+			if (l >= m_offsets.size())
+				return 0;
+			const std::vector<unsigned int> &offsets = m_offsets[l];
+			// particles which were emitted after the search have no neighbors
+			if (index + 1 >= offsets.size())
+				return 0;
+			return offsets[index + 1] - offsets[index];
+		}
+
+		FORCE_INLINE unsigned int getNeighbor(const unsigned int fluidModelIndex, const unsigned int pointSetIndex, const unsigned int index, const unsigned int k) const
+		{
+			const unsigned int l = listIndex(fluidModelIndex, pointSetIndex);
+			return m_neighbors[l][m_offsets[l][index] + k];
+		}
+	};
+}
+
+#endif
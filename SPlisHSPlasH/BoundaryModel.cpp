@@ -6,6 +6,9 @@
 #include "Utilities/Logger.h"
 #include "NeighborhoodSearch.h"
 #include "Simulation.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace SPH;
 
@@ -20,6 +23,16 @@ BoundaryModel::BoundaryModel() :
 {		
 	m_sorted = false;
 	m_pointSetIndex = 0;
+	m_bodyLocal = false;
+	m_R.setIdentity();
+	m_translation.setZero();
+	m_velocity.setZero();
+	m_angularVelocity.setZero();
+	m_searchRadius = 0.0;
+	m_cellSize = 0.0;
+	m_gridMin.setZero();
+	m_gridMax.setZero();
+	m_gridRes[0] = m_gridRes[1] = m_gridRes[2] = 0;
 }
 
 BoundaryModel::~BoundaryModel(void)
@@ -30,6 +43,8 @@ BoundaryModel::~BoundaryModel(void)
 	m_V.clear();
 	m_forcePerThread.clear();
 	m_torquePerThread.clear();
+	m_cellStart.clear();
+	m_transformFlags.clear();
 
 	delete m_rigidBody;
 }
@@ -59,6 +74,44 @@ void BoundaryModel::reset()
 void BoundaryModel::computeBoundaryVolume()
 {
 	Simulation *sim = Simulation::getCurrent();
+
+	// The volume of a body-local model only depends on its own particles in rest configuration.
+	if (m_bodyLocal)
+	{
+		prepareBodyLocalSearch();
+		const Real radius2 = m_searchRadius * m_searchRadius;
+		const int nx = (int)m_gridRes[0];
+		const int ny = (int)m_gridRes[1];
+		const int nz = (int)m_gridRes[2];
+
+		#pragma omp parallel default(shared)
+		{
+			#pragma omp for schedule(static)  
+			for (int i = 0; i < (int)numberOfParticles(); i++)
+			{
+				const Vector3r &xi = m_x0[i];
+				const int cx = std::min((int)((xi[0] - m_gridMin[0]) / m_cellSize), nx - 1);
+				const int cy = std::min((int)((xi[1] - m_gridMin[1]) / m_cellSize), ny - 1);
+				const int cz = std::min((int)((xi[2] - m_gridMin[2]) / m_cellSize), nz - 1);
+				Real delta = sim->W_zero();
+				for (int z = std::max(cz - 1, 0); z <= std::min(cz + 1, nz - 1); z++)
+					for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, ny - 1); y++)
+						for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, nx - 1); x++)
+						{
+							const unsigned int cell = ((unsigned int)z * m_gridRes[1] + (unsigned int)y) * m_gridRes[0] + (unsigned int)x;
+							for (unsigned int j = m_cellStart[cell]; j < m_cellStart[cell + 1]; j++)
+							{
+								const Vector3r xij = xi - m_x0[j];
+								if (((int)j != i) && (xij.squaredNorm() < radius2))
+									delta += sim->W(xij);
+							}
+						}
+				m_V[i] = static_cast<Real>(1.0) / delta;
+			}
+		}
+		return;
+	}
+
 	const unsigned int nFluids = sim->numberOfFluidModels();
 	NeighborhoodSearch *neighborhoodSearch = Simulation::getCurrent()->getNeighborhoodSearch();
 	
@@ -113,17 +166,149 @@ void BoundaryModel::initModel(RigidBodyObject *rbo, const unsigned int numBounda
 		}
 	}
 	m_rigidBody = rbo;
+	m_R = rbo->getRotation();
+	m_translation = rbo->getPosition();
+	m_velocity = rbo->getVelocity();
+	m_angularVelocity = rbo->getAngularVelocity();
 
+#ifdef GPU_NEIGHBORHOOD_SEARCH
+	m_bodyLocal = false;
+#else
+	m_bodyLocal = m_rigidBody->isDynamic() && (numBoundaryParticles > 0);
+#endif
+	if (m_bodyLocal)
+		initBodyLocalGrid();
+
+	// Body-local models are not part of the global neighborhood search.
 	NeighborhoodSearch *neighborhoodSearch = Simulation::getCurrent()->getNeighborhoodSearch();
-	m_pointSetIndex = neighborhoodSearch->add_point_set(&m_x[0][0], m_x.size(), m_rigidBody->isDynamic(), false, true, this);
+	m_pointSetIndex = neighborhoodSearch->add_point_set(&m_x[0][0], m_x.size(), m_rigidBody->isDynamic() && !m_bodyLocal, false, !m_bodyLocal, this);
+}
+
+void BoundaryModel::initBodyLocalGrid()
+{
+	const unsigned int numParticles = numberOfParticles();
+	m_searchRadius = Simulation::getCurrent()->getSupportRadius();
+
+	// grid which covers all particles and the search radius around them
+	Vector3r minX = m_x0[0];
+	Vector3r maxX = m_x0[0];
+	for (unsigned int i = 1; i < numParticles; i++)
+	{
+		minX = minX.cwiseMin(m_x0[i]);
+		maxX = maxX.cwiseMax(m_x0[i]);
+	}
+	m_gridMin = minX - Vector3r::Constant(m_searchRadius);
+	m_gridMax = maxX + Vector3r::Constant(m_searchRadius);
+
+	// limit the number of cells for large bodies
+	const Vector3r extent = m_gridMax - m_gridMin;
+	const Real maxCells = static_cast<Real>(16.0 * 1024.0 * 1024.0);
+	m_cellSize = std::max(m_searchRadius, std::cbrt(extent[0] * extent[1] * extent[2] / maxCells));
+	for (unsigned int d = 0; d < 3; d++)
+		m_gridRes[d] = std::max((unsigned int)(extent[d] / m_cellSize), 1u);
+	const unsigned int numCells = m_gridRes[0] * m_gridRes[1] * m_gridRes[2];
+
+	// counting sort of the particles by cells
+	std::vector<unsigned int> cellIndex(numParticles);
+	m_cellStart.assign(numCells + 1, 0);
+	for (unsigned int i = 0; i < numParticles; i++)
+	{
+		unsigned int c[3];
+		for (unsigned int d = 0; d < 3; d++)
+			c[d] = std::min((unsigned int)((m_x0[i][d] - m_gridMin[d]) / m_cellSize), m_gridRes[d] - 1);
+		cellIndex[i] = (c[2] * m_gridRes[1] + c[1]) * m_gridRes[0] + c[0];
+		m_cellStart[cellIndex[i] + 1]++;
+	}
+	for (unsigned int c = 0; c < numCells; c++)
+		m_cellStart[c + 1] += m_cellStart[c];
+
+	std::vector<unsigned int> offset(m_cellStart.begin(), m_cellStart.end() - 1);
+	std::vector<Vector3r> x0(numParticles);
+	std::vector<Vector3r> x(numParticles);
+	std::vector<Vector3r> v(numParticles);
+	std::vector<Real> V(numParticles);
+	for (unsigned int i = 0; i < numParticles; i++)
+	{
+		const unsigned int j = offset[cellIndex[i]]++;
+		x0[j] = m_x0[i];
+		x[j] = m_x[i];
+		v[j] = m_v[i];
+		V[j] = m_V[i];
+	}
+	// copy instead of swap, so that the point set of the neighborhood search keeps its pointer
+	std::copy(x0.begin(), x0.end(), m_x0.begin());
+	std::copy(x.begin(), x.end(), m_x.begin());
+	std::copy(v.begin(), v.end(), m_v.begin());
+	std::copy(V.begin(), V.end(), m_V.begin());
+
+	m_transformFlags = std::vector<std::atomic<unsigned char>>(numParticles);
+}
+
+void BoundaryModel::prepareBodyLocalSearch()
+{
+	if (m_bodyLocal && (m_searchRadius != Simulation::getCurrent()->getSupportRadius()))
+		initBodyLocalGrid();
+}
+
+unsigned int BoundaryModel::findNeighbors(const Vector3r &x, std::vector<unsigned int> &neighbors, std::vector<unsigned int> &newParticles)
+{
+	const Vector3r xl = m_R.transpose() * (x - m_translation);
+	if ((xl.array() < m_gridMin.array()).any() || (xl.array() >= m_gridMax.array()).any())
+		return 0;
+
+	const Real radius2 = m_searchRadius * m_searchRadius;
+	int c[3];
+	for (unsigned int d = 0; d < 3; d++)
+		c[d] = std::min((int)((xl[d] - m_gridMin[d]) / m_cellSize), (int)m_gridRes[d] - 1);
+
+	unsigned int count = 0;
+	for (int z = std::max(c[2] - 1, 0); z <= std::min(c[2] + 1, (int)m_gridRes[2] - 1); z++)
+		for (int y = std::max(c[1] - 1, 0); y <= std::min(c[1] + 1, (int)m_gridRes[1] - 1); y++)
+			for (int cx = std::max(c[0] - 1, 0); cx <= std::min(c[0] + 1, (int)m_gridRes[0] - 1); cx++)
+			{
+				const unsigned int cell = ((unsigned int)z * m_gridRes[1] + (unsigned int)y) * m_gridRes[0] + (unsigned int)cx;
+				for (unsigned int j = m_cellStart[cell]; j < m_cellStart[cell + 1]; j++)
+				{
+					if ((xl - m_x0[j]).squaredNorm() < radius2)
+					{
+						neighbors.push_back(j);
+						count++;
+						if ((m_transformFlags[j].load(std::memory_order_relaxed) == 0) &&
+							(m_transformFlags[j].exchange(1, std::memory_order_relaxed) == 0))
+							newParticles.push_back(j);
+					}
+				}
+			}
+	return count;
+}
+
+void BoundaryModel::setTransformation(const Matrix3r &R, const Vector3r &x, const Vector3r &v, const Vector3r &omega)
+{
+	m_R = R;
+	m_translation = x;
+	m_velocity = v;
+	m_angularVelocity = omega;
+}
+
+void BoundaryModel::updateParticles()
+{
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)  
+		for (int j = 0; j < (int)numberOfParticles(); j++)
+		{
+			m_x[j] = m_R * m_x0[j] + m_translation;
+			m_v[j] = m_angularVelocity.cross(m_x[j] - m_translation) + m_velocity;
+		}
+	}
 }
 
 void BoundaryModel::performNeighborhoodSearchSort()
 {
 	const unsigned int numPart = numberOfParticles();
 
-	// sort static boundaries only once
-	if ((numPart == 0) || (!m_rigidBody->isDynamic() && !m_sorted))
+	// sort static boundaries only once, body-local models are sorted by their own grid
+	if ((numPart == 0) || (!m_rigidBody->isDynamic() && !m_sorted) || m_bodyLocal)
 		return;
 
 	NeighborhoodSearch *neighborhoodSearch = Simulation::getCurrent()->getNeighborhoodSearch();
@@ -150,6 +335,8 @@ void BoundaryModel::getForceAndTorque(Vector3r &force, Vector3r &torque)
 		force += m_forcePerThread[j];
 		torque += m_torquePerThread[j];
 	}
+	// torque with respect to the center of mass of the pose the forces were computed for
+	torque -= m_translation.cross(force);
 }
 
 void BoundaryModel::clearForceAndTorque()
@@ -166,3 +353,15 @@ void BoundaryModel::clearForceAndTorque()
 		m_torquePerThread[j].setZero();
 	}
 }
+
+size_t BoundaryModel::getMemoryUsage() const
+{
+	return vectorMemory(m_x0) +
+		vectorMemory(m_x) +
+		vectorMemory(m_v) +
+		vectorMemory(m_V) +
+		vectorMemory(m_forcePerThread) +
+		vectorMemory(m_torquePerThread) +
+		vectorMemory(m_cellStart) +
+		vectorMemory(m_transformFlags);
+}
@@ -3,6 +3,7 @@
 
 #include "Common.h"
 #include <vector>
+#include <atomic>
 
 #include "RigidBodyObject.h"
 #include "SPHKernels.h"
@@ -11,7 +12,12 @@ namespace SPH
 {	
 	class TimeStep;
 
-	/** \brief The boundary model stores the information required for boundary handling
+	/** \brief The boundary model stores the information required for boundary handling.
+	* The particles of a dynamic body are given in body-local coordinates (getPosition0()).
+	* Without GPU neighborhood search, dynamic bodies are body-local: their particles
+	* are stored in a static grid in body-local coordinates and only the particles
+	* which have fluid neighbors are transformed to world space in each step
+	* (see BodyLocalNeighborhoodSearch).
 	*/
 	class BoundaryModel 
 	{
@@ -30,18 +36,72 @@ namespace SPH
 			bool m_sorted;
 			unsigned int m_pointSetIndex;
 
+			// body-local neighborhood search
+			bool m_bodyLocal;
+			Matrix3r m_R;
+			Vector3r m_translation;
+			Vector3r m_velocity;
+			Vector3r m_angularVelocity;
+			Real m_searchRadius;
+			Real m_cellSize;
+			Vector3r m_gridMin;
+			Vector3r m_gridMax;
+			unsigned int m_gridRes[3];
+			/** Start index of the particles of each grid cell, the particles are sorted by cells */
+			std::vector<unsigned int> m_cellStart;
+			/** Marks the particles which are transformed in the current search */
+			std::vector<std::atomic<unsigned char>> m_transformFlags;
+
+			/** Sort the particles by the cells of a grid in body-local coordinates. */
+			void initBodyLocalGrid();
+
 		public:
 			unsigned int numberOfParticles() const { return static_cast<unsigned int>(m_x.size()); }
 
 			void computeBoundaryVolume();
 
+			unsigned int getPointSetIndex() const { return m_pointSetIndex; }
+			bool isBodyLocal() const { return m_bodyLocal; }
+
+			/** Set the transformation and the velocities of the body. Body-local
+			* models only transform the particles with fluid neighbors in the
+			* neighborhood search, all other models must call updateParticles().
+			*/
+			void setTransformation(const Matrix3r &R, const Vector3r &x, const Vector3r &v, const Vector3r &omega);
+			/** Transform all particles to world space using the current transformation. */
+			void updateParticles();
+
+			/** Rebuild the body-local grid if the support radius has changed. */
+			void prepareBodyLocalSearch();
+			/** Append the indices of all particles within the support radius of the
+			* world space position x. Particles which were not found before in the current
+			* search are also appended to newParticles and must be transformed by
+			* transformParticle().
+			*/
+			unsigned int findNeighbors(const Vector3r &x, std::vector<unsigned int> &neighbors, std::vector<unsigned int> &newParticles);
+			FORCE_INLINE void transformParticle(const unsigned int i)
+			{
+				m_x[i] = m_R * m_x0[i] + m_translation;
+				m_v[i] = m_angularVelocity.cross(m_x[i] - m_translation) + m_velocity;
+				m_transformFlags[i].store(0, std::memory_order_relaxed);
+			}
+
 			virtual void reset();
 
 			void performNeighborhoodSearchSort();
 
+			/** Return the allocated memory of the boundary particle data in bytes. */
+			size_t getMemoryUsage() const;
+
 			void initModel(RigidBodyObject *rbo, const unsigned int numBoundaryParticles, Vector3r *boundaryParticles);
 			RigidBodyObject* getRigidBodyObject() { return m_rigidBody; }
 
+			/** Add a force which acts at the position pos. The torque is accumulated
+			* with respect to the origin and transformed to the center of mass in
+			* getForceAndTorque(), so the rigid body is not accessed during the
+			* fluid step. The center of mass is taken from the current transformation
+			* of the model, i.e. the pose which was used in the fluid step.
+			*/
 			FORCE_INLINE void addForce(const Vector3r &pos, const Vector3r &f)
 			{
 				if (m_rigidBody->isDynamic())
@@ -52,7 +112,7 @@ namespace SPH
 					int tid = 0;
 					#endif
 					m_forcePerThread[tid] += f;
-					m_torquePerThread[tid] += (pos - m_rigidBody->getPosition()).cross(f);
+					m_torquePerThread[tid] += pos.cross(f);
 				}
 			}
 
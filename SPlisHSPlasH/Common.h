@@ -21,6 +21,17 @@ typedef float Real;
 #define RealVectorParameterType ParameterBase::VEC_FLOAT
 #endif
 
+/** Type of sums over many particles or neighbors (densities, solver residuals,
+* CG vectors). In a mixed-precision build (USE_MIXED_PRECISION) the particle
+* data is stored in single precision but these values are accumulated in double
+* precision.
+*/
+#if defined(USE_DOUBLE) || defined(USE_MIXED_PRECISION)
+typedef double AccumReal;
+#else
+typedef float AccumReal;
+#endif
+
 using Vector2r = Eigen::Matrix<Real, 2, 1>;
 using Vector3r = Eigen::Matrix<Real, 3, 1>;
 using Vector4r = Eigen::Matrix<Real, 4, 1>;
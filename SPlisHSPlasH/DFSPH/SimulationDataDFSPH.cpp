@@ -1,4 +1,5 @@
 #include "SimulationDataDFSPH.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/SPHKernels.h"
 #include "SPlisHSPlasH/Simulation.h"
 
@@ -102,3 +103,11 @@ void SimulationDataDFSPH::emittedParticles(FluidModel *model, const unsigned int
 		m_kappaV[fluidModelIndex][j] = 0.0;
 	}
 }
+
+size_t SimulationDataDFSPH::getMemoryUsage() const
+{
+	return vectorMemory(m_factor) +
+		vectorMemory(m_kappa) +
+		vectorMemory(m_kappaV) +
+		vectorMemory(m_density_adv);
+}
@@ -44,6 +44,10 @@ namespace SPH
 			 * to call the z_sort of the neighborhood search.
 			 */
 			void performNeighborhoodSearchSort();
+
+			/** Return the allocated memory of the particle data in bytes.
+			*/
+			size_t getMemoryUsage() const;
 			void emittedParticles(FluidModel *model, const unsigned int startIndex);
 
 			FORCE_INLINE const Real getFactor(const unsigned int fluidIndex, const unsigned int i) const
@@ -139,6 +139,7 @@ void TimeStepDFSPH::step()
 	STOP_TIMING_AVG;
 
 	// compute final positions
+	const bool sim2D = sim->is2DSimulation();
 	for (unsigned int m = 0; m < nModels; m++)
 	{
 		FluidModel *fm = sim->getFluidModel(m);
@@ -154,6 +155,8 @@ void TimeStepDFSPH::step()
 					const Vector3r &vi = fm->getVelocity(i);
 					xi += h * vi;
 				}
+				if (sim2D)
+					projectTo2D(fm, i);
 			}
 		}
 	}
@@ -326,7 +329,7 @@ void TimeStepDFSPH::pressureSolve()
 			#pragma omp for schedule(static)  
 			for (int i = 0; i < numParticles; i++)
 			{
-				computeDensityAdv(fluidModelIndex, i, numParticles, h, density0);
+				computeDensityAdv(sim, fluidModelIndex, i, numParticles, h, density0);
 				m_simulationData.getFactor(fluidModelIndex, i) *= invH2;
 #ifdef USE_WARMSTART
 				m_simulationData.getKappa(fluidModelIndex, i) = 0.0;
@@ -392,7 +395,7 @@ void TimeStepDFSPH::pressureSolveIteration(const unsigned int fluidModelIndex, R
 	const unsigned int nFluids = sim->numberOfFluidModels();
 	const Real h = TimeManager::getCurrent()->getTimeStepSize();
 	const Real invH = 1.0 / h;
-	Real density_error = 0.0;
+	AccumReal density_error = 0.0;
 
 	#pragma omp parallel default(shared)
 	{
@@ -454,13 +457,13 @@ void TimeStepDFSPH::pressureSolveIteration(const unsigned int fluidModelIndex, R
 		#pragma omp for reduction(+:density_error) schedule(static) 
 		for (int i = 0; i < numParticles; i++)
 		{
-			computeDensityAdv(fluidModelIndex, i, numParticles, h, density0);
+			computeDensityAdv(sim, fluidModelIndex, i, numParticles, h, density0);
 
 			density_error += density0 * m_simulationData.getDensityAdv(fluidModelIndex, i) - density0;
 		}
 	}
 
-	avg_density_err = density_error / numParticles;
+	avg_density_err = static_cast<Real>(density_error / numParticles);
 }
 
 #ifdef USE_WARMSTART_V
@@ -486,7 +489,7 @@ void TimeStepDFSPH::warmstartDivergenceSolve(const unsigned int fluidModelIndex)
 		for (int i = 0; i < numParticles; i++)
 		{
 			m_simulationData.getKappaV(fluidModelIndex, i) = static_cast<Real>(0.5)*max(m_simulationData.getKappaV(fluidModelIndex, i)*invH, -static_cast<Real>(0.5) * density0*density0);
-			computeDensityChange(fluidModelIndex, i, h);
+			computeDensityChange(sim, fluidModelIndex, i, h);
 		}
 
 		#pragma omp for schedule(static)  
@@ -564,7 +567,7 @@ void TimeStepDFSPH::divergenceSolve()
 			#pragma omp for schedule(static)  
 			for (int i = 0; i < numParticles; i++)
 			{
-				computeDensityChange(fluidModelIndex, i, h);
+				computeDensityChange(sim, fluidModelIndex, i, h);
 				m_simulationData.getFactor(fluidModelIndex, i) *= invH;
 
 #ifdef USE_WARMSTART_V
@@ -636,7 +639,7 @@ void TimeStepDFSPH::divergenceSolveIteration(const unsigned int fluidModelIndex,
 	const unsigned int nFluids = sim->numberOfFluidModels();
 	const Real h = TimeManager::getCurrent()->getTimeStepSize();
 	const Real invH = 1.0 / h;
-	Real density_error = 0.0;
+	AccumReal density_error = 0.0;
 
 	//////////////////////////////////////////////////////////////////////////
 	// Perform Jacobi iteration over all blocks
@@ -696,18 +699,17 @@ void TimeStepDFSPH::divergenceSolveIteration(const unsigned int fluidModelIndex,
 		#pragma omp for reduction(+:density_error) schedule(static) 
 		for (int i = 0; i < (int)numParticles; i++)
 		{
-			computeDensityChange(fluidModelIndex, i, h);
+			computeDensityChange(sim, fluidModelIndex, i, h);
 			density_error += density0 * m_simulationData.getDensityAdv(fluidModelIndex, i);
 		}
 	}
 
-	avg_density_err = density_error/numParticles;
+	avg_density_err = static_cast<Real>(density_error / numParticles);
 }
 
 
-void TimeStepDFSPH::computeDensityAdv(const unsigned int fluidModelIndex, const unsigned int i, const int numParticles, const Real h, const Real density0)
+void TimeStepDFSPH::computeDensityAdv(Simulation *sim, const unsigned int fluidModelIndex, const unsigned int i, const int numParticles, const Real h, const Real density0)
 {
-	Simulation *sim = Simulation::getCurrent();
 	FluidModel *model = sim->getFluidModel(fluidModelIndex);
 	const Real &density = model->getDensity(i);
 	Real &densityAdv = m_simulationData.getDensityAdv(fluidModelIndex, i);
@@ -736,9 +738,8 @@ void TimeStepDFSPH::computeDensityAdv(const unsigned int fluidModelIndex, const
 	densityAdv = max(densityAdv, static_cast<Real>(1.0));
 }
 
-void TimeStepDFSPH::computeDensityChange(const unsigned int fluidModelIndex, const unsigned int i, const Real h)
+void TimeStepDFSPH::computeDensityChange(Simulation *sim, const unsigned int fluidModelIndex, const unsigned int i, const Real h)
 {
-	Simulation *sim = Simulation::getCurrent();
 	FluidModel *model = sim->getFluidModel(fluidModelIndex);
 	Real &densityAdv = m_simulationData.getDensityAdv(fluidModelIndex, i);
 	const Vector3r &xi = model->getPosition(i);
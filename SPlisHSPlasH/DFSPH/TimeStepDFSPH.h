@@ -12,6 +12,7 @@
 namespace SPH
 {
 	class SimulationDataDFSPH;
+	class Simulation;
 
 	/** \brief This class implements the Divergence-free Smoothed Particle Hydrodynamics approach introduced
 	* by Bender and Koschier \cite Bender:2015, \cite Bender2017.
@@ -32,8 +33,9 @@ namespace SPH
 		void pressureSolveIteration(const unsigned int fluidModelIndex, Real &avg_density_err);
 		void divergenceSolve();
 		void divergenceSolveIteration(const unsigned int fluidModelIndex, Real &avg_density_err);
-		void computeDensityAdv(const unsigned int fluidModelIndex, const unsigned int index, const int numParticles, const Real h, const Real density0);
-		void computeDensityChange(const unsigned int fluidModelIndex, const unsigned int index, const Real h);
+		/** The density helpers are called by the OpenMP worker threads, so the simulation is passed as parameter. */
+		void computeDensityAdv(Simulation *sim, const unsigned int fluidModelIndex, const unsigned int index, const int numParticles, const Real h, const Real density0);
+		void computeDensityChange(Simulation *sim, const unsigned int fluidModelIndex, const unsigned int index, const Real h);
 
 #ifdef USE_WARMSTART_V
 		void warmstartDivergenceSolve(const unsigned int fluidModelIndex);
@@ -58,6 +60,8 @@ namespace SPH
 		TimeStepDFSPH();
 		virtual ~TimeStepDFSPH(void);
 
+		virtual size_t getMemoryUsage() const { return m_simulationData.getMemoryUsage(); }
+
 		virtual void step();
 		virtual void reset();
 
@@ -20,27 +20,27 @@ DragForce_Gissler2017::~DragForce_Gissler2017(void)
 {
 }
 
-void DragForce_Gissler2017::step()
+DragForce_Gissler2017::FusedTerm::FusedTerm(DragForce_Gissler2017 *drag)
 {
-	Simulation *sim = Simulation::getCurrent();
-	const Real supportRadius = sim->getSupportRadius();
-	const Real radius = sim->getValue<Real>(Simulation::PARTICLE_RADIUS);
-	const Real diam = static_cast<Real>(2.0)*radius;
+	m_sim = Simulation::getCurrent();
+	m_drag = drag;
+	m_model = drag->getModel();
+	m_fluidModelIndex = m_model->getPointSetIndex();
+
+	const Real radius = m_sim->getValue<Real>(Simulation::PARTICLE_RADIUS);
+	m_diam = static_cast<Real>(2.0)*radius;
 	static const Real pi = static_cast<Real>(M_PI);
 	const Real rho_l = m_model->getDensity0();
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
-	const unsigned int nFluids = sim->numberOfFluidModels();
-	FluidModel *model = m_model;
+	const Real C_d = drag->C_d;
+	const Real C_k = drag->C_k;
+	const Real mu_l = drag->mu_l;
+	const Real sigma = drag->sigma;
 
+	m_L = cbrt(static_cast<Real>(0.75) / pi) * m_diam;
 
-	// Air velocity.
-	const Vector3r va(0, 0, 0);
-
-	const Real L = cbrt(static_cast<Real>(0.75) / pi) * diam;
-
-	const Real inv_td = static_cast<Real>(0.5)*C_d * mu_l / (rho_l * L*L);
+	const Real inv_td = static_cast<Real>(0.5)*C_d * mu_l / (rho_l * m_L*m_L);
 	const Real td = static_cast<Real>(1.0) / inv_td;
-	Real omegaSquare = C_k * sigma / (rho_l * L*L*L) - inv_td*inv_td;
+	Real omegaSquare = C_k * sigma / (rho_l * m_L*m_L*m_L) - inv_td*inv_td;
 	std::max(omegaSquare, static_cast<Real>(0.0));
 	const Real omega = sqrt(omegaSquare);
 
@@ -55,87 +55,70 @@ void DragForce_Gissler2017::step()
 	const Real c_def = static_cast<Real>(1.0) - exp(-t_max / td) * (cos(omega * t_max) + static_cast<Real>(1.0)/(omega*td) * sin(omega * t_max));
 
 	// Weber number without velocity
-	const Real We_i_wo_v = rho_a * L / sigma;
+	m_We_i_wo_v = drag->rho_a * m_L / sigma;
 
 	// Equation (8)
-	const Real y_coeff = (C_F * We_i_wo_v * c_def) / (C_k * C_b);
+	m_y_coeff = (drag->C_F * m_We_i_wo_v * c_def) / (C_k * drag->C_b);
 
 	const Real n_full = 38;
-	const Real n_full_23 = n_full * 2.0/3.0;
-	
-	const unsigned int numParticles = m_model->numActiveParticles();
-	#pragma omp parallel default(shared)
-	{
-		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
-		{
-			const Vector3r &vi = m_model->getVelocity(i);
-			Vector3r v_i_rel = va - vi;
-			const Real vi_rel_square = v_i_rel.squaredNorm();
-			const Real vi_rel_norm = sqrt(vi_rel_square);
-			const Real We_i = We_i_wo_v * vi_rel_square;
-
-			Vector3r v_i_rel_n = v_i_rel;
-			if (vi_rel_norm <= 1.0e-6)
-				continue;
-			// Else.
-			v_i_rel_n = v_i_rel_n * (1.0 / vi_rel_norm);
- 
-			// Equation (8)
-			const Real y_i_max = std::min(vi_rel_square * y_coeff, static_cast<Real>(1.0));
-
-			const Real Re_i = static_cast<Real>(2.0)*std::max((rho_a * vi_rel_norm * L) / mu_a, static_cast<Real>(0.1));
-
-			Real C_Di_sphere;
-			if (Re_i <= 1000.0)
-				C_Di_sphere = static_cast<Real>(24.0) / Re_i * (static_cast<Real>(1.0) + static_cast<Real>(1.0/6.0) * pow(Re_i, static_cast<Real>(2.0/3.0)));
-			else
-				C_Di_sphere = static_cast<Real>(0.424);
-
-			// Equation (9)
-			const Real C_Di_Liu = C_Di_sphere * (static_cast<Real>(1.0) + static_cast<Real>(2.632) * y_i_max);
-
-			unsigned int numNeighbors = sim->numberOfNeighbors(0, i);
-			for (unsigned int pid = 1; pid < sim->numberOfPointSets(); pid++)
-				numNeighbors += sim->numberOfNeighbors(pid, i);
-
-			// Equation (10)
-			Real C_Di;
-			const Real factor_n = std::min(n_full_23, (Real) numNeighbors) / n_full_23;
-			if (numNeighbors == 0)
-				C_Di = C_Di_Liu;
-			else
-				C_Di = (static_cast<Real>(1.0) - factor_n) * C_Di_Liu + factor_n;
-
-			// Equation (12)
-			const Real h1 = (L + C_b*L*y_i_max);
-			const Real A_i_droplet = pi * h1*h1;
-
-			// Equation (13)
-			const Real A_i_unoccluded = (static_cast<Real>(1.0) - factor_n) * A_i_droplet + factor_n * diam*diam;
-
-			//////////////////////////////////////////////////////////////////////////
-			// Fluid
-			//////////////////////////////////////////////////////////////////////////
-			Real max_v_x = 0.0;
-			const Vector3r &xi = m_model->getPosition(i);
-			forall_fluid_neighbors_in_same_phase(
-				Vector3r xixj = xi - xj;
-				xixj.normalize();
-				const Real x_v = v_i_rel_n.dot(xixj);
-				max_v_x = std::max(max_v_x, x_v);
-			)
-			// Equation (15)
-			const Real w_i = std::max(static_cast<Real>(0.0), std::min(static_cast<Real>(1.0), static_cast<Real>(1.0) - max_v_x));
-
-			// Equation (14)
-			const Real A_i = w_i * A_i_unoccluded;
-
-			// Drag force. Additionally dividing by mass to get acceleration.
-			Vector3r &ai = m_model->getAcceleration(i);
-			ai += m_dragCoefficient * static_cast<Real>(0.5) / m_model->getMass(i) * rho_a * (v_i_rel * vi_rel_norm) * C_Di * A_i;
-		}
-	}
+	m_n_full_23 = n_full * 2.0/3.0;
+}
+
+void DragForce_Gissler2017::FusedTerm::beginParticle(const unsigned int i, const Vector3r &xi)
+{
+	static const Real pi = static_cast<Real>(M_PI);
+	const Real C_b = m_drag->C_b;
+
+	// Air velocity.
+	const Vector3r va(0, 0, 0);
+
+	const Vector3r &vi = m_model->getVelocity(i);
+	m_v_i_rel = va - vi;
+	const Real vi_rel_square = m_v_i_rel.squaredNorm();
+	m_vi_rel_norm = sqrt(vi_rel_square);
+	m_max_v_x = 0.0;
+
+	m_skip = (m_vi_rel_norm <= 1.0e-6);
+	if (m_skip)
+		return;
+	m_v_i_rel_n = m_v_i_rel * (1.0 / m_vi_rel_norm);
+
+	// Equation (8)
+	const Real y_i_max = std::min(vi_rel_square * m_y_coeff, static_cast<Real>(1.0));
+
+	const Real Re_i = static_cast<Real>(2.0)*std::max((m_drag->rho_a * m_vi_rel_norm * m_L) / m_drag->mu_a, static_cast<Real>(0.1));
+
+	Real C_Di_sphere;
+	if (Re_i <= 1000.0)
+		C_Di_sphere = static_cast<Real>(24.0) / Re_i * (static_cast<Real>(1.0) + static_cast<Real>(1.0/6.0) * pow(Re_i, static_cast<Real>(2.0/3.0)));
+	else
+		C_Di_sphere = static_cast<Real>(0.424);
+
+	// Equation (9)
+	const Real C_Di_Liu = C_Di_sphere * (static_cast<Real>(1.0) + static_cast<Real>(2.632) * y_i_max);
+
+	unsigned int numNeighbors = m_sim->numberOfNeighbors(0, i);
+	for (unsigned int pid = 1; pid < m_sim->numberOfPointSets(); pid++)
+		numNeighbors += m_sim->numberOfNeighbors(pid, i);
+
+	// Equation (10)
+	const Real factor_n = std::min(m_n_full_23, (Real) numNeighbors) / m_n_full_23;
+	if (numNeighbors == 0)
+		m_C_Di = C_Di_Liu;
+	else
+		m_C_Di = (static_cast<Real>(1.0) - factor_n) * C_Di_Liu + factor_n;
+
+	// Equation (12)
+	const Real h1 = (m_L + C_b*m_L*y_i_max);
+	const Real A_i_droplet = pi * h1*h1;
+
+	// Equation (13)
+	m_A_i_unoccluded = (static_cast<Real>(1.0) - factor_n) * A_i_droplet + factor_n * m_diam*m_diam;
+}
+
+void DragForce_Gissler2017::step()
+{
+	NonPressureForceFusion::computeForces(m_model, FusedTerm(this));
 }
 
 
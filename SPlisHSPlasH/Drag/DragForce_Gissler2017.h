@@ -4,6 +4,7 @@
 #include "SPlisHSPlasH/Common.h"
 #include "SPlisHSPlasH/FluidModel.h"
 #include "DragBase.h"
+#include "SPlisHSPlasH/NonPressureForceFusion.h"
 
 namespace SPH
 {
@@ -23,6 +24,59 @@ namespace SPH
 		const Real mu_a = 0.00001845;		
 
 	public:
+		/** Term of the method for the fused neighbor pass (see NonPressureForceFusion). */
+		struct FusedTerm : public NoFusedTerm
+		{
+			static const bool usesFluidNeighbors = true;
+
+			Simulation *m_sim;
+			DragForce_Gissler2017 *m_drag;
+			FluidModel *m_model;
+			unsigned int m_fluidModelIndex;
+			Real m_diam;
+			Real m_L;
+			Real m_We_i_wo_v;
+			Real m_y_coeff;
+			Real m_n_full_23;
+			/** per-particle values */
+			bool m_skip;
+			Vector3r m_v_i_rel;
+			Vector3r m_v_i_rel_n;
+			Real m_vi_rel_norm;
+			Real m_C_Di;
+			Real m_A_i_unoccluded;
+			Real m_max_v_x;
+
+			FusedTerm(DragForce_Gissler2017 *drag);
+
+			void beginParticle(const unsigned int i, const Vector3r &xi);
+
+			FORCE_INLINE void fluidNeighbor(const unsigned int pid, FluidModel *fm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj)
+			{
+				// only neighbors in the same phase
+				if (m_skip || (pid != m_fluidModelIndex))
+					return;
+				Vector3r xixj = xi - xj;
+				xixj.normalize();
+				const Real x_v = m_v_i_rel_n.dot(xixj);
+				m_max_v_x = std::max(m_max_v_x, x_v);
+			}
+
+			FORCE_INLINE void endParticle(const unsigned int i, Vector3r &ai)
+			{
+				if (m_skip)
+					return;
+				// Equation (15)
+				const Real w_i = std::max(static_cast<Real>(0.0), std::min(static_cast<Real>(1.0), static_cast<Real>(1.0) - m_max_v_x));
+
+				// Equation (14)
+				const Real A_i = w_i * m_A_i_unoccluded;
+
+				// Drag force. Additionally dividing by mass to get acceleration.
+				ai += m_drag->m_dragCoefficient * static_cast<Real>(0.5) / m_model->getMass(i) * m_drag->rho_a * (m_v_i_rel * m_vi_rel_norm) * m_C_Di * A_i;
+			}
+		};
+
 		DragForce_Gissler2017(FluidModel *model);
 		virtual ~DragForce_Gissler2017(void);
 
@@ -12,22 +12,16 @@ DragForce_Macklin2014::~DragForce_Macklin2014(void)
 {
 }
 
+DragForce_Macklin2014::FusedTerm::FusedTerm(DragForce_Macklin2014 *drag)
+{
+	m_model = drag->getModel();
+	m_dragCoefficient = drag->m_dragCoefficient;
+	m_density0 = m_model->getDensity0();
+}
+
 void DragForce_Macklin2014::step()
 {
-	const Real density0 = m_model->getDensity0();
-
-	const unsigned int numParticles = m_model->numActiveParticles();
-
-	#pragma omp parallel default(shared)
-	{
-		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
-		{
-			Vector3r &ai = m_model->getAcceleration(i);
-			const Vector3r &vi = m_model->getVelocity(i);
-			ai -= m_dragCoefficient * static_cast<Real>(1.0) / m_model->getMass(i) * vi * (1.0 - m_model->getDensity(i) / density0);
-		}
-	}
+	NonPressureForceFusion::computeForces(m_model, FusedTerm(this));
 }
 
 
@@ -4,6 +4,7 @@
 #include "SPlisHSPlasH/Common.h"
 #include "SPlisHSPlasH/FluidModel.h"
 #include "DragBase.h"
+#include "SPlisHSPlasH/NonPressureForceFusion.h"
 
 namespace SPH
 {
@@ -13,6 +14,22 @@ namespace SPH
 	class DragForce_Macklin2014 : public DragBase
 	{
 	public:
+		/** Term of the method for the fused neighbor pass (see NonPressureForceFusion). */
+		struct FusedTerm : public NoFusedTerm
+		{
+			FluidModel *m_model;
+			Real m_dragCoefficient;
+			Real m_density0;
+
+			FusedTerm(DragForce_Macklin2014 *drag);
+
+			FORCE_INLINE void endParticle(const unsigned int i, Vector3r &ai)
+			{
+				const Vector3r &vi = m_model->getVelocity(i);
+				ai -= m_dragCoefficient * static_cast<Real>(1.0) / m_model->getMass(i) * vi * (1.0 - m_model->getDensity(i) / m_density0);
+			}
+		};
+
 		DragForce_Macklin2014(FluidModel *model);
 		virtual ~DragForce_Macklin2014(void);
 
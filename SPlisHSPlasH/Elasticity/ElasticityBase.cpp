@@ -1,4 +1,6 @@
 #include "ElasticityBase.h"
+#include "SPlisHSPlasH/Simulation.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 
 using namespace SPH;
 using namespace GenParam;
@@ -38,3 +40,71 @@ void ElasticityBase::initParameters()
 }
 
 
+
+void ElasticityBase::initRestNeighborhoods()
+{
+	Simulation *sim = Simulation::getCurrent();
+	const unsigned int numParticles = m_model->numActiveParticles();
+	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
+
+	m_current_to_initial_index.resize(numParticles);
+	m_initial_to_current_index.resize(numParticles);
+	m_neighborOffsets.resize(numParticles + 1);
+
+	// only neighbors in same phase will influence elasticity
+	m_neighborOffsets[0] = 0;
+	for (unsigned int i = 0; i < numParticles; i++)
+		m_neighborOffsets[i + 1] = m_neighborOffsets[i] + sim->numberOfNeighbors(fluidModelIndex, fluidModelIndex, i);
+	m_initialNeighbors.resize(m_neighborOffsets[numParticles]);
+	m_neighbors.resize(m_neighborOffsets[numParticles]);
+
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			m_current_to_initial_index[i] = i;
+			m_initial_to_current_index[i] = i;
+
+			const unsigned int offset = m_neighborOffsets[i];
+			const unsigned int numNeighbors = m_neighborOffsets[i + 1] - offset;
+			for (unsigned int j = 0; j < numNeighbors; j++)
+			{
+				m_initialNeighbors[offset + j] = sim->getNeighbor(fluidModelIndex, fluidModelIndex, i, j);
+				m_neighbors[offset + j] = m_initialNeighbors[offset + j];
+			}
+		}
+	}
+}
+
+void ElasticityBase::sortRestNeighborhoods()
+{
+	const unsigned int numPart = m_model->numActiveParticles();
+	if (numPart == 0)
+		return;
+
+	Simulation *sim = Simulation::getCurrent();
+	auto const& d = sim->getNeighborhoodSearch()->point_set(m_model->getPointSetIndex());
+	d.sort_field(&m_current_to_initial_index[0]);
+
+	// The rows are stored in the initial order, so only the neighbor indices change.
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)numPart; i++)
+			m_initial_to_current_index[m_current_to_initial_index[i]] = i;
+
+		#pragma omp for schedule(static)
+		for (int k = 0; k < (int)m_neighbors.size(); k++)
+			m_neighbors[k] = m_initial_to_current_index[m_initialNeighbors[k]];
+	}
+}
+
+size_t ElasticityBase::getRestNeighborhoodMemoryUsage() const
+{
+	return vectorMemory(m_current_to_initial_index) +
+		vectorMemory(m_initial_to_current_index) +
+		vectorMemory(m_neighborOffsets) +
+		vectorMemory(m_initialNeighbors) +
+		vectorMemory(m_neighbors);
+}
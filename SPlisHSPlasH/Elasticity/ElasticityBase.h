@@ -8,6 +8,12 @@
 namespace SPH
 {
 	/** \brief Base class for all elasticity methods.
+	*
+	* The neighborhoods in the rest configuration are stored in CSR format:
+	* the neighbors of the particle with the initial index i0 are the entries
+	* m_neighborOffsets[i0],...,m_neighborOffsets[i0+1]-1. Derived methods store
+	* their precomputed rest state quantities of the pairs in arrays with the
+	* same layout.
 	*/
 	class ElasticityBase : public NonPressureForceBase
 	{
@@ -15,8 +21,25 @@ namespace SPH
 		Real m_youngsModulus;
 		Real m_poissonRatio;
 
+		// initial particle indices, used to access their original positions
+		std::vector<unsigned int> m_current_to_initial_index;
+		std::vector<unsigned int> m_initial_to_current_index;
+		// initial particle neighborhood (CSR)
+		std::vector<unsigned int> m_neighborOffsets;
+		std::vector<unsigned int> m_initialNeighbors;
+		// current indices of the initial neighbors
+		std::vector<unsigned int> m_neighbors;
+
 		virtual void initParameters();
 
+		/** Store the current neighborhoods in the same phase as rest neighborhoods.
+		* The current particle order is used as initial order.
+		*/
+		void initRestNeighborhoods();
+		/** Sort the index maps after a z-sort and update the current neighbor indices. */
+		void sortRestNeighborhoods();
+		size_t getRestNeighborhoodMemoryUsage() const;
+
 	public:
 		static int YOUNGS_MODULUS;
 		static int POISSON_RATIO;
@@ -1,4 +1,5 @@
 #include "Elasticity_Becker2009.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/Simulation.h"
 #include "SPlisHSPlasH/Utilities/MathFunctions.h"
 
@@ -13,9 +14,6 @@ Elasticity_Becker2009::Elasticity_Becker2009(FluidModel *model) :
 {
 	const unsigned int numParticles = model->numActiveParticles();
 	m_restVolumes.resize(numParticles);
-	m_current_to_initial_index.resize(numParticles);
-	m_initial_to_current_index.resize(numParticles);
-	m_initialNeighbors.resize(numParticles);
 	m_rotations.resize(numParticles, Matrix3r::Identity());
 	m_stress.resize(numParticles);
 	m_F.resize(numParticles);
@@ -69,23 +67,19 @@ void Elasticity_Becker2009::initValues()
 	const unsigned int numParticles = model->numActiveParticles();
 	const unsigned int fluidModelIndex = model->getPointSetIndex();
 
-	// Store the neighbors in the reference configurations and
+	// Store the neighbors in the reference configurations
+	initRestNeighborhoods();
+	const unsigned int numEntries = static_cast<unsigned int>(m_initialNeighbors.size());
+	m_restDiff.resize(numEntries);
+	m_restW.resize(numEntries);
+	m_restGradW.resize(numEntries);
+
 	// compute the volume of each particle in rest state
 	#pragma omp parallel default(shared)
 	{
 		#pragma omp for schedule(static) 
 		for (int i = 0; i < (int)numParticles; i++)
 		{
-			m_current_to_initial_index[i] = i;
-			m_initial_to_current_index[i] = i;
-
-			// only neighbors in same phase will influence elasticity
-			const unsigned int numNeighbors = sim->numberOfNeighbors(fluidModelIndex, fluidModelIndex, i);
-			m_initialNeighbors[i].resize(numNeighbors);
-			for (unsigned int j = 0; j < numNeighbors; j++)
-				m_initialNeighbors[i][j] = sim->getNeighbor(fluidModelIndex, fluidModelIndex, i, j);
-
-			// compute volume
 			Real density = model->getMass(i) * sim->W_zero();
 			const Vector3r &xi = model->getPosition(i);
 			forall_fluid_neighbors_in_same_phase(
@@ -94,6 +88,24 @@ void Elasticity_Becker2009::initValues()
 			m_restVolumes[i] = model->getMass(i) / density;
 		}
 	}
+
+	// precompute the kernel values and gradients of the rest configuration
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static) 
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			const Vector3r &xi0 = model->getPosition0(i);
+			for (unsigned int k = m_neighborOffsets[i]; k < m_neighborOffsets[i + 1]; k++)
+			{
+				const unsigned int neighborIndex = m_initialNeighbors[k];
+				const Vector3r xj_xi_0 = model->getPosition0(neighborIndex) - xi0;
+				m_restDiff[k] = xj_xi_0;
+				m_restW[k] = sim->W(xj_xi_0);
+				m_restGradW[k] = m_restVolumes[neighborIndex] * sim->gradW(xj_xi_0);
+			}
+		}
+	}
 }
 
 void Elasticity_Becker2009::step()
@@ -118,17 +130,12 @@ void Elasticity_Becker2009::performNeighborhoodSearchSort()
 	Simulation *sim = Simulation::getCurrent();
 	auto const& d = sim->getNeighborhoodSearch()->point_set(m_model->getPointSetIndex());
 	d.sort_field(&m_restVolumes[0]);
-	d.sort_field(&m_current_to_initial_index[0]);
-
-	for (unsigned int i = 0; i < numPart; i++)
-		m_initial_to_current_index[m_current_to_initial_index[i]] = i;
+	sortRestNeighborhoods();
 }
 
 void Elasticity_Becker2009::computeRotations()
 {
-	Simulation *sim = Simulation::getCurrent();
 	const unsigned int numParticles = m_model->numActiveParticles();
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
 	FluidModel *model = m_model;
 
 	#pragma omp parallel default(shared)
@@ -138,26 +145,18 @@ void Elasticity_Becker2009::computeRotations()
 		{
 			const unsigned int i0 = m_current_to_initial_index[i];
 			const Vector3r &xi = m_model->getPosition(i);
-			const Vector3r &xi0 = m_model->getPosition0(i0);
 			Matrix3r Apq;
 			Apq.setZero();
 
-			const size_t numNeighbors = m_initialNeighbors[i0].size();
-
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
-			for (unsigned int j = 0; j < numNeighbors; j++)
+			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
 			{
-				const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-				// get initial neighbor index considering the current particle order 
-				const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
-
+				const unsigned int neighborIndex = m_neighbors[k];
 				const Vector3r &xj = model->getPosition(neighborIndex);
-				const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
 				const Vector3r xj_xi = xj - xi;
-				const Vector3r xj_xi_0 = xj0 - xi0;
-				Apq += m_model->getMass(neighborIndex) * sim->W(xj_xi_0) * (xj_xi * xj_xi_0.transpose());
+				Apq += m_model->getMass(neighborIndex) * m_restW[k] * (xj_xi * m_restDiff[k].transpose());
 			}
 
 // 			Vector3r sigma;
@@ -173,9 +172,7 @@ void Elasticity_Becker2009::computeRotations()
 
 void Elasticity_Becker2009::computeStress()
 {
-	Simulation *sim = Simulation::getCurrent();
 	const unsigned int numParticles = m_model->numActiveParticles();
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
 	FluidModel *model = m_model;
 
 	// Elasticity tensor
@@ -193,30 +190,21 @@ void Elasticity_Becker2009::computeStress()
 		{
 			const unsigned int i0 = m_current_to_initial_index[i];
 			const Vector3r &xi = m_model->getPosition(i);
-			const Vector3r &xi0 = m_model->getPosition0(i0);
 
 			Matrix3r nablaU;
 			nablaU.setZero();
-			const size_t numNeighbors = m_initialNeighbors[i0].size();
 
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
-			for (unsigned int j = 0; j < numNeighbors; j++)
+			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
 			{
-				const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-				// get initial neighbor index considering the current particle order 
-				const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
-
-				const Vector3r &xj = model->getPosition(neighborIndex);
-				const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
-
+				const Vector3r &xj = model->getPosition(m_neighbors[k]);
 				const Vector3r xj_xi = xj - xi;
-				const Vector3r xj_xi_0 = xj0 - xi0;
 
-				const Vector3r uji = m_rotations[i].transpose() * xj_xi - xj_xi_0;
+				const Vector3r uji = m_rotations[i].transpose() * xj_xi - m_restDiff[k];
 				// subtract because kernel gradient is taken in direction of xji0 instead of xij0
-				nablaU -= (m_restVolumes[neighborIndex] * uji) * sim->gradW(xj_xi_0).transpose();
+				nablaU -= uji * m_restGradW[k].transpose();
 			}
 			m_F[i] = nablaU + Matrix3r::Identity();
 
@@ -237,9 +225,7 @@ void Elasticity_Becker2009::computeStress()
 
 void Elasticity_Becker2009::computeForces()
 {
-	Simulation *sim = Simulation::getCurrent();
 	const unsigned int numParticles = m_model->numActiveParticles();
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
 	FluidModel *model = m_model;
 
 	#pragma omp parallel default(shared)
@@ -248,39 +234,28 @@ void Elasticity_Becker2009::computeForces()
 		for (int i = 0; i < (int)numParticles; i++)
 		{
 			const unsigned int i0 = m_current_to_initial_index[i];
-			const Vector3r &xi0 = m_model->getPosition0(i0);
-
-			const size_t numNeighbors = m_initialNeighbors[i0].size();
-			Vector3r fi;
-			fi.setZero();
+			const unsigned int offset = m_neighborOffsets[i0];
+			const unsigned int numNeighbors = m_neighborOffsets[i0 + 1] - offset;
 
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
-			for (unsigned int j = 0; j < numNeighbors; j++)
+			// f_ij = -V_i V_j sigma_j gradW0 and f_ji = V_i V_j sigma_i gradW0,
+			// the volume V_j is contained in the precomputed gradient.
+			Vector3r fj, sumGradW;
+			fj.setZero();
+			sumGradW.setZero();
+			for (unsigned int k = offset; k < offset + numNeighbors; k++)
 			{
-				const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-				// get initial neighbor index considering the current particle order 
-				const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
-
-				const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
-
-				const Vector3r xj_xi_0 = xj0 - xi0;
-				const Vector3r gradW0 = sim->gradW(xj_xi_0);
-
-				const Vector3r dji = m_restVolumes[i] * gradW0;
-				const Vector3r dij = -m_restVolumes[neighborIndex] * gradW0;
-
-				Vector3r sdji, sdij;
-				symMatTimesVec(m_stress[neighborIndex], dji, sdji);
-				symMatTimesVec(m_stress[i], dij, sdij);
-
-				const Vector3r fij = -m_restVolumes[neighborIndex] * sdji;
-				const Vector3r fji = -m_restVolumes[i] * sdij;
-
-				fi += m_rotations[neighborIndex] * fij - m_rotations[i] * fji;
+				const unsigned int neighborIndex = m_neighbors[k];
+				Vector3r sg;
+				symMatTimesVec(m_stress[neighborIndex], m_restGradW[k], sg);
+				fj += m_rotations[neighborIndex] * sg;
+				sumGradW += m_restGradW[k];
 			}
-			fi = 0.5*fi;
+			Vector3r si;
+			symMatTimesVec(m_stress[i], sumGradW, si);
+			Vector3r fi = -static_cast<Real>(0.5) * m_restVolumes[i] * (fj + m_rotations[i] * si);
 
 			if (m_alpha != 0.0)
 			{
@@ -292,14 +267,10 @@ void Elasticity_Becker2009::computeForces()
 				Vector3r fi_hg;
 				fi_hg.setZero();
 				const Vector3r &xi = m_model->getPosition(i);
-				for (unsigned int j = 0; j < numNeighbors; j++)
+				for (unsigned int k = offset; k < offset + numNeighbors; k++)
 				{
-					const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-					// get initial neighbor index considering the current particle order 
-					const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
-
+					const unsigned int neighborIndex = m_neighbors[k];
 					const Vector3r &xj = model->getPosition(neighborIndex);
-					const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
 
 					// Note: Ganzenmller defines xij = xj-xi
 					const Vector3r xi_xj = -(xi - xj);
@@ -307,9 +278,9 @@ void Elasticity_Becker2009::computeForces()
 					if (xixj_l > 1.0e-6)
 					{
 						// Note: Ganzenmller defines xij = xj-xi
-						const Vector3r xi_xj_0 = -(xi0 - xj0);
+						const Vector3r &xi_xj_0 = m_restDiff[k];
 						const Real xixj0_l2 = xi_xj_0.squaredNorm();
-						const Real W0 = sim->W(xi_xj_0);
+						const Real W0 = m_restW[k];
 
 						const Vector3r xij_i = m_F[i] * m_rotations[i] * xi_xj_0;
 						const Vector3r xji_j = -m_F[neighborIndex] * m_rotations[neighborIndex] * xi_xj_0;
@@ -333,3 +304,14 @@ void Elasticity_Becker2009::computeForces()
 	}
 }
 
+size_t Elasticity_Becker2009::getMemoryUsage() const
+{
+	return getRestNeighborhoodMemoryUsage() +
+		vectorMemory(m_restVolumes) +
+		vectorMemory(m_restDiff) +
+		vectorMemory(m_restW) +
+		vectorMemory(m_restGradW) +
+		vectorMemory(m_rotations) +
+		vectorMemory(m_stress) +
+		vectorMemory(m_F);
+}
@@ -13,13 +13,13 @@ namespace SPH
 	class Elasticity_Becker2009 : public ElasticityBase
 	{
 	protected:
-		// initial particle indices, used to access their original positions
-		std::vector<unsigned int> m_current_to_initial_index;
-		std::vector<unsigned int> m_initial_to_current_index;
-		// initial particle neighborhood
-		std::vector<std::vector<unsigned int>> m_initialNeighbors;
 		// volumes in rest configuration
 		std::vector<Real> m_restVolumes;
+		// rest state of the neighbor pairs (see ElasticityBase): xj0 - xi0,
+		// W(xj0 - xi0) and V_j gradW(xj0 - xi0)
+		std::vector<Vector3r> m_restDiff;
+		std::vector<Real> m_restW;
+		std::vector<Vector3r> m_restGradW;
 		std::vector<Matrix3r> m_rotations;
 		std::vector<Vector6r> m_stress;
 		std::vector<Matrix3r> m_F;
@@ -50,6 +50,8 @@ namespace SPH
 		Elasticity_Becker2009(FluidModel *model);
 		virtual ~Elasticity_Becker2009(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 		virtual void performNeighborhoodSearchSort();
@@ -1,4 +1,5 @@
 #include "Elasticity_Peer2018.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/Simulation.h"
 #include "SPlisHSPlasH/Utilities/MathFunctions.h"
 #include "SPlisHSPlasH/TimeManager.h"
@@ -19,13 +20,15 @@ Elasticity_Peer2018::Elasticity_Peer2018(FluidModel *model) :
 {
 	const unsigned int numParticles = model->numActiveParticles();
 	m_restVolumes.resize(numParticles);
-	m_current_to_initial_index.resize(numParticles);
-	m_initial_to_current_index.resize(numParticles);
-	m_initialNeighbors.resize(numParticles);
 	m_rotations.resize(numParticles, Matrix3r::Identity());
 	m_stress.resize(numParticles);
 	m_L.resize(numParticles);
 	m_F.resize(numParticles);
+	m_preconditionerP.resize(numParticles);
+	m_preconditionerQ.resize(numParticles);
+	m_preconditionerRotations.resize(numParticles);
+	m_preconditionerValid = false;
+	m_dt = 0.0;
 
 	m_iterations = 0;
 	m_maxIter = 100;
@@ -100,23 +103,15 @@ void Elasticity_Peer2018::initValues()
 	const unsigned int numParticles = model->numActiveParticles();
 	const unsigned int fluidModelIndex = model->getPointSetIndex();
 
-	// Store the neighbors in the reference configurations and
+	// Store the neighbors in the reference configurations
+	initRestNeighborhoods();
+
 	// compute the volume of each particle in rest state
 	#pragma omp parallel default(shared)
 	{
 		#pragma omp for schedule(static) 
 		for (int i = 0; i < (int)numParticles; i++)
 		{
-			m_current_to_initial_index[i] = i;
-			m_initial_to_current_index[i] = i;
-
-			// only neighbors in same phase will influence elasticity
-			const unsigned int numNeighbors = sim->numberOfNeighbors(fluidModelIndex, fluidModelIndex, i);
-			m_initialNeighbors[i].resize(numNeighbors);
-			for (unsigned int j = 0; j < numNeighbors; j++)
-				m_initialNeighbors[i][j] = sim->getNeighbor(fluidModelIndex, fluidModelIndex, i, j);
-
-			// compute volume
 			Real density = model->getMass(i) * sim->W_zero();
 			const Vector3r &xi = model->getPosition(i);
 			forall_fluid_neighbors_in_same_phase(
@@ -128,6 +123,8 @@ void Elasticity_Peer2018::initValues()
 	}
 
 	computeMatrixL();
+	computeRestKernels();
+	m_preconditionerValid = false;
 }
 
 
@@ -137,28 +134,32 @@ void Elasticity_Peer2018::step()
 	const unsigned int numParticles = m_model->numActiveParticles();
 	const Real dt = TimeManager::getCurrent()->getTimeStepSize();
 
+	// the diagonal blocks of the preconditioner depend on the rotations
+	computeRotations();
+	updatePreconditioner();
+
 	//////////////////////////////////////////////////////////////////////////
 	// Init linear system solver and preconditioner
 	//////////////////////////////////////////////////////////////////////////
 	MatrixReplacement A(3 * m_model->numActiveParticles(), matrixVecProd, (void*)this);
-	//m_solver.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElement, (void*)this);
+	m_dt = dt;
+	m_solver.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElement, (void*)this);
 
 	m_solver.setTolerance(m_maxError);
 	m_solver.setMaxIterations(m_maxIter);
 	m_solver.compute(A);
 
-	VectorXr b(3 * numParticles);
-	VectorXr x(3 * numParticles);
-	VectorXr g(3 * numParticles);
+	VectorXs b(3 * numParticles);
+	VectorXs x(3 * numParticles);
+	VectorXs g(3 * numParticles);
 
-	computeRotations();
 	computeRHS(b);
 
 	// warmstart
 	#pragma omp parallel for schedule(static) 
 	for (int i = 0; i < (int)numParticles; i++)
 	{
-		g.segment<3>(3 * i) = m_model->getVelocity(i) + dt * m_model->getAcceleration(i);
+		g.segment<3>(3 * i) = (m_model->getVelocity(i) + dt * m_model->getAcceleration(i)).cast<SolverReal>();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -176,7 +177,7 @@ void Elasticity_Peer2018::step()
 		for (int i = 0; i < (int)numParticles; i++)
 		{
 			Vector3r &ai = m_model->getAcceleration(i);
-			ai += (1.0 / dt) * (x.segment<3>(3 * i) - m_model->getVelocity(i));
+			ai += (1.0 / dt) * (x.segment<3>(3 * i).cast<Real>() - m_model->getVelocity(i));
 		}
 	}
 }
@@ -197,18 +198,17 @@ void Elasticity_Peer2018::performNeighborhoodSearchSort()
 	auto const& d = sim->getNeighborhoodSearch()->point_set(m_model->getPointSetIndex());
 	d.sort_field(&m_restVolumes[0]);
 	d.sort_field(&m_rotations[0]);
-	d.sort_field(&m_current_to_initial_index[0]);
 	d.sort_field(&m_L[0]);
-
-	for (unsigned int i = 0; i < numPart; i++)
-		m_initial_to_current_index[m_current_to_initial_index[i]] = i;
+	d.sort_field(&m_preconditionerP[0]);
+	d.sort_field(&m_preconditionerQ[0]);
+	d.sort_field(&m_preconditionerRotations[0]);
+	sortRestNeighborhoods();
 }
 
 void Elasticity_Peer2018::computeRotations()
 {
 	Simulation *sim = Simulation::getCurrent();
 	const unsigned int numParticles = m_model->numActiveParticles();
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
 	FluidModel *model = m_model;
 
 	#pragma omp parallel default(shared)
@@ -218,27 +218,17 @@ void Elasticity_Peer2018::computeRotations()
 		{
 			const unsigned int i0 = m_current_to_initial_index[i];
 			const Vector3r &xi = m_model->getPosition(i);
-			const Vector3r &xi0 = m_model->getPosition0(i0);
 			Matrix3r F;
 			F.setZero();
 
-			const size_t numNeighbors = m_initialNeighbors[i0].size();
-
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
-			for (unsigned int j = 0; j < numNeighbors; j++)
+			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
 			{
-				const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-				// get initial neighbor index considering the current particle order 
-				const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
-
-				const Vector3r &xj = model->getPosition(neighborIndex);
-				const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
+				const Vector3r &xj = model->getPosition(m_neighbors[k]);
 				const Vector3r xj_xi = xj - xi;
-				const Vector3r xi_xj_0 = xi0 - xj0;
-				const Vector3r correctedKernel = m_L[i] * sim->gradW(xi_xj_0);
-				F += m_restVolumes[neighborIndex] * xj_xi * correctedKernel.transpose();
+				F += xj_xi * m_restKernel[k].transpose();
 			}
 
 			if (sim->is2DSimulation())
@@ -259,8 +249,6 @@ void Elasticity_Peer2018::computeMatrixL()
 {
 	Simulation *sim = Simulation::getCurrent();
 	const unsigned int numParticles = m_model->numActiveParticles();
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
-	FluidModel *model = m_model;
 
 	#pragma omp parallel default(shared)
 	{
@@ -272,16 +260,13 @@ void Elasticity_Peer2018::computeMatrixL()
 			Matrix3r L;
 			L.setZero();
 
-			const size_t numNeighbors = m_initialNeighbors[i0].size();
-
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
-			for (unsigned int j = 0; j < numNeighbors; j++)
+			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
 			{
-				const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-				// get initial neighbor index considering the current particle order 
-				const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
+				const unsigned int neighborIndex = m_neighbors[k];
+				const unsigned int neighborIndex0 = m_initialNeighbors[k];
 
 				const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
 				const Vector3r xj_xi_0 = xj0 - xi0;
@@ -306,12 +291,130 @@ void Elasticity_Peer2018::computeMatrixL()
 	}
 }
 
+void Elasticity_Peer2018::computeRestKernels()
+{
+	Simulation *sim = Simulation::getCurrent();
+	const unsigned int numParticles = m_model->numActiveParticles();
+	const unsigned int numEntries = static_cast<unsigned int>(m_neighbors.size());
+	m_restKernel.resize(numEntries);
+	m_restKernelNeighbor.resize(numEntries);
+
+	// The volumes and correction matrices do not change, so the corrected
+	// kernel gradients of both particles of a pair are computed once.
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)  
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			const unsigned int i0 = m_current_to_initial_index[i];
+			const Vector3r &xi0 = m_model->getPosition0(i0);
+			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
+			{
+				const unsigned int neighborIndex = m_neighbors[k];
+				const Vector3r xi_xj_0 = xi0 - m_model->getPosition0(m_initialNeighbors[k]);
+				const Vector3r gradW = sim->gradW(xi_xj_0);
+				m_restKernel[k] = m_restVolumes[neighborIndex] * (m_L[i] * gradW);
+				m_restKernelNeighbor[k] = -m_restVolumes[i] * m_restVolumes[neighborIndex] * (m_L[neighborIndex] * gradW);
+			}
+		}
+	}
+
+	// rotation invariant part of the diagonal blocks (see updatePreconditioner())
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)  
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			const unsigned int i0 = m_current_to_initial_index[i];
+			Vector3r sumKernel_i;
+			sumKernel_i.setZero();
+			Real p = 0.0;
+			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
+			{
+				sumKernel_i += m_restKernel[k];
+				p += m_restKernelNeighbor[k].squaredNorm() / m_restVolumes[m_neighbors[k]];
+			}
+			m_preconditionerP[i] = p + m_restVolumes[i] * sumKernel_i.squaredNorm();
+		}
+	}
+}
 
-void Elasticity_Peer2018::computeRHS(VectorXr & rhs)
+void Elasticity_Peer2018::updatePreconditioner()
+{
+	const unsigned int numParticles = m_model->numActiveParticles();
+
+	// The blocks are only updated if a rotation has changed by more than
+	// about 10 degrees (cos(angle) = (trace(R R_old^T) - 1) / 2).
+	bool update = !m_preconditionerValid;
+	if (!update)
+	{
+		const Real minTrace = static_cast<Real>(1.0) + static_cast<Real>(2.0) * cos(static_cast<Real>(10.0 / 180.0 * M_PI));
+		#pragma omp parallel default(shared)
+		{
+			#pragma omp for schedule(static) reduction(||:update)
+			for (int i = 0; i < (int)numParticles; i++)
+			{
+				if ((m_rotations[i] * m_preconditionerRotations[i].transpose()).trace() < minTrace)
+					update = true;
+			}
+		}
+	}
+	if (!update)
+		return;
+
+	// Diagonal block of the operator in matrixVecProd: the velocity v_i changes
+	// the stress of particle i (via c = R_i sum_j V_j L_i gradW_ij) and the stress
+	// of each neighbor j (via d_j = R_j V_i L_j gradW_ji). With the stress
+	// 2 mu eps + lambda tr(eps) I this gives
+	// I + dt^2/m_i (mu (V_i |c|^2 + sum_j V_j |d_j|^2) I + (mu+lambda) (V_i c c^T + sum_j V_j d_j d_j^T)).
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)  
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			const unsigned int i0 = m_current_to_initial_index[i];
+			Vector3r sumKernel_i;
+			sumKernel_i.setZero();
+			Matrix3r Q;
+			Q.setZero();
+			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
+			{
+				const unsigned int neighborIndex = m_neighbors[k];
+				sumKernel_i += m_restKernel[k];
+				// the precomputed kernel of the neighbor contains V_i V_j
+				const Vector3r d = m_rotations[neighborIndex] * m_restKernelNeighbor[k];
+				Q += (static_cast<Real>(1.0) / m_restVolumes[neighborIndex]) * (d * d.transpose());
+			}
+			const Vector3r c = m_rotations[i] * sumKernel_i;
+			m_preconditionerQ[i] = Q + m_restVolumes[i] * (c * c.transpose());
+			m_preconditionerRotations[i] = m_rotations[i];
+		}
+	}
+	m_preconditionerValid = true;
+	INCREASE_COUNTER("Elasticity - preconditioner updates", static_cast<Real>(1.0));
+}
+
+void Elasticity_Peer2018::diagonalMatrixElement(const unsigned int i, Matrix3r &result, void *userData)
+{
+	Elasticity_Peer2018 *elasticity = static_cast<Elasticity_Peer2018*>(userData);
+	FluidModel *model = elasticity->getModel();
+	const Real dt = elasticity->m_dt;
+	const Real youngsModulus = elasticity->m_youngsModulus;
+	const Real poissonRatio = elasticity->m_poissonRatio;
+
+	Real mu = youngsModulus / (static_cast<Real>(2.0) * (static_cast<Real>(1.0) + poissonRatio));
+	Real lambda = youngsModulus * poissonRatio / ((static_cast<Real>(1.0) + poissonRatio) * (static_cast<Real>(1.0) - static_cast<Real>(2.0) * poissonRatio));
+
+	const Real factor = dt*dt / model->getMass(i);
+	result = (static_cast<Real>(1.0) + factor * mu * elasticity->m_preconditionerP[i]) * Matrix3r::Identity() +
+		(factor * (mu + lambda)) * elasticity->m_preconditionerQ[i];
+}
+
+
+void Elasticity_Peer2018::computeRHS(VectorXs & rhs)
 {
 	Simulation *sim = Simulation::getCurrent();
 	const unsigned int numParticles = m_model->numActiveParticles();
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
 	FluidModel *model = m_model;
 	const Real dt = TimeManager::getCurrent()->getTimeStepSize();
 
@@ -325,8 +428,6 @@ void Elasticity_Peer2018::computeRHS(VectorXr & rhs)
 		{
 			const unsigned int i0 = m_current_to_initial_index[i];
 			const Vector3r &xi = m_model->getPosition(i);
-			const Vector3r &xi0 = m_model->getPosition0(i0);
-			const size_t numNeighbors = m_initialNeighbors[i0].size();
 
  			//////////////////////////////////////////////////////////////////////////
  			// compute corotated deformation gradient (Eq. 18)
@@ -336,19 +437,14 @@ void Elasticity_Peer2018::computeRHS(VectorXr & rhs)
   			//////////////////////////////////////////////////////////////////////////
  			// Fluid
  			//////////////////////////////////////////////////////////////////////////
- 			for (unsigned int j = 0; j < numNeighbors; j++)
+ 			for (unsigned int k = m_neighborOffsets[i0]; k < m_neighborOffsets[i0 + 1]; k++)
  			{
- 				const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
- 				// get initial neighbor index considering the current particle order 
- 				const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
- 
- 				const Vector3r &xj = model->getPosition(neighborIndex);
- 				const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
+ 				const Vector3r &xj = model->getPosition(m_neighbors[k]);
  				const Vector3r xj_xi = xj - xi;
- 				const Vector3r xi_xj_0 = xi0 - xj0;
- 				const Vector3r correctedRotatedKernel = m_rotations[i] * m_L[i] * sim->gradW(xi_xj_0);
- 				m_F[i] += m_restVolumes[neighborIndex] * xj_xi * correctedRotatedKernel.transpose();
+ 				m_F[i] += xj_xi * m_restKernel[k].transpose();
  			}
+			// the rotation is the same for all neighbors
+			m_F[i] = m_F[i] * m_rotations[i].transpose();
 
 			if (sim->is2DSimulation())
 				m_F[i](2, 2) = 1.0;
@@ -383,28 +479,27 @@ void Elasticity_Peer2018::computeRHS(VectorXr & rhs)
 		{
 			const unsigned int i0 = m_current_to_initial_index[i];
 			const Vector3r &xi0 = m_model->getPosition0(i0);
-			const size_t numNeighbors = m_initialNeighbors[i0].size();
+			const unsigned int offset = m_neighborOffsets[i0];
+			const unsigned int numNeighbors = m_neighborOffsets[i0 + 1] - offset;
 
 			//////////////////////////////////////////////////////////////////////////
 			// Compute elastic force
 			//////////////////////////////////////////////////////////////////////////
-			Vector3r force;
+			Vector3r force, sumKernel_i;
 			force.setZero();
-			for (unsigned int j = 0; j < numNeighbors; j++)
+			sumKernel_i.setZero();
+			for (unsigned int k = offset; k < offset + numNeighbors; k++)
 			{
-				const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-				// get initial neighbor index considering the current particle order 
-				const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
-
-				const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
-				const Vector3r xi_xj_0 = xi0 - xj0;
-				const Vector3r correctedRotatedKernel_i = m_rotations[i] * m_L[i] * sim->gradW(xi_xj_0);
-				const Vector3r correctedRotatedKernel_j = -m_rotations[neighborIndex] * m_L[neighborIndex] * sim->gradW(xi_xj_0);
-				Vector3r PWi, PWj;
-				symMatTimesVec(m_stress[i], correctedRotatedKernel_i, PWi);
-				symMatTimesVec(m_stress[neighborIndex], correctedRotatedKernel_j, PWj);
-				force += m_restVolumes[i] * m_restVolumes[neighborIndex] * (PWi - PWj);
+				const unsigned int neighborIndex = m_neighbors[k];
+				Vector3r PWj;
+				symMatTimesVec(m_stress[neighborIndex], m_rotations[neighborIndex] * m_restKernelNeighbor[k], PWj);
+				force -= PWj;
+				sumKernel_i += m_restKernel[k];
 			}
+			// the stress and rotation of particle i are the same for all neighbors
+			Vector3r PWi;
+			symMatTimesVec(m_stress[i], m_rotations[i] * sumKernel_i, PWi);
+			force += m_restVolumes[i] * PWi;
 
 			if (m_alpha != 0.0)
 			{
@@ -416,11 +511,10 @@ void Elasticity_Peer2018::computeRHS(VectorXr & rhs)
 				Vector3r fi_hg;
 				fi_hg.setZero();
 				const Vector3r &xi = m_model->getPosition(i);
-				for (unsigned int j = 0; j < numNeighbors; j++)
+				for (unsigned int k = offset; k < offset + numNeighbors; k++)
 				{
-					const unsigned int neighborIndex = m_initial_to_current_index[m_initialNeighbors[i0][j]];
-					// get initial neighbor index considering the current particle order 
-					const unsigned int neighborIndex0 = m_initialNeighbors[i0][j];
+					const unsigned int neighborIndex = m_neighbors[k];
+					const unsigned int neighborIndex0 = m_initialNeighbors[k];
 
 					const Vector3r &xj = model->getPosition(neighborIndex);
 					const Vector3r &xj0 = m_model->getPosition0(neighborIndex0);
@@ -450,25 +544,25 @@ void Elasticity_Peer2018::computeRHS(VectorXr & rhs)
 				model->getAcceleration(i) += fi_hg / model->getMass(i);
 			}
 
-			rhs.segment<3>(3 * i) = model->getVelocity(i) + dt * (model->getAcceleration(i) + 1.0 / model->getMass(i) * force);
+			rhs.segment<3>(3 * i) = (model->getVelocity(i) + dt * (model->getAcceleration(i) + 1.0 / model->getMass(i) * force)).cast<SolverReal>();
 		}
 	}
 }
 
-void Elasticity_Peer2018::matrixVecProd(const Real* vec, Real *result, void *userData)
+void Elasticity_Peer2018::matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData)
 {
-	Simulation *sim = Simulation::getCurrent();
 	Elasticity_Peer2018 * elasticity = static_cast<Elasticity_Peer2018*>(userData);
 	FluidModel *model = elasticity->getModel();
 	const unsigned int numParticles = model->numActiveParticles();
 	const Real dt = TimeManager::getCurrent()->getTimeStepSize();
 
 	const auto &current_to_initial_index = elasticity->m_current_to_initial_index;
-	const auto &initial_to_current_index = elasticity->m_initial_to_current_index;
-	const auto &initialNeighbors = elasticity->m_initialNeighbors;
+	const auto &neighborOffsets = elasticity->m_neighborOffsets;
+	const auto &neighbors = elasticity->m_neighbors;
+	const auto &restKernel = elasticity->m_restKernel;
+	const auto &restKernelNeighbor = elasticity->m_restKernelNeighbor;
 	const auto &restVolumes = elasticity->m_restVolumes;
 	const auto &rotations = elasticity->m_rotations;
-	const auto &L = elasticity->m_L;
 	auto &stress = elasticity->m_stress;
 	const Real youngsModulus = elasticity->m_youngsModulus;
 	const Real poissonRatio = elasticity->m_poissonRatio;
@@ -482,9 +576,7 @@ void Elasticity_Peer2018::matrixVecProd(const Real* vec, Real *result, void *use
 		for (int i = 0; i < (int)numParticles; i++)
 		{
 			const unsigned int i0 = current_to_initial_index[i];
-			const Vector3r &pi = Eigen::Map<const Vector3r>(&vec[3 * i], 3);
-			const Vector3r &xi0 = model->getPosition0(i0);
-			const size_t numNeighbors = initialNeighbors[i0].size();
+			const Vector3r &pi = Eigen::Map<const Vector3s>(&vec[3 * i]).cast<Real>();
 
  			//////////////////////////////////////////////////////////////////////////
  			// compute corotated deformation gradient (Eq. 18)
@@ -495,20 +587,13 @@ void Elasticity_Peer2018::matrixVecProd(const Real* vec, Real *result, void *use
   			//////////////////////////////////////////////////////////////////////////
  			// Fluid
  			//////////////////////////////////////////////////////////////////////////
- 			for (unsigned int j = 0; j < numNeighbors; j++)
+ 			for (unsigned int k = neighborOffsets[i0]; k < neighborOffsets[i0 + 1]; k++)
  			{
- 				const unsigned int neighborIndex = initial_to_current_index[initialNeighbors[i0][j]];
- 				// get initial neighbor index considering the current particle order 
- 				const unsigned int neighborIndex0 = initialNeighbors[i0][j];
- 
- 				const Vector3r &pj = Eigen::Map<const Vector3r>(&vec[3 * neighborIndex], 3);
- 				const Vector3r &xj0 = model->getPosition0(neighborIndex0);
+ 				const Vector3r &pj = Eigen::Map<const Vector3s>(&vec[3 * neighbors[k]]).cast<Real>();
  				const Vector3r pj_pi = pj - pi;
- 				const Vector3r xi_xj_0 = xi0 - xj0;
- 				const Vector3r correctedRotatedKernel = rotations[i] * L[i] * sim->gradW(xi_xj_0);
-				nablaU += restVolumes[neighborIndex] * pj_pi * correctedRotatedKernel.transpose();
+				nablaU += pj_pi * restKernel[k].transpose();
  			}
-			nablaU *= dt;
+			nablaU = dt * nablaU * rotations[i].transpose();
  
  			//////////////////////////////////////////////////////////////////////////
  			// compute Cauchy strain: epsilon = 0.5 (nablaU + nablaU^T)
@@ -539,29 +624,24 @@ void Elasticity_Peer2018::matrixVecProd(const Real* vec, Real *result, void *use
 		for (int i = 0; i < (int)numParticles; i++)
 		{
 			const unsigned int i0 = current_to_initial_index[i];
-			const Vector3r &xi0 = model->getPosition0(i0);
-			const size_t numNeighbors = initialNeighbors[i0].size();
 
 			//////////////////////////////////////////////////////////////////////////
 			// Compute elastic force
 			//////////////////////////////////////////////////////////////////////////
-			Vector3r force;
+			Vector3r force, sumKernel_i;
 			force.setZero();
-			for (unsigned int j = 0; j < numNeighbors; j++)
+			sumKernel_i.setZero();
+			for (unsigned int k = neighborOffsets[i0]; k < neighborOffsets[i0 + 1]; k++)
 			{
-				const unsigned int neighborIndex = initial_to_current_index[initialNeighbors[i0][j]];
-				// get initial neighbor index considering the current particle order 
-				const unsigned int neighborIndex0 = initialNeighbors[i0][j];
-
-				const Vector3r &xj0 = model->getPosition0(neighborIndex0);
-				const Vector3r xi_xj_0 = xi0 - xj0;
-				const Vector3r correctedRotatedKernel_i = rotations[i] * L[i] * sim->gradW(xi_xj_0);
-				const Vector3r correctedRotatedKernel_j = -rotations[neighborIndex] * L[neighborIndex] * sim->gradW(xi_xj_0);
-				Vector3r PWi, PWj;
-				elasticity->symMatTimesVec(stress[i], correctedRotatedKernel_i, PWi);
-				elasticity->symMatTimesVec(stress[neighborIndex], correctedRotatedKernel_j, PWj);
-				force += restVolumes[i] * restVolumes[neighborIndex] * (PWi - PWj);
+				const unsigned int neighborIndex = neighbors[k];
+				Vector3r PWj;
+				elasticity->symMatTimesVec(stress[neighborIndex], rotations[neighborIndex] * restKernelNeighbor[k], PWj);
+				force -= PWj;
+				sumKernel_i += restKernel[k];
 			}
+			Vector3r PWi;
+			elasticity->symMatTimesVec(stress[i], rotations[i] * sumKernel_i, PWi);
+			force += restVolumes[i] * PWi;
 
 			const Real factor = dt / model->getMass(i);
 			result[3 * i] = vec[3 * i] - factor * force[0];
@@ -570,3 +650,18 @@ void Elasticity_Peer2018::matrixVecProd(const Real* vec, Real *result, void *use
 		}
 	}
 }
+
+size_t Elasticity_Peer2018::getMemoryUsage() const
+{
+	return getRestNeighborhoodMemoryUsage() +
+		vectorMemory(m_restVolumes) +
+		vectorMemory(m_restKernel) +
+		vectorMemory(m_restKernelNeighbor) +
+		vectorMemory(m_rotations) +
+		vectorMemory(m_stress) +
+		vectorMemory(m_L) +
+		vectorMemory(m_F) +
+		vectorMemory(m_preconditionerP) +
+		vectorMemory(m_preconditionerQ) +
+		vectorMemory(m_preconditionerRotations);
+}
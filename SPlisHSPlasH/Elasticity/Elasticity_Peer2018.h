@@ -15,19 +15,28 @@ namespace SPH
 	class Elasticity_Peer2018 : public ElasticityBase
 	{
 	protected:
-		typedef Eigen::ConjugateGradient<MatrixReplacement, Eigen::Lower | Eigen::Upper, Eigen::IdentityPreconditioner> Solver;
+		typedef Eigen::ConjugateGradient<MatrixReplacement, Eigen::Lower | Eigen::Upper, BlockJacobiPreconditioner3D> Solver;
 
-		// initial particle indices, used to access their original positions
-		std::vector<unsigned int> m_current_to_initial_index;
-		std::vector<unsigned int> m_initial_to_current_index;
-		// initial particle neighborhood
-		std::vector<std::vector<unsigned int>> m_initialNeighbors;
 		// volumes in rest configuration
 		std::vector<Real> m_restVolumes;
+		// corrected kernel gradients of the neighbor pairs in rest state (see ElasticityBase):
+		// V_j L_i gradW(xi0 - xj0) and -V_i V_j L_j gradW(xi0 - xj0)
+		std::vector<Vector3r> m_restKernel;
+		std::vector<Vector3r> m_restKernelNeighbor;
 		std::vector<Matrix3r> m_rotations;
 		std::vector<Vector6r> m_stress;
 		std::vector<Matrix3r> m_L;
 		std::vector<Matrix3r> m_F;
+		// The diagonal block of particle i is I + dt^2/m_i (mu p_i I + (mu+lambda) Q_i).
+		// p_i does not depend on the rotations, Q_i is updated if the rotations change
+		// significantly (see updatePreconditioner()).
+		std::vector<Real> m_preconditionerP;
+		std::vector<Matrix3r> m_preconditionerQ;
+		std::vector<Matrix3r> m_preconditionerRotations;
+		bool m_preconditionerValid;
+		// time step size of the current step, diagonalMatrixElement() runs on the 
+		// OpenMP worker threads which have no current time manager
+		Real m_dt;
 		unsigned int m_iterations;
 		unsigned int m_maxIter;
 		Real m_maxError;
@@ -36,8 +45,10 @@ namespace SPH
 
 		void initValues();
 		void computeMatrixL();
+		void computeRestKernels();
+		void updatePreconditioner();
 		void computeRotations();
-		void computeRHS(VectorXr & rhs);	
+		void computeRHS(VectorXs & rhs);	
 
 		virtual void initParameters();
 
@@ -62,11 +73,14 @@ namespace SPH
 		Elasticity_Peer2018(FluidModel *model);
 		virtual ~Elasticity_Peer2018(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 		virtual void performNeighborhoodSearchSort();
 
-		static void matrixVecProd(const Real* vec, Real *result, void *userData);
+		static void matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData);
+		static void diagonalMatrixElement(const unsigned int row, Matrix3r &result, void *userData);
 	};
 }
 
@@ -73,6 +73,7 @@ void Emitter::emitParticles(std::vector <unsigned int> &reusedParticles, unsigne
 	const Vector3r & emitDir = m_rotation.col(0);
 	Vector3r emitVel = m_velocity * emitDir;
 	Simulation *sim = Simulation::getCurrent();
+	const bool sim2D = sim->is2DSimulation();
 	const Real radius = sim->getParticleRadius();
 	const Real diam = static_cast<Real>(2.0)*radius;
 
@@ -104,6 +105,8 @@ void Emitter::emitParticles(std::vector <unsigned int> &reusedParticles, unsigne
 					fm->getVelocity(i) = emitVel;
 					fm->getPosition(i) += timeStepSize * emitVel;
 					fm->setParticleState(i, ParticleState::AnimatedByEmitter);
+					if (sim2D)
+						TimeStep::projectTo2D(fm, i);
 				}
 			}
 		}
@@ -149,6 +152,8 @@ void Emitter::emitParticles(std::vector <unsigned int> &reusedParticles, unsigne
 					m_model->getPosition(index) = (i*diam + startX)*axisWidth + (j*diam + startZ)*axisHeight + offset;
 					m_model->getVelocity(index) = emitVel;
 					m_model->setParticleState(index, ParticleState::AnimatedByEmitter);
+					if (sim2D)
+						TimeStep::projectTo2D(m_model, index);
 
 					if (reused)
 					{
@@ -186,6 +191,8 @@ void Emitter::emitParticles(std::vector <unsigned int> &reusedParticles, unsigne
 						m_model->getPosition(index) = (i*diam + startX)*axisWidth + (j*diam + startZ)*axisHeight + offset;
 						m_model->getVelocity(index) = emitVel;
 						m_model->setParticleState(index, ParticleState::AnimatedByEmitter);
+						if (sim2D)
+							TimeStep::projectTo2D(m_model, index);
 						numEmittedParticles++;
 					}
 					index++;
@@ -211,6 +218,7 @@ void Emitter::emitParticlesCircle(std::vector <unsigned int> &reusedParticles, u
 	const Real timeStepSize = tm->getTimeStepSize();
 	const Vector3r & emitDir = m_rotation.col(0);
 	Simulation *sim = Simulation::getCurrent();
+	const bool sim2D = sim->is2DSimulation();
 	const Real particleRadius = sim->getParticleRadius();
 	const Real diam = static_cast<Real>(2.0)*particleRadius;
 	Vector3r emitVel = m_velocity * emitDir;
@@ -246,6 +254,8 @@ void Emitter::emitParticlesCircle(std::vector <unsigned int> &reusedParticles, u
  					fm->getVelocity(i) = emitVel;
  					fm->getPosition(i) += timeStepSize * emitVel;
  					fm->setParticleState(i, ParticleState::AnimatedByEmitter);
+ 					if (sim2D)
+ 						TimeStep::projectTo2D(fm, i);
  				}
  			}
 		}
@@ -297,6 +307,8 @@ void Emitter::emitParticlesCircle(std::vector <unsigned int> &reusedParticles, u
 					m_model->getPosition(index) = x*axisWidth + y*axisHeight + offset;
 					m_model->getVelocity(index) = velocity;
 					m_model->setParticleState(index, ParticleState::AnimatedByEmitter);
+					if (sim2D)
+						TimeStep::projectTo2D(m_model, index);
 
 					if (reused)
 					{
@@ -336,6 +348,8 @@ void Emitter::emitParticlesCircle(std::vector <unsigned int> &reusedParticles, u
 						m_model->getPosition(index) = x*axisWidth + y*axisHeight + offset;
 						m_model->getVelocity(index) = velocity;
 						m_model->setParticleState(index, ParticleState::AnimatedByEmitter);
+						if (sim2D)
+							TimeStep::projectTo2D(m_model, index);
 						numEmittedParticles++;
 						index++;
 					}
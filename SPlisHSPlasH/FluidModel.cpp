@@ -6,6 +6,7 @@
 #include "Utilities/Logger.h"
 #include "NeighborhoodSearch.h"
 #include "Simulation.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "EmitterSystem.h"
 #include "Viscosity/ViscosityBase.h"
 #include "SurfaceTension/SurfaceTensionBase.h"
@@ -73,7 +74,8 @@ FluidModel::FluidModel() :
 	m_v(),
 	m_density(),
 	m_particleId(),
-	m_particleState()
+	m_particleState(),
+	m_surfaceClassification(this)
 {		
 	m_density0 = 1000.0;
 	m_pointSetIndex = 0;
@@ -226,6 +228,7 @@ void FluidModel::reset()
 	if (neighborhoodSearch->point_set(m_pointSetIndex).n_points() != nPoints)
 		neighborhoodSearch->resize_point_set(m_pointSetIndex, &getPosition(0)[0], nPoints);
 
+	m_surfaceClassification.invalidate();
 	if (m_surfaceTension)
 		m_surfaceTension->reset();
 	if (m_viscosity)
@@ -339,6 +342,7 @@ void FluidModel::performNeighborhoodSearchSort()
 	d.sort_field(&m_density[0]);
 	d.sort_field(&m_particleId[0]);
 	d.sort_field(&m_particleState[0]);
+	m_surfaceClassification.invalidate();
 
 	if (m_viscosity)
 		m_viscosity->performNeighborhoodSearchSort();
@@ -439,6 +443,7 @@ void FluidModel::computeElasticity()
 
 void FluidModel::emittedParticles(const unsigned int startIndex)
 {
+	m_surfaceClassification.invalidate();
 	if (m_viscosity)
 		m_viscosity->emittedParticles(startIndex);
 	if (m_surfaceTension)
@@ -611,3 +616,16 @@ void FluidModel::removeFieldByName(const std::string &fieldName)
 	}
 }
 
+size_t FluidModel::getMemoryUsage() const
+{
+	return vectorMemory(m_masses) +
+		vectorMemory(m_a) +
+		vectorMemory(m_v0) +
+		vectorMemory(m_x0) +
+		vectorMemory(m_x) +
+		vectorMemory(m_v) +
+		vectorMemory(m_density) +
+		vectorMemory(m_particleId) +
+		vectorMemory(m_particleState) +
+		m_surfaceClassification.getMemoryUsage();
+}
@@ -7,6 +7,7 @@
 #include "RigidBodyObject.h"
 #include "SPHKernels.h"
 #include "ParameterObject.h"
+#include "SurfaceClassification.h"
 
 namespace SPH 
 {	
@@ -110,6 +111,7 @@ namespace SPH
 			DragBase *m_drag;
 			ElasticityMethods m_elasticityMethod;
 			ElasticityBase *m_elasticity;
+			SurfaceClassification m_surfaceClassification;
 			std::vector<FieldDescription> m_fields;
 
 			std::function<void()> m_dragMethodChanged;
@@ -169,6 +171,9 @@ namespace SPH
 
 			void emittedParticles(const unsigned int startIndex);
 
+			/** Return the allocated memory of the particle data in bytes (without the data of the non-pressure force methods). */
+			size_t getMemoryUsage() const;
+
 			int getSurfaceTensionMethod() const { return static_cast<int>(m_surfaceTensionMethod); }
 			void setSurfaceTensionMethod(const int val);
 			int getViscosityMethod() const { return static_cast<int>(m_viscosityMethod); }
@@ -185,6 +190,7 @@ namespace SPH
 			VorticityBase *getVorticityBase() { return m_vorticity; }
 			DragBase *getDragBase() { return m_drag; }
 			ElasticityBase *getElasticityBase() { return m_elasticity; }
+			SurfaceClassification &getSurfaceClassification() { return m_surfaceClassification; }
 
 			void setDragMethodChangedCallback(std::function<void()> const& callBackFct);
 			void setSurfaceMethodChangedCallback(std::function<void()> const& callBackFct);
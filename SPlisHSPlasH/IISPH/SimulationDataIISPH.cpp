@@ -1,4 +1,5 @@
 #include "SimulationDataIISPH.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/SPHKernels.h"
 #include "SPlisHSPlasH/Simulation.h"
 
@@ -110,3 +111,14 @@ void SimulationDataIISPH::emittedParticles(FluidModel *model, const unsigned int
 		m_lastPressure[fluidModelIndex][j] = 0.0;
 	}
 }
+
+size_t SimulationDataIISPH::getMemoryUsage() const
+{
+	return vectorMemory(m_aii) +
+		vectorMemory(m_dii) +
+		vectorMemory(m_dij_pj) +
+		vectorMemory(m_density_adv) +
+		vectorMemory(m_pressure) +
+		vectorMemory(m_lastPressure) +
+		vectorMemory(m_pressureAccel);
+}
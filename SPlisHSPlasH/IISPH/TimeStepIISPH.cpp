@@ -267,9 +267,10 @@ void TimeStepIISPH::pressureSolveIteration(const unsigned int fluidModelIndex, R
 	}
 
 	// Compute new pressure
+	AccumReal density_error = 0.0;
 	#pragma omp parallel default(shared)
 	{
-		#pragma omp for schedule(static)  
+		#pragma omp for reduction(+:density_error) schedule(static)
 		for (int i = 0; i < (int)numParticles; i++)
 		{
 			Real &pi = m_simulationData.getPressure(fluidModelIndex, i);
@@ -319,8 +320,7 @@ void TimeStepIISPH::pressureSolveIteration(const unsigned int fluidModelIndex, R
 			{
 				const Real newDensity = density0 * ((aii*pi + sum)*h2 - b) + density0;
 
-				#pragma omp atomic
-				avg_density_err += newDensity - density0;
+				density_error += newDensity - density0;
 			}
 		}
 	}
@@ -332,7 +332,7 @@ void TimeStepIISPH::pressureSolveIteration(const unsigned int fluidModelIndex, R
 		lastPi = pi;
 	}
 
-	avg_density_err /= numParticles;
+	avg_density_err = static_cast<Real>(density_error / numParticles);
 }
 
 void TimeStepIISPH::integration(const unsigned int fluidModelIndex)
@@ -345,6 +345,7 @@ void TimeStepIISPH::integration(const unsigned int fluidModelIndex)
 	computePressureAccels(fluidModelIndex);
 
 	Real h = TimeManager::getCurrent()->getTimeStepSize();
+	const bool sim2D = sim->is2DSimulation();
 
 	#pragma omp parallel default(shared)
 	{
@@ -358,6 +359,8 @@ void TimeStepIISPH::integration(const unsigned int fluidModelIndex)
 				vel += m_simulationData.getPressureAccel(fluidModelIndex, i) * h;
 				pos += vel * h;
 			}
+			if (sim2D)
+				projectTo2D(model, i);
 		}
 	}
 }
@@ -37,6 +37,8 @@ namespace SPH
 		TimeStepIISPH();
 		virtual ~TimeStepIISPH(void);
 
+		virtual size_t getMemoryUsage() const { return m_simulationData.getMemoryUsage(); }
+
 		virtual void step();
 		virtual void reset();
 		virtual void resize();
@@ -24,6 +24,9 @@ namespace SPH
 		virtual void performNeighborhoodSearchSort() {};
 		virtual void emittedParticles(const unsigned int startIndex) {};
 
+		/** Return the allocated memory of the data of the method in bytes. */
+		virtual size_t getMemoryUsage() const { return 0; }
+
 		FluidModel *getModel() { return m_model; }
 
 		virtual void init();
@@ -0,0 +1,105 @@
+#include "NonPressureForceFusion.h"
+#include "SurfaceTension/SurfaceTension_Becker2007.h"
+#include "SurfaceTension/SurfaceTension_Akinci2013.h"
+#include "Viscosity/Viscosity_Standard.h"
+#include "Viscosity/Viscosity_XSPH.h"
+#include "Drag/DragForce_Macklin2014.h"
+#include "Drag/DragForce_Gissler2017.h"
+
+using namespace SPH;
+
+namespace
+{
+	bool isFusable(SurfaceTensionBase *st)
+	{
+		// methods restricted to the surface band process their own particle list
+		if ((st == nullptr) || st->getSurfaceBandOnly())
+			return false;
+		return (dynamic_cast<SurfaceTension_Becker2007*>(st) != nullptr) ||
+			(dynamic_cast<SurfaceTension_Akinci2013*>(st) != nullptr);
+	}
+
+	bool isFusable(ViscosityBase *visco)
+	{
+		return (dynamic_cast<Viscosity_Standard*>(visco) != nullptr) ||
+			(dynamic_cast<Viscosity_XSPH*>(visco) != nullptr);
+	}
+
+	bool isFusable(DragBase *drag)
+	{
+		return (dynamic_cast<DragForce_Macklin2014*>(drag) != nullptr) ||
+			(dynamic_cast<DragForce_Gissler2017*>(drag) != nullptr);
+	}
+
+	template<class Term1, class Term2, class Term3>
+	void computeFused(FluidModel *model, Term1 term1, Term2 term2, Term3 term3)
+	{
+		term1.prepare();
+		term2.prepare();
+		term3.prepare();
+		NonPressureForceFusion::computeForces(model, term1, term2, term3);
+	}
+
+	// The terms are selected at runtime. Each combination of methods is a
+	// separate instantiation, so the calls in the neighbor loop are inlined.
+	template<class Term1, class Term2>
+	void dispatchDrag(FluidModel *model, const Term1 &term1, const Term2 &term2, DragBase *drag)
+	{
+		if (DragForce_Macklin2014 *d = dynamic_cast<DragForce_Macklin2014*>(drag))
+			computeFused(model, term1, term2, DragForce_Macklin2014::FusedTerm(d));
+		else if (DragForce_Gissler2017 *d = dynamic_cast<DragForce_Gissler2017*>(drag))
+			computeFused(model, term1, term2, DragForce_Gissler2017::FusedTerm(d));
+		else
+			computeFused(model, term1, term2, NoFusedTerm());
+	}
+
+	template<class Term1>
+	void dispatchViscosity(FluidModel *model, const Term1 &term1, ViscosityBase *visco, DragBase *drag)
+	{
+		if (Viscosity_Standard *v = dynamic_cast<Viscosity_Standard*>(visco))
+			dispatchDrag(model, term1, Viscosity_Standard::FusedTerm(v), drag);
+		else if (Viscosity_XSPH *v = dynamic_cast<Viscosity_XSPH*>(visco))
+			dispatchDrag(model, term1, Viscosity_XSPH::FusedTerm(v), drag);
+		else
+			dispatchDrag(model, term1, NoFusedTerm(), drag);
+	}
+
+	void dispatchSurfaceTension(FluidModel *model, SurfaceTensionBase *st, ViscosityBase *visco, DragBase *drag)
+	{
+		if (SurfaceTension_Becker2007 *s = dynamic_cast<SurfaceTension_Becker2007*>(st))
+			dispatchViscosity(model, SurfaceTension_Becker2007::FusedTerm(s), visco, drag);
+		else if (SurfaceTension_Akinci2013 *s = dynamic_cast<SurfaceTension_Akinci2013*>(st))
+			dispatchViscosity(model, SurfaceTension_Akinci2013::FusedTerm(s), visco, drag);
+		else
+			dispatchViscosity(model, NoFusedTerm(), visco, drag);
+	}
+}
+
+void NonPressureForceFusion::step(FluidModel *model)
+{
+	SurfaceTensionBase *st = model->getSurfaceTensionBase();
+	ViscosityBase *visco = model->getViscosityBase();
+	DragBase *drag = model->getDragBase();
+
+	// None of the fused methods reads the accelerations or changes the velocities,
+	// so they can be evaluated in any order. Implicit viscosity methods can change
+	// the velocities. In this case the drag force is computed afterwards as usual.
+	const bool fuseSurfaceTension = isFusable(st);
+	const bool fuseViscosity = isFusable(visco);
+	const bool fuseDrag = isFusable(drag) && ((visco == nullptr) || fuseViscosity);
+
+	if ((st != nullptr) && !fuseSurfaceTension)
+		st->step();
+	if ((visco != nullptr) && !fuseViscosity)
+		visco->step();
+
+	if (fuseSurfaceTension || fuseViscosity || fuseDrag)
+		dispatchSurfaceTension(model,
+			fuseSurfaceTension ? st : nullptr,
+			fuseViscosity ? visco : nullptr,
+			fuseDrag ? drag : nullptr);
+
+	model->computeVorticity();
+	if ((drag != nullptr) && !fuseDrag)
+		drag->step();
+}
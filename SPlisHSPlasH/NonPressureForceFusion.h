@@ -0,0 +1,115 @@
+#ifndef __NonPressureForceFusion_h__
+#define __NonPressureForceFusion_h__
+
+#include "Common.h"
+#include "Simulation.h"
+
+namespace SPH
+{
+	/** \brief Term without contribution which fills the unused slots of the
+	* fused neighbor pass (see NonPressureForceFusion).
+	*
+	* A term of an explicit non-pressure force method has the same interface:
+	* prepare() is called once before the pass, beginParticle() and endParticle()
+	* once per particle and fluidNeighbor() and boundaryNeighbor() for each
+	* neighbor if the term requests these neighbors. A term is copied for each
+	* thread, so it can store per-particle values.
+	*/
+	struct NoFusedTerm
+	{
+		static const bool usesFluidNeighbors = false;
+		static const bool usesBoundaryNeighbors = false;
+
+		void prepare() {}
+		FORCE_INLINE void beginParticle(const unsigned int i, const Vector3r &xi) {}
+		FORCE_INLINE void fluidNeighbor(const unsigned int pid, FluidModel *fm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj) {}
+		FORCE_INLINE void boundaryNeighbor(BoundaryModel *bm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj) {}
+		FORCE_INLINE void endParticle(const unsigned int i, Vector3r &ai) {}
+	};
+
+	/** \brief Evaluation of several explicit non-pressure forces in one traversal
+	* of the neighborhood of each particle.
+	*
+	* Usually each method runs its own neighbor loop, so the neighbor lists, positions
+	* and velocities are loaded from memory once per method. If fused non-pressure
+	* forces are enabled (see Simulation::FUSED_NON_PRESSURE_FORCES), the explicit
+	* surface tension, viscosity and drag methods are evaluated in one pass. The
+	* terms are template parameters, so the calls are inlined. Implicit methods and
+	* methods with several dependent passes keep their own step().
+	*/
+	class NonPressureForceFusion
+	{
+	public:
+		/** Evaluate up to three terms in one neighbor pass and add their accelerations.
+		* If a particle list is given, only the first numListParticles particles of
+		* the list are processed.
+		*/
+		template<class Term1, class Term2, class Term3>
+		static void computeForces(FluidModel *model, const Term1 &term1, const Term2 &term2, const Term3 &term3,
+			const std::vector<unsigned int> *particleList = nullptr, const unsigned int numListParticles = 0)
+		{
+			Simulation *sim = Simulation::getCurrent();
+			const unsigned int numParticles = (particleList != nullptr) ? numListParticles : model->numActiveParticles();
+			const unsigned int fluidModelIndex = model->getPointSetIndex();
+			const unsigned int nFluids = sim->numberOfFluidModels();
+			const bool usesFluidNeighbors = Term1::usesFluidNeighbors || Term2::usesFluidNeighbors || Term3::usesFluidNeighbors;
+			const bool usesBoundaryNeighbors = Term1::usesBoundaryNeighbors || Term2::usesBoundaryNeighbors || Term3::usesBoundaryNeighbors;
+
+			#pragma omp parallel default(shared)
+			{
+				Term1 t1(term1);
+				Term2 t2(term2);
+				Term3 t3(term3);
+
+				#pragma omp for schedule(static)
+				for (int k = 0; k < (int)numParticles; k++)
+				{
+					const unsigned int i = (particleList != nullptr) ? (*particleList)[k] : k;
+					const Vector3r &xi = model->getPosition(i);
+					t1.beginParticle(i, xi);
+					t2.beginParticle(i, xi);
+					t3.beginParticle(i, xi);
+
+					if (usesFluidNeighbors)
+					{
+						forall_fluid_neighbors(
+							t1.fluidNeighbor(pid, fm_neighbor, neighborIndex, xi, xj);
+							t2.fluidNeighbor(pid, fm_neighbor, neighborIndex, xi, xj);
+							t3.fluidNeighbor(pid, fm_neighbor, neighborIndex, xi, xj);
+						)
+					}
+					if (usesBoundaryNeighbors)
+					{
+						forall_boundary_neighbors(
+							t1.boundaryNeighbor(bm_neighbor, neighborIndex, xi, xj);
+							t2.boundaryNeighbor(bm_neighbor, neighborIndex, xi, xj);
+							t3.boundaryNeighbor(bm_neighbor, neighborIndex, xi, xj);
+						)
+					}
+
+					Vector3r &ai = model->getAcceleration(i);
+					t1.endParticle(i, ai);
+					t2.endParticle(i, ai);
+					t3.endParticle(i, ai);
+				}
+			}
+		}
+
+		/** Evaluate a single term (used by the step() of the explicit methods). */
+		template<class Term>
+		static void computeForces(FluidModel *model, Term term,
+			const std::vector<unsigned int> *particleList = nullptr, const unsigned int numListParticles = 0)
+		{
+			term.prepare();
+			computeForces(model, term, NoFusedTerm(), NoFusedTerm(), particleList, numListParticles);
+		}
+
+		/** Compute the surface tension, viscosity and drag forces of a fluid model.
+		* The explicit methods are evaluated in one fused pass, all other methods
+		* by their step().
+		*/
+		static void step(FluidModel *model);
+	};
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "SimulationDataPBF.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/SPHKernels.h"
 #include "SPlisHSPlasH/Simulation.h"
 
@@ -104,3 +105,10 @@ void SimulationDataPBF::emittedParticles(FluidModel *model, const unsigned int s
 	}
 }
 
+size_t SimulationDataPBF::getMemoryUsage() const
+{
+	return vectorMemory(m_lambda) +
+		vectorMemory(m_deltaX) +
+		vectorMemory(m_oldX) +
+		vectorMemory(m_lastX);
+}
@@ -40,6 +40,10 @@ namespace SPH
 			*/
 			void performNeighborhoodSearchSort();
 
+			/** Return the allocated memory of the particle data in bytes.
+			*/
+			size_t getMemoryUsage() const;
+
 			void emittedParticles(FluidModel *model, const unsigned int startIndex);
 
 			FORCE_INLINE const Real& getLambda(const unsigned int fluidIndex, const unsigned int i) const
@@ -128,6 +128,7 @@ void TimeStepPBF::step()
 		computeDensities(fluidModelIndex);
 	sim->computeNonPressureForces();
 
+	const bool sim2D = sim->is2DSimulation();
 	for (unsigned int fluidModelIndex = 0; fluidModelIndex < nModels; fluidModelIndex++)
 	{
 		FluidModel *model = sim->getFluidModel(fluidModelIndex);
@@ -138,6 +139,8 @@ void TimeStepPBF::step()
 			{
 				if (model->getParticleState(i) == ParticleState::Active)
 					model->getVelocity(i) += h * model->getAcceleration(i);
+				if (sim2D)
+					projectTo2D(model, i);
 			}
 		}
 	}
@@ -202,24 +205,23 @@ void TimeStepPBF::pressureSolveIteration(const unsigned int fluidModelIndex, Rea
 
 	const Real density0 = model->getDensity0();
 
+	AccumReal density_error = 0.0;
 	#pragma omp parallel default(shared)
 	{
-		#pragma omp for schedule(static)  
+		#pragma omp for reduction(+:density_error) schedule(static)
 		for (int i = 0; i < (int) numParticles; i++)
 		{
-			Real &density = model->getDensity(i);				
-			density = 1.0;
 			m_simulationData.getLambda(fluidModelIndex, i) = 0.0;
 
 			// Compute current density for particle i
-			density = model->getVolume(i) * sim->W_zero();
+			AccumReal densitySum = model->getVolume(i) * sim->W_zero();
 			const Vector3r &xi = model->getPosition(i);
 
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
 			forall_fluid_neighbors(
-				density += fm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
+				densitySum += fm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
 			)
 
 			//////////////////////////////////////////////////////////////////////////
@@ -227,12 +229,13 @@ void TimeStepPBF::pressureSolveIteration(const unsigned int fluidModelIndex, Rea
 			//////////////////////////////////////////////////////////////////////////
 			forall_boundary_neighbors(
 				// Boundary: Akinci2012
-				density += bm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
+				densitySum += bm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
 			)
 
+			const Real density = static_cast<Real>(densitySum);
+			model->getDensity(i) = density;
 			const Real density_err = density0 * (max(density, static_cast<Real>(1.0)) - static_cast<Real>(1.0));
-			#pragma omp atomic
-			avg_density_err += density_err;
+			density_error += density_err;
 
 			// Evaluate constraint function
 			const Real C = std::max(density - static_cast<Real>(1.0), static_cast<Real>(0.0));			// clamp to prevent particle clumping at surface
@@ -273,7 +276,7 @@ void TimeStepPBF::pressureSolveIteration(const unsigned int fluidModelIndex, Rea
 		}
 	}
 
-	avg_density_err /= numParticles;
+	avg_density_err = static_cast<Real>(density_error / numParticles);
 
 	#pragma omp parallel default(shared)
 	{
@@ -44,6 +44,8 @@ namespace SPH
 		TimeStepPBF();
 		virtual ~TimeStepPBF(void);
 
+		virtual size_t getMemoryUsage() const { return m_simulationData.getMemoryUsage(); }
+
 		/** Perform a simulation step. */
 		virtual void step();
 
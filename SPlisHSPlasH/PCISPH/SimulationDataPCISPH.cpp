@@ -1,4 +1,5 @@
 #include "SimulationDataPCISPH.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/SPHKernels.h"
 #include "SPlisHSPlasH/Simulation.h"
 #include <iostream>
@@ -128,4 +129,14 @@ void SimulationDataPCISPH::emittedParticles(FluidModel *model, const unsigned in
 		m_lastX[fluidModelIndex][j] = model->getPosition(j);
 		m_lastV[fluidModelIndex][j] = model->getVelocity(j);
 	}
+}
+
+size_t SimulationDataPCISPH::getMemoryUsage() const
+{
+	return vectorMemory(m_pcisph_factor) +
+		vectorMemory(m_lastX) +
+		vectorMemory(m_lastV) +
+		vectorMemory(m_densityAdv) +
+		vectorMemory(m_pressure) +
+		vectorMemory(m_pressureAccel);
 }
\ No newline at end of file
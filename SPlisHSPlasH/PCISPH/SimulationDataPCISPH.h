@@ -43,6 +43,10 @@ namespace SPH
 			 */
 			void performNeighborhoodSearchSort();
 
+			/** Return the allocated memory of the particle data in bytes.
+			*/
+			size_t getMemoryUsage() const;
+
 			Real getPCISPH_ScalingFactor(const unsigned int fluidIndex) { return m_pcisph_factor[fluidIndex]; }
 
 			void emittedParticles(FluidModel *model, const unsigned int startIndex);
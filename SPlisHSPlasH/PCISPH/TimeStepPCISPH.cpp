@@ -62,6 +62,7 @@ void TimeStepPCISPH::step()
 	pressureSolve();
 	STOP_TIMING_AVG;
 
+	const bool sim2D = sim->is2DSimulation();
 	for (unsigned int fluidModelIndex = 0; fluidModelIndex < nModels; fluidModelIndex++)
 	{
 		FluidModel *model = sim->getFluidModel(fluidModelIndex);
@@ -82,6 +83,8 @@ void TimeStepPCISPH::step()
 					v = lastV + h * accel;
 					x = lastX + h * v;
 				}
+				if (sim2D)
+					projectTo2D(model, i);
 			}
 		}
 	}
@@ -169,40 +172,40 @@ void TimeStepPCISPH::pressureSolveIteration(const unsigned int fluidModelIndex,
 
 
 	// Predict density 
+	AccumReal density_error = 0.0;
 	#pragma omp parallel default(shared)
 	{
-		#pragma omp for schedule(static)  
+		#pragma omp for reduction(+:density_error) schedule(static)
 		for (int i = 0; i < numParticles; i++)
 		{
 			const Vector3r &xi = model->getPosition(i);
-			Real &densityAdv = m_simulationData.getDensityAdv(fluidModelIndex, i);
-			densityAdv = model->getVolume(i) * sim->W_zero();
+			AccumReal densitySum = model->getVolume(i) * sim->W_zero();
 				
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
 			forall_fluid_neighbors(
-				densityAdv += fm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
+				densitySum += fm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
 			)
 
 			//////////////////////////////////////////////////////////////////////////
 			// Boundary
 			//////////////////////////////////////////////////////////////////////////
 			forall_boundary_neighbors(
-				densityAdv += bm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
+				densitySum += bm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
 			)
 
-			densityAdv = max(densityAdv, static_cast<Real>(1.0));
+			Real &densityAdv = m_simulationData.getDensityAdv(fluidModelIndex, i);
+			densityAdv = max(static_cast<Real>(densitySum), static_cast<Real>(1.0));
 			const Real density_err = density0 * (densityAdv - static_cast<Real>(1.0));
 			Real &pressure = m_simulationData.getPressure(fluidModelIndex, i);
 			pressure += invH2 * m_simulationData.getPCISPH_ScalingFactor(fluidModelIndex) * (densityAdv - static_cast<Real>(1.0));
 
-			#pragma omp atomic
-			avg_density_err += density_err;
+			density_error += density_err;
 		}
 	}
 
-	avg_density_err /= numParticles;
+	avg_density_err = static_cast<Real>(density_error / numParticles);
 
 	// Compute pressure forces
 	#pragma omp parallel default(shared)
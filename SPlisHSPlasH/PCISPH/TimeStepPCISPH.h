@@ -31,6 +31,8 @@ namespace SPH
 		TimeStepPCISPH();
 		virtual ~TimeStepPCISPH(void);
 
+		virtual size_t getMemoryUsage() const { return m_simulationData.getMemoryUsage(); }
+
 		virtual void step();
 		virtual void reset();
 		virtual void resize();
@@ -1,4 +1,5 @@
 #include "SimulationDataPF.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 
 #include "SPlisHSPlasH/SPHKernels.h"
 #include "SPlisHSPlasH/Simulation.h"
@@ -116,3 +117,12 @@ void SimulationDataPF::emittedParticles(FluidModel *model, const unsigned int st
 		m_particleOffset[j] += numEmittedParticles;
 	}
 }
+
+size_t SimulationDataPF::getMemoryUsage() const
+{
+	return vectorMemory(m_old_position) +
+		vectorMemory(m_num_fluid_neighbors) +
+		vectorMemory(m_s) +
+		vectorMemory(m_mat_diag) +
+		vectorMemory(m_particleOffset);
+}
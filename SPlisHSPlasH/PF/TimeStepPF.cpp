@@ -49,7 +49,8 @@ TimeStepPF::TimeStepPF() :
 	TimeStep(),
 	m_stiffness(50000.0),
 	m_counter(0),
-	m_numActiveParticlesTotal(0)
+	m_numActiveParticlesTotal(0),
+	m_sim(nullptr)
 {
 	m_simulationData.init();
 }
@@ -132,8 +133,8 @@ void TimeStepPF::solvePDConstraints()
 	// total number of active fluid particles
 	m_numActiveParticlesTotal = m_simulationData.getParticleOffset(nModels - 1) + sim->getFluidModel(nModels - 1)->numActiveParticles();
 	
-	VectorXr x(3 * m_numActiveParticlesTotal);
-	VectorXr b(3 * m_numActiveParticlesTotal);
+	VectorXs x(3 * m_numActiveParticlesTotal);
+	VectorXs b(3 * m_numActiveParticlesTotal);
 
 	for (unsigned int fluidModelIndex = 0; fluidModelIndex < nModels; fluidModelIndex++)
 	{
@@ -146,7 +147,7 @@ void TimeStepPF::solvePDConstraints()
 			//////////////////////////////////////////////////////////////////////////
 			// initialize positions
 			//////////////////////////////////////////////////////////////////////////
-			x.Vec3Block(offset + i) = m_simulationData.getS(fluidModelIndex, i);
+			x.Vec3Block(offset + i) = m_simulationData.getS(fluidModelIndex, i).cast<SolverReal>();
 
 			//////////////////////////////////////////////////////////////////////////
 			// count number of fluid neighbors for relaxation
@@ -164,6 +165,7 @@ void TimeStepPF::solvePDConstraints()
 	MatrixReplacement A(3 * m_numActiveParticlesTotal, matrixVecProd, (void*) this);
 #ifdef PD_USE_DIAGONAL_PRECONDITIONER
 	preparePreconditioner();
+	m_sim = sim;
 	m_solver.preconditioner().init(m_numActiveParticlesTotal, diagonalMatrixElement, (void*)this);
 #endif
 	m_solver.setMaxIterations(m_maxIterations);
@@ -192,7 +194,7 @@ void TimeStepPF::solvePDConstraints()
 	updatePositionsAndVelocity(x);
 }
 
-void SPH::TimeStepPF::updatePositionsAndVelocity(const VectorXr & x)
+void SPH::TimeStepPF::updatePositionsAndVelocity(const VectorXs & x)
 {
 	Simulation *sim = Simulation::getCurrent();
 	const unsigned int nModels = sim->numberOfFluidModels();
@@ -211,8 +213,9 @@ void SPH::TimeStepPF::updatePositionsAndVelocity(const VectorXr & x)
 			{
 				if (model->getParticleState(i) == ParticleState::Active)
 				{
-					const Vector3r vel = h_inv * (x.Vec3Block(offset + i) - m_simulationData.getOldPosition(fluidModelIndex, i));
-					model->setPosition(i, x.Vec3Block(offset + i));
+					const Vector3r xi = x.Vec3Block(offset + i).cast<Real>();
+					const Vector3r vel = h_inv * (xi - m_simulationData.getOldPosition(fluidModelIndex, i));
+					model->setPosition(i, xi);
 					model->setVelocity(i, vel);
 				}
 			}
@@ -224,7 +227,7 @@ void SPH::TimeStepPF::updatePositionsAndVelocity(const VectorXr & x)
 FORCE_INLINE void SPH::TimeStepPF::diagonalMatrixElement(const unsigned int row, Vector3r &result, void *userData)
 {
 	TimeStepPF *timeStepPF = static_cast<TimeStepPF*>(userData);
-	Simulation *sim = Simulation::getCurrent();
+	Simulation *sim = timeStepPF->m_sim;
 	const unsigned int nModels = sim->numberOfFluidModels();
 
 	// TODO: use m_simulationData->getParticleOffset instead of accessing FluidModels
@@ -276,6 +279,7 @@ void SPH::TimeStepPF::addAccellerationToVelocity()
 	Simulation *sim = Simulation::getCurrent();
 	const auto  h = TimeManager::getCurrent()->getTimeStepSize();
 	const unsigned int nModels = sim->numberOfFluidModels();
+	const bool sim2D = sim->is2DSimulation();
 
 	for (unsigned int fluidModelIndex = 0; fluidModelIndex < nModels; fluidModelIndex++)
 	{
@@ -288,13 +292,15 @@ void SPH::TimeStepPF::addAccellerationToVelocity()
 			{
 				if (model->getParticleState(i) == ParticleState::Active)
 					model->setVelocity(i, model->getVelocity(i) + h * model->getAcceleration(i));
+				if (sim2D)
+					projectTo2D(model, i);
 			}
 		}
 	}
 }
 
 /** \brief compute the right hand side of the system in a matrix-free fashion and store the result in result*/
-void SPH::TimeStepPF::matrixFreeRHS(const VectorXr & x, VectorXr & result)
+void SPH::TimeStepPF::matrixFreeRHS(const VectorXs & x, VectorXs & result)
 {
 	Simulation *sim = Simulation::getCurrent();
 	const Real h = TimeManager::getCurrent()->getTimeStepSize();;
@@ -329,7 +335,7 @@ void SPH::TimeStepPF::matrixFreeRHS(const VectorXr & x, VectorXr & result)
 				//////////////////////////////////////////////////////////////////////////
 				std::vector<Vector3r> p(numParticlesInConstraint);
 				// the i'th particle itself
-				p[0] = x.Vec3Block(offset + i);
+				p[0] = x.Vec3Block(offset + i).cast<Real>();
 				unsigned int counter = 1;
 				// fluid neighbors
 				for (unsigned int pid = 0; pid < nModels; pid++)
@@ -338,7 +344,7 @@ void SPH::TimeStepPF::matrixFreeRHS(const VectorXr & x, VectorXr & result)
 					for (unsigned int j = 0; j < sim->numberOfNeighbors(fluidModelIndex, pid, i); j++)
 					{
 						const unsigned int neighborIndex = sim->getNeighbor(fluidModelIndex, pid, i, j);
-						p[counter++] = x.Vec3Block(neighborOffset + neighborIndex);
+						p[counter++] = x.Vec3Block(neighborOffset + neighborIndex).cast<Real>();
 					}
 				}
 				// boundary neighbors
@@ -504,7 +510,7 @@ void SPH::TimeStepPF::matrixFreeRHS(const VectorXr & x, VectorXr & result)
 	}
 }
 
-void SPH::TimeStepPF::matrixVecProd(const Real* vec, Real *result, void *userData)
+void SPH::TimeStepPF::matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData)
 {
 	TimeStepPF *timeStepPF = static_cast<TimeStepPF*>(userData);
 	
@@ -12,15 +12,14 @@
 
 namespace SPH
 {
+	class Simulation;
+
 	/** \brief This class implements the Projective Fluids approach introduced
 	* by Weiler, Koschier and Bender \cite Weiler:2016.
 	*/
 	class TimeStepPF : public TimeStep
 	{
 	protected:
-		using VectorXr = Eigen::Matrix<Real, -1, 1>;
-		using VectorXrMap = Eigen::Map<VectorXr>;
-
 #ifdef PD_USE_DIAGONAL_PRECONDITIONER
 		using Solver = Eigen::ConjugateGradient<MatrixReplacement, Eigen::Lower | Eigen::Upper, JacobiPreconditioner3D>;
 		FORCE_INLINE static void diagonalMatrixElement(const unsigned int row, Vector3r &result, void *userData);
@@ -34,13 +33,17 @@ namespace SPH
 		Real m_stiffness;
 		unsigned int m_counter;
 		unsigned int m_numActiveParticlesTotal;
+		/** Simulation of the current step. The preconditioner calls diagonalMatrixElement() 
+		* on the OpenMP worker threads which have no current simulation. 
+		*/
+		Simulation *m_sim;
 
 		void initialGuessForPositions(const unsigned int fluidModelIndex);
 		void solvePDConstraints();
-		void updatePositionsAndVelocity(const VectorXr & x);
+		void updatePositionsAndVelocity(const VectorXs & x);
 		void addAccellerationToVelocity();
 
-		void matrixFreeRHS(const VectorXr & x, VectorXr & result);
+		void matrixFreeRHS(const VectorXs & x, VectorXs & result);
 
 		/** Perform the neighborhood search for all fluid particles.
 		*/
@@ -55,11 +58,13 @@ namespace SPH
 		TimeStepPF();
 		virtual ~TimeStepPF(void);
 
+		virtual size_t getMemoryUsage() const { return m_simulationData.getMemoryUsage(); }
+
 		virtual void step()   override;
 		virtual void reset()  override;
 		virtual void resize() override;
 
-		static void matrixVecProd(const Real* vec, Real *result, void *userData);
+		static void matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData);
 	};
 }
 
@@ -8,9 +8,20 @@
 
 namespace SPH
 {
+	/** \brief Number of kernel contexts. 
+	*
+	* The parameters of the kernels are static members. Each kernel is a template 
+	* with the context as parameter, so that each context has its own parameters 
+	* and lookup tables. Simulations with different support radii which exist at 
+	* the same time in one process use different contexts (see Simulation::setParticleRadius).
+	* The kernels without template parameter (e.g. CubicKernel) belong to context 0.
+	*/
+	const unsigned int NUM_KERNEL_CONTEXTS = 4;
+
 	/** \brief Cubic spline kernel.
 	*/
-	class CubicKernel
+	template<unsigned int context>
+	class CubicKernelT
 	{
 	protected:
 		static Real m_radius;
@@ -86,9 +97,21 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real CubicKernelT<context>::m_radius;
+	template<unsigned int context>
+	Real CubicKernelT<context>::m_k;
+	template<unsigned int context>
+	Real CubicKernelT<context>::m_l;
+	template<unsigned int context>
+	Real CubicKernelT<context>::m_W_zero;
+
+	typedef CubicKernelT<0> CubicKernel;
+
 	/** \brief Poly6 kernel.
 	*/
-	class Poly6Kernel
+	template<unsigned int context>
+	class Poly6KernelT
 	{
 	protected:
 		static Real m_radius;
@@ -186,9 +209,23 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real Poly6KernelT<context>::m_radius;
+	template<unsigned int context>
+	Real Poly6KernelT<context>::m_k;
+	template<unsigned int context>
+	Real Poly6KernelT<context>::m_l;
+	template<unsigned int context>
+	Real Poly6KernelT<context>::m_m;
+	template<unsigned int context>
+	Real Poly6KernelT<context>::m_W_zero;
+
+	typedef Poly6KernelT<0> Poly6Kernel;
+
 	/** \brief Spiky kernel.
 	*/
-	class SpikyKernel
+	template<unsigned int context>
+	class SpikyKernelT
 	{
 	protected:
 		static Real m_radius;
@@ -266,9 +303,21 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real SpikyKernelT<context>::m_radius;
+	template<unsigned int context>
+	Real SpikyKernelT<context>::m_k;
+	template<unsigned int context>
+	Real SpikyKernelT<context>::m_l;
+	template<unsigned int context>
+	Real SpikyKernelT<context>::m_W_zero;
+
+	typedef SpikyKernelT<0> SpikyKernel;
+
 	/** \brief quintic Wendland C2 kernel.
 	*/
-	class WendlandQuinticC2Kernel
+	template<unsigned int context>
+	class WendlandQuinticC2KernelT
 	{
 	protected:
 		static Real m_radius;
@@ -326,9 +375,21 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real WendlandQuinticC2KernelT<context>::m_radius;
+	template<unsigned int context>
+	Real WendlandQuinticC2KernelT<context>::m_k;
+	template<unsigned int context>
+	Real WendlandQuinticC2KernelT<context>::m_l;
+	template<unsigned int context>
+	Real WendlandQuinticC2KernelT<context>::m_W_zero;
+
+	typedef WendlandQuinticC2KernelT<0> WendlandQuinticC2Kernel;
+
 	/** \brief Cohesion kernel used for the surface tension method of Akinci el al. \cite Akinci:2013.
 	*/
-	class CohesionKernel
+	template<unsigned int context>
+	class CohesionKernelT
 	{
 	protected:
 		static Real m_radius;
@@ -394,9 +455,21 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real CohesionKernelT<context>::m_radius;
+	template<unsigned int context>
+	Real CohesionKernelT<context>::m_k;
+	template<unsigned int context>
+	Real CohesionKernelT<context>::m_c;
+	template<unsigned int context>
+	Real CohesionKernelT<context>::m_W_zero;
+
+	typedef CohesionKernelT<0> CohesionKernel;
+
 	/** \brief Adhesion kernel used for the surface tension method of Akinci el al. \cite Akinci:2013.
 	*/
-	class AdhesionKernel
+	template<unsigned int context>
+	class AdhesionKernelT
 	{
 	protected:
 		static Real m_radius;
@@ -450,10 +523,20 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real AdhesionKernelT<context>::m_radius;
+	template<unsigned int context>
+	Real AdhesionKernelT<context>::m_k;
+	template<unsigned int context>
+	Real AdhesionKernelT<context>::m_W_zero;
+
+	typedef AdhesionKernelT<0> AdhesionKernel;
+
 
 	/** \brief Cubic spline kernel (2D).
 	*/
-	class CubicKernel2D
+	template<unsigned int context>
+	class CubicKernel2DT
 	{
 	protected:
 		static Real m_radius;
@@ -533,9 +616,21 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real CubicKernel2DT<context>::m_radius;
+	template<unsigned int context>
+	Real CubicKernel2DT<context>::m_k;
+	template<unsigned int context>
+	Real CubicKernel2DT<context>::m_l;
+	template<unsigned int context>
+	Real CubicKernel2DT<context>::m_W_zero;
+
+	typedef CubicKernel2DT<0> CubicKernel2D;
+
 	/** \brief Wendland Quintic C2 spline kernel (2D).
 	*/
-	class WendlandQuinticC2Kernel2D
+	template<unsigned int context>
+	class WendlandQuinticC2Kernel2DT
 	{
 	protected:
 		static Real m_radius;
@@ -593,6 +688,17 @@ namespace SPH
 		}
 	};
 
+	template<unsigned int context>
+	Real WendlandQuinticC2Kernel2DT<context>::m_radius;
+	template<unsigned int context>
+	Real WendlandQuinticC2Kernel2DT<context>::m_k;
+	template<unsigned int context>
+	Real WendlandQuinticC2Kernel2DT<context>::m_l;
+	template<unsigned int context>
+	Real WendlandQuinticC2Kernel2DT<context>::m_W_zero;
+
+	typedef WendlandQuinticC2Kernel2DT<0> WendlandQuinticC2Kernel2D;
+
 
 	/** \brief Precomputed kernel which is based on a lookup table as described by Bender and Koschier \cite Bender:2015, \cite Bender2017.
 	*
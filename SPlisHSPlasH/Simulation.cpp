@@ -1,6 +1,7 @@
 #include "Simulation.h"
 #include "TimeManager.h"
 #include "Utilities/Timing.h"
+#include "Utilities/SystemInfo.h"
 #include "TimeStep.h"
 #include "EmitterSystem.h"
 #include "SPlisHSPlasH/WCSPH/TimeStepWCSPH.h"
@@ -9,6 +10,17 @@
 #include "SPlisHSPlasH/IISPH/TimeStepIISPH.h"
 #include "SPlisHSPlasH/DFSPH/TimeStepDFSPH.h"
 #include "SPlisHSPlasH/PF/TimeStepPF.h"
+#include "Viscosity/ViscosityBase.h"
+#include "SurfaceTension/SurfaceTensionBase.h"
+#include "Vorticity/VorticityBase.h"
+#include "Drag/DragBase.h"
+#include "Elasticity/ElasticityBase.h"
+#include "NonPressureForceFusion.h"
+#include <iomanip>
+#include <mutex>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 
@@ -16,7 +28,7 @@ using namespace SPH;
 using namespace std;
 using namespace GenParam;
 
-Simulation* Simulation::current = nullptr;
+thread_local Simulation* Simulation::current = nullptr;
 int Simulation::SIM_2D = -1;
 int Simulation::PARTICLE_RADIUS = -1;
 int Simulation::GRAVITATION = -1;
@@ -24,6 +36,7 @@ int Simulation::CFL_METHOD = -1;
 int Simulation::CFL_FACTOR = -1;
 int Simulation::CFL_MAX_TIMESTEPSIZE = -1;
 int Simulation::ENABLE_Z_SORT = -1;
+int Simulation::FUSED_NON_PRESSURE_FORCES = -1;
 int Simulation::KERNEL_METHOD = -1;
 int Simulation::GRAD_KERNEL_METHOD = -1;
 int Simulation::ENUM_KERNEL_CUBIC = -1;
@@ -51,6 +64,41 @@ int Simulation::ENUM_SIMULATION_IISPH = -1;
 int Simulation::ENUM_SIMULATION_DFSPH = -1;
 int Simulation::ENUM_SIMULATION_PF = -1;
 
+namespace
+{
+	/** Support radius and number of simulations of each kernel context.
+	*/
+	std::mutex kernelContextMutex;
+	Real kernelContextRadius[NUM_KERNEL_CONTEXTS];
+	unsigned int kernelContextUsers[NUM_KERNEL_CONTEXTS] = { 0 };
+
+	template<unsigned int context>
+	void setKernelRadius(const Real supportRadius)
+	{
+		Poly6KernelT<context>::setRadius(supportRadius);
+		SpikyKernelT<context>::setRadius(supportRadius);
+		CubicKernelT<context>::setRadius(supportRadius);
+		WendlandQuinticC2KernelT<context>::setRadius(supportRadius);
+		PrecomputedKernel<CubicKernelT<context>, 10000>::setRadius(supportRadius);
+		CohesionKernelT<context>::setRadius(supportRadius);
+		AdhesionKernelT<context>::setRadius(supportRadius);
+		CubicKernel2DT<context>::setRadius(supportRadius);
+		WendlandQuinticC2Kernel2DT<context>::setRadius(supportRadius);
+	}
+
+	void setKernelRadius(const unsigned int context, const Real supportRadius)
+	{
+		static_assert(NUM_KERNEL_CONTEXTS == 4, "setKernelRadius must handle all kernel contexts");
+		if (context == 0)
+			setKernelRadius<0>(supportRadius);
+		else if (context == 1)
+			setKernelRadius<1>(supportRadius);
+		else if (context == 2)
+			setKernelRadius<2>(supportRadius);
+		else if (context == 3)
+			setKernelRadius<3>(supportRadius);
+	}
+}
 
 Simulation::Simulation () 
 {
@@ -61,14 +109,22 @@ Simulation::Simulation ()
 
 	m_kernelMethod = -1;
 	m_gradKernelMethod = -1;
+	m_kernelFct = nullptr;
+	m_gradKernelFct = nullptr;
+	m_cohesionKernelFct = nullptr;
+	m_adhesionKernelFct = nullptr;
+	m_kernelContext = NUM_KERNEL_CONTEXTS;
 
 	m_neighborhoodSearch = nullptr;
 	m_timeStep = nullptr;
 	m_simulationMethod = SimulationMethods::NumSimulationMethods;
 	m_simulationMethodChanged = NULL;
+	m_loadBoundaryVolume = NULL;
+	m_storeBoundaryVolume = NULL;
 
 	m_sim2D = false;
 	m_enableZSort = true;
+	m_fusedNonPressureForces = false;
 
 	m_animationFieldSystem = new AnimationFieldSystem();
 }
@@ -87,6 +143,13 @@ Simulation::~Simulation ()
 	for (unsigned int i = 0; i < m_boundaryModels.size(); i++)
 		delete m_boundaryModels[i];
 	m_boundaryModels.clear();
+	m_bodyLocalNeighborhoodSearch.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(kernelContextMutex);
+		if (m_kernelContext < NUM_KERNEL_CONTEXTS)
+			kernelContextUsers[m_kernelContext]--;
+	}
 
 	current = nullptr;
 }
@@ -95,6 +158,11 @@ Simulation* Simulation::getCurrent ()
 {
 	if (current == nullptr)
 	{
+#ifdef _OPENMP
+		// a worker thread must not create a simulation of its own
+		if (omp_in_parallel())
+			return nullptr;
+#endif
 		current = new Simulation ();
 	}
 	return current;
@@ -144,6 +212,10 @@ void Simulation::initParameters()
 	setGroup(ENABLE_Z_SORT, "Simulation");
 	setDescription(ENABLE_Z_SORT, "Enable z-sort to improve cache hits.");
 
+	FUSED_NON_PRESSURE_FORCES = createBoolParameter("fusedNonPressureForces", "Fused non-pressure forces", &m_fusedNonPressureForces);
+	setGroup(FUSED_NON_PRESSURE_FORCES, "Simulation");
+	setDescription(FUSED_NON_PRESSURE_FORCES, "Evaluate the explicit surface tension, viscosity and drag methods in one neighbor pass.");
+
 	ParameterBase::GetFunc<Real> getRadiusFct = std::bind(&Simulation::getParticleRadius, this);
 	ParameterBase::SetFunc<Real> setRadiusFct = std::bind(&Simulation::setParticleRadius, this, std::placeholders::_1);
 	PARTICLE_RADIUS = createNumericParameter("particleRadius", "Particle radius", getRadiusFct, setRadiusFct);
@@ -234,47 +306,139 @@ void Simulation::setParticleRadius(Real val)
 	m_supportRadius = static_cast<Real>(4.0)*m_particleRadius;
 
 	// init kernel
-	Poly6Kernel::setRadius(m_supportRadius);
-	SpikyKernel::setRadius(m_supportRadius);
-	CubicKernel::setRadius(m_supportRadius);
-	WendlandQuinticC2Kernel::setRadius(m_supportRadius);
-	PrecomputedCubicKernel::setRadius(m_supportRadius);
-	CohesionKernel::setRadius(m_supportRadius);
-	AdhesionKernel::setRadius(m_supportRadius);
-	CubicKernel2D::setRadius(m_supportRadius);
-	WendlandQuinticC2Kernel2D::setRadius(m_supportRadius);
+	{
+		std::lock_guard<std::mutex> lock(kernelContextMutex);
+		if (m_kernelContext < NUM_KERNEL_CONTEXTS)
+			kernelContextUsers[m_kernelContext]--;
+
+		// share the kernel context with simulations which use the same support radius
+		m_kernelContext = NUM_KERNEL_CONTEXTS;
+		for (unsigned int i = 0; i < NUM_KERNEL_CONTEXTS; i++)
+		{
+			if ((kernelContextUsers[i] > 0) && (kernelContextRadius[i] == m_supportRadius))
+			{
+				m_kernelContext = i;
+				break;
+			}
+		}
+		if (m_kernelContext == NUM_KERNEL_CONTEXTS)
+		{
+			for (unsigned int i = 0; i < NUM_KERNEL_CONTEXTS; i++)
+			{
+				if (kernelContextUsers[i] == 0)
+				{
+					m_kernelContext = i;
+					break;
+				}
+			}
+			if (m_kernelContext == NUM_KERNEL_CONTEXTS)
+			{
+				LOG_ERR << "All " << NUM_KERNEL_CONTEXTS << " kernel contexts are used by simulations with a different support radius. The kernels of context 0 are overwritten.";
+				m_kernelContext = 0;
+			}
+			kernelContextRadius[m_kernelContext] = m_supportRadius;
+			setKernelRadius(m_kernelContext, m_supportRadius);
+		}
+		kernelContextUsers[m_kernelContext]++;
+	}
+	updateKernelFunctions();
 }
 
-void Simulation::setGradKernel(int val)
+template<unsigned int context>
+void Simulation::setKernelFunctions()
 {
-	m_gradKernelMethod = val;
+	typedef PrecomputedKernel<CubicKernelT<context>, 10000> PrecomputedCubicKernelT;
 
 	if (!m_sim2D)
 	{
-		if ((m_gradKernelMethod < 0) || (m_gradKernelMethod > 4))
-			m_gradKernelMethod = 0;
+		if (m_kernelMethod == 0)
+		{
+			m_W_zero = CubicKernelT<context>::W_zero();
+			m_kernelFct = CubicKernelT<context>::W;
+		}
+		else if (m_kernelMethod == 1)
+		{
+			m_W_zero = WendlandQuinticC2KernelT<context>::W_zero();
+			m_kernelFct = WendlandQuinticC2KernelT<context>::W;
+		}
+		else if (m_kernelMethod == 2)
+		{
+			m_W_zero = Poly6KernelT<context>::W_zero();
+			m_kernelFct = Poly6KernelT<context>::W;
+		}
+		else if (m_kernelMethod == 3)
+		{
+			m_W_zero = SpikyKernelT<context>::W_zero();
+			m_kernelFct = SpikyKernelT<context>::W;
+		}
+		else if (m_kernelMethod == 4)
+		{
+			m_W_zero = PrecomputedCubicKernelT::W_zero();
+			m_kernelFct = PrecomputedCubicKernelT::W;
+		}
 
 		if (m_gradKernelMethod == 0)
-			m_gradKernelFct = CubicKernel::gradW;
+			m_gradKernelFct = CubicKernelT<context>::gradW;
 		else if (m_gradKernelMethod == 1)
-			m_gradKernelFct = WendlandQuinticC2Kernel::gradW;
+			m_gradKernelFct = WendlandQuinticC2KernelT<context>::gradW;
 		else if (m_gradKernelMethod == 2)
-			m_gradKernelFct = Poly6Kernel::gradW;
+			m_gradKernelFct = Poly6KernelT<context>::gradW;
 		else if (m_gradKernelMethod == 3)
-			m_gradKernelFct = SpikyKernel::gradW;
+			m_gradKernelFct = SpikyKernelT<context>::gradW;
 		else if (m_gradKernelMethod == 4)
-			m_gradKernelFct = Simulation::PrecomputedCubicKernel::gradW;
+			m_gradKernelFct = PrecomputedCubicKernelT::gradW;
 	}
 	else
 	{
-		if ((m_gradKernelMethod < 0) || (m_gradKernelMethod > 1))
-			m_gradKernelMethod = 0;
+		if (m_kernelMethod == 0)
+		{
+			m_W_zero = CubicKernel2DT<context>::W_zero();
+			m_kernelFct = CubicKernel2DT<context>::W;
+		}
+		else if (m_kernelMethod == 1)
+		{
+			m_W_zero = WendlandQuinticC2Kernel2DT<context>::W_zero();
+			m_kernelFct = WendlandQuinticC2Kernel2DT<context>::W;
+		}
 
 		if (m_gradKernelMethod == 0)
-			m_gradKernelFct = CubicKernel2D::gradW;
+			m_gradKernelFct = CubicKernel2DT<context>::gradW;
 		else if (m_gradKernelMethod == 1)
-			m_gradKernelFct = WendlandQuinticC2Kernel2D::gradW;
+			m_gradKernelFct = WendlandQuinticC2Kernel2DT<context>::gradW;
+	}
+
+	m_cohesionKernelFct = CohesionKernelT<context>::W;
+	m_adhesionKernelFct = AdhesionKernelT<context>::W;
+}
+
+void Simulation::updateKernelFunctions()
+{
+	static_assert(NUM_KERNEL_CONTEXTS == 4, "updateKernelFunctions must handle all kernel contexts");
+	if (m_kernelContext == 0)
+		setKernelFunctions<0>();
+	else if (m_kernelContext == 1)
+		setKernelFunctions<1>();
+	else if (m_kernelContext == 2)
+		setKernelFunctions<2>();
+	else if (m_kernelContext == 3)
+		setKernelFunctions<3>();
+}
+
+void Simulation::setGradKernel(int val)
+{
+	m_gradKernelMethod = val;
+
+	if (!m_sim2D)
+	{
+		if ((m_gradKernelMethod < 0) || (m_gradKernelMethod > 4))
+			m_gradKernelMethod = 0;
 	}
+	else
+	{
+		if ((m_gradKernelMethod < 0) || (m_gradKernelMethod > 1))
+			m_gradKernelMethod = 0;
+	}
+	updateKernelFunctions();
 }
 
 void Simulation::setKernel(int val)
@@ -287,49 +451,13 @@ void Simulation::setKernel(int val)
 	{
 		if ((m_kernelMethod < 0) || (m_kernelMethod > 4))
 			m_kernelMethod = 0;
-
-		if (m_kernelMethod == 0)
-		{
-			m_W_zero = CubicKernel::W_zero();
-			m_kernelFct = CubicKernel::W;
-		}
-		else if (m_kernelMethod == 1)
-		{
-			m_W_zero = WendlandQuinticC2Kernel::W_zero();
-			m_kernelFct = WendlandQuinticC2Kernel::W;
-		}
-		else if (m_kernelMethod == 2)
-		{
-			m_W_zero = Poly6Kernel::W_zero();
-			m_kernelFct = Poly6Kernel::W;
-		}
-		else if (m_kernelMethod == 3)
-		{
-			m_W_zero = SpikyKernel::W_zero();
-			m_kernelFct = SpikyKernel::W;
-		}
-		else if (m_kernelMethod == 4)
-		{
-			m_W_zero = Simulation::PrecomputedCubicKernel::W_zero();
-			m_kernelFct = Simulation::PrecomputedCubicKernel::W;
-		}
 	}
 	else
 	{
 		if ((m_kernelMethod < 0) || (m_kernelMethod > 1))
 			m_kernelMethod = 0;
-
-		if (m_kernelMethod == 0)
-		{
-			m_W_zero = CubicKernel2D::W_zero();
-			m_kernelFct = CubicKernel2D::W;
-		}
-		else if (m_kernelMethod == 1)
-		{
-			m_W_zero = WendlandQuinticC2Kernel2D::W_zero();
-			m_kernelFct = WendlandQuinticC2Kernel2D::W;
-		}
 	}
+	updateKernelFunctions();
 	updateBoundaryVolume();
 }
 
@@ -406,15 +534,106 @@ void Simulation::computeNonPressureForces()
 	for (unsigned int i = 0; i < numberOfFluidModels(); i++)
 	{
 		FluidModel *fm = getFluidModel(i);
-		fm->computeSurfaceTension();
-		fm->computeViscosity();
-		fm->computeVorticity();
-		fm->computeDragForce();
+		if (m_fusedNonPressureForces)
+			NonPressureForceFusion::step(fm);
+		else
+		{
+			fm->computeSurfaceTension();
+			fm->computeViscosity();
+			fm->computeVorticity();
+			fm->computeDragForce();
+		}
 		fm->computeElasticity();
 	}
 	STOP_TIMING_AVG
 }
 
+void Simulation::getMemoryUsage(std::vector<MemoryUsageEntry> &entries)
+{
+	entries.clear();
+	for (unsigned int i = 0; i < numberOfFluidModels(); i++)
+	{
+		FluidModel *fm = getFluidModel(i);
+		const std::string &id = fm->getId();
+		entries.push_back({ id + ": fluid model", fm->getMemoryUsage(), true });
+		if (fm->getViscosityBase() != nullptr)
+			entries.push_back({ id + ": viscosity", fm->getViscosityBase()->getMemoryUsage(), true });
+		if (fm->getSurfaceTensionBase() != nullptr)
+			entries.push_back({ id + ": surface tension", fm->getSurfaceTensionBase()->getMemoryUsage(), true });
+		if (fm->getVorticityBase() != nullptr)
+			entries.push_back({ id + ": vorticity", fm->getVorticityBase()->getMemoryUsage(), true });
+		if (fm->getDragBase() != nullptr)
+			entries.push_back({ id + ": drag", fm->getDragBase()->getMemoryUsage(), true });
+		if (fm->getElasticityBase() != nullptr)
+			entries.push_back({ id + ": elasticity", fm->getElasticityBase()->getMemoryUsage(), true });
+	}
+	if (m_timeStep != nullptr)
+		entries.push_back({ "simulation method", m_timeStep->getMemoryUsage(), true });
+
+	size_t boundaryBytes = 0;
+	for (unsigned int i = 0; i < numberOfBoundaryModels(); i++)
+		boundaryBytes += getBoundaryModel(i)->getMemoryUsage();
+	entries.push_back({ "boundary models", boundaryBytes, false });
+
+	if (m_neighborhoodSearch != nullptr)
+		entries.push_back({ "neighbor lists", getNeighborhoodSearchMemoryUsage(), true });
+}
+
+size_t Simulation::getNeighborhoodSearchMemoryUsage() const
+{
+	// The neighbor lists are stored per particle and per neighboring point set 
+	// in the neighborhood search. The estimate uses the current number of 
+	// neighbors, i.e. the reserved capacity is not taken into account.
+	size_t bytes = 0;
+	const unsigned int nPointSets = numberOfPointSets();
+	for (unsigned int i = 0; i < static_cast<unsigned int>(m_fluidModels.size()); i++)
+	{
+		const unsigned int numParticles = m_fluidModels[i]->numActiveParticles();
+		for (unsigned int j = 0; j < nPointSets; j++)
+		{
+			bytes += numParticles * sizeof(std::vector<unsigned int>);
+			if (m_bodyLocalNeighborhoodSearch.isBodyLocal(j))
+				continue;
+			for (unsigned int k = 0; k < numParticles; k++)
+				bytes += numberOfNeighbors(i, j, k) * sizeof(unsigned int);
+		}
+	}
+	return bytes + m_bodyLocalNeighborhoodSearch.getMemoryUsage();
+}
+
+void Simulation::printMemoryUsage()
+{
+	std::vector<MemoryUsageEntry> entries;
+	getMemoryUsage(entries);
+
+	unsigned int numParticles = 0;
+	for (unsigned int i = 0; i < numberOfFluidModels(); i++)
+		numParticles += getFluidModel(i)->numActiveParticles();
+
+	size_t total = 0;
+	size_t perParticleTotal = 0;
+	const double MB = 1024.0 * 1024.0;
+	LOG_INFO << "---------------------------------------------------------------------------";
+	LOG_INFO << "Memory usage:";
+	for (unsigned int i = 0; i < entries.size(); i++)
+	{
+		LOG_INFO << entries[i].name << ": " << std::fixed << std::setprecision(2) << entries[i].bytes / MB << " MB";
+		total += entries[i].bytes;
+		if (entries[i].perParticle)
+			perParticleTotal += entries[i].bytes;
+	}
+	LOG_INFO << "Total: " << std::fixed << std::setprecision(2) << total / MB << " MB";
+	if (numParticles > 0)
+	{
+		const double bytesPerParticle = perParticleTotal / (double)numParticles;
+		LOG_INFO << "Bytes per fluid particle: " << std::fixed << std::setprecision(1) << bytesPerParticle;
+		LOG_INFO << "Projection for 1M fluid particles: " << std::fixed << std::setprecision(2) << (bytesPerParticle * 1.0e6 + (total - perParticleTotal)) / MB << " MB";
+		LOG_INFO << "Projection for 10M fluid particles: " << std::fixed << std::setprecision(2) << (bytesPerParticle * 1.0e7 + (total - perParticleTotal)) / MB << " MB";
+	}
+	LOG_INFO << "Peak memory of the process: " << std::fixed << std::setprecision(2) << Utilities::SystemInfo::getPeakMemoryUsage() / MB << " MB";
+	LOG_INFO << "---------------------------------------------------------------------------";
+}
+
 void Simulation::reset()
 {
 	// reset fluid models
@@ -504,6 +723,9 @@ void Simulation::performNeighborhoodSearch()
 {
 	START_TIMING("neighborhood_search");
 	m_neighborhoodSearch->find_neighbors();
+	m_bodyLocalNeighborhoodSearch.findNeighbors();
+	for (unsigned int i = 0; i < numberOfFluidModels(); i++)
+		getFluidModel(i)->getSurfaceClassification().invalidate();
 	STOP_TIMING_AVG;
 }
 
@@ -528,6 +750,12 @@ void Simulation::setSimulationMethodChangedCallback(std::function<void()> const&
 	m_simulationMethodChanged = callBackFct;
 }
 
+void Simulation::setBoundaryVolumeCacheCallbacks(std::function<bool()> const& loadFct, std::function<void()> const& storeFct)
+{
+	m_loadBoundaryVolume = loadFct;
+	m_storeBoundaryVolume = storeFct;
+}
+
 void Simulation::emittedParticles(FluidModel *model, const unsigned int startIndex)
 {
 	model->emittedParticles(startIndex);
@@ -557,6 +785,7 @@ void Simulation::addBoundaryModel(RigidBodyObject *rbo, const unsigned int numBo
 	BoundaryModel *bm = new BoundaryModel();
 	bm->initModel(rbo, numBoundaryParticles, boundaryParticles);
 	m_boundaryModels.push_back(bm);
+	m_bodyLocalNeighborhoodSearch.addBoundaryModel(bm);
 }
 
 void Simulation::addFluidModel(const std::string &id, const unsigned int nFluidParticles, Vector3r* fluidParticles, Vector3r* fluidVelocities, const unsigned int nMaxEmitterParticles)
@@ -580,42 +809,42 @@ void Simulation::updateBoundaryVolume()
 	// (see Akinci et al. "Versatile rigid - fluid coupling for incompressible SPH", Siggraph 2012
 	//////////////////////////////////////////////////////////////////////////
 
-	// Search boundary neighborhood
-
-	// Activate only static boundaries
 	LOG_INFO << "Initialize boundary volume";
-	m_neighborhoodSearch->set_active(false);
-	for (unsigned int i = 0; i < numberOfBoundaryModels(); i++)
-	{
-		if (!getBoundaryModel(i)->getRigidBodyObject()->isDynamic())
-			m_neighborhoodSearch->set_active(i + nFluids, true, true);
-	}
-
-	//performNeighborhoodSearchSort();
-	m_neighborhoodSearch->find_neighbors();
-
-	// Boundary objects
-	for (unsigned int body = 0; body < numberOfBoundaryModels(); body++)
-	{
-		if (!getBoundaryModel(body)->getRigidBodyObject()->isDynamic())
-			getBoundaryModel(body)->computeBoundaryVolume();
-	}
-
-	////////////////////////////////////////////////////////////////////////// 
-	// Compute boundary psi for all dynamic bodies
-	//////////////////////////////////////////////////////////////////////////
-	for (unsigned int body = 0; body < numberOfBoundaryModels(); body++)
+	if ((m_loadBoundaryVolume == nullptr) || !m_loadBoundaryVolume())
 	{
-		// Deactivate all
+		// Search boundary neighborhood in a single pass:
+		// static boundaries see all boundaries (including the dynamic ones), 
+		// a dynamic boundary only sees itself.
+		// The neighbor lists of inactive pairs are empty, so computeBoundaryVolume()
+		// only sums up the contributions of the active pairs.
 		m_neighborhoodSearch->set_active(false);
-
-		// Only activate next dynamic body
-		if (getBoundaryModel(body)->getRigidBodyObject()->isDynamic())
+		bool search = false;
+		for (unsigned int i = 0; i < numberOfBoundaryModels(); i++)
 		{
-			m_neighborhoodSearch->set_active(body + nFluids, true, true);
+			BoundaryModel *bm_i = getBoundaryModel(i);
+			// body-local models compute the volume in rest configuration using their own grid
+			if (bm_i->isBodyLocal())
+				continue;
+			search = true;
+			if (bm_i->getRigidBodyObject()->isDynamic())
+				m_neighborhoodSearch->set_active(i + nFluids, i + nFluids, true);
+			else
+			{
+				for (unsigned int j = 0; j < numberOfBoundaryModels(); j++)
+					m_neighborhoodSearch->set_active(i + nFluids, j + nFluids, true);
+			}
+		}
+
+		//performNeighborhoodSearchSort();
+		if (search)
 			m_neighborhoodSearch->find_neighbors();
+
+		// Boundary objects
+		for (unsigned int body = 0; body < numberOfBoundaryModels(); body++)
 			getBoundaryModel(body)->computeBoundaryVolume();
-		}
+
+		if (m_storeBoundaryVolume != nullptr)
+			m_storeBoundaryVolume();
 	}
 
 	// Activate only fluids 
@@ -625,6 +854,9 @@ void Simulation::updateBoundaryVolume()
 		for (unsigned int j = 0; j < numberOfFluidModels(); j++)
 			m_neighborhoodSearch->set_active(i, j, true);
 		for (unsigned int j = numberOfFluidModels(); j < m_neighborhoodSearch->point_sets().size(); j++)
-			m_neighborhoodSearch->set_active(i, j, true);
+		{
+			if (!m_bodyLocalNeighborhoodSearch.isBodyLocal(j))
+				m_neighborhoodSearch->set_active(i, j, true);
+		}
 	}
 }
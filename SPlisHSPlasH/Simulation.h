@@ -7,7 +7,9 @@
 #include "ParameterObject.h"
 #include "NeighborhoodSearch.h"
 #include "BoundaryModel.h"
+#include "BodyLocalNeighborhoodSearch.h"
 #include "AnimationFieldSystem.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 
 
 /** Loop over the fluid neighbors of all fluid phases. 
@@ -56,7 +58,12 @@ namespace SPH
 	enum class SimulationMethods { WCSPH = 0, PCISPH, PBF, IISPH, DFSPH, PF, NumSimulationMethods };
 
 	/** \brief Class to manage the current simulation time and the time step size. 
-	* This class is a singleton.
+	* The current simulation is stored per thread, i.e., several simulations 
+	* can run concurrently in one process if each of them is driven by its own 
+	* thread (and OpenMP thread team). The worker threads of a team have no current 
+	* simulation: getCurrent() returns nullptr inside a parallel region instead of 
+	* creating a new simulation. Code which runs on the worker threads (e.g. the 
+	* diagonal element functions of the preconditioners) gets the simulation from its caller.
 	*/
 	class Simulation : public GenParam::ParameterObject
 	{
@@ -68,6 +75,7 @@ namespace SPH
 		static int CFL_FACTOR;
 		static int CFL_MAX_TIMESTEPSIZE;
 		static int ENABLE_Z_SORT;
+		static int FUSED_NON_PRESSURE_FORCES;
 
 		static int KERNEL_METHOD;
 		static int GRAD_KERNEL_METHOD;
@@ -105,6 +113,7 @@ namespace SPH
 		std::vector<FluidModel*> m_fluidModels;
 		std::vector<BoundaryModel*> m_boundaryModels;
 		NeighborhoodSearch *m_neighborhoodSearch;
+		BodyLocalNeighborhoodSearch m_bodyLocalNeighborhoodSearch;
 		AnimationFieldSystem *m_animationFieldSystem;
 		int m_cflMethod;
 		Real m_cflFactor;
@@ -114,6 +123,9 @@ namespace SPH
 		Real m_W_zero;
 		Real(*m_kernelFct)(const Vector3r &);
 		Vector3r(*m_gradKernelFct)(const Vector3r &r);
+		Real(*m_cohesionKernelFct)(const Vector3r &);
+		Real(*m_adhesionKernelFct)(const Vector3r &);
+		unsigned int m_kernelContext;
 		SimulationMethods m_simulationMethod;
 		TimeStep *m_timeStep;
 		Vector3r m_gravitation;
@@ -121,12 +133,20 @@ namespace SPH
 		Real m_supportRadius;
 		bool m_sim2D;
 		bool m_enableZSort;
+		bool m_fusedNonPressureForces;
 		std::function<void()> m_simulationMethodChanged;		
+		/** Callbacks to load/store the boundary volumes from/to a cache */
+		std::function<bool()> m_loadBoundaryVolume;
+		std::function<void()> m_storeBoundaryVolume;
 
 		virtual void initParameters();
+		/** Set the kernel function pointers for the chosen kernels of the kernel context. */
+		template<unsigned int context>
+		void setKernelFunctions();
+		void updateKernelFunctions();
 		
 	private:
-		static Simulation *current;
+		static thread_local Simulation *current;
 
 	public:
 		Simulation ();
@@ -161,11 +181,22 @@ namespace SPH
 		FORCE_INLINE Real W_zero() const { return m_W_zero; }
 		FORCE_INLINE Real W(const Vector3r &r) const { return m_kernelFct(r); }
 		FORCE_INLINE Vector3r gradW(const Vector3r &r) { return m_gradKernelFct(r); }
+		/** Cohesion kernel of Akinci et al. \cite Akinci:2013 */
+		FORCE_INLINE Real cohesionW(const Vector3r &r) const { return m_cohesionKernelFct(r); }
+		/** Adhesion kernel of Akinci et al. \cite Akinci:2013 */
+		FORCE_INLINE Real adhesionW(const Vector3r &r) const { return m_adhesionKernelFct(r); }
+		/** Return the kernel context (see NUM_KERNEL_CONTEXTS). */
+		unsigned int getKernelContext() const { return m_kernelContext; }
 
 		int getSimulationMethod() const { return static_cast<int>(m_simulationMethod); }
 		void setSimulationMethod(const int val);
 
 		void setSimulationMethodChangedCallback(std::function<void()> const& callBackFct);
+		/** Set the callbacks which are used by updateBoundaryVolume() to load the volumes
+		* of the boundary particles from a cache and to store them after they were computed.
+		* The load function returns false if no cached volumes are available.
+		*/
+		void setBoundaryVolumeCacheCallbacks(std::function<bool()> const& loadFct, std::function<void()> const& storeFct);
 
 		TimeStep *getTimeStep() { return m_timeStep; }
 
@@ -184,18 +215,32 @@ namespace SPH
 		*/
 		void updateTimeStepSizeCFL(const Real minTimeStepSize);
 
-		/** Perform the neighborhood search for all fluid particles.
+		/** Perform the neighborhood search for all fluid particles. The neighbors
+		* in body-local boundary models are found by the body-local neighborhood search.
 		*/
 		virtual void performNeighborhoodSearch();
 		void performNeighborhoodSearchSort();
 
 		void computeNonPressureForces();
 
+		/** Collect the allocated memory of the fluid models, the non-pressure 
+		* force methods, the simulation method, the boundary models and the 
+		* neighbor lists. 
+		*/
+		void getMemoryUsage(std::vector<MemoryUsageEntry> &entries);
+		/** Estimate the memory of the neighbor lists of the fluid particles in bytes. */
+		size_t getNeighborhoodSearchMemoryUsage() const;
+		/** Print the memory usage of all components, the memory per fluid particle 
+		* and a projection for larger scenes to the log.
+		*/
+		void printMemoryUsage();
+
 		void animateParticles();
 		void emitParticles();
 		virtual void emittedParticles(FluidModel *model, const unsigned int startIndex);
 
 		NeighborhoodSearch* getNeighborhoodSearch() { return m_neighborhoodSearch; }
+		BodyLocalNeighborhoodSearch &getBodyLocalNeighborhoodSearch() { return m_bodyLocalNeighborhoodSearch; }
 
 		FORCE_INLINE unsigned int numberOfPointSets() const
 		{
@@ -204,21 +249,29 @@ namespace SPH
 
 		FORCE_INLINE unsigned int numberOfNeighbors(const unsigned int pointSetIndex, const unsigned int index) const
 		{
+			if (m_bodyLocalNeighborhoodSearch.isBodyLocal(pointSetIndex))
+				return m_bodyLocalNeighborhoodSearch.numberOfNeighbors(0, pointSetIndex, index);
 			return static_cast<unsigned int>(m_neighborhoodSearch->point_set(0).n_neighbors(pointSetIndex, index));
 		}
 
 		FORCE_INLINE unsigned int numberOfNeighbors(const unsigned int pointSetIndex, const unsigned int neighborPointSetIndex, const unsigned int index) const
 		{
+			if (m_bodyLocalNeighborhoodSearch.isBodyLocal(neighborPointSetIndex))
+				return m_bodyLocalNeighborhoodSearch.numberOfNeighbors(pointSetIndex, neighborPointSetIndex, index);
 			return static_cast<unsigned int>(m_neighborhoodSearch->point_set(pointSetIndex).n_neighbors(neighborPointSetIndex, index));
 		}
 
 		FORCE_INLINE unsigned int getNeighbor(const unsigned int pointSetIndex, const unsigned int index, const unsigned int k) const
 		{
+			if (m_bodyLocalNeighborhoodSearch.isBodyLocal(pointSetIndex))
+				return m_bodyLocalNeighborhoodSearch.getNeighbor(0, pointSetIndex, index, k);
 			return m_neighborhoodSearch->point_set(0).neighbor(pointSetIndex, index, k);
 		}
 
 		FORCE_INLINE unsigned int getNeighbor(const unsigned int pointSetIndex, const unsigned int neighborPointSetIndex, const unsigned int index, const unsigned int k) const
 		{
+			if (m_bodyLocalNeighborhoodSearch.isBodyLocal(neighborPointSetIndex))
+				return m_bodyLocalNeighborhoodSearch.getNeighbor(pointSetIndex, neighborPointSetIndex, index, k);
 			return m_neighborhoodSearch->point_set(pointSetIndex).neighbor(neighborPointSetIndex, index, k);
 		}
 	};
@@ -0,0 +1,120 @@
+#include "SurfaceClassification.h"
+#include "Simulation.h"
+#include "Utilities/Counting.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace SPH;
+
+SurfaceClassification::SurfaceClassification(FluidModel *model) :
+	m_model(model),
+	m_threshold(static_cast<Real>(0.9)),
+	m_valid(false),
+	m_numRings(0)
+{
+}
+
+void SurfaceClassification::setThreshold(const Real val)
+{
+	if (val != m_threshold)
+	{
+		m_threshold = val;
+		m_valid = false;
+	}
+}
+
+void SurfaceClassification::update(const unsigned int numRings)
+{
+	if (m_valid && (m_numRings >= numRings))
+		return;
+
+	Simulation *sim = Simulation::getCurrent();
+	const unsigned int numParticles = m_model->numActiveParticles();
+	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
+	const unsigned int nPointSets = sim->numberOfPointSets();
+
+	const Real diam = static_cast<Real>(2.0)*sim->getParticleRadius();
+	const unsigned int fullNeighborhood = latticeNeighbors(sim->getSupportRadius(), diam, sim->is2DSimulation());
+	const unsigned int minNeighbors = static_cast<unsigned int>(m_threshold * static_cast<Real>(fullNeighborhood));
+
+	m_ring.resize(numParticles);
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			unsigned int n = 0;
+			for (unsigned int pid = 0; pid < nPointSets; pid++)
+				n += sim->numberOfNeighbors(fluidModelIndex, pid, i);
+			m_ring[i] = (n < minNeighbors) ? 0 : NO_RING;
+		}
+	}
+
+	m_band.clear();
+	for (unsigned int i = 0; i < numParticles; i++)
+	{
+		if (m_ring[i] == 0)
+			m_band.push_back(i);
+	}
+	m_ringEnd.resize(numRings + 1);
+	m_ringEnd[0] = static_cast<unsigned int>(m_band.size());
+
+	// Add the neighbors of the particles in the previous ring. The rings are
+	// small compared to the fluid, so this is done serially.
+	unsigned int ringStart = 0;
+	for (unsigned int r = 1; r <= numRings; r++)
+	{
+		const unsigned int ringEnd = static_cast<unsigned int>(m_band.size());
+		for (unsigned int k = ringStart; k < ringEnd; k++)
+		{
+			const unsigned int i = m_band[k];
+			for (unsigned int j = 0; j < sim->numberOfNeighbors(fluidModelIndex, fluidModelIndex, i); j++)
+			{
+				const unsigned int neighborIndex = sim->getNeighbor(fluidModelIndex, fluidModelIndex, i, j);
+				if (m_ring[neighborIndex] == NO_RING)
+				{
+					m_ring[neighborIndex] = static_cast<unsigned char>(r);
+					m_band.push_back(neighborIndex);
+				}
+			}
+		}
+		std::sort(m_band.begin() + ringEnd, m_band.end());
+		ringStart = ringEnd;
+		m_ringEnd[r] = static_cast<unsigned int>(m_band.size());
+	}
+
+	m_numRings = numRings;
+	m_valid = true;
+
+	if (numParticles > 0)
+		INCREASE_COUNTER("Surface particles (%)", static_cast<Real>(100.0) * static_cast<Real>(m_ringEnd[0]) / static_cast<Real>(numParticles));
+}
+
+unsigned int SurfaceClassification::latticeNeighbors(const Real supportRadius, const Real spacing, const bool is2D)
+{
+	// The lattice points at a distance of exactly the support radius (e.g. at
+	// two diameters for the default support radius) are found or not depending
+	// on rounding. They are excluded, so that the count is a lower bound of the
+	// neighbors of an interior particle.
+	const Real r = supportRadius / spacing * static_cast<Real>(1.0 - 1.0e-4);
+	const int n = static_cast<int>(std::ceil(r));
+	const int nz = is2D ? 0 : n;
+	unsigned int count = 0;
+	for (int i = -n; i <= n; i++)
+		for (int j = -n; j <= n; j++)
+			for (int k = -nz; k <= nz; k++)
+			{
+				const int d2 = i*i + j*j + k*k;
+				if ((d2 > 0) && (static_cast<Real>(d2) < r*r))
+					count++;
+			}
+	return count;
+}
+
+size_t SurfaceClassification::getMemoryUsage() const
+{
+	return vectorMemory(m_ring) +
+		vectorMemory(m_band) +
+		vectorMemory(m_ringEnd);
+}
@@ -0,0 +1,78 @@
+#ifndef __SurfaceClassification_h__
+#define __SurfaceClassification_h__
+
+#include "Common.h"
+#include <vector>
+
+namespace SPH
+{
+	class FluidModel;
+
+	/** \brief Classification of the particles of a fluid model at the free surface.
+	*
+	* A particle is a surface particle if it has less neighbors than
+	* threshold * (number of neighbors of a particle with a complete neighborhood).
+	* The complete neighborhood is the number of neighbors of a particle in the
+	* interior of a lattice with a spacing of one particle diameter.
+	* All point sets are counted, so fluid particles at a boundary are not classified
+	* as surface particles. The surface band consists of the surface particles (ring 0)
+	* and the neighbors of the previous ring in the same phase (rings 1, 2, ...).
+	*
+	* The band particles are stored ring by ring in a compact list. Within a ring
+	* the list is sorted by index. So the particles up to ring r are the first
+	* numBandParticles(r) entries of the list.
+	*
+	* The classification depends only on the neighborhoods. It is computed once
+	* after each neighborhood search, when it is requested first, and then shared
+	* by all methods of the fluid model.
+	*/
+	class SurfaceClassification
+	{
+	public:
+		static const unsigned char NO_RING = 255;
+
+	protected:
+		FluidModel *m_model;
+		Real m_threshold;
+		bool m_valid;
+		unsigned int m_numRings;
+		/** ring of each particle (NO_RING if the particle is not in the band) */
+		std::vector<unsigned char> m_ring;
+		std::vector<unsigned int> m_band;
+		/** m_ringEnd[r] is the number of particles in the rings 0,...,r */
+		std::vector<unsigned int> m_ringEnd;
+
+	public:
+		SurfaceClassification(FluidModel *model);
+
+		/** Mark the classification as outdated (e.g. after a neighborhood search). */
+		void invalidate() { m_valid = false; }
+
+		Real getThreshold() const { return m_threshold; }
+		void setThreshold(const Real val);
+
+		/** Classify the particles and determine the band up to the given ring if the
+		* current classification is outdated or has less rings.
+		*/
+		void update(const unsigned int numRings);
+
+		/** Return the number of neighbors of a particle in the interior of a lattice
+		* with the given spacing (without the particle itself). Points at a distance
+		* of exactly the support radius are not counted.
+		*/
+		static unsigned int latticeNeighbors(const Real supportRadius, const Real spacing, const bool is2D);
+
+		FORCE_INLINE unsigned char getRing(const unsigned int i) const { return m_ring[i]; }
+		FORCE_INLINE bool isSurfaceParticle(const unsigned int i) const { return m_ring[i] == 0; }
+
+		/** Return the number of particles in the rings 0,...,ring. */
+		FORCE_INLINE unsigned int numBandParticles(const unsigned int ring) const { return m_ringEnd[ring]; }
+		FORCE_INLINE unsigned int getBandParticle(const unsigned int k) const { return m_band[k]; }
+		const std::vector<unsigned int> &getBandParticles() const { return m_band; }
+
+		/** Return the allocated memory in bytes. */
+		size_t getMemoryUsage() const;
+	};
+}
+
+#endif
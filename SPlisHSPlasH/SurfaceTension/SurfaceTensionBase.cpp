@@ -4,11 +4,15 @@ using namespace SPH;
 using namespace GenParam;
 
 int SurfaceTensionBase::SURFACE_TENSION_COEFFICIENT = -1;
+int SurfaceTensionBase::SURFACE_BAND_ONLY = -1;
+int SurfaceTensionBase::SURFACE_THRESHOLD = -1;
 
 SurfaceTensionBase::SurfaceTensionBase(FluidModel *model) :
 	NonPressureForceBase(model)
 {
 	m_surfaceTension = 0.05;
+	m_surfaceBandOnly = false;
+	m_surfaceThreshold = static_cast<Real>(0.9);
 }
 
 SurfaceTensionBase::~SurfaceTensionBase(void)
@@ -24,6 +28,27 @@ void SurfaceTensionBase::initParameters()
 	setDescription(SURFACE_TENSION_COEFFICIENT, "Coefficient for the surface tension computation");
 	RealParameter* rparam = static_cast<RealParameter*>(getParameter(SURFACE_TENSION_COEFFICIENT));
 	rparam->setMinValue(0.0);
+
+	SURFACE_BAND_ONLY = createBoolParameter("surfaceBandOnly", "Surface band only", &m_surfaceBandOnly);
+	setGroup(SURFACE_BAND_ONLY, "Surface tension");
+	setDescription(SURFACE_BAND_ONLY, "Compute the surface tension only for the particles near the free surface.");
+
+	SURFACE_THRESHOLD = createNumericParameter("surfaceThreshold", "Surface threshold", &m_surfaceThreshold);
+	setGroup(SURFACE_THRESHOLD, "Surface tension");
+	setDescription(SURFACE_THRESHOLD, "A particle is a surface particle if it has less neighbors than this fraction of a complete neighborhood.");
+	rparam = static_cast<RealParameter*>(getParameter(SURFACE_THRESHOLD));
+	rparam->setMinValue(0.0);
+	rparam->setMaxValue(1.0);
+}
+
+SurfaceClassification *SurfaceTensionBase::getSurfaceBand(const unsigned int numRings)
+{
+	if (!m_surfaceBandOnly)
+		return nullptr;
+	SurfaceClassification &sc = m_model->getSurfaceClassification();
+	sc.setThreshold(m_surfaceThreshold);
+	sc.update(numRings);
+	return &sc;
 }
 
 
@@ -4,23 +4,41 @@
 #include "SPlisHSPlasH/Common.h"
 #include "SPlisHSPlasH/FluidModel.h"
 #include "SPlisHSPlasH/NonPressureForceBase.h"
+#include "SPlisHSPlasH/SurfaceClassification.h"
 
 namespace SPH
 {
 	/** \brief Base class for all surface tension methods.
+	*
+	* Only particles near the free surface get significant surface tension forces.
+	* If surfaceBandOnly is set, the forces are only computed for the particles
+	* in the rings 0 and 1 of the surface band of the fluid model (see
+	* SurfaceClassification). The quantities which the forces need at the neighbors
+	* are computed for the required number of additional rings.
 	*/
 	class SurfaceTensionBase : public NonPressureForceBase
 	{
 	protected:
 		Real m_surfaceTension;
+		bool m_surfaceBandOnly;
+		Real m_surfaceThreshold;
 
 		virtual void initParameters();
 
+		/** Return the surface classification of the fluid model which is updated up to
+		* the given ring or nullptr if the computation is not restricted to the surface band.
+		*/
+		SurfaceClassification *getSurfaceBand(const unsigned int numRings);
+
 	public:
 		static int SURFACE_TENSION_COEFFICIENT;
+		static int SURFACE_BAND_ONLY;
+		static int SURFACE_THRESHOLD;
 
 		SurfaceTensionBase(FluidModel *model);
 		virtual ~SurfaceTensionBase(void);
+
+		bool getSurfaceBandOnly() const { return m_surfaceBandOnly; }
 	};
 }
 
@@ -1,4 +1,5 @@
 #include "SurfaceTension_Akinci2013.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include <iostream>
 #include "../Simulation.h"
 
@@ -23,17 +24,21 @@ void SurfaceTension_Akinci2013::computeNormals()
 {
 	Simulation *sim = Simulation::getCurrent();
 	const Real supportRadius = sim->getSupportRadius();
-	const unsigned int numParticles = m_model->numActiveParticles();
 	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
 	const unsigned int nFluids = sim->numberOfFluidModels();
 	FluidModel *model = m_model;
 
+	// The forces in the rings 0 and 1 need the normals of their neighbors.
+	SurfaceClassification *band = getSurfaceBand(2);
+	const unsigned int numParticles = band ? band->numBandParticles(2) : m_model->numActiveParticles();
+
 	// Compute normals
 	#pragma omp parallel default(shared)
 	{
 		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
+		for (int k = 0; k < (int)numParticles; k++)
 		{
+			const unsigned int i = band ? band->getBandParticle(k) : k;
 			const Vector3r &xi = m_model->getPosition(i);
 			Vector3r &ni = getNormal(i);
 			ni.setZero();
@@ -51,71 +56,29 @@ void SurfaceTension_Akinci2013::computeNormals()
 
 }
 
-void SurfaceTension_Akinci2013::step()
+SurfaceTension_Akinci2013::FusedTerm::FusedTerm(SurfaceTension_Akinci2013 *st)
 {
-	Simulation *sim = Simulation::getCurrent();
-	const Real density0 = m_model->getDensity0();
-	const Real supportRadius = sim->getSupportRadius();
-	const unsigned int numParticles = m_model->numActiveParticles();
-	const Real k = m_surfaceTension;
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
-	const unsigned int nFluids = sim->numberOfFluidModels();
-	FluidModel *model = m_model;
-
-	computeNormals();
-
-	// Compute forces
-	#pragma omp parallel default(shared)
-	{
-		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
-		{
-			const Vector3r &xi = m_model->getPosition(i);
-			const Vector3r &ni = getNormal(i);
-			const Real &rhoi = m_model->getDensity(i);
-			Vector3r &ai = m_model->getAcceleration(i);
+	m_sim = Simulation::getCurrent();
+	m_st = st;
+	m_model = st->getModel();
+	m_fluidModelIndex = m_model->getPointSetIndex();
+	m_k = st->m_surfaceTension;
+	m_density0 = m_model->getDensity0();
+	m_supportRadius = m_sim->getSupportRadius();
+}
 
-			//////////////////////////////////////////////////////////////////////////
-			// Fluid
-			//////////////////////////////////////////////////////////////////////////
-			forall_fluid_neighbors_in_same_phase(
-				const Real &rhoj = m_model->getDensity(neighborIndex);
-				const Real K_ij = static_cast<Real>(2.0)*density0 / (rhoi + rhoj);
-
-				Vector3r accel;
-				accel.setZero();
-
-				// Cohesion force
-				Vector3r xixj = (xi - xj);
-				const Real length2 = xixj.squaredNorm();
-				if (length2 > 1.0e-9)
-				{
-					xixj = (static_cast<Real>(1.0) / sqrt(length2)) * xixj;
-					accel -= k * m_model->getMass(neighborIndex) * xixj * CohesionKernel::W(xi - xj);
-				}
-
-				// Curvature
-				const Vector3r &nj = getNormal(neighborIndex);
-				accel -= k * supportRadius* (ni - nj);
-
-				ai += K_ij * accel;
-			)
+void SurfaceTension_Akinci2013::FusedTerm::prepare()
+{
+	m_st->computeNormals();
+}
 
-			//////////////////////////////////////////////////////////////////////////
-			// Boundary
-			//////////////////////////////////////////////////////////////////////////
-			forall_boundary_neighbors(
-					// adhesion force					
-					Vector3r xixj = (xi - xj);
-					const Real length2 = xixj.squaredNorm();
-					if (length2 > 1.0e-9)
-					{
-						xixj = ((Real) 1.0 / sqrt(length2)) * xixj;
-						ai -= k * density0 * bm_neighbor->getVolume(neighborIndex) * xixj * AdhesionKernel::W(xi - xj);
-					}
-			)
-		}
-	}
+void SurfaceTension_Akinci2013::step()
+{
+	SurfaceClassification *band = getSurfaceBand(2);
+	if (band)
+		NonPressureForceFusion::computeForces(m_model, FusedTerm(this), &band->getBandParticles(), band->numBandParticles(1));
+	else
+		NonPressureForceFusion::computeForces(m_model, FusedTerm(this));
 }
 
 
@@ -134,3 +97,7 @@ void SurfaceTension_Akinci2013::performNeighborhoodSearchSort()
 	d.sort_field(&m_normals[0]);
 }
 
+size_t SurfaceTension_Akinci2013::getMemoryUsage() const
+{
+	return vectorMemory(m_normals);
+}
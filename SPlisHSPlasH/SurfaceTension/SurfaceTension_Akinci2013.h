@@ -4,6 +4,7 @@
 #include "SPlisHSPlasH/Common.h"
 #include "SPlisHSPlasH/FluidModel.h"
 #include "SurfaceTensionBase.h"
+#include "SPlisHSPlasH/NonPressureForceFusion.h"
 
 namespace SPH
 {
@@ -16,9 +17,85 @@ namespace SPH
 		std::vector<Vector3r> m_normals;
 
 	public:
+		/** Term of the method for the fused neighbor pass (see NonPressureForceFusion).
+		* The normals are computed in a separate pass by prepare().
+		*/
+		struct FusedTerm : public NoFusedTerm
+		{
+			static const bool usesFluidNeighbors = true;
+			static const bool usesBoundaryNeighbors = true;
+
+			Simulation *m_sim;
+			SurfaceTension_Akinci2013 *m_st;
+			FluidModel *m_model;
+			unsigned int m_fluidModelIndex;
+			Real m_k;
+			Real m_density0;
+			Real m_supportRadius;
+			Vector3r m_ni;
+			Real m_rhoi;
+			Vector3r m_ai;
+
+			FusedTerm(SurfaceTension_Akinci2013 *st);
+			void prepare();
+
+			FORCE_INLINE void beginParticle(const unsigned int i, const Vector3r &xi)
+			{
+				m_ni = m_st->getNormal(i);
+				m_rhoi = m_model->getDensity(i);
+				m_ai.setZero();
+			}
+
+			FORCE_INLINE void fluidNeighbor(const unsigned int pid, FluidModel *fm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj)
+			{
+				// only neighbors in the same phase
+				if (pid != m_fluidModelIndex)
+					return;
+				const Real &rhoj = m_model->getDensity(neighborIndex);
+				const Real K_ij = static_cast<Real>(2.0)*m_density0 / (m_rhoi + rhoj);
+
+				Vector3r accel;
+				accel.setZero();
+
+				// Cohesion force
+				Vector3r xixj = (xi - xj);
+				const Real length2 = xixj.squaredNorm();
+				if (length2 > 1.0e-9)
+				{
+					xixj = (static_cast<Real>(1.0) / sqrt(length2)) * xixj;
+					accel -= m_k * m_model->getMass(neighborIndex) * xixj * m_sim->cohesionW(xi - xj);
+				}
+
+				// Curvature
+				const Vector3r &nj = m_st->getNormal(neighborIndex);
+				accel -= m_k * m_supportRadius* (m_ni - nj);
+
+				m_ai += K_ij * accel;
+			}
+
+			FORCE_INLINE void boundaryNeighbor(BoundaryModel *bm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj)
+			{
+				// adhesion force
+				Vector3r xixj = (xi - xj);
+				const Real length2 = xixj.squaredNorm();
+				if (length2 > 1.0e-9)
+				{
+					xixj = ((Real) 1.0 / sqrt(length2)) * xixj;
+					m_ai -= m_k * m_density0 * bm_neighbor->getVolume(neighborIndex) * xixj * m_sim->adhesionW(xi - xj);
+				}
+			}
+
+			FORCE_INLINE void endParticle(const unsigned int i, Vector3r &ai)
+			{
+				ai += m_ai;
+			}
+		};
+
 		SurfaceTension_Akinci2013(FluidModel *model);
 		virtual ~SurfaceTension_Akinci2013(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
@@ -13,53 +13,26 @@ SurfaceTension_Becker2007::~SurfaceTension_Becker2007(void)
 {
 }
 
-void SurfaceTension_Becker2007::step()
+SurfaceTension_Becker2007::FusedTerm::FusedTerm(SurfaceTension_Becker2007 *st)
 {
-	Simulation *sim = Simulation::getCurrent();
-	const unsigned int numParticles = m_model->numActiveParticles();
-	const Real k = m_surfaceTension;
-	const Real radius = sim->getValue<Real>(Simulation::PARTICLE_RADIUS);
+	m_sim = Simulation::getCurrent();
+	m_model = st->getModel();
+	m_fluidModelIndex = m_model->getPointSetIndex();
+	m_k = st->m_surfaceTension;
+	m_density0 = m_model->getDensity0();
+	const Real radius = m_sim->getValue<Real>(Simulation::PARTICLE_RADIUS);
 	const Real diameter = static_cast<Real>(2.0) * radius;
-	const Real diameter2 = diameter*diameter;
-	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
-	const unsigned int nFluids = sim->numberOfFluidModels();
-	FluidModel *model = m_model;
-	const Real density0 = model->getDensity0();
-
-	// Compute forces
-	#pragma omp parallel default(shared)
-	{
-		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
-		{
-			const Vector3r &xi = m_model->getPosition(i);
-			Vector3r &ai = m_model->getAcceleration(i);
-
-			//////////////////////////////////////////////////////////////////////////
-			// Fluid
-			//////////////////////////////////////////////////////////////////////////
-			forall_fluid_neighbors_in_same_phase(
-				const Vector3r xixj = xi - xj;
-				const Real r2 = xixj.dot(xixj);
-				if (r2 > diameter2)
-					ai -= k / m_model->getMass(i) * m_model->getMass(neighborIndex) * (xi - xj) * sim->W(xi - xj);
-				else
-					ai -= k / m_model->getMass(i) * m_model->getMass(neighborIndex) * (xi - xj) * sim->W(Vector3r(diameter, 0.0, 0.0));
-			)
+	m_diameter2 = diameter*diameter;
+	m_W_diameter = m_sim->W(Vector3r(diameter, 0.0, 0.0));
+}
 
-			//////////////////////////////////////////////////////////////////////////
-			// Boundary
-			//////////////////////////////////////////////////////////////////////////
-			forall_boundary_neighbors(
-				const Vector3r xixj = xi - xj;
-				const Real r2 = xixj.dot(xixj);
-				if (r2 > diameter2)
-					ai -= k / m_model->getMass(i) * density0 * bm_neighbor->getVolume(neighborIndex) * (xi - xj) * sim->W(xi - xj);
-				else
-					ai -= k / m_model->getMass(i) * density0 * bm_neighbor->getVolume(neighborIndex) * (xi - xj) * sim->W(Vector3r(diameter, 0.0, 0.0));
-			)
-		}
-	}
+void SurfaceTension_Becker2007::step()
+{
+	SurfaceClassification *band = getSurfaceBand(1);
+	if (band)
+		NonPressureForceFusion::computeForces(m_model, FusedTerm(this), &band->getBandParticles(), band->numBandParticles(1));
+	else
+		NonPressureForceFusion::computeForces(m_model, FusedTerm(this));
 }
 
 
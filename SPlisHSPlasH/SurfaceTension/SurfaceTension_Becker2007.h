@@ -4,6 +4,7 @@
 #include "SPlisHSPlasH/Common.h"
 #include "SPlisHSPlasH/FluidModel.h"
 #include "SurfaceTensionBase.h"
+#include "SPlisHSPlasH/NonPressureForceFusion.h"
 
 namespace SPH
 {
@@ -13,6 +14,59 @@ namespace SPH
 	class SurfaceTension_Becker2007 : public SurfaceTensionBase
 	{
 	public:
+		/** Term of the method for the fused neighbor pass (see NonPressureForceFusion). */
+		struct FusedTerm : public NoFusedTerm
+		{
+			static const bool usesFluidNeighbors = true;
+			static const bool usesBoundaryNeighbors = true;
+
+			Simulation *m_sim;
+			FluidModel *m_model;
+			unsigned int m_fluidModelIndex;
+			Real m_k;
+			Real m_density0;
+			Real m_diameter2;
+			Real m_W_diameter;
+			Real m_k_mi;
+			Vector3r m_ai;
+
+			FusedTerm(SurfaceTension_Becker2007 *st);
+
+			FORCE_INLINE void beginParticle(const unsigned int i, const Vector3r &xi)
+			{
+				m_k_mi = m_k / m_model->getMass(i);
+				m_ai.setZero();
+			}
+
+			FORCE_INLINE void fluidNeighbor(const unsigned int pid, FluidModel *fm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj)
+			{
+				// only neighbors in the same phase
+				if (pid != m_fluidModelIndex)
+					return;
+				const Vector3r xixj = xi - xj;
+				const Real r2 = xixj.dot(xixj);
+				if (r2 > m_diameter2)
+					m_ai -= m_k_mi * m_model->getMass(neighborIndex) * xixj * m_sim->W(xixj);
+				else
+					m_ai -= m_k_mi * m_model->getMass(neighborIndex) * xixj * m_W_diameter;
+			}
+
+			FORCE_INLINE void boundaryNeighbor(BoundaryModel *bm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj)
+			{
+				const Vector3r xixj = xi - xj;
+				const Real r2 = xixj.dot(xixj);
+				if (r2 > m_diameter2)
+					m_ai -= m_k_mi * m_density0 * bm_neighbor->getVolume(neighborIndex) * xixj * m_sim->W(xixj);
+				else
+					m_ai -= m_k_mi * m_density0 * bm_neighbor->getVolume(neighborIndex) * xixj * m_W_diameter;
+			}
+
+			FORCE_INLINE void endParticle(const unsigned int i, Vector3r &ai)
+			{
+				ai += m_ai;
+			}
+		};
+
 		SurfaceTension_Becker2007(FluidModel *model);
 		virtual ~SurfaceTension_Becker2007(void);
 
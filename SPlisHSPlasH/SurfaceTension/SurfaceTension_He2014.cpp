@@ -1,4 +1,5 @@
 #include "SurfaceTension_He2014.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include <iostream>
 #include "../Simulation.h"
 
@@ -28,18 +29,25 @@ void SurfaceTension_He2014::step()
 {
 	Simulation *sim = Simulation::getCurrent();
 	const unsigned int numParticles = m_model->numActiveParticles();
-	const Real k = m_surfaceTension;
 	const Real density0 = m_model->getDensity0();
 	const unsigned int fluidModelIndex = m_model->getPointSetIndex();
 	const unsigned int nFluids = sim->numberOfFluidModels();
 	FluidModel *model = m_model;
 
+	// The forces in the rings 0 and 1 need the gradients of their neighbors
+	// and the gradients need the color field of the neighbors.
+	SurfaceClassification *band = getSurfaceBand(3);
+	const unsigned int numColor = band ? band->numBandParticles(3) : numParticles;
+	const unsigned int numGradient = band ? band->numBandParticles(2) : numParticles;
+	const unsigned int numForces = band ? band->numBandParticles(1) : numParticles;
+
 	// Compute color field
 	#pragma omp parallel default(shared)
 	{
 		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
+		for (int k = 0; k < (int)numColor; k++)
 		{
+			const unsigned int i = band ? band->getBandParticle(k) : k;
 			const Vector3r &xi = m_model->getPosition(i);
 			Real &ci = getColor(i);
 			ci = m_model->getMass(i) / m_model->getDensity(i) * sim->W_zero();
@@ -65,8 +73,9 @@ void SurfaceTension_He2014::step()
 	#pragma omp parallel default(shared)
 	{
 		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
+		for (int k = 0; k < (int)numGradient; k++)
 		{
+			const unsigned int i = band ? band->getBandParticle(k) : k;
 			const Vector3r &xi = m_model->getPosition(i);
 			Vector3r gradC_i;
 			gradC_i.setZero();
@@ -89,13 +98,14 @@ void SurfaceTension_He2014::step()
 	#pragma omp parallel default(shared)
 	{
 		#pragma omp for schedule(static)  
-		for (int i = 0; i < (int)numParticles; i++)
+		for (int k = 0; k < (int)numForces; k++)
 		{
+			const unsigned int i = band ? band->getBandParticle(k) : k;
 			const Vector3r &xi = m_model->getPosition(i);
 			const Real &gradC2_i = getGradC2(i);
 			Vector3r &ai = m_model->getAcceleration(i);
 			const Real &density_i = m_model->getDensity(i);
-			const Real factor = static_cast<Real>(0.25)*k / density_i;
+			const Real factor = static_cast<Real>(0.25)*m_surfaceTension / density_i;
 
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
@@ -132,3 +142,9 @@ void SPH::SurfaceTension_He2014::performNeighborhoodSearchSort()
 	d.sort_field(&m_color[0]);
 	d.sort_field(&m_gradC2[0]);
 }
+
+size_t SurfaceTension_He2014::getMemoryUsage() const
+{
+	return vectorMemory(m_color) +
+		vectorMemory(m_gradC2);
+}
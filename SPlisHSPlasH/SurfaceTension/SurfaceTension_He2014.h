@@ -20,6 +20,8 @@ namespace SPH
 		SurfaceTension_He2014(FluidModel *model);
 		virtual ~SurfaceTension_He2014(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
@@ -1,8 +1,11 @@
 #include "TimeManager.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace SPH;
 
-TimeManager* TimeManager::current = 0;
+thread_local TimeManager* TimeManager::current = 0;
 
 TimeManager::TimeManager () 
 {
@@ -19,6 +22,11 @@ TimeManager* TimeManager::getCurrent ()
 {
 	if (current == 0)
 	{
+#ifdef _OPENMP
+		// a worker thread must not create a time manager of its own
+		if (omp_in_parallel())
+			return 0;
+#endif
 		current = new TimeManager ();
 	}
 	return current;
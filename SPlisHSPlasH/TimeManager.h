@@ -6,13 +6,14 @@
 namespace SPH
 {
 	/** \brief Class to manage the current simulation time and the time step size. 
-	* This class is a singleton.
+	* The current time manager is stored per thread. As for the simulation, 
+	* getCurrent() returns nullptr on the OpenMP worker threads (see Simulation).
 	*/
 	class TimeManager
 	{
 	private:
 		Real time;
-		static TimeManager *current;
+		static thread_local TimeManager *current;
 		Real h;
 
 	public:
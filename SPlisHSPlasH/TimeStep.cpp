@@ -56,14 +56,21 @@ void TimeStep::clearAccelerations(const unsigned int fluidModelIndex)
 	Simulation *sim = Simulation::getCurrent();
 	FluidModel *model = sim->getFluidModel(fluidModelIndex);
 	const unsigned int count = model->numActiveParticles();
-	const Vector3r grav(sim->getVecValue<Real>(Simulation::GRAVITATION));
-	for (unsigned int i=0; i < count; i++)
+	Vector3r grav(sim->getVecValue<Real>(Simulation::GRAVITATION));
+	if (sim->is2DSimulation())
+		grav[2] = 0.0;
+
+	#pragma omp parallel default(shared)
 	{
-		// Clear accelerations of dynamic particles
-		if (model->getMass(i) != 0.0)
+		#pragma omp for schedule(static)  
+		for (int i = 0; i < (int) count; i++)
 		{
-			Vector3r &a = model->getAcceleration(i);
-			a = grav;
+			// Clear accelerations of dynamic particles
+			if (model->getMass(i) != 0.0)
+			{
+				Vector3r &a = model->getAcceleration(i);
+				a = grav;
+			}
 		}
 	}
 }
@@ -81,10 +88,8 @@ void TimeStep::computeDensities(const unsigned int fluidModelIndex)
 		#pragma omp for schedule(static)  
 		for (int i = 0; i < (int) numParticles; i++)
 		{
-			Real &density = model->getDensity(i);
-
 			// Compute current density for particle i
-			density = model->getVolume(i) * sim->W_zero();
+			AccumReal density = model->getVolume(i) * sim->W_zero();
 			const Vector3r &xi = model->getPosition(i);
 
 			//////////////////////////////////////////////////////////////////////////
@@ -102,7 +107,7 @@ void TimeStep::computeDensities(const unsigned int fluidModelIndex)
 				density += bm_neighbor->getVolume(neighborIndex) * sim->W(xi - xj);
 			)
 
-			density *= density0;
+			model->getDensity(i) = static_cast<Real>(density * density0);
 		}
 	}
 }
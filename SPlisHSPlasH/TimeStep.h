@@ -32,6 +32,16 @@ namespace SPH
 		virtual void initParameters();
 
 	public:
+		/** Keep particle i in the xy-plane in a 2D simulation. This is done in the
+		* final integration loop of each method, so no extra pass is required.
+		* Emitters call it for the particles they emit or move.
+		*/
+		static FORCE_INLINE void projectTo2D(FluidModel *model, const unsigned int i)
+		{
+			model->getPosition(i)[2] = 0.0;
+			model->getVelocity(i)[2] = 0.0;
+		}
+
 		TimeStep();
 		virtual ~TimeStep(void);
 
@@ -42,6 +52,9 @@ namespace SPH
 		virtual void resize() = 0;
 
 		virtual void emittedParticles(FluidModel *model, const unsigned int startIndex) {};
+
+		/** Return the allocated memory of the data of the simulation method in bytes. */
+		virtual size_t getMemoryUsage() const { return 0; }
 	};
 }
 
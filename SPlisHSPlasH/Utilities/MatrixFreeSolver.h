@@ -5,7 +5,13 @@
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
-using SystemMatrixType = Eigen::SparseMatrix<Real>;
+/** Scalar type of the vectors and dot products of the matrix-free solvers
+* (double precision in a mixed-precision build, see AccumReal). */
+using SolverReal = AccumReal;
+using VectorXs = Eigen::Matrix<SolverReal, -1, 1>;
+using Vector3s = Eigen::Matrix<SolverReal, 3, 1>;
+using Matrix3s = Eigen::Matrix<SolverReal, 3, 3>;
+using SystemMatrixType = Eigen::SparseMatrix<SolverReal>;
 
 namespace SPH
 {
@@ -28,10 +34,10 @@ namespace SPH
 	{
 	public:
 		// Required typedefs, constants, and method:
-		typedef Real Scalar;
-		typedef Real RealScalar;
+		typedef SolverReal Scalar;
+		typedef SolverReal RealScalar;
 		typedef int StorageIndex;
-		typedef void(*MatrixVecProdFct) (const Real*, Real*, void *);
+		typedef void(*MatrixVecProdFct) (const SolverReal*, SolverReal*, void *);
 
 		enum
 		{
@@ -102,7 +108,7 @@ namespace SPH
 				{
 					Real res;
 					m_diagonalElementFct(i, res, m_userData);
-					m_invDiag[i] = static_cast<Real>(1.0) / res;
+					m_invDiag[i] = static_cast<SolverReal>(1.0) / res;
 				}
 			}
 			return *this; 
@@ -125,7 +131,7 @@ namespace SPH
 		/** diagonal matrix element callback */
 		DiagonalMatrixElementFct m_diagonalElementFct;
 		void *m_userData;
-		VectorXr m_invDiag;
+		VectorXs m_invDiag;
 	};
 
 	/** Matrix-free Jacobi preconditioner  */
@@ -169,9 +175,9 @@ namespace SPH
 				{
 					Vector3r res;
 					m_diagonalElementFct(i, res, m_userData);
-					m_invDiag[3*i] = static_cast<Real>(1.0) / res[0];
-					m_invDiag[3*i+1] = static_cast<Real>(1.0) / res[1];
-					m_invDiag[3*i+2] = static_cast<Real>(1.0) / res[2];
+					m_invDiag[3*i] = static_cast<SolverReal>(1.0) / res[0];
+					m_invDiag[3*i+1] = static_cast<SolverReal>(1.0) / res[1];
+					m_invDiag[3*i+2] = static_cast<SolverReal>(1.0) / res[2];
 				}
 			}
 			return *this;
@@ -194,7 +200,7 @@ namespace SPH
 		/** diagonal matrix element callback */
 		DiagonalMatrixElementFct m_diagonalElementFct;
 		void *m_userData;
-		VectorXr m_invDiag;
+		VectorXs m_invDiag;
 	};
 
 	/** Matrix-free 3x3 block Jacobi preconditioner  */
@@ -238,7 +244,7 @@ namespace SPH
 				{
 					Matrix3r res;
 					m_diagonalElementFct(i, res, m_userData);
-					m_invDiag[i] = res.inverse();
+					m_invDiag[i] = res.cast<SolverReal>().inverse();
 				}
 			}
 			return *this;
@@ -252,7 +258,7 @@ namespace SPH
 				#pragma omp for schedule(static) 
 				for (int i = 0; i < (int)m_dim; i++)
 				{
-					static_cast<VectorXr&>(x).block<3, 1>(3 * i, 0) = m_invDiag[i] * static_cast<const VectorXr&>(b).block<3, 1>(3 * i, 0);
+					static_cast<VectorXs&>(x).block<3, 1>(3 * i, 0) = m_invDiag[i] * static_cast<const VectorXs&>(b).block<3, 1>(3 * i, 0);
 				}
 			}
 		}
@@ -268,7 +274,7 @@ namespace SPH
 		/** diagonal matrix element callback */
 		DiagonalMatrixElementFct m_diagonalElementFct;
 		void *m_userData;
-		std::vector<Matrix3r> m_invDiag;
+		std::vector<Matrix3s> m_invDiag;
 	};
 }
 
@@ -292,8 +298,8 @@ namespace Eigen
 				// however, for iterative solvers, alpha is always equal to 1, so let's not bother about it.
 				assert(alpha == Scalar(1) && "scaling is not implemented");
 
-				const Real *vec = &rhs(0);
-				Real *res = &dst(0);
+				const SolverReal *vec = &rhs(0);
+				SolverReal *res = &dst(0);
 				MatrixReplacement& lhs_ = const_cast<MatrixReplacement&>(lhs);
 				lhs_.getMatrixVecProdFct()(vec, res, lhs_.getUserData());
 			}
@@ -0,0 +1,38 @@
+#ifndef __MemoryUsage_h__
+#define __MemoryUsage_h__
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace SPH
+{
+	/** \brief Memory used by a component of the simulation in bytes.
+	*/
+	struct MemoryUsageEntry
+	{
+		std::string name;
+		size_t bytes;
+		/** true if the memory grows with the number of fluid particles */
+		bool perParticle;
+	};
+
+	/** Return the allocated memory of a vector in bytes. */
+	template<typename T, typename Alloc>
+	size_t vectorMemory(const std::vector<T, Alloc> &v)
+	{
+		return v.capacity() * sizeof(T);
+	}
+
+	/** Return the allocated memory of a vector of vectors in bytes. */
+	template<typename T, typename Alloc1, typename Alloc2>
+	size_t vectorMemory(const std::vector<std::vector<T, Alloc1>, Alloc2> &v)
+	{
+		size_t bytes = v.capacity() * sizeof(std::vector<T, Alloc1>);
+		for (size_t i = 0; i < v.size(); i++)
+			bytes += vectorMemory(v[i]);
+		return bytes;
+	}
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include "Utilities/Logger.h"
 
 #define _USE_MATH_DEFINES
 #include "math.h"
@@ -16,6 +17,52 @@ using namespace SPH;
 
 PoissonDiskSampling::PoissonDiskSampling()
 {
+	m_useSeed = false;
+	m_seed = 0;
+}
+
+/** Sort the key-index pairs in parallel: each thread sorts a contiguous chunk,
+* then the chunks are merged pairwise. The pairs are unique, so the result
+* does not depend on the number of threads.
+*/
+template<typename T>
+static void parallelSort(std::vector<T> &v)
+{
+	#ifdef _OPENMP
+	const int numChunks = omp_get_max_threads();
+	#else
+	const int numChunks = 1;
+	#endif
+	const size_t n = v.size();
+	if ((numChunks == 1) || (n < 10000))
+	{
+		std::sort(v.begin(), v.end());
+		return;
+	}
+
+	std::vector<size_t> bounds(numChunks + 1);
+	for (int c = 0; c <= numChunks; c++)
+		bounds[c] = (n * c) / numChunks;
+
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)  
+		for (int c = 0; c < numChunks; c++)
+			std::sort(v.begin() + bounds[c], v.begin() + bounds[c + 1]);
+	}
+
+	for (int width = 1; width < numChunks; width *= 2)
+	{
+		#pragma omp parallel default(shared)
+		{
+			#pragma omp for schedule(static)  
+			for (int c = 0; c < numChunks; c += 2 * width)
+			{
+				if (c + width < numChunks)
+					std::inplace_merge(v.begin() + bounds[c], v.begin() + bounds[c + width], v.begin() + bounds[std::min(c + 2 * width, numChunks)]);
+			}
+		}
+	}
 }
 
 void PoissonDiskSampling::sampleMesh(const unsigned int numVertices, const Vector3r *vertices, const unsigned int numFaces, const unsigned int *faces,
@@ -28,10 +75,20 @@ void PoissonDiskSampling::sampleMesh(const unsigned int numVertices, const Vecto
 
 	m_cellSize = m_r / sqrt(static_cast<Real>(3.0));
 
+	samples.clear();
+
 	// Init sampling
 	m_maxArea = numeric_limits<Real>::min();
 	determineMinX(numVertices, vertices);
 
+	// the cell coordinates must fit into the cell keys
+	const Real maxExtent = (m_maxVec - m_minVec).maxCoeff();
+	if (maxExtent / m_cellSize + 4.0 >= (Real)(1u << CELL_KEY_BITS))
+	{
+		LOG_ERR << "Poisson disk sampling: the sampling radius is too small for the size of the mesh.";
+		return;
+	}
+
 	determineTriangleAreas(numVertices, vertices, numFaces, faces);
 
 	const Real circleArea = static_cast<Real>(M_PI) * minRadius * minRadius;
@@ -62,13 +119,16 @@ void PoissonDiskSampling::sampleMesh(const unsigned int numVertices, const Vecto
 	}
 
 	// Sort Initial points for CellID
-	quickSort(0, (int)m_initialInfoVec.size() - 1);
+	sortInitialPoints();
 
 	// PoissonSampling
 	parallelUniformSurfaceSampling(samples);
 
 	// release data
 	m_initialInfoVec.clear();
+	m_cellKeys.clear();
+	m_cellStart.clear();
+	m_cellSample.clear();
 	for (int i = 0; i < m_phaseGroups.size(); i++)
 	{
 		m_phaseGroups[i].clear();
@@ -119,50 +179,43 @@ void PoissonDiskSampling::generateInitialPointSet(const unsigned int numVertices
 {
 	m_totalArea = 0.0;
 	
-	// Drawing random barycentric coordinates
-	std::uniform_real_distribution<Real> distribution(0.0, 1.0);
-	
-	random_device r;
-	std::vector<std::default_random_engine> generators;
+	// The points are generated in blocks with a generator per block, so the
+	// point set only depends on the seed and not on the number of threads.
+	const unsigned int seed = m_useSeed ? m_seed : random_device()();
+	const unsigned int blockSize = 4096;
+	const unsigned int numPoints = (unsigned int)m_initialInfoVec.size();
+	const unsigned int numBlocks = (numPoints + blockSize - 1) / blockSize;
 
-	#ifdef _OPENMP
-	const int maxThreads = omp_get_max_threads();
-	#else
-	const int maxThreads = 1;
-	#endif
-
-    for (int i = 0; i < maxThreads; ++i) 
-        generators.emplace_back(default_random_engine(r()));
-	
 	#pragma omp parallel default(shared)
 	{	
 		// Generating the surface points
 		#pragma omp for schedule(static) 
-		for (int i = 0; i < (int)m_initialInfoVec.size(); i++)
+		for (int block = 0; block < (int)numBlocks; block++)
 		{
-			#ifdef _OPENMP
-			int tid = omp_get_thread_num();
-			#else
-			int tid = 0;
-			#endif
-			// Get the generator based on thread id
-			std::default_random_engine& generator = generators[tid];
-			
-			Real rn1 = sqrt(distribution(generator));
-			Real bc1 = static_cast<Real>(1.0) - rn1;
-			Real bc2 = distribution(generator)*rn1;
-			Real bc3 = static_cast<Real>(1.0) - bc1 - bc2;
-
-			// Triangle selection with probability proportional to area
-			const unsigned int randIndex = getAreaIndex(m_areas, m_totalArea, generator, distribution);
-
-			// Calculating point coordinates
-			const Vector3r &v1 = vertices[faces[3 * randIndex]];
-			const Vector3r &v2 = vertices[faces[3 * randIndex + 1]];
-			const Vector3r &v3 = vertices[faces[3 * randIndex + 2]];
-
-			m_initialInfoVec[i].pos = bc1*v1 + bc2*v2 + bc3*v3;
-			m_initialInfoVec[i].ID = randIndex;
+			std::seed_seq seq = { seed, (unsigned int)block };
+			std::default_random_engine generator(seq);
+			// Drawing random barycentric coordinates
+			std::uniform_real_distribution<Real> distribution(0.0, 1.0);
+
+			const unsigned int end = std::min((block + 1) * blockSize, numPoints);
+			for (unsigned int i = block * blockSize; i < end; i++)
+			{
+				Real rn1 = sqrt(distribution(generator));
+				Real bc1 = static_cast<Real>(1.0) - rn1;
+				Real bc2 = distribution(generator)*rn1;
+				Real bc3 = static_cast<Real>(1.0) - bc1 - bc2;
+
+				// Triangle selection with probability proportional to area
+				const unsigned int randIndex = getAreaIndex(m_areas, m_totalArea, generator, distribution);
+
+				// Calculating point coordinates
+				const Vector3r &v1 = vertices[faces[3 * randIndex]];
+				const Vector3r &v2 = vertices[faces[3 * randIndex + 1]];
+				const Vector3r &v3 = vertices[faces[3 * randIndex + 2]];
+
+				m_initialInfoVec[i].pos = bc1*v1 + bc2*v2 + bc3*v3;
+				m_initialInfoVec[i].ID = randIndex;
+			}
 		}
 	}
 }
@@ -197,217 +250,183 @@ unsigned int PoissonDiskSampling::getAreaIndex(const vector<Real>& areas, const
 
 void PoissonDiskSampling::parallelUniformSurfaceSampling(std::vector<Vector3r> &samples)
 {
-
-	// Sort initial points into HashMap storing only the index of the first point of cell
-	// and build phase groups
-	unordered_map<CellPos, HashEntry, CellPosHasher> hMap(2 * m_initialInfoVec.size());
 	samples.clear();
-	samples.reserve(m_initialInfoVec.size());
+	if (m_initialInfoVec.size() == 0)
+		return;
 
-	// Already insert first Initial point as start of first cell in hashmap
-	{
-		const CellPos& cell = m_initialInfoVec[0].cP;
-		HashEntry &entry = hMap[cell];
-		entry.startIndex = 0;
-		entry.samples.reserve(5);
-		int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
-		m_phaseGroups[index].push_back(cell);
-	}
+	// Determine the cells of the sorted initial points and build phase groups
+	buildCells();
 
-	for (int i = 1; i < (int)m_initialInfoVec.size(); i++)
-	{
-		const CellPos& cell = m_initialInfoVec[i].cP;
-		if (cell != m_initialInfoVec[i - 1].cP)
-		{
-			HashEntry &entry = hMap[cell];
-			entry.startIndex = i;
-			entry.samples.reserve(5);
-			int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
-			m_phaseGroups[index].push_back(cell);
-		}
-	}
 	// Loop over number of tries to find a sample in a cell
 	for (int k = 0; k < (int)m_numTrials; k++)
 	{
 		// Loop over the 27 cell groups
 		for (int pg = 0; pg < m_phaseGroups.size(); pg++)
 		{
-			const vector<CellPos>& cells = m_phaseGroups[pg];
-			// Loop over the cells in each cell group
-			#pragma omp parallel for schedule(static)
-			for (int i = 0; i < (int)cells.size(); i++)
+			const vector<unsigned int>& cells = m_phaseGroups[pg];
+			// Loop over the cells in each cell group. The cells of a group are at least
+			// three cells apart, so a thread only writes its own cell and reads cells
+			// which are not modified in this phase.
+			#pragma omp parallel default(shared)
 			{
-				const auto entryIt = hMap.find(cells[i]);
-				// Check if cell exists
-				if (entryIt != hMap.end())
+				#pragma omp for schedule(static)
+				for (int i = 0; i < (int)cells.size(); i++)
 				{
-					// Check if max Index is not exceeded
-					HashEntry& entry = entryIt->second;
-					if (entry.startIndex + k < m_initialInfoVec.size())
+					const unsigned int cell = cells[i];
+					const unsigned int index = m_cellStart[cell] + k;
+					// choose kth point from cell
+					if ((m_cellSample[cell] < 0) && (index < m_cellStart[cell + 1]))
 					{
-						if (m_initialInfoVec[entry.startIndex].cP == m_initialInfoVec[entry.startIndex + k].cP)
-						{
-							// choose kth point from cell
-							const InitialPointInfo& test = m_initialInfoVec[entry.startIndex + k];
-							// Assign sample
-							if (!nbhConflict(hMap, test))
-							{
-								const int index = entry.startIndex + k;
-								#pragma omp critical
-								{
-									entry.samples.push_back(index);
-									samples.push_back(m_initialInfoVec[index].pos);
-								}
-							}
-						}
+						// Assign sample
+						if (!nbhConflict(m_initialInfoVec[index]))
+							m_cellSample[cell] = (int)index;
 					}
 				}
 			}
 		}
 	}
+
+	// collect the samples in the order of the cells
+	unsigned int numSamples = 0;
+	for (size_t cell = 0; cell < m_cellSample.size(); cell++)
+	{
+		if (m_cellSample[cell] >= 0)
+			numSamples++;
+	}
+	samples.reserve(numSamples);
+	for (size_t cell = 0; cell < m_cellSample.size(); cell++)
+	{
+		if (m_cellSample[cell] >= 0)
+			samples.push_back(m_initialInfoVec[m_cellSample[cell]].pos);
+	}
 }
 
-bool PoissonDiskSampling::nbhConflict(const unordered_map<CellPos, HashEntry, CellPosHasher>& hMap, const InitialPointInfo& iPI)
+void PoissonDiskSampling::sortInitialPoints()
 {
-	CellPos nbPos = iPI.cP;
+	const unsigned int numPoints = (unsigned int)m_initialInfoVec.size();
+	std::vector<std::pair<CellKey, unsigned int>> keys(numPoints);
 
-	// check neighboring cells inside to outside
-	if (checkCell(hMap, nbPos, iPI)) 
-		return true;
-	for (int level = 1; level < 3; level++)
+	#pragma omp parallel default(shared)
 	{
-		for (int ud = -level; ud < level + 1; ud += 2 * level)
-		{
-			for (int i = -level+1; i < level ; i++)
-			{
-				for (int j = -level + 1; j < level ; j++)
-				{
-					nbPos = CellPos(i, ud, j) + iPI.cP;
-					if (checkCell(hMap, nbPos, iPI)) 
-						return true;
-				}
-			}
+		#pragma omp for schedule(static)  
+		for (int i = 0; i < (int)numPoints; i++)
+			keys[i] = std::make_pair(cellKey(m_initialInfoVec[i].cP), (unsigned int)i);
+	}
 
-			for (int i = -level; i < level + 1; i++)
-			{
-				for (int j = -level + 1; j < level ; j++)
-				{
-					nbPos = CellPos(j, i, ud) + iPI.cP;
-					if (checkCell(hMap, nbPos, iPI)) 
-						return true;
-				}
+	parallelSort(keys);
 
-				for (int j = -level; j < level + 1; j++)
-				{
-					nbPos = CellPos(ud, i, j) + iPI.cP;
-					if (checkCell(hMap, nbPos, iPI)) 
-						return true;
-				}
-			}
-		}
+	std::vector<InitialPointInfo> sorted(numPoints);
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)  
+		for (int i = 0; i < (int)numPoints; i++)
+			sorted[i] = m_initialInfoVec[keys[i].second];
 	}
-	return false;
+	m_initialInfoVec.swap(sorted);
 }
 
-bool PoissonDiskSampling::checkCell(const unordered_map<CellPos, HashEntry, CellPosHasher>& hMap, const CellPos& cell, const InitialPointInfo& iPI)
+void PoissonDiskSampling::buildCells()
 {
-	const auto nbEntryIt = hMap.find(cell);
-	if (nbEntryIt != hMap.end())
+	const unsigned int numPoints = (unsigned int)m_initialInfoVec.size();
+	unsigned int numCells = 1;
+	for (unsigned int i = 1; i < numPoints; i++)
 	{
-		const HashEntry& nbEntry = nbEntryIt->second;
-		for (unsigned int i = 0; i < nbEntry.samples.size(); i++)
-		{
-			const InitialPointInfo &info = m_initialInfoVec[nbEntry.samples[i]];
-			Real dist;
-			if (m_distanceNorm == 0 || iPI.ID == info.ID)
-			{
-				dist = (iPI.pos - info.pos).norm();
-			}
-			else if (m_distanceNorm == 1)
-			{
-				Vector3r v = (info.pos - iPI.pos).normalized();
-				Real c1 = m_faceNormals[iPI.ID].dot(v);
-				Real c2 = m_faceNormals[info.ID].dot(v);
-
-				dist = (iPI.pos - info.pos).norm();
-				if (fabs(c1 - c2) > 0.00001f)
-					dist *= (asin(c1) - asin(c2)) / (c1 - c2);
-				else
-					dist /= (sqrt(static_cast<Real>(1.0) - c1*c1));
-			}
-			else
-			{
-				return true;
-			}
+		if (m_initialInfoVec[i].cP != m_initialInfoVec[i - 1].cP)
+			numCells++;
+	}
 
-			if (dist < m_r)
-				return true;
+	m_cellKeys.resize(numCells);
+	m_cellStart.resize(numCells + 1);
+	unsigned int numGroupCells[27] = {};
+	unsigned int c = 0;
+	for (unsigned int i = 0; i < numPoints; i++)
+	{
+		const CellPos& cell = m_initialInfoVec[i].cP;
+		if ((i == 0) || (cell != m_initialInfoVec[i - 1].cP))
+		{
+			m_cellKeys[c] = cellKey(cell);
+			m_cellStart[c] = i;
+			numGroupCells[cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3)]++;
+			c++;
 		}
 	}
-	return false;
-}
+	m_cellStart[numCells] = numPoints;
+	m_cellSample.assign(numCells, -1);
 
-void PoissonDiskSampling::determineMinX(const unsigned int numVertices, const Vector3r *vertices)
-{
-	m_minVec = Vector3r(numeric_limits<Real>::max(), numeric_limits<Real>::max(), numeric_limits<Real>::max());
-
-	for (int i = 0; i < (int)numVertices; i++)
+	for (unsigned int pg = 0; pg < 27; pg++)
+		m_phaseGroups[pg].reserve(numGroupCells[pg]);
+	for (c = 0; c < numCells; c++)
 	{
-		const Vector3r& v = vertices[i];
-		m_minVec[0] = std::min(m_minVec[0], v[0]);
-		m_minVec[1] = std::min(m_minVec[1], v[1]);
-		m_minVec[2] = std::min(m_minVec[2], v[2]);
+		const CellPos& cell = m_initialInfoVec[m_cellStart[c]].cP;
+		const int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
+		m_phaseGroups[index].push_back(c);
 	}
 }
 
-void PoissonDiskSampling::quickSort(int left, int right)
+bool PoissonDiskSampling::nbhConflict(const InitialPointInfo& iPI) const
 {
-	if (left < right)
+	// The cells of a row in z-direction are contiguous in the sorted cell keys,
+	// so each of the 5x5 rows of neighboring cells is found by one binary search.
+	// The rows are checked inside to outside.
+	static const int rows[25][2] = { 
+		{ 0, 0 }, 
+		{ -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 },
+		{ -2, -2 }, { -2, -1 }, { -2, 0 }, { -2, 1 }, { -2, 2 }, { 2, -2 }, { 2, -1 }, { 2, 0 }, { 2, 1 }, { 2, 2 },
+		{ -1, -2 }, { 0, -2 }, { 1, -2 }, { -1, 2 }, { 0, 2 }, { 1, 2 } };
+
+	for (unsigned int r = 0; r < 25; r++)
 	{
-		int index = partition(left, right);
-		quickSort(left, index - 1);
-		quickSort(index, right);
+		const CellPos first = iPI.cP + CellPos(rows[r][0], rows[r][1], -2);
+		const CellKey lastKey = cellKey(iPI.cP + CellPos(rows[r][0], rows[r][1], 2));
+		unsigned int cell = (unsigned int)(std::lower_bound(m_cellKeys.begin(), m_cellKeys.end(), cellKey(first)) - m_cellKeys.begin());
+		for (; (cell < m_cellKeys.size()) && (m_cellKeys[cell] <= lastKey); cell++)
+		{
+			if ((m_cellSample[cell] >= 0) && checkSample(m_cellSample[cell], iPI))
+				return true;
+		}
 	}
+	return false;
 }
 
-int PoissonDiskSampling::partition(int left, int right)
+bool PoissonDiskSampling::checkSample(const unsigned int sampleIndex, const InitialPointInfo& iPI) const
 {
-	int i = left;
-	int j = right;
-	Vector3r tmpPos;
-	CellPos tmpCell;
-	InitialPointInfo tmpInfo;
-	CellPos pivot = m_initialInfoVec[left + (right - left) / 2].cP;
-	
-	while (i <= j)
+	const InitialPointInfo &info = m_initialInfoVec[sampleIndex];
+	Real dist;
+	if (m_distanceNorm == 0 || iPI.ID == info.ID)
 	{
-		while (compareCellID(m_initialInfoVec[i].cP, pivot))
-			i++;
-
-		while (compareCellID(pivot, m_initialInfoVec[j].cP))
-			j--;
-
-		if (i <= j)
-		{
-			tmpInfo = m_initialInfoVec[i];
-			m_initialInfoVec[i] = m_initialInfoVec[j];
-			m_initialInfoVec[j] = tmpInfo;
-			i++;
-			j--;
-		}
+		dist = (iPI.pos - info.pos).norm();
+	}
+	else if (m_distanceNorm == 1)
+	{
+		Vector3r v = (info.pos - iPI.pos).normalized();
+		Real c1 = m_faceNormals[iPI.ID].dot(v);
+		Real c2 = m_faceNormals[info.ID].dot(v);
+
+		dist = (iPI.pos - info.pos).norm();
+		if (fabs(c1 - c2) > 0.00001f)
+			dist *= (asin(c1) - asin(c2)) / (c1 - c2);
+		else
+			dist /= (sqrt(static_cast<Real>(1.0) - c1*c1));
 	}
-	return i;
+	else
+	{
+		return true;
+	}
+
+	return dist < m_r;
 }
 
-bool PoissonDiskSampling::compareCellID(CellPos& a, CellPos& b)
+void PoissonDiskSampling::determineMinX(const unsigned int numVertices, const Vector3r *vertices)
 {
-	for (unsigned int i = 0; i < 3; i++)
+	m_minVec = Vector3r(numeric_limits<Real>::max(), numeric_limits<Real>::max(), numeric_limits<Real>::max());
+	m_maxVec = -m_minVec;
+
+	for (int i = 0; i < (int)numVertices; i++)
 	{
-		if (a[i] < b[i]) return true;
-		if (a[i] > b[i]) return false;
+		const Vector3r& v = vertices[i];
+		m_minVec = m_minVec.cwiseMin(v);
+		m_maxVec = m_maxVec.cwiseMax(v);
 	}
-
-	return false;
 }
 
 void PoissonDiskSampling::computeFaceNormals(const unsigned int numVertices, const Vector3r *vertices, const unsigned int numFaces, const unsigned int *faces)
@@ -4,7 +4,7 @@
 #include "../Common.h"
 
 #include <random>
-#include <unordered_map>
+#include <vector>
 #include <string>
 
 namespace SPH
@@ -15,17 +15,8 @@ namespace SPH
 	class PoissonDiskSampling
 	{
 		typedef Eigen::Vector3i CellPos;
+		typedef unsigned long long CellKey;
 
-		struct CellPosHasher
-		{
-			std::size_t operator()(const CellPos& k) const
-			{
-				const int p1 = 73856093 * k[0];
-				const int p2 = 19349663 * k[1];
-				const int p3 = 83492791 * k[2];
-				return (size_t)(p1 + p2 + p3);
-			}
-		};
 	public:
 		PoissonDiskSampling();
 
@@ -38,20 +29,30 @@ namespace SPH
 			unsigned int ID;
 		};
 
-		/** \brief Struct to store the hash entry (spatial hashing)
-		*/
-		struct HashEntry
-		{
-			HashEntry() { startIndex = 0; };
-			std::vector<unsigned int> samples;
-			unsigned int startIndex;
-		};
-
 		FORCE_INLINE static int floor(const Real v)
 		{
 			return (int)(v + 32768.f) - 32768;			// Shift to get positive values 
 		}
 
+		/** Number of bits per coordinate of a cell key. */
+		static const unsigned int CELL_KEY_BITS = 21;
+
+		/** Key of a cell which is ordered like the cell position (x, then y, then z).
+		* The cell coordinates of the samples start at 1 and the neighbor search
+		* visits coordinates down to -1, so the coordinates are shifted by 2.
+		*/
+		FORCE_INLINE static CellKey cellKey(const CellPos &c)
+		{
+			return ((CellKey)(c[0] + 2) << (2 * CELL_KEY_BITS)) | ((CellKey)(c[1] + 2) << CELL_KEY_BITS) | (CellKey)(c[2] + 2);
+		}
+
+		/** Set the seed of the random number generators. The sampling is then
+		* reproducible (independent of the number of threads).
+		*/
+		void setSeed(const unsigned int seed) { m_seed = seed; m_useSeed = true; }
+		/** Use a random seed for each sampling (default). */
+		void setRandomSeed() { m_useSeed = false; }
+
 		/** Performs the poisson sampling with the
 		* respective parameters. Compare
 		* http://graphics.cs.umass.edu/pubs/sa_2010.pdf
@@ -81,8 +82,20 @@ namespace SPH
 		Vector3r m_minVec;
 		Vector3r m_maxVec;
 
+		/** initial points sorted by their cells */
 		std::vector<InitialPointInfo> m_initialInfoVec;
-		std::vector<std::vector<CellPos>> m_phaseGroups;
+		/** sorted keys of the non-empty cells */
+		std::vector<CellKey> m_cellKeys;
+		/** index of the first initial point of each cell (CSR, size: number of cells + 1) */
+		std::vector<unsigned int> m_cellStart;
+		/** index of the accepted sample of each cell, -1 if there is none. Since the
+		* diagonal of a cell is the sampling radius, a cell contains at most one sample. */
+		std::vector<int> m_cellSample;
+		/** cell indices of the 27 phase groups */
+		std::vector<std::vector<unsigned int>> m_phaseGroups;
+
+		bool m_useSeed;
+		unsigned int m_seed;
 
 		Real m_maxArea;
 
@@ -92,16 +105,13 @@ namespace SPH
 		unsigned int getAreaIndex(const std::vector<Real>& areas, const Real totalArea, std::default_random_engine &generator, std::uniform_real_distribution<Real> &distribution);
 		void parallelUniformSurfaceSampling(std::vector<Vector3r> &samples);
 
-		void quickSort(int left, int right);
-		int partition(int left, int right);
-		bool compareCellID(CellPos& a, CellPos& b);
+		void sortInitialPoints();
+		void buildCells();
 
 		void determineMinX(const unsigned int numVertices, const Vector3r *vertices);
 
-		bool nbhConflict(const std::unordered_map<CellPos, HashEntry, CellPosHasher>& kvMap, const InitialPointInfo& iPI);
-		bool checkCell(const std::unordered_map<CellPos, HashEntry, CellPosHasher>& kvMap, const CellPos& cell, const InitialPointInfo& iPI);
-		
-
+		bool nbhConflict(const InitialPointInfo& iPI) const;
+		bool checkSample(const unsigned int sampleIndex, const InitialPointInfo& iPI) const;
 	};
 }
 
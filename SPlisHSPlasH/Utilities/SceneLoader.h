@@ -180,6 +180,8 @@ namespace Utilities
 
 		void readParameterObject(const std::string &key, GenParam::ParameterObject *paramObj);
 		ColoringData readColoringInfo(const std::string &key);
+
+		nlohmann::json &getJSONData() { return m_jsonData; }
 	};
 
 	template <>
@@ -1,19 +1,124 @@
 #include "VolumeSampling.h"
 #include "SDFFunctions.h"
+#include "WindingNumbers.h"
 #include "Utilities/Timing.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/Logger.h"
 
 using namespace Eigen;
 using namespace std;
 using namespace Utilities;
 
 
-void VolumeSampling::sampleMesh(const unsigned int numVertices, const Vector3r *vertices,
-	const unsigned int numFaces, const unsigned int *faces,
-	const Real radius, const AlignedBox3r *region, 
-	const std::array<unsigned int, 3> &resolution, const bool invert, 
-	const unsigned int sampleMode, 
-	std::vector<Vector3r> &samples)
- {
+/** Sample the lattice of the given sampling mode in the box and keep the
+* positions for which isInside returns true.
+*/
+template<typename InsideFunc>
+static void sampleLattice(const AlignedBox3r &bbox, const Real radius, const unsigned int sampleMode,
+	const InsideFunc &isInside, std::vector<Vector3r> &samples)
+{
+	const Real diameter = 2.0 * radius;
+
+	Real xshift = diameter;
+	Real yshift = diameter;
+	if (sampleMode == 1)
+		yshift = sqrt(3.0) * radius;
+	else if (sampleMode == 2)
+	{
+		xshift = sqrt(3.0) * radius;
+		yshift = sqrt(6.0) * diameter / 3.0;
+	}
+
+	// lattice coordinates (accumulated in the same way as in a serial loop)
+	std::vector<Real> xCoords, yCoords, zCoords;
+	for (Real z = bbox.min()[2]; z <= bbox.max()[2]; z += diameter)
+		zCoords.push_back(z);
+	for (Real y = bbox.min()[1]; y <= bbox.max()[1]; y += yshift)
+		yCoords.push_back(y);
+	for (Real x = bbox.min()[0]; x <= bbox.max()[0]; x += xshift)
+		xCoords.push_back(x);
+	const unsigned int nx = (unsigned int)xCoords.size();
+	const unsigned int ny = (unsigned int)yCoords.size();
+	const unsigned int numRows = (unsigned int)zCoords.size() * ny;
+
+	#ifdef _OPENMP
+	const int maxThreads = omp_get_max_threads();
+	#else
+	const int maxThreads = 1;
+	#endif
+	std::vector<std::vector<Vector3r>> threadSamples(maxThreads);
+
+	#pragma omp parallel default(shared)
+	{
+		#ifdef _OPENMP
+		const int tid = omp_get_thread_num();
+		const int numThreads = omp_get_num_threads();
+		#else
+		const int tid = 0;
+		const int numThreads = 1;
+		#endif
+
+		// Each thread samples a contiguous range of lattice rows, so concatenating
+		// the thread buffers yields the same order for any number of threads.
+		const unsigned int begin = (unsigned int)(((unsigned long long) numRows * tid) / numThreads);
+		const unsigned int end = (unsigned int)(((unsigned long long) numRows * (tid + 1)) / numThreads);
+		std::vector<Vector3r> &localSamples = threadSamples[tid];
+
+		for (unsigned int row = begin; row < end; row++)
+		{
+			const unsigned int counter_y = row % ny;
+			const Real y = yCoords[counter_y];
+			const Real z = zCoords[row / ny];
+			for (unsigned int counter_x = 0; counter_x < nx; counter_x++)
+			{
+				const Real x = xCoords[counter_x];
+				Vector3r particlePosition;
+				if (sampleMode == 1)
+				{
+					if (counter_y % 2 == 0)
+						particlePosition = Vector3r(x, y + radius, z + radius);
+					else
+						particlePosition = Vector3r(x + radius, y + radius, z);
+				}
+				else if (sampleMode == 2)
+				{
+					particlePosition = Vector3r(x, y + radius, z + radius);
+
+					Vector3r shift_vec(0, 0, 0);
+					if (counter_x % 2)
+					{
+						shift_vec[2] += diameter / (2.0 * (counter_y % 2 ? -1 : 1));
+					}
+					if (counter_y % 2)
+					{
+						shift_vec[0] += xshift / 2.0;
+						shift_vec[2] += diameter / 2.0;
+					}
+					particlePosition += shift_vec;
+				}
+				else
+				{
+					// Use center of voxel
+					particlePosition = Vector3r(x + radius, y + radius, z + radius);
+				}
+
+				if (isInside(particlePosition))
+					localSamples.push_back(particlePosition);
+			}
+		}
+	}
+
+	size_t numSamples = samples.size();
+	for (int t = 0; t < maxThreads; t++)
+		numSamples += threadSamples[t].size();
+	samples.reserve(numSamples);
+	for (int t = 0; t < maxThreads; t++)
+		samples.insert(samples.end(), threadSamples[t].begin(), threadSamples[t].end());
+
+}
+
+static AlignedBox3r computeSamplingBox(const unsigned int numVertices, const Vector3r *vertices, const AlignedBox3r *region)
+{
 	AlignedBox3r bbox = SDFFunctions::computeBoundingBox(numVertices, vertices);
 
 	if (region)
@@ -24,84 +129,64 @@ void VolumeSampling::sampleMesh(const unsigned int numVertices, const Vector3r *
 			bbox.max()[i] = std::min(region->max()[i], bbox.max()[i]);
 		}
 	}
+	return bbox;
+}
 
-	Discregrid::CubicLagrangeDiscreteGrid* sdf = SDFFunctions::generateSDF(numVertices, vertices, numFaces, faces, bbox, resolution, invert);
+void VolumeSampling::sampleMesh(const unsigned int numVertices, const Vector3r *vertices,
+	const unsigned int numFaces, const unsigned int *faces,
+	const Real radius, const AlignedBox3r *region, 
+	const std::array<unsigned int, 3> &resolution, const bool invert, 
+	const unsigned int sampleMode, 
+	std::vector<Vector3r> &samples,
+	const std::string &sdfCacheFile)
+{
+	const AlignedBox3r bbox = computeSamplingBox(numVertices, vertices, region);
 
-	const Real diameter = 2.0 * radius;
+	Discregrid::CubicLagrangeDiscreteGrid* sdf = nullptr;
+	if ((sdfCacheFile != "") && FileSystem::fileExists(sdfCacheFile))
+	{
+		sdf = new Discregrid::CubicLagrangeDiscreteGrid(sdfCacheFile);
+		// the cached SDF must cover the sampled region with the requested resolution
+		if ((sdf->resolution() != resolution) || !sdf->domain().contains(bbox.cast<double>()))
+		{
+			LOG_WARN << "Cached SDF " << sdfCacheFile << " does not match the mesh and is regenerated.";
+			delete sdf;
+			sdf = nullptr;
+		}
+		else
+			LOG_INFO << "Loaded cached SDF: " << sdfCacheFile;
+	}
+	if (sdf == nullptr)
+	{
+		sdf = SDFFunctions::generateSDF(numVertices, vertices, numFaces, faces, bbox, resolution, invert);
+		if (sdfCacheFile != "")
+		{
+			LOG_INFO << "Save SDF: " << sdfCacheFile;
+			sdf->save(sdfCacheFile);
+		}
+	}
 
-	// sample object
-	const unsigned int numberOfSamplePoints = (((unsigned int)((1.0f / diameter) * (bbox.max()[2] - bbox.min()[2]))) + 1) *
-		(((unsigned int)((1.0f / diameter) * (bbox.max()[1] - bbox.min()[1]))) + 1) *
-		(((unsigned int)((1.0f / diameter) * (bbox.max()[0] - bbox.min()[0]))) + 1);
-
-	unsigned int currentSample = 0;
- //	Real currentPercent = 0.0;
- 	int counter_x = 0;
- 	int counter_y = 0;
- 	Real xshift = diameter;
- 	Real yshift = diameter;
- 
- 	if (sampleMode == 1)
- 		yshift = sqrt(3.0) * radius;
- 	else if (sampleMode == 2)
- 	{
- 		xshift = sqrt(3.0) * radius;
- 		yshift = sqrt(6.0) * diameter / 3.0;
- 	}
- 	for (Real z = bbox.min()[2]; z <= bbox.max()[2]; z += diameter)
- 	{
- 		for (Real y = bbox.min()[1]; y <= bbox.max()[1]; y += yshift)
- 		{
- 			for (Real x = bbox.min()[0]; x <= bbox.max()[0]; x += xshift)
- 			{
- 				Vector3r particlePosition;
- 				if (sampleMode == 1)
- 				{					
- 					if (counter_y % 2 == 0)
- 						particlePosition = Vector3r(x, y + radius, z + radius);
- 					else
- 						particlePosition = Vector3r(x + radius, y + radius, z);
- 				}
- 				else if (sampleMode == 2)
- 				{
- 					particlePosition = Vector3r(x, y + radius, z + radius);
- 
- 					Vector3r shift_vec(0, 0, 0);
- 					if (counter_x % 2)
- 					{
- 						shift_vec[2] += diameter / (2.0 * (counter_y % 2 ? -1 : 1));
- 					}
- 					if (counter_y % 2)
- 					{
- 						shift_vec[0] += xshift / 2.0;
- 						shift_vec[2] += diameter / 2.0;
- 					}
- 					particlePosition += shift_vec;
- 				}
- 				else
- 				{
- 					// Use center of voxel
- 					particlePosition = Vector3r(x + radius, y + radius, z + radius);
- 				}
- 
-				if (SDFFunctions::distance(sdf, particlePosition, 0.0) < 0.0)
-					samples.push_back(particlePosition);
- 				currentSample++;
- 
-//  				if ((Real)currentSample / (Real)numberOfSamplePoints > currentPercent)
-//  				{
-//  					LOG_INFO << currentPercent * 100.0 << "%";
-//  					currentPercent += 0.05;
-//  				}
- 				counter_x++;
- 			}
- 			counter_x = 0;
- 			counter_y++;
- 		}
- 		counter_y = 0;
- 	}
-// 	LOG_INFO << "100%";
+	sampleLattice(bbox, radius, sampleMode,
+		[&](const Vector3r &x) { return SDFFunctions::distance(sdf, x, 0.0) < 0.0; },
+		samples);
 
 	delete sdf;
 }
- 
\ No newline at end of file
+
+void VolumeSampling::sampleMeshWindingNumbers(const unsigned int numVertices, const Vector3r *vertices,
+	const unsigned int numFaces, const unsigned int *faces,
+	const Real radius, const AlignedBox3r *region,
+	const bool invert, const unsigned int sampleMode,
+	std::vector<Vector3r> &samples,
+	const Real accuracy)
+{
+	const AlignedBox3r bbox = computeSamplingBox(numVertices, vertices, region);
+
+	START_TIMING("Fast winding numbers");
+	const FastWindingNumbers fwn(numVertices, vertices, numFaces, faces, accuracy);
+	STOP_TIMING_PRINT;
+
+	sampleLattice(bbox, radius, sampleMode,
+		[&](const Vector3r &x) { return (fwn.computeWindingNumber(x) > 0.5) != invert; },
+		samples);
+}
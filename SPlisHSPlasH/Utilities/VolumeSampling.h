@@ -3,6 +3,7 @@
 
 #include "../Common.h"
 #include <vector>
+#include <string>
 
 
 namespace Utilities
@@ -25,13 +26,38 @@ namespace Utilities
 		* @param invert defines if the mesh should be inverted and the outside is sampled
 		* @param sampleMode 0=regular, 1=almost dense, 2=dense
 		* @param samples sampled vertices that will be returned
+		* @param sdfCacheFile file used to cache the SDF ("" if not used), the caller
+		* must encode the mesh, its scaling, the resolution and the invert flag in the name
 		*/
 		static void sampleMesh(const unsigned int numVertices, const Vector3r *vertices, 
 			const unsigned int numFaces, const unsigned int *faces,
 			const Real radius, const AlignedBox3r *region,
 			const std::array<unsigned int, 3> &resolution, const bool invert,
 			const unsigned int sampleMode,
-			std::vector<Vector3r> &samples);		
+			std::vector<Vector3r> &samples,
+			const std::string &sdfCacheFile = "");
+
+		/** Performs the volume sampling using fast generalized winding numbers
+		* instead of an SDF for the inside test. This is robust for meshes which
+		* are not closed.
+		*
+		* @param numVertices number of vertices
+		* @param vertices vertex data 
+		* @param numFaces number of faces
+		* @param faces index list of faces
+		* @param radius radius of sampled particles
+		* @param region defines a subregion of the mesh to be sampled (nullptr if not used)
+		* @param invert defines if the mesh should be inverted and the outside is sampled
+		* @param sampleMode 0=regular, 1=almost dense, 2=dense
+		* @param samples sampled vertices that will be returned
+		* @param accuracy accuracy of the fast winding numbers (see FastWindingNumbers)
+		*/
+		static void sampleMeshWindingNumbers(const unsigned int numVertices, const Vector3r *vertices,
+			const unsigned int numFaces, const unsigned int *faces,
+			const Real radius, const AlignedBox3r *region,
+			const bool invert, const unsigned int sampleMode,
+			std::vector<Vector3r> &samples,
+			const Real accuracy = 2.0);
 	};
 }
 
@@ -1,6 +1,7 @@
 #include "WindingNumbers.h"
 #include "SPlisHSPlasH/Common.h"
 #include <Eigen/Dense>
+#include <algorithm>
 
 #define _USE_MATH_DEFINES
 #include "math.h"
@@ -51,3 +52,152 @@ Real WindingNumbers::computeGeneralizedWindingNumber(const Vector3r& p, const Tr
  
  	return w_p;
 }
+
+
+FastWindingNumbers::FastWindingNumbers(const unsigned int numVertices, const Vector3r *vertices,
+	const unsigned int numFaces, const unsigned int *faces, const Real accuracy)
+{
+	m_accuracy = accuracy;
+	m_vertices.assign(vertices, vertices + numVertices);
+	m_faces.assign(faces, faces + 3 * numFaces);
+
+	m_triangles.resize(numFaces);
+	std::vector<Vector3r> centroids(numFaces);
+	for (unsigned int i = 0; i < numFaces; i++)
+	{
+		m_triangles[i] = i;
+		centroids[i] = (m_vertices[m_faces[3 * i]] + m_vertices[m_faces[3 * i + 1]] + m_vertices[m_faces[3 * i + 2]]) / static_cast<Real>(3.0);
+	}
+
+	m_nodes.reserve(2 * (numFaces / 4 + 1));
+	Node root;
+	root.child = 0;
+	root.begin = 0;
+	root.end = numFaces;
+	m_nodes.push_back(root);
+	if (numFaces > 0)
+		build(0, centroids);
+}
+
+FastWindingNumbers::FastWindingNumbers(const TriangleMesh &mesh, const Real accuracy) :
+	FastWindingNumbers(mesh.numVertices(), mesh.getVertices().data(), mesh.numFaces(), mesh.getFaces().data(), accuracy)
+{
+}
+
+void FastWindingNumbers::build(const unsigned int nodeIndex, const std::vector<Vector3r> &centroids)
+{
+	const unsigned int maxTrianglesPerLeaf = 8;
+	const unsigned int begin = m_nodes[nodeIndex].begin;
+	const unsigned int end = m_nodes[nodeIndex].end;
+
+	// dipole of the node: area-weighted normal and center
+	Vector3r normal = Vector3r::Zero();
+	Vector3r center = Vector3r::Zero();
+	Real area = 0.0;
+	AlignedBox3r box;
+	for (unsigned int i = begin; i < end; i++)
+	{
+		const unsigned int t = m_triangles[i];
+		const Vector3r &a = m_vertices[m_faces[3 * t]];
+		const Vector3r &b = m_vertices[m_faces[3 * t + 1]];
+		const Vector3r &c = m_vertices[m_faces[3 * t + 2]];
+		const Vector3r n = static_cast<Real>(0.5) * (b - a).cross(c - a);
+		const Real A = n.norm();
+		normal += n;
+		center += A * centroids[t];
+		area += A;
+		box.extend(centroids[t]);
+	}
+	if (area > 0.0)
+		center /= area;
+	else
+		center = box.center();
+
+	Real radius2 = 0.0;
+	for (unsigned int i = begin; i < end; i++)
+	{
+		const unsigned int t = m_triangles[i];
+		for (unsigned int j = 0; j < 3; j++)
+			radius2 = std::max(radius2, (m_vertices[m_faces[3 * t + j]] - center).squaredNorm());
+	}
+
+	m_nodes[nodeIndex].center = center;
+	m_nodes[nodeIndex].normal = normal;
+	m_nodes[nodeIndex].radius = sqrt(radius2);
+
+	if (end - begin <= maxTrianglesPerLeaf)
+		return;
+
+	// split at the median of the centroids along the longest axis
+	unsigned int axis;
+	box.diagonal().maxCoeff(&axis);
+	const unsigned int mid = begin + (end - begin) / 2;
+	std::nth_element(m_triangles.begin() + begin, m_triangles.begin() + mid, m_triangles.begin() + end,
+		[&](const unsigned int t1, const unsigned int t2) { return centroids[t1][axis] < centroids[t2][axis]; });
+
+	const unsigned int child = static_cast<unsigned int>(m_nodes.size());
+	m_nodes[nodeIndex].child = child;
+	Node left, right;
+	left.child = 0;
+	left.begin = begin;
+	left.end = mid;
+	right.child = 0;
+	right.begin = mid;
+	right.end = end;
+	m_nodes.push_back(left);
+	m_nodes.push_back(right);
+	build(child, centroids);
+	build(child + 1, centroids);
+}
+
+Real FastWindingNumbers::computeWindingNumber(const Vector3r &p) const
+{
+	if (m_triangles.size() == 0)
+		return 0.0;
+
+	static const Real fourPi = 4.0 * M_PI;
+	const Real accuracy2 = m_accuracy * m_accuracy;
+	Real w = 0.0;
+
+	unsigned int stack[64];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const Node &node = m_nodes[stack[--stackSize]];
+		const Vector3r d = node.center - p;
+		const Real dist2 = d.squaredNorm();
+		if (dist2 > accuracy2 * node.radius * node.radius)
+		{
+			// far field: dipole approximation
+			w += d.dot(node.normal) / (fourPi * dist2 * sqrt(dist2));
+		}
+		else if (node.child == 0)
+		{
+			// near field: exact contribution of the triangles
+			for (unsigned int i = node.begin; i < node.end; i++)
+			{
+				const unsigned int t = m_triangles[i];
+				w += WindingNumbers::computeGeneralizedWindingNumber(p, m_vertices[m_faces[3 * t]], m_vertices[m_faces[3 * t + 1]], m_vertices[m_faces[3 * t + 2]]);
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.child;
+			stack[stackSize++] = node.child + 1;
+		}
+	}
+	return w;
+}
+
+void FastWindingNumbers::computeWindingNumbers(const unsigned int numPoints, const Vector3r *points, std::vector<Real> &windingNumbers) const
+{
+	windingNumbers.resize(numPoints);
+
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)  
+		for (int i = 0; i < (int)numPoints; i++)
+			windingNumbers[i] = computeWindingNumber(points[i]);
+	}
+}
@@ -1,5 +1,9 @@
+#ifndef __WindingNumbers_h__
+#define __WindingNumbers_h__
+
 #include "SPlisHSPlasH/Common.h"
 #include "SPlisHSPlasH/TriangleMesh.h"
+#include <vector>
 
 namespace Utilities
 {
@@ -14,4 +18,52 @@ namespace Utilities
 		*/
 		static Real computeGeneralizedWindingNumber(const Vector3r& p, const SPH::TriangleMesh &mesh);
 	};
-}
\ No newline at end of file
+
+	/** \brief Fast evaluation of the generalized winding number of a triangle mesh
+	* using a bounding volume hierarchy (see Barill et al. "Fast winding numbers for
+	* soups and clouds", 2018). The triangles of a node which is far away from the
+	* query point are approximated by a dipole at the area-weighted center of the node.
+	* A node counts as far away if the distance to its center is larger than
+	* accuracy times the radius of the node.
+	*/
+	class FastWindingNumbers
+	{
+	protected:
+		struct Node
+		{
+			Vector3r center;
+			/** area-weighted normal of all triangles in the node */
+			Vector3r normal;
+			Real radius;
+			/** index of the first child (second child is child+1), 0 for leaves */
+			unsigned int child;
+			unsigned int begin;
+			unsigned int end;
+		};
+
+		std::vector<Vector3r> m_vertices;
+		std::vector<unsigned int> m_faces;
+		/** triangle indices sorted by the leaves of the hierarchy */
+		std::vector<unsigned int> m_triangles;
+		std::vector<Node> m_nodes;
+		Real m_accuracy;
+
+		void build(const unsigned int nodeIndex, const std::vector<Vector3r> &centroids);
+
+	public:
+		FastWindingNumbers(const unsigned int numVertices, const Vector3r *vertices,
+			const unsigned int numFaces, const unsigned int *faces, const Real accuracy = 2.0);
+		FastWindingNumbers(const SPH::TriangleMesh &mesh, const Real accuracy = 2.0);
+
+		Real getAccuracy() const { return m_accuracy; }
+		void setAccuracy(const Real accuracy) { m_accuracy = accuracy; }
+
+		/** Determine the winding number of a point p. */
+		Real computeWindingNumber(const Vector3r &p) const;
+
+		/** Determine the winding numbers of all points in parallel. */
+		void computeWindingNumbers(const unsigned int numPoints, const Vector3r *points, std::vector<Real> &windingNumbers) const;
+	};
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "Viscosity_Bender2017.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/TimeManager.h"
 #include "Utilities/Counting.h"
 #include "../Simulation.h"
@@ -364,3 +365,9 @@ void Viscosity_Bender2017::performNeighborhoodSearchSort()
 	d.sort_field(&m_viscosityLambda[0]);
 }
 
+size_t Viscosity_Bender2017::getMemoryUsage() const
+{
+	return vectorMemory(m_targetStrainRate) +
+		vectorMemory(m_viscosityFactor) +
+		vectorMemory(m_viscosityLambda);
+}
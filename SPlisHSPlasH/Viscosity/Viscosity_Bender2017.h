@@ -31,6 +31,8 @@ namespace SPH
 		Viscosity_Bender2017(FluidModel *model);
 		virtual ~Viscosity_Bender2017(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
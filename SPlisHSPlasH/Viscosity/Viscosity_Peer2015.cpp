@@ -1,4 +1,5 @@
 #include "Viscosity_Peer2015.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/TimeManager.h"
 #include "Utilities/Timing.h"
 #include "Utilities/Counting.h"
@@ -20,6 +21,7 @@ Viscosity_Peer2015::Viscosity_Peer2015(FluidModel *model) :
 	m_iterations = 0;
 	m_maxIter = 50;
 	m_maxError = 0.01;
+	m_sim = nullptr;
 
 	model->addField({ "target nablaV", FieldType::Matrix3, [&](const unsigned int i) -> Real* { return &m_targetNablaV[i](0,0); } });
 }
@@ -52,7 +54,7 @@ void Viscosity_Peer2015::initParameters()
 	rparam->setMinValue(1e-6);
 }
 
-void Viscosity_Peer2015::matrixVecProd(const Real* vec, Real *result, void *userData)
+void Viscosity_Peer2015::matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData)
 {
 	Simulation *sim = Simulation::getCurrent();
 	FluidModel *model = (FluidModel*)userData;
@@ -82,9 +84,9 @@ void Viscosity_Peer2015::matrixVecProd(const Real* vec, Real *result, void *user
 void Viscosity_Peer2015::diagonalMatrixElement(const unsigned int row, Real &result, void *userData)
 {
 	// Diagonal element
-	FluidModel *model = (FluidModel*)userData;
-	Simulation *sim = Simulation::getCurrent();
-	result = model->getDensity(row) - model->getMass(row) * sim->W_zero();
+	Viscosity_Peer2015 *visco = (Viscosity_Peer2015*)userData;
+	FluidModel *model = visco->getModel();
+	result = model->getDensity(row) - model->getMass(row) * visco->m_sim->W_zero();
 }
 
 void Viscosity_Peer2015::step()
@@ -147,21 +149,22 @@ void Viscosity_Peer2015::step()
 	// Init linear system solver and preconditioner
 	//////////////////////////////////////////////////////////////////////////
 	MatrixReplacement A(m_model->numActiveParticles(), matrixVecProd, (void*) m_model);
-	m_solver.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElement, (void*)m_model);
+	m_sim = sim;
+	m_solver.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElement, (void*)this);
 
 	m_solver.setTolerance(m_maxError);
 	m_solver.setMaxIterations(m_maxIter);
 	m_solver.compute(A);
 
-	VectorXr b0(numParticles);
-	VectorXr b1(numParticles);
-	VectorXr b2(numParticles);
-	VectorXr x0(numParticles);
-	VectorXr x1(numParticles);
-	VectorXr x2(numParticles);
-	VectorXr g0(numParticles);
-	VectorXr g1(numParticles);
-	VectorXr g2(numParticles);
+	VectorXs b0(numParticles);
+	VectorXs b1(numParticles);
+	VectorXs b2(numParticles);
+	VectorXs x0(numParticles);
+	VectorXs x1(numParticles);
+	VectorXs x2(numParticles);
+	VectorXs g0(numParticles);
+	VectorXs g1(numParticles);
+	VectorXs g2(numParticles);
 
 	//////////////////////////////////////////////////////////////////////////
 	// Compute RHS
@@ -237,3 +240,8 @@ void Viscosity_Peer2015::reset()
 void Viscosity_Peer2015::performNeighborhoodSearchSort()
 {
 }
+
+size_t Viscosity_Peer2015::getMemoryUsage() const
+{
+	return vectorMemory(m_targetNablaV);
+}
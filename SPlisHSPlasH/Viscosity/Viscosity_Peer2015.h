@@ -9,6 +9,8 @@
 
 namespace SPH
 {
+	class Simulation;
+
 	/** \brief This class implements the implicit simulation method for
 	* viscous fluids introduced
 	* by Peer et al. \cite Peer2015.
@@ -22,6 +24,10 @@ namespace SPH
 		unsigned int m_iterations;
 		unsigned int m_maxIter;
 		Real m_maxError;
+		/** Simulation of the current step. The preconditioner calls diagonalMatrixElement() 
+		* on the OpenMP worker threads which have no current simulation. 
+		*/
+		Simulation *m_sim;
 
 		virtual void initParameters();
 
@@ -33,12 +39,14 @@ namespace SPH
 		Viscosity_Peer2015(FluidModel *model);
 		virtual ~Viscosity_Peer2015(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
 		virtual void performNeighborhoodSearchSort();
 
-		static void matrixVecProd(const Real* vec, Real *result, void *userData);
+		static void matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData);
 		FORCE_INLINE static void diagonalMatrixElement(const unsigned int row, Real &result, void *userData);
 
 		FORCE_INLINE const Matrix3r& getTargetNablaV(const unsigned int i) const
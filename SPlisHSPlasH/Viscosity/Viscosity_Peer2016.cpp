@@ -1,4 +1,5 @@
 #include "Viscosity_Peer2016.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/TimeManager.h"
 #include "Utilities/Timing.h"
 #include "Utilities/Counting.h"
@@ -27,6 +28,7 @@ Viscosity_Peer2016::Viscosity_Peer2016(FluidModel *model) :
 	m_maxErrorV = 0.01;
 	m_maxIterOmega = 50;
 	m_maxErrorOmega = 0.01;
+	m_sim = nullptr;
 
 	model->addField({ "target nablaV", FieldType::Matrix3, [&](const unsigned int i) -> Real* { return &m_targetNablaV[i](0,0); } });
 	model->addField({ "omega (visco)", FieldType::Vector3, [&](const unsigned int i) -> Real* { return &m_omega[i][0]; } });
@@ -78,7 +80,7 @@ void Viscosity_Peer2016::initParameters()
 	rparam->setMinValue(1e-6);
 }
 
-void Viscosity_Peer2016::matrixVecProdV(const Real* vec, Real *result, void *userData)
+void Viscosity_Peer2016::matrixVecProdV(const SolverReal* vec, SolverReal *result, void *userData)
 {
 	Simulation *sim = Simulation::getCurrent();
 	FluidModel *model = (FluidModel*)userData;
@@ -108,12 +110,12 @@ void Viscosity_Peer2016::matrixVecProdV(const Real* vec, Real *result, void *use
 void Viscosity_Peer2016::diagonalMatrixElementV(const unsigned int i, Real &result, void *userData)
 {
 	// Diagonal element
-	FluidModel *model = (FluidModel*)userData;
-	Simulation *sim = Simulation::getCurrent();
-	result = model->getDensity(i) - model->getMass(i) * sim->W_zero();
+	Viscosity_Peer2016 *visco = (Viscosity_Peer2016*)userData;
+	FluidModel *model = visco->getModel();
+	result = model->getDensity(i) - model->getMass(i) * visco->m_sim->W_zero();
 }
 
-void Viscosity_Peer2016::matrixVecProdOmega(const Real* vec, Real *result, void *userData)
+void Viscosity_Peer2016::matrixVecProdOmega(const SolverReal* vec, SolverReal *result, void *userData)
 {
 	Simulation *sim = Simulation::getCurrent();
 	FluidModel *model = (FluidModel*)userData;
@@ -156,8 +158,9 @@ void Viscosity_Peer2016::matrixVecProdOmega(const Real* vec, Real *result, void
 void Viscosity_Peer2016::diagonalMatrixElementOmega(const unsigned int i, Real &result, void *userData)
 {
 	// Diagonal element
-	Simulation *sim = Simulation::getCurrent();
-	FluidModel *model = (FluidModel*)userData;
+	Viscosity_Peer2016 *visco = (Viscosity_Peer2016*)userData;
+	Simulation *sim = visco->m_sim;
+	FluidModel *model = visco->getModel();
 	const unsigned int fluidModelIndex = model->getPointSetIndex();
 	const unsigned int nFluids = sim->numberOfFluidModels();
 
@@ -191,26 +194,27 @@ void Viscosity_Peer2016::step()
 	// Init linear system solver and preconditioner
 	//////////////////////////////////////////////////////////////////////////
 	MatrixReplacement A(m_model->numActiveParticles(), matrixVecProdV, (void*)m_model);
-	m_solverV.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElementV, (void*)m_model);
+	m_sim = sim;
+	m_solverV.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElementV, (void*)this);
 	m_solverV.setTolerance(m_maxErrorV);
 	m_solverV.setMaxIterations(m_maxIterV);
 	m_solverV.compute(A);
 
 	MatrixReplacement A2(m_model->numActiveParticles(), matrixVecProdOmega, (void*)m_model);
-	m_solverOmega.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElementOmega, (void*)m_model);
+	m_solverOmega.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElementOmega, (void*)this);
 	m_solverOmega.setTolerance(m_maxErrorOmega);
 	m_solverOmega.setMaxIterations(m_maxIterOmega);
 	m_solverOmega.compute(A2);
 
-	VectorXr b0(numParticles);
-	VectorXr b1(numParticles);
-	VectorXr b2(numParticles);
-	VectorXr x0(numParticles);
-	VectorXr x1(numParticles);
-	VectorXr x2(numParticles);
-	VectorXr g0(numParticles);
-	VectorXr g1(numParticles);
-	VectorXr g2(numParticles);
+	VectorXs b0(numParticles);
+	VectorXs b1(numParticles);
+	VectorXs b2(numParticles);
+	VectorXs x0(numParticles);
+	VectorXs x1(numParticles);
+	VectorXs x2(numParticles);
+	VectorXs g0(numParticles);
+	VectorXs g1(numParticles);
+	VectorXs g2(numParticles);
 
 
 	#pragma omp parallel default(shared)
@@ -425,3 +429,9 @@ void Viscosity_Peer2016::reset()
 void Viscosity_Peer2016::performNeighborhoodSearchSort()
 {
 }
+
+size_t Viscosity_Peer2016::getMemoryUsage() const
+{
+	return vectorMemory(m_targetNablaV) +
+		vectorMemory(m_omega);
+}
@@ -9,6 +9,8 @@
 
 namespace SPH
 {
+	class Simulation;
+
 	/** \brief This class implements the implicit simulation method for
 	* viscous fluids introduced
 	* by Peer and Teschner \cite Peer2016.
@@ -27,6 +29,10 @@ namespace SPH
 		Real m_maxErrorV;
 		unsigned int m_maxIterOmega;
 		Real m_maxErrorOmega;
+		/** Simulation of the current step. The preconditioner calls the diagonal element functions 
+		* on the OpenMP worker threads which have no current simulation. 
+		*/
+		Simulation *m_sim;
 
 		virtual void initParameters();
 
@@ -41,15 +47,17 @@ namespace SPH
 		Viscosity_Peer2016(FluidModel *model);
 		virtual ~Viscosity_Peer2016(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
 		virtual void performNeighborhoodSearchSort();
 
-		static void matrixVecProdV(const Real* vec, Real *result, void *userData);
+		static void matrixVecProdV(const SolverReal* vec, SolverReal *result, void *userData);
 		FORCE_INLINE static void diagonalMatrixElementV(const unsigned int row, Real &result, void *userData);
 
-		static void matrixVecProdOmega(const Real* vec, Real *result, void *userData);
+		static void matrixVecProdOmega(const SolverReal* vec, SolverReal *result, void *userData);
 		FORCE_INLINE static void diagonalMatrixElementOmega(const unsigned int row, Real &result, void *userData);
 
 		FORCE_INLINE const Matrix3r& getTargetNablaV(const unsigned int i) const
@@ -4,6 +4,7 @@
 #include "SPlisHSPlasH/Common.h"
 #include "SPlisHSPlasH/FluidModel.h"
 #include "ViscosityBase.h"
+#include "SPlisHSPlasH/NonPressureForceFusion.h"
 
 namespace SPH
 {
@@ -15,6 +16,41 @@ namespace SPH
 	class Viscosity_Standard : public ViscosityBase
 	{
 	public:
+		/** Term of the method for the fused neighbor pass (see NonPressureForceFusion). */
+		struct FusedTerm : public NoFusedTerm
+		{
+			static const bool usesFluidNeighbors = true;
+
+			Simulation *m_sim;
+			FluidModel *m_model;
+			Real m_viscosity;
+			Real m_h2;
+			Real m_d;
+			Vector3r m_vi;
+			Vector3r m_ai;
+
+			FusedTerm(Viscosity_Standard *visco);
+
+			FORCE_INLINE void beginParticle(const unsigned int i, const Vector3r &xi)
+			{
+				m_vi = m_model->getVelocity(i);
+				m_ai.setZero();
+			}
+
+			FORCE_INLINE void fluidNeighbor(const unsigned int pid, FluidModel *fm_neighbor, const unsigned int neighborIndex, const Vector3r &xi, const Vector3r &xj)
+			{
+				const Vector3r &vj = fm_neighbor->getVelocity(neighborIndex);
+				const Real density_j = fm_neighbor->getDensity(neighborIndex);
+				const Vector3r xixj = xi - xj;
+				m_ai += m_d * m_viscosity * (fm_neighbor->getMass(neighborIndex) / density_j) * (m_vi - vj).dot(xixj) / (xixj.squaredNorm() + 0.01*m_h2) * m_sim->gradW(xixj);
+			}
+
+			FORCE_INLINE void endParticle(const unsigned int i, Vector3r &ai)
+			{
+				ai += m_ai;
+			}
+		};
+
 		Viscosity_Standard(FluidModel *model);
 		virtual ~Viscosity_Standard(void);
 
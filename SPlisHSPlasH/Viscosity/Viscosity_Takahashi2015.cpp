@@ -1,4 +1,5 @@
 #include "Viscosity_Takahashi2015.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/TimeManager.h"
 #include "Utilities/Timing.h"
 #include "Utilities/Counting.h"
@@ -55,7 +56,7 @@ void Viscosity_Takahashi2015::initParameters()
 	rparam->setMinValue(1e-6);
 }
 
-void Viscosity_Takahashi2015::matrixVecProd(const Real* vec, Real *result, void *userData)
+void Viscosity_Takahashi2015::matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData)
 {
 	Viscosity_Takahashi2015 *visco = (Viscosity_Takahashi2015*)userData;
 	FluidModel *model = visco->getModel();
@@ -77,7 +78,7 @@ void Viscosity_Takahashi2015::matrixVecProd(const Real* vec, Real *result, void
 	}
 }
 
-void Viscosity_Takahashi2015::computeViscosityAcceleration(Viscosity_Takahashi2015 *visco, const Real* v)
+void Viscosity_Takahashi2015::computeViscosityAcceleration(Viscosity_Takahashi2015 *visco, const SolverReal* v)
 {
 	Simulation *sim = Simulation::getCurrent();
 	FluidModel *model = visco->getModel();
@@ -90,7 +91,7 @@ void Viscosity_Takahashi2015::computeViscosityAcceleration(Viscosity_Takahashi20
 		for (int i = 0; i < (int)numParticles; i++)
 		{
 			const Vector3r &xi = model->getPosition(i);
-			const Vector3r &vi = Eigen::Map<const Vector3r>(&v[3*i]);
+			const Vector3r &vi = Eigen::Map<const Vector3s>(&v[3*i]).cast<Real>();
 			const Real density_i = model->getDensity(i);
 
 			Matrix3r nablaV;
@@ -100,7 +101,7 @@ void Viscosity_Takahashi2015::computeViscosityAcceleration(Viscosity_Takahashi20
 			// Fluid
 			//////////////////////////////////////////////////////////////////////////
 			forall_fluid_neighbors_in_same_phase(
-				const Vector3r &vj = Eigen::Map<const Vector3r>(&v[3 * neighborIndex]);
+				const Vector3r &vj = Eigen::Map<const Vector3s>(&v[3 * neighborIndex]).cast<Real>();
 				const Vector3r gradW = sim->gradW(xi - xj);
 
 				const Matrix3r dyad = (vj - vi) * gradW.transpose();
@@ -152,8 +153,8 @@ void Viscosity_Takahashi2015::step()
 	m_solver.setMaxIterations(m_maxIter);
 	m_solver.compute(A);
 
-	VectorXr b(3*numParticles);
-	VectorXr x(3*numParticles);
+	VectorXs b(3*numParticles);
+	VectorXs x(3*numParticles);
 	x.setZero();
 
 	//////////////////////////////////////////////////////////////////////////
@@ -229,3 +230,9 @@ void Viscosity_Takahashi2015::reset()
 void Viscosity_Takahashi2015::performNeighborhoodSearchSort()
 {
 }
+
+size_t Viscosity_Takahashi2015::getMemoryUsage() const
+{
+	return vectorMemory(m_accel) +
+		vectorMemory(m_viscousStress);
+}
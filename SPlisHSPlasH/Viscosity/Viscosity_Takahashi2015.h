@@ -30,7 +30,7 @@ namespace SPH
 		Real m_maxError;
 
 		virtual void initParameters();
-		static void computeViscosityAcceleration(Viscosity_Takahashi2015 *visco, const Real* v);
+		static void computeViscosityAcceleration(Viscosity_Takahashi2015 *visco, const SolverReal* v);
 
 	public:
 		static int ITERATIONS;
@@ -40,12 +40,14 @@ namespace SPH
 		Viscosity_Takahashi2015(FluidModel *model);
 		virtual ~Viscosity_Takahashi2015(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
 		virtual void performNeighborhoodSearchSort();
 
-		static void matrixVecProd(const Real* vec, Real *result, void *userData);
+		static void matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData);
 		FORCE_INLINE static void diagonalMatrixElement(const unsigned int row, Real &result, void *userData);
 
 		FORCE_INLINE const Matrix3r& getViscousStress(const unsigned int i) const
@@ -1,4 +1,5 @@
 #include "Viscosity_Weiler2018.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/TimeManager.h"
 #include "Utilities/Timing.h"
 #include "Utilities/Counting.h"
@@ -19,6 +20,8 @@ Viscosity_Weiler2018::Viscosity_Weiler2018(FluidModel *model) :
 	m_maxError = 0.01;
 	m_iterations = 0;
 	m_boundaryViscosity = 0.0;
+	m_sim = nullptr;
+	m_dt = 0.0;
 
 	m_vDiff.resize(model->numParticles(), Vector3r::Zero());
 
@@ -59,7 +62,7 @@ void Viscosity_Weiler2018::initParameters()
 	rparam->setMinValue(1e-6);
 }
 
-void Viscosity_Weiler2018::matrixVecProd(const Real* vec, Real *result, void *userData)
+void Viscosity_Weiler2018::matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData)
 {
 	Simulation *sim = Simulation::getCurrent();
 	Viscosity_Weiler2018 *visco = (Viscosity_Weiler2018*)userData;
@@ -88,7 +91,7 @@ void Viscosity_Weiler2018::matrixVecProd(const Real* vec, Real *result, void *us
 			Vector3r ai;
 			ai.setZero();
 			const Real density_i = model->getDensity(i);
-			const Vector3r &vi = Eigen::Map<const Vector3r>(&vec[3 * i]);
+			const Vector3r &vi = Eigen::Map<const Vector3s>(&vec[3 * i]).cast<Real>();
 
 			//////////////////////////////////////////////////////////////////////////
 			// Fluid
@@ -97,7 +100,7 @@ void Viscosity_Weiler2018::matrixVecProd(const Real* vec, Real *result, void *us
 				const Real density_j = model->getDensity(neighborIndex);
 				const Vector3r gradW = sim->gradW(xi - xj);
 
-				const Vector3r &vj = Eigen::Map<const Vector3r>(&vec[3 * neighborIndex]);
+				const Vector3r &vj = Eigen::Map<const Vector3s>(&vec[3 * neighborIndex]).cast<Real>();
 				const Vector3r xixj = xi - xj;
 
 				ai += d * mu * (model->getMass(neighborIndex) / density_j) * (vi - vj).dot(xixj) / (xixj.squaredNorm() + 0.01*h2) * gradW;
@@ -129,8 +132,8 @@ void Viscosity_Weiler2018::matrixVecProd(const Real* vec, Real *result, void *us
 void Viscosity_Weiler2018::diagonalMatrixElement(const unsigned int i, Matrix3r &result, void *userData)
 {
 	// Diagonal element
-	Simulation *sim = Simulation::getCurrent();
 	Viscosity_Weiler2018 *visco = (Viscosity_Weiler2018*)userData;
+	Simulation *sim = visco->m_sim;
 	FluidModel *model = visco->getModel();
 	const unsigned int nFluids = sim->numberOfFluidModels();
 	const unsigned int fluidModelIndex = model->getPointSetIndex();
@@ -142,7 +145,7 @@ void Viscosity_Weiler2018::diagonalMatrixElement(const unsigned int i, Matrix3r
 
 	const Real h = sim->getSupportRadius();
 	const Real h2 = h*h;
-	const Real dt = TimeManager::getCurrent()->getTimeStepSize();
+	const Real dt = visco->m_dt;
 	const Real mu = visco->m_viscosity;
 	const Real mub = visco->m_boundaryViscosity;
 
@@ -181,11 +184,12 @@ void Viscosity_Weiler2018::diagonalMatrixElement(const unsigned int i, Vector3r
 {
 	// Diagonal element
 	Viscosity_Weiler2018 *visco = (Viscosity_Weiler2018*)userData;
+	Simulation *sim = visco->m_sim;
 	FluidModel *model = visco->getModel();
 
 	const Real h = model->getSupportRadius();
 	const Real h2 = h*h;
-	const Real dt = TimeManager::getCurrent()->getTimeStepSize();
+	const Real dt = visco->m_dt;
 	const Real mu = visco->m_viscosity;
 	const Real mub = visco->m_boundaryViscosity;
 	const unsigned int nFluids = sim->numberOfFluidModels();
@@ -243,15 +247,17 @@ void Viscosity_Weiler2018::step()
 	// Init linear system solver and preconditioner
 	//////////////////////////////////////////////////////////////////////////
 	MatrixReplacement A(3*m_model->numActiveParticles(), matrixVecProd, (void*) this);
+	m_sim = Simulation::getCurrent();
+	m_dt = h;
 	m_solver.preconditioner().init(m_model->numActiveParticles(), diagonalMatrixElement, (void*)this);
 
 	m_solver.setTolerance(m_maxError);
 	m_solver.setMaxIterations(m_maxIter);
 	m_solver.compute(A);
 
-	VectorXr b(3*numParticles);
-	VectorXr x(3*numParticles);
-	VectorXr g(3*numParticles);
+	VectorXs b(3*numParticles);
+	VectorXs x(3*numParticles);
+	VectorXs g(3*numParticles);
 
 	//////////////////////////////////////////////////////////////////////////
 	// Compute RHS
@@ -303,3 +309,8 @@ void Viscosity_Weiler2018::reset()
 void Viscosity_Weiler2018::performNeighborhoodSearchSort()
 {
 }
+
+size_t Viscosity_Weiler2018::getMemoryUsage() const
+{
+	return vectorMemory(m_vDiff);
+}
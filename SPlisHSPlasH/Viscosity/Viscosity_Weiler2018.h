@@ -10,6 +10,8 @@
 
 namespace SPH
 {
+	class Simulation;
+
 	/** \brief This class implements the implicit Laplace viscosity method introduced 
 	* by Weiler et al. 2018 \cite Weiler2018.
 	*/
@@ -21,6 +23,11 @@ namespace SPH
 		Real m_maxError;
 		unsigned int m_iterations;
 		std::vector<Vector3r> m_vDiff;
+		/** Simulation and time step size of the current step. The preconditioner calls 
+		* diagonalMatrixElement() on the OpenMP worker threads which have no current simulation. 
+		*/
+		Simulation *m_sim;
+		Real m_dt;
 
 #ifdef USE_BLOCKDIAGONAL_PRECONDITIONER
 		typedef Eigen::ConjugateGradient<MatrixReplacement, Eigen::Lower | Eigen::Upper, BlockJacobiPreconditioner3D> Solver;
@@ -43,12 +50,14 @@ namespace SPH
 		Viscosity_Weiler2018(FluidModel *model);
 		virtual ~Viscosity_Weiler2018(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
 		virtual void performNeighborhoodSearchSort();
 
-		static void matrixVecProd(const Real* vec, Real *result, void *userData);
+		static void matrixVecProd(const SolverReal* vec, SolverReal *result, void *userData);
 	};
 }
 
@@ -1,4 +1,5 @@
 #include "MicropolarModel_Bender2017.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include <iostream>
 #include "../TimeManager.h"
 #include "../Simulation.h"
@@ -174,3 +175,8 @@ void SPH::MicropolarModel_Bender2017::performNeighborhoodSearchSort()
 	d.sort_field(&m_omega[0]);
 }
 
+size_t MicropolarModel_Bender2017::getMemoryUsage() const
+{
+	return vectorMemory(m_angularAcceleration) +
+		vectorMemory(m_omega);
+}
@@ -27,6 +27,8 @@ namespace SPH
 		MicropolarModel_Bender2017(FluidModel *model);
 		virtual ~MicropolarModel_Bender2017(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
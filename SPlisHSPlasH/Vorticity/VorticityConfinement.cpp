@@ -1,4 +1,5 @@
 #include "VorticityConfinement.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include <iostream>
 #include "../TimeManager.h"
 #include "../Simulation.h"
@@ -101,3 +102,8 @@ void VorticityConfinement::performNeighborhoodSearchSort()
 {
 }
 
+size_t VorticityConfinement::getMemoryUsage() const
+{
+	return vectorMemory(m_omega) +
+		vectorMemory(m_normOmega);
+}
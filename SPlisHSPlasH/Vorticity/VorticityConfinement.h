@@ -20,6 +20,8 @@ namespace SPH
 		VorticityConfinement(FluidModel *model);
 		virtual ~VorticityConfinement(void);
 
+		virtual size_t getMemoryUsage() const;
+
 		virtual void step();
 		virtual void reset();
 
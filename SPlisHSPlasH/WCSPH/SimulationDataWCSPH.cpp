@@ -1,4 +1,5 @@
 #include "SimulationDataWCSPH.h"
+#include "SPlisHSPlasH/Utilities/MemoryUsage.h"
 #include "SPlisHSPlasH/SPHKernels.h"
 #include "../Simulation.h"
 
@@ -77,4 +78,10 @@ void SimulationDataWCSPH::emittedParticles(FluidModel *model, const unsigned int
 		m_pressure[fluidModelIndex][j] = 0.0;
 		m_pressureAccel[fluidModelIndex][j].setZero();
 	}
+}
+
+size_t SimulationDataWCSPH::getMemoryUsage() const
+{
+	return vectorMemory(m_pressure) +
+		vectorMemory(m_pressureAccel);
 }
\ No newline at end of file
@@ -98,6 +98,7 @@ void TimeStepWCSPH::step()
 
 	sim->updateTimeStepSize();
 	const Real h = tm->getTimeStepSize();
+	const bool sim2D = sim->is2DSimulation();
 
 	for (unsigned int fluidModelIndex = 0; fluidModelIndex < nModels; fluidModelIndex++)
 	{
@@ -116,6 +117,8 @@ void TimeStepWCSPH::step()
 					vel += accel * h;
 					pos += vel * h;
 				}
+				if (sim2D)
+					projectTo2D(model, i);
 			}
 		}
 	}
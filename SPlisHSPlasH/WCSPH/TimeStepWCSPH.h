@@ -39,6 +39,8 @@ namespace SPH
 		TimeStepWCSPH();
 		virtual ~TimeStepWCSPH(void);
 
+		virtual size_t getMemoryUsage() const { return m_simulationData.getMemoryUsage(); }
+
 		virtual void step();
 		virtual void reset();
 		virtual void resize();
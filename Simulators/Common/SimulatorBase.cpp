@@ -45,6 +45,7 @@ int SimulatorBase::STOP_AT = -1;
 int SimulatorBase::NUM_STEPS_PER_RENDER = -1;
 int SimulatorBase::PARTIO_EXPORT = -1;
 int SimulatorBase::VTK_EXPORT = -1;
+int SimulatorBase::PARTICLE_CACHE_EXPORT = -1;
 int SimulatorBase::RB_EXPORT = -1;
 int SimulatorBase::PARTICLE_EXPORT_FPS = -1;
 int SimulatorBase::PARTICLE_EXPORT_ATTRIBUTES = -1;
@@ -70,6 +71,7 @@ SimulatorBase::SimulatorBase()
 	m_useGUI = true;
 	m_enablePartioExport = false;
 	m_enableVTKExport = false;
+	m_enableParticleCacheExport = false;
 	m_enableRigidBodyExport = false;
 	m_framesPerSecond = 25;
 	m_nextFrameTime = 0.0;
@@ -130,6 +132,10 @@ void SimulatorBase::initParameters()
 	setGroup(VTK_EXPORT, "Export");
 	setDescription(VTK_EXPORT, "Enable/disable VTK export.");
 
+	PARTICLE_CACHE_EXPORT = createBoolParameter("enableParticleCacheExport", "Particle cache export", &m_enableParticleCacheExport);
+	setGroup(PARTICLE_CACHE_EXPORT, "Export");
+	setDescription(PARTICLE_CACHE_EXPORT, "Enable/disable export of all frames in a compressed particle cache file per fluid model (positions, velocities and ids).");
+
 	RB_EXPORT = createBoolParameter("enableRigidBodyExport", "Rigid body export", &m_enableRigidBodyExport);
 	setGroup(RB_EXPORT, "Export");
 	setDescription(RB_EXPORT, "Enable/disable rigid body export.");
@@ -150,6 +156,12 @@ void SimulatorBase::init(int argc, char **argv, const char *simName)
 	m_exePath = FileSystem::getProgramPath();
 	m_dataPath = FileSystem::normalizePath(getExePath() + "/" + std::string(SPH_DATA_PATH));
 	setUseParticleCaching(true);
+	bool asyncLogging = false;
+#ifdef USE_PERF_COUNTERS
+	bool perfCounters = false;
+#endif
+	std::string cachePath = "";
+	unsigned int cacheSize = 0;
 
 	try
 	{
@@ -161,10 +173,17 @@ void SimulatorBase::init(int argc, char **argv, const char *simName)
 		options.add_options()
 			("h,help", "Print help")
 			("no-cache", "Disable caching of boundary samples/maps.")	
+			("cache-dir", "Directory of the preprocessing cache (default: Cache directory of the scene).", cxxopts::value<std::string>())
+			("cache-size", "Size budget of the preprocessing cache in MB, the least recently used entries are removed (default: 0 = unlimited).", cxxopts::value<unsigned int>())
 			("data-path", "Path of the data directory.", cxxopts::value<std::string>())
 			("output-dir", "Output directory for log file and partio files.", cxxopts::value<std::string>())
 			("no-initial-pause", "Disable caching of boundary samples/maps.")
 			("no-gui", "Disable GUI.")
+			("async-log", "Write log messages in a background thread.")
+			("profile", "Record all time measurements and export them as Chrome trace and CSV file (output directory).")
+#ifdef USE_PERF_COUNTERS
+			("perf-counters", "Measure hardware performance counters (cycles, instructions, LLC misses, branch misses) for all time measurements.")
+#endif
 			;
 
 		options.add_options("invisible")
@@ -184,11 +203,38 @@ void SimulatorBase::init(int argc, char **argv, const char *simName)
 			setUseParticleCaching(false);
 		}
 
+		if (result.count("cache-dir"))
+		{
+			cachePath = result["cache-dir"].as<std::string>();
+		}
+
+		if (result.count("cache-size"))
+		{
+			cacheSize = result["cache-size"].as<unsigned int>();
+		}
+
 		if (result.count("no-gui"))
 		{
 			setUseGUI(false);
 		}
 
+		if (result.count("async-log"))
+		{
+			asyncLogging = true;
+		}
+
+		if (result.count("profile"))
+		{
+			Timing::enableProfiling();
+		}
+
+#ifdef USE_PERF_COUNTERS
+		if (result.count("perf-counters"))
+		{
+			perfCounters = true;
+		}
+#endif
+
 		m_dataPath = FileSystem::normalizePath(getExePath() + "/" + std::string(SPH_DATA_PATH));
 		if (result.count("data-path"))
 		{
@@ -244,6 +290,12 @@ void SimulatorBase::init(int argc, char **argv, const char *simName)
 	std::string logPath = FileSystem::normalizePath(m_outputPath + "/log");
 	FileSystem::makeDirs(logPath);
 	Utilities::logger.addSink(unique_ptr<Utilities::FileSink>(new Utilities::FileSink(Utilities::LogLevel::DEBUG, logPath + "/SPH_log.txt")));
+	if (asyncLogging)
+		Utilities::logger.activateAsyncMode();
+#ifdef USE_PERF_COUNTERS
+	if (perfCounters)
+		Timing::enablePerfCounters();
+#endif
 
 	LOG_DEBUG << "Git refspec: " << GIT_REFSPEC;
 	LOG_DEBUG << "Git SHA1:    " << GIT_SHA1;
@@ -260,6 +312,14 @@ void SimulatorBase::init(int argc, char **argv, const char *simName)
 	else
 		return;
 
+	if (getUseParticleCaching())
+	{
+		if (cachePath == "")
+			cachePath = FileSystem::getFilePath(m_sceneFile) + "/Cache";
+		m_preprocessingCache.init(cachePath, (unsigned long long) cacheSize * 1024ull * 1024ull);
+		LOG_INFO << "Preprocessing cache: " << m_preprocessingCache.getPath();
+	}
+
 	// OpenGL
 	if (getUseGUI())
 	{
@@ -281,6 +341,24 @@ void SimulatorBase::init(int argc, char **argv, const char *simName)
 
 void SimulatorBase::cleanup()
 {
+	if (Timing::isProfiling())
+	{
+		std::string profilePath = FileSystem::normalizePath(m_outputPath + "/profile");
+		FileSystem::makeDirs(profilePath);
+		Timing::writeChromeTrace(profilePath + "/trace.json");
+		Timing::writeStepCSV(profilePath + "/steps.csv");
+		LOG_INFO << "Profiling data written to " << profilePath;
+	}
+#ifdef USE_PERF_COUNTERS
+	if (Timing::isPerfCountersEnabled())
+	{
+		std::string profilePath = FileSystem::normalizePath(m_outputPath + "/profile");
+		FileSystem::makeDirs(profilePath);
+		Timing::writePerfCounterCSV(profilePath + "/perf_counters.csv");
+		LOG_INFO << "Hardware counters written to " << profilePath;
+	}
+#endif
+
 	for (unsigned int i = 0; i < m_scene.boundaryModels.size(); i++)
 		delete m_scene.boundaryModels[i];
 	m_scene.boundaryModels.clear();
@@ -479,6 +557,8 @@ void SimulatorBase::buildModel()
 	createAnimationFields();
 
 	Simulation *sim = Simulation::getCurrent();
+	if (m_preprocessingCache.isEnabled())
+		sim->setBoundaryVolumeCacheCallbacks([&]() { return loadBoundaryVolume(); }, [&]() { storeBoundaryVolume(); });
 
 	if (sim->getTimeStep())
 		sim->getTimeStep()->resize();
@@ -565,10 +645,6 @@ void SimulatorBase::initFluidData()
 
 	std::string base_path = FileSystem::getFilePath(m_sceneFile);
 
-	const bool useCache = getUseParticleCaching();
-	std::string scene_path = FileSystem::getFilePath(getSceneFile());
-	string cachePath = scene_path + "/Cache";
-
 	unsigned int startIndex = 0;
 	unsigned int endIndex = 0;
 	for (unsigned int i = 0; i < m_scene.fluidModels.size(); i++)
@@ -585,69 +661,76 @@ void SimulatorBase::initFluidData()
 		transform(ext.begin(), ext.end(), ext.begin(), ::toupper);
 		if (ext == "OBJ")
 		{
-			// check if mesh file has changed
-			std::string md5FileName = FileSystem::normalizePath(cachePath + "/" + FileSystem::getFileNameWithExt(fileName) + "_fluid.md5");
-			bool md5 = false;
-			if (useCache)
-			{
-				string md5Str = FileSystem::getFileMD5(fileName);
-				if (FileSystem::fileExists(md5FileName))
-					md5 = FileSystem::checkMD5(md5Str, md5FileName);
-			}
-
-			// Cache sampling
-			std::string mesh_base_path = FileSystem::getFilePath(fileName);
-			std::string mesh_file_name = FileSystem::getFileName(fileName);
-
-			std::string mode = to_string(m_scene.fluidModels[i]->mode);
-			const string scaleStr = real2String(m_scene.fluidModels[i]->scale[0]) + "_" + real2String(m_scene.fluidModels[i]->scale[1]) + "_" + real2String(m_scene.fluidModels[i]->scale[2]);
-			const string resStr = real2String(m_scene.fluidModels[i]->resolutionSDF[0]) + "_" + real2String(m_scene.fluidModels[i]->resolutionSDF[1]) + "_" + real2String(m_scene.fluidModels[i]->resolutionSDF[2]);
-			const string particleFileName = FileSystem::normalizePath(cachePath + "/" + mesh_file_name + "_fluid_" + real2String(m_scene.particleRadius) + "_m" + mode + "_s" + scaleStr + "_r" + resStr + ".bgeo");
-
-			// check MD5 if cache file is available
+			const bool invert = m_scene.fluidModels[i]->invert;
+			const int mode = m_scene.fluidModels[i]->mode;
+			const Vector3r &scale = m_scene.fluidModels[i]->scale;
+			const std::array<unsigned int, 3> &resolutionSDF = m_scene.fluidModels[i]->resolutionSDF;
+
+			// the SDF does not depend on the particle radius and the sampling mode
+			const std::string sdfParams = real2String(scale[0]) + " " + real2String(scale[1]) + " " + real2String(scale[2]) + " " +
+				std::to_string(resolutionSDF[0]) + " " + std::to_string(resolutionSDF[1]) + " " + std::to_string(resolutionSDF[2]) + " " + std::to_string(invert);
+			const std::string samplesParams = sdfParams + " " + real2String(m_scene.particleRadius) + " " + std::to_string(mode);
+			std::string samplesKey, samplesFileName;
 			bool foundCacheFile = false;
-
-			if (useCache)
-				foundCacheFile = FileSystem::fileExists(particleFileName);
-
-			if (useCache && foundCacheFile && md5)
+			std::vector<Vector3r> samples;
+			if (m_preprocessingCache.isEnabled())
 			{
-				PartioReaderWriter::readParticles(particleFileName, m_scene.fluidModels[i]->translation, m_scene.fluidModels[i]->rotation, 1.0, fluidParticles[fluidIndex], fluidVelocities[fluidIndex]);
-				LOG_INFO << "Loaded cached fluid sampling: " << particleFileName;
+				samplesKey = m_preprocessingCache.getKey("fluid_samples", { fileName }, samplesParams);
+				if (m_preprocessingCache.find(samplesKey, "bgeo", samplesFileName))
+				{
+					foundCacheFile = PartioReaderWriter::readParticles(samplesFileName, Vector3r::Zero(), Matrix3r::Identity(), 1.0, samples);
+					if (foundCacheFile)
+						LOG_INFO << "Loaded cached fluid sampling: " << samplesFileName;
+					else
+						samples.clear();
+				}
 			}
 
-			if (!useCache || !foundCacheFile || !md5)
+			if (!foundCacheFile)
 			{
 				LOG_INFO << "Volume sampling of " << fileName;
 
 				TriangleMesh mesh;
-				loadObj(fileName, mesh, m_scene.fluidModels[i]->scale);
-
-				bool invert = m_scene.fluidModels[i]->invert;
-				int mode = m_scene.fluidModels[i]->mode;
-				std::array<unsigned int, 3> resolutionSDF = m_scene.fluidModels[i]->resolutionSDF;
+				loadObj(fileName, mesh, scale);
 
 				LOG_INFO << "SDF resolution: " << resolutionSDF[0] << ", " << resolutionSDF[1] << ", " << resolutionSDF[2];
-					
+
+				// the SDF is loaded from the cache or written to a temporary file which is moved to the cache
+				std::string sdfKey, sdfFileName;
+				bool foundSDF = false;
+				if (m_preprocessingCache.isEnabled())
+				{
+					sdfKey = m_preprocessingCache.getKey("fluid_sdf", { fileName }, sdfParams);
+					foundSDF = m_preprocessingCache.find(sdfKey, "cdf", sdfFileName);
+					if (!foundSDF)
+						sdfFileName = m_preprocessingCache.beginWrite(sdfKey, "cdf");
+				}
+
 				START_TIMING("Volume sampling");
 				Utilities::VolumeSampling::sampleMesh(mesh.numVertices(), mesh.getVertices().data(), mesh.numFaces(), mesh.getFaces().data(),
-					m_scene.particleRadius, nullptr, resolutionSDF, invert, mode, fluidParticles[fluidIndex]);
+					m_scene.particleRadius, nullptr, resolutionSDF, invert, mode, samples, sdfFileName);
 				STOP_TIMING_AVG;
 
-				fluidVelocities[fluidIndex].resize(fluidParticles[fluidIndex].size(), m_scene.fluidModels[i]->initialVelocity);
-
 				// Cache sampling
-				if (useCache && (FileSystem::makeDir(cachePath) == 0))
+				if (m_preprocessingCache.isEnabled())
 				{
-					LOG_INFO << "Save particle sampling: " << particleFileName;
-					PartioReaderWriter::writeParticles(particleFileName, (unsigned int)fluidParticles[fluidIndex].size(), fluidParticles[fluidIndex].data(), fluidVelocities[fluidIndex].data(), 0.0);
-					FileSystem::writeMD5File(fileName, md5FileName);
-				}
+					if (!foundSDF)
+						m_preprocessingCache.endWrite(sdfFileName, sdfKey, "cdf");
 
-				// transform particles
-				for (unsigned int j = 0; j < (unsigned int)fluidParticles[fluidIndex].size(); j++)
-					fluidParticles[fluidIndex][j] = m_scene.fluidModels[i]->rotation * fluidParticles[fluidIndex][j] + m_scene.fluidModels[i]->translation;
+					const std::string tmpFileName = m_preprocessingCache.beginWrite(samplesKey, "bgeo");
+					LOG_INFO << "Save particle sampling: " << m_preprocessingCache.getFileName(samplesKey, "bgeo");
+					PartioReaderWriter::writeParticles(tmpFileName, (unsigned int)samples.size(), samples.data(), nullptr, 0.0);
+					m_preprocessingCache.endWrite(tmpFileName, samplesKey, "bgeo");
+				}
 			}
+
+			// transform particles, the samples are appended since several blocks can belong to the same fluid model
+			std::vector<Vector3r> &particles = fluidParticles[fluidIndex];
+			const unsigned int offset = (unsigned int)particles.size();
+			particles.resize(offset + samples.size());
+			for (unsigned int j = 0; j < (unsigned int)samples.size(); j++)
+				particles[offset + j] = m_scene.fluidModels[i]->rotation * samples[j] + m_scene.fluidModels[i]->translation;
+			fluidVelocities[fluidIndex].resize(particles.size(), m_scene.fluidModels[i]->initialVelocity);
 		}
 		else
 		{
@@ -675,6 +758,87 @@ void SimulatorBase::initFluidData()
 	LOG_INFO << "Number of fluid particles: " << nParticles;
 }
 
+std::string SimulatorBase::getBoundaryVolumeCacheKey()
+{
+	Simulation *sim = Simulation::getCurrent();
+	std::string params = real2String(sim->getParticleRadius()) + " " + real2String(sim->getSupportRadius()) + " " + 
+		std::to_string(sim->getKernel()) + " " + std::to_string(sim->is2DSimulation());
+	for (unsigned int i = 0; i < sim->numberOfBoundaryModels(); i++)
+	{
+		BoundaryModel *bm = sim->getBoundaryModel(i);
+		const unsigned int numParticles = bm->numberOfParticles();
+		// the volume of a dynamic body is computed in its local coordinate system,
+		// the static bodies see the dynamic bodies at their current positions
+		const bool isDynamic = bm->getRigidBodyObject()->isDynamic();
+		params += " " + std::to_string(isDynamic) + " " + std::to_string(bm->isBodyLocal()) + " " + std::to_string(numParticles);
+		if (numParticles > 0)
+		{
+			params += " " + PreprocessingCache::hashData(&bm->getPosition(0), numParticles * sizeof(Vector3r));
+			if (isDynamic)
+				params += " " + PreprocessingCache::hashData(&bm->getPosition0(0), numParticles * sizeof(Vector3r));
+		}
+	}
+	return m_preprocessingCache.getKey("boundary_volume", {}, params);
+}
+
+bool SimulatorBase::loadBoundaryVolume()
+{
+	std::string fileName;
+	if (!m_preprocessingCache.find(getBoundaryVolumeCacheKey(), "bin", fileName))
+		return false;
+
+	Simulation *sim = Simulation::getCurrent();
+	unsigned int numParticles = 0;
+	for (unsigned int i = 0; i < sim->numberOfBoundaryModels(); i++)
+		numParticles += sim->getBoundaryModel(i)->numberOfParticles();
+
+	std::vector<Real> volumes(numParticles);
+	std::ifstream file(fileName, std::ios::binary);
+	if (numParticles > 0)
+		file.read(reinterpret_cast<char*>(volumes.data()), numParticles * sizeof(Real));
+	if (!file)
+	{
+		LOG_WARN << "Cannot read cached boundary volumes: " << fileName;
+		return false;
+	}
+
+	unsigned int index = 0;
+	for (unsigned int i = 0; i < sim->numberOfBoundaryModels(); i++)
+	{
+		BoundaryModel *bm = sim->getBoundaryModel(i);
+		for (unsigned int j = 0; j < bm->numberOfParticles(); j++)
+			bm->setVolume(j, volumes[index++]);
+	}
+	LOG_INFO << "Loaded cached boundary volumes: " << fileName;
+	return true;
+}
+
+void SimulatorBase::storeBoundaryVolume()
+{
+	const std::string key = getBoundaryVolumeCacheKey();
+	const std::string tmpFileName = m_preprocessingCache.beginWrite(key, "bin");
+
+	Simulation *sim = Simulation::getCurrent();
+	std::vector<Real> volumes;
+	for (unsigned int i = 0; i < sim->numberOfBoundaryModels(); i++)
+	{
+		BoundaryModel *bm = sim->getBoundaryModel(i);
+		for (unsigned int j = 0; j < bm->numberOfParticles(); j++)
+			volumes.push_back(bm->getVolume(j));
+	}
+
+	std::ofstream file(tmpFileName, std::ios::binary);
+	if (volumes.size() > 0)
+		file.write(reinterpret_cast<const char*>(volumes.data()), volumes.size() * sizeof(Real));
+	file.close();
+	if (file.fail())
+	{
+		remove(tmpFileName.c_str());
+		return;
+	}
+	m_preprocessingCache.endWrite(tmpFileName, key, "bin");
+}
+
 void SimulatorBase::createEmitters()
 {
 	Simulation *sim = Simulation::getCurrent();
@@ -1179,10 +1343,13 @@ void SimulatorBase::particleExport()
 {	
 	std::string partioExportPath = FileSystem::normalizePath(m_outputPath + "/partio");
 	std::string vtkExportPath = FileSystem::normalizePath(m_outputPath + "/vtk");
+	std::string cacheExportPath = FileSystem::normalizePath(m_outputPath + "/particle_cache");
 	if (m_enablePartioExport)
 		FileSystem::makeDirs(partioExportPath);
 	if (m_enableVTKExport)
 		FileSystem::makeDirs(vtkExportPath);
+	if (m_enableParticleCacheExport)
+		FileSystem::makeDirs(cacheExportPath);
 
 	Simulation *sim = Simulation::getCurrent();
 	for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
@@ -1201,9 +1368,37 @@ void SimulatorBase::particleExport()
 			std::string exportFileName = FileSystem::normalizePath(vtkExportPath + "/" + fileName);
 			writeParticlesVTK(exportFileName + ".vtk", model);
 		}
+		if (m_enableParticleCacheExport)
+		{
+			std::string exportFileName = FileSystem::normalizePath(cacheExportPath + "/ParticleData_" + model->getId());
+			writeParticlesCache(exportFileName + ".sphc", i, model);
+		}
 	}
 }
 
+void SimulatorBase::writeParticlesCache(const std::string &fileName, const unsigned int fluidModelIndex, FluidModel *model)
+{
+	// one cache file per fluid model which is opened at the first exported frame
+	if (m_particleCacheWriters.size() <= fluidModelIndex)
+		m_particleCacheWriters.resize(fluidModelIndex + 1);
+	std::unique_ptr<ParticleCacheWriter> &writer = m_particleCacheWriters[fluidModelIndex];
+	if (!writer)
+	{
+		writer.reset(new ParticleCacheWriter());
+		if (!writer->open(fileName))
+			return;
+	}
+	if (!writer->isOpen())
+		return;
+
+	const unsigned int numParticles = model->numActiveParticles();
+	const Real time = TimeManager::getCurrent()->getTime();
+	if (numParticles > 0)
+		writer->writeFrame(time, numParticles, &model->getPosition(0), &model->getVelocity(0), &model->getParticleId(0));
+	else
+		writer->writeFrame(time, 0, nullptr, nullptr, nullptr);
+}
+
 
 void SimulatorBase::writeParticlesPartio(const std::string &fileName, FluidModel *model)
 {
@@ -1259,41 +1454,36 @@ void SimulatorBase::writeParticlesPartio(const std::string &fileName, FluidModel
  	}
 
 	const unsigned int numParticles = model->numActiveParticles();
-
-	for (unsigned int i = 0; i < numParticles; i++)
+	if (numParticles > 0)
 	{
-		Partio::ParticleIndex index = particleData.addParticle();
-		float* pos = particleData.dataWrite<float>(posAttr, index);
-		int* id = particleData.dataWrite<int>(idAttr, index);
-
-		const Vector3r &x = model->getPosition(i);
-		pos[0] = (float)x[0];
-		pos[1] = (float)x[1];
-		pos[2] = (float)x[2];
-	
-		id[0] = model->getParticleId(i);
+		// allocate all particles at once and copy each attribute as a contiguous block
+		particleData.addParticles((int)numParticles);
 
- 		for (unsigned int j = 0; j < attributes.size(); j++)
- 		{
- 			const int fieldIndex = attrMap[j];
- 			if (fieldIndex != -1)
- 			{
- 				const FieldDescription &field = model->getField(fieldIndex);
- 				if (field.type == FieldType::Scalar)
- 				{
- 					float* val = particleData.dataWrite<float>(partioAttrMap[j], index);
- 					*val = (float) *field.getFct(i);
- 				}
- 				else if (field.type == FieldType::Vector3)
- 				{
- 					float* val = particleData.dataWrite<float>(partioAttrMap[j], index);
-					Eigen::Map<Vector3r> vec(field.getFct(i));
- 					val[0] = (float)vec[0];
- 					val[1] = (float)vec[1];
- 					val[2] = (float)vec[2];
- 				}
- 			}
- 		}
+		PartioReaderWriter::convertToFloat(&model->getPosition(0)[0], particleData.dataWrite<float>(posAttr, 0), 3 * numParticles);
+
+		int *id = particleData.dataWrite<int>(idAttr, 0);
+		#pragma omp parallel default(shared)
+		{
+			#pragma omp for schedule(static)
+			for (int i = 0; i < (int)numParticles; i++)
+				id[i] = (int)model->getParticleId(i);
+		}
+
+		for (unsigned int j = 0; j < attributes.size(); j++)
+		{
+			const int fieldIndex = attrMap[j];
+			if (fieldIndex != -1)
+			{
+				// the field data of all particles is stored contiguously (see renderFluid),
+				// so the accessor has to be evaluated only once
+				const FieldDescription &field = model->getField(fieldIndex);
+				float *val = particleData.dataWrite<float>(partioAttrMap[j], 0);
+				if (field.type == FieldType::Scalar)
+					PartioReaderWriter::convertToFloat(field.getFct(0), val, numParticles);
+				else if (field.type == FieldType::Vector3)
+					PartioReaderWriter::convertToFloat(field.getFct(0), val, 3 * numParticles);
+			}
+		}
 	}
 
 	Partio::write(fileName.c_str(), particleData, true);
@@ -1466,12 +1656,13 @@ void SimulatorBase::step()
 	if (TimeManager::getCurrent()->getTime() >= m_nextFrameTime)
 	{
 		m_nextFrameTime += static_cast<Real>(1.0) / m_framesPerSecond;
-		if (m_enablePartioExport || m_enableVTKExport)
+		if (m_enablePartioExport || m_enableVTKExport || m_enableParticleCacheExport)
 			particleExport();
 		if (m_enableRigidBodyExport)
 			rigidBodyExport();
 		m_frameCounter++;
 	}
+	Timing::finishStep();
 #ifdef DL_OUTPUT
 	if (TimeManager::getCurrent()->getTime() >= m_nextTiming)
 	{
@@ -1481,6 +1672,7 @@ void SimulatorBase::step()
 		Timing::printTimeSums();
 		Counting::printAverageCounts();
 		Counting::printCounterSums();
+		Simulation::getCurrent()->printMemoryUsage();
 		m_nextTiming += 1.0;
 	}
 #endif
@@ -1493,6 +1685,7 @@ void SimulatorBase::reset()
 	m_nextFrameTime = 0.0;
 	m_frameCounter = 1;
 	m_isFirstFrame = true;
+	m_particleCacheWriters.clear();
 #ifdef DL_OUTPUT
 	m_nextTiming = 1.0;
 #endif
@@ -9,6 +9,8 @@
 #include "extern/AntTweakBar/include/AntTweakBar.h"
 #include "ParameterObject.h"
 #include "SPlisHSPlasH/TriangleMesh.h"
+#include "Utilities/ParticleCache.h"
+#include "Utilities/PreprocessingCache.h"
 
 namespace SPH
 {
@@ -29,6 +31,7 @@ namespace SPH
 		std::string m_outputPath;
 		std::string m_sceneFile;
 		bool m_useParticleCaching;
+		Utilities::PreprocessingCache m_preprocessingCache;
 		bool m_useGUI;
 		Utilities::SceneLoader::Scene m_scene;
 		GLint m_context_major_version;
@@ -45,6 +48,7 @@ namespace SPH
 		Real m_stopAt;
 		bool m_enablePartioExport;
 		bool m_enableVTKExport;
+		bool m_enableParticleCacheExport;
 		bool m_enableRigidBodyExport;
 		unsigned int m_framesPerSecond;
 		std::string m_particleAttributes;
@@ -53,6 +57,7 @@ namespace SPH
 		std::unique_ptr<Utilities::SceneLoader> m_sceneLoader;
 		Real m_nextFrameTime;
 		unsigned int m_frameCounter;
+		std::vector<std::unique_ptr<Utilities::ParticleCacheWriter>> m_particleCacheWriters;
 		bool m_isFirstFrame;
 		std::vector<std::string> m_colorField;
 		std::vector<int> m_colorMapType;
@@ -70,7 +75,13 @@ namespace SPH
 		void initFluidData();
 		void createFluidBlocks(std::map<std::string, unsigned int> &fluidIDs, std::vector<std::vector<Vector3r>> &fluidParticles, std::vector<std::vector<Vector3r>> &fluidVelocities);
 		void createEmitters();
-		void createAnimationFields();
+
+		/** Return the cache key of the boundary volumes which depends on the
+		* boundary particles and the kernel.
+		*/
+		std::string getBoundaryVolumeCacheKey();
+		bool loadBoundaryVolume();
+		void storeBoundaryVolume();
 
 		static void selection(const Eigen::Vector2i &start, const Eigen::Vector2i &end, void *clientData);
 		static void mouseMove(int x, int y, void *clientData);
@@ -83,6 +94,7 @@ namespace SPH
 		static int NUM_STEPS_PER_RENDER;
 		static int PARTIO_EXPORT;
 		static int VTK_EXPORT;
+		static int PARTICLE_CACHE_EXPORT;
 		static int RB_EXPORT;
 		static int PARTICLE_EXPORT_FPS;
 		static int PARTICLE_EXPORT_ATTRIBUTES;
@@ -109,9 +121,12 @@ namespace SPH
 		void rigidBodyExport();
 		void writeParticlesPartio(const std::string &fileName, FluidModel *model);
 		void writeParticlesVTK(const std::string &fileName, FluidModel *model);
+		void writeParticlesCache(const std::string &fileName, const unsigned int fluidModelIndex, FluidModel *model);
 		void step();
 		void reset();
 
+		/** Add the animation fields of the scene to the current simulation. */
+		void createAnimationFields();
 		static void loadObj(const std::string &filename, TriangleMesh &mesh, const Vector3r &scale);
 
 		Utilities::SceneLoader *getSceneLoader() { return m_sceneLoader.get(); }
@@ -134,6 +149,7 @@ namespace SPH
 		std::vector<std::vector<unsigned int>>& getSelectedParticles() { return m_selectedParticles; }
 		bool getUseParticleCaching() const { return m_useParticleCaching; }
 		void setUseParticleCaching(bool val) { m_useParticleCaching = val; }
+		Utilities::PreprocessingCache &getPreprocessingCache() { return m_preprocessingCache; }
 		bool getUseGUI() const { return m_useGUI; }
 		void setUseGUI(bool val) { m_useGUI = val; }
 
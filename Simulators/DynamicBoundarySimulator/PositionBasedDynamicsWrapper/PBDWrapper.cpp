@@ -15,6 +15,9 @@
 #include "Simulation/Simulation.h"
 #include "Visualization/Visualization.h"
 #include "Simulation/TimeStepController.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 #define _USE_MATH_DEFINES
@@ -46,6 +49,16 @@ PBDWrapper::PBDWrapper()
 
 PBDWrapper::~PBDWrapper()
 {
+	waitForTimeStep();
+	if (m_stepThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stepMutex);
+			m_stopStepThread = true;
+		}
+		m_stepCondition.notify_all();
+		m_stepThread.join();
+	}
 	delete m_shader;
 	delete PBD::TimeManager::getCurrent();
 	delete m_timeStep;
@@ -58,6 +71,7 @@ void PBDWrapper::initGUI()
 	TwAddVarRW(SPH::MiniGL::getTweakBar(), "RenderStaticBodies", TW_TYPE_BOOLCPP, &m_drawStaticBodies, " label='Render static bodies' group=PBD ");
 	TwAddVarRW(SPH::MiniGL::getTweakBar(), "RenderDistanceFields", TW_TYPE_BOOLCPP, &m_drawSDF, " label='Render distance fields' group=PBD ");
 	TwAddVarRW(SPH::MiniGL::getTweakBar(), "DampingCoeff", TW_TYPE_REAL, &m_dampingCoeff, " label='Damping' group=PBD ");
+	TwAddVarRW(SPH::MiniGL::getTweakBar(), "PipelinedStep", TW_TYPE_BOOLCPP, &m_pipelinedStep, " label='Pipelined step' group=PBD help='Overlap the rigid body step with the next fluid step. The fluid uses predicted boundaries, so the coupling lags one step behind.' ");
 	TwType enumType = TwDefineEnum("VelocityUpdateMethodType", NULL, 0);
 	TwAddVarCB(SPH::MiniGL::getTweakBar(), "VelocityUpdateMethod", enumType, setVelocityUpdateMethod, getVelocityUpdateMethod, m_timeStep, " label='Velocity update method' enum='0 {First Order Update}, 1 {Second Order Update}' group=PBD");
 	TwAddVarCB(SPH::MiniGL::getTweakBar(), "MaxIter", TW_TYPE_UINT32, setMaxIterations, getMaxIterations, m_timeStep, " label='Max. iterations'  min=1 step=1 group=PBD ");
@@ -125,6 +139,7 @@ void PBDWrapper::initShader()
 
  void PBDWrapper::reset()
  {
+	waitForTimeStep();
 	m_model.reset();
 	m_timeStep->reset();
  }
@@ -132,10 +147,15 @@ void PBDWrapper::initShader()
 
  
  void PBDWrapper::timeStep()
+ {
+	timeStep(SPH::TimeManager::getCurrent()->getTimeStepSize());
+ }
+
+ void PBDWrapper::timeStep(const Real h)
  {
 	PBD::ParticleData &pd = m_model.getParticles();
 	PBD::SimulationModel::RigidBodyVector &rb = m_model.getRigidBodies();
-	PBD::TimeManager::getCurrent()->setTimeStepSize(SPH::TimeManager::getCurrent()->getTimeStepSize());
+	PBD::TimeManager::getCurrent()->setTimeStepSize(h);
 
 	m_timeStep->step(m_model);
 
@@ -150,6 +170,58 @@ void PBDWrapper::initShader()
 	}
 }
  
+void PBDWrapper::startTimeStep()
+{
+	waitForTimeStep();
+	// the time step size is read here since the SPH time manager belongs to the calling thread
+	const Real h = SPH::TimeManager::getCurrent()->getTimeStepSize();
+	if (!m_stepThread.joinable())
+		m_stepThread = std::thread(&PBDWrapper::stepThreadLoop, this);
+	{
+		std::lock_guard<std::mutex> lock(m_stepMutex);
+		m_stepSize = h;
+		m_stepPending = true;
+	}
+	m_stepCondition.notify_all();
+}
+
+void PBDWrapper::waitForTimeStep()
+{
+	std::unique_lock<std::mutex> lock(m_stepMutex);
+	m_stepCondition.wait(lock, [this]() { return !m_stepPending; });
+}
+
+bool PBDWrapper::isTimeStepRunning() const
+{
+	std::lock_guard<std::mutex> lock(m_stepMutex);
+	return m_stepPending;
+}
+
+void PBDWrapper::stepThreadLoop()
+{
+#ifdef _OPENMP
+	// the rigid body step is mostly serial, the OpenMP threads are left to the fluid step
+	omp_set_num_threads(1);
+#endif
+	std::unique_lock<std::mutex> lock(m_stepMutex);
+	while (true)
+	{
+		m_stepCondition.wait(lock, [this]() { return m_stepPending || m_stopStepThread; });
+		if (m_stopStepThread)
+			return;
+		const Real h = m_stepSize;
+		lock.unlock();
+
+		START_TIMING("SimStep - PBD");
+		timeStep(h);
+		STOP_TIMING_AVG;
+
+		lock.lock();
+		m_stepPending = false;
+		m_stepCondition.notify_all();
+	}
+}
+
 void PBDWrapper::updateVisModels()
 {
 	PBD::ParticleData &pd = m_model.getParticles();
@@ -3,6 +3,9 @@
 
 #include "SPlisHSPlasH/Common.h"
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "Visualization/Shader.h"
 #include "extern/AntTweakBar/include/AntTweakBar.h"
 #include "Simulation/SimulationModel.h"
@@ -34,7 +37,18 @@ protected:
 	std::string m_sceneFileName;
 	bool m_enableMayaExport = false;
 	Real m_dampingCoeff = 0.0;
-
+	bool m_pipelinedStep = false;
+	/** The pipelined time steps run in a persistent worker thread. It waits
+	* on m_stepCondition until a step is requested or the thread is stopped.
+	*/
+	std::thread m_stepThread;
+	mutable std::mutex m_stepMutex;
+	std::condition_variable m_stepCondition;
+	bool m_stepPending = false;
+	bool m_stopStepThread = false;
+	Real m_stepSize = 0.0;
+
+	void stepThreadLoop();
 	SPH::Shader *createShader(const std::string &vertexShader, const std::string &geometryShader, const std::string &fragmentShader);
 
 public:
@@ -63,6 +77,16 @@ public:
 	void initTetModelConstraints();
 
 	void timeStep();
+	void timeStep(const Real h);
+	/** Start a time step with the current time step size in the worker thread.
+	* The rigid bodies must not be accessed until waitForTimeStep() is called.
+	*/
+	void startTimeStep();
+	/** Wait until the time step started by startTimeStep() is finished. */
+	void waitForTimeStep();
+	bool isTimeStepRunning() const;
+	bool getPipelinedStep() const { return m_pipelinedStep; }
+	void setPipelinedStep(const bool val) { m_pipelinedStep = val; }
 	void updateVisModels();
 
 	void initShader();
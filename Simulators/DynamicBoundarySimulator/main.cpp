@@ -43,7 +43,10 @@ void renderBoundary();
 void reset();
 void initParameters();
 void updateBoundaryParticles(const bool forceUpdate);
+void predictBoundaryParticles();
 void updateBoundaryForces();
+void simulationStep();
+void finishPipelinedStep();
 void TW_CALL setCurrentFluidModel(const void *value, void *clientData);
 void TW_CALL getCurrentFluidModel(void *value, void *clientData);
 void TW_CALL setColorField(const void *value, void *clientData);
@@ -133,9 +136,14 @@ int main( int argc, char **argv )
 	}
 
 	base->readParameters();
+	Simulation::getCurrent()->printMemoryUsage();
 
 	pbdWrapper.initModel(TimeManager::getCurrent()->getTimeStepSize());
 
+	bool pipelinedStep = false;
+	if (base->getSceneLoader()->readValue("Configuration", "pipelinedRigidBodyStep", pipelinedStep))
+		pbdWrapper.setPipelinedStep(pipelinedStep);
+
 	if (!useGUI)
 	{
 		const Real stopAt = base->getValue<Real>(SimulatorBase::STOP_AT);
@@ -163,6 +171,7 @@ int main( int argc, char **argv )
 
 	base->cleanup();
 
+	Simulation::getCurrent()->printMemoryUsage();
 	Utilities::Timing::printAverageTimes();
 	Utilities::Timing::printTimeSums();
 
@@ -253,12 +262,14 @@ void initParameters()
 
 void reset()
 {
+	Simulation::getCurrent()->printMemoryUsage();
 	Utilities::Timing::printAverageTimes();
 	Utilities::Timing::reset();
 
 	Utilities::Counting::printAverageCounts();
 	Utilities::Counting::reset();
 
+	finishPipelinedStep();
 	Simulation::getCurrent()->reset();
 	base->reset();
 
@@ -285,88 +296,30 @@ void timeStep ()
 		return;
 
 	// Simulation code
-	Simulation *sim = Simulation::getCurrent();
-	const bool sim2D = sim->is2DSimulation();
 	const unsigned int numSteps = base->getValue<unsigned int>(SimulatorBase::NUM_STEPS_PER_RENDER);
 	for (unsigned int i = 0; i < numSteps; i++)
 	{
-		START_TIMING("SimStep");
-		SPH::Simulation::getCurrent()->getTimeStep()->step();
-		STOP_TIMING_AVG;
-
-		updateBoundaryForces();
-
-		//////////////////////////////////////////////////////////////////////////
-		// PBD
-		//////////////////////////////////////////////////////////////////////////
-		START_TIMING("SimStep - PBD");
-		pbdWrapper.timeStep();
-		STOP_TIMING_AVG;
-
-		updateBoundaryParticles(false);
-
-		base->step();
+		simulationStep();
 
 		INCREASE_COUNTER("Time step size", TimeManager::getCurrent()->getTimeStepSize());
-
-		// Make sure that particles stay in xy-plane in a 2D simulation
-		if (sim2D)
-		{
-			for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
-			{
-				FluidModel *model = sim->getFluidModel(i);
-				for (unsigned int i = 0; i < model->numActiveParticles(); i++)
-				{
-					model->getPosition(i)[2] = 0.0;
-					model->getVelocity(i)[2] = 0.0;
-				}
-			}
-		}
 	}
+	// the rigid bodies are rendered after this function
+	finishPipelinedStep();
 }
 
 bool timeStepNoGUI()
 {
 	const Real stopAt = base->getValue<Real>(SimulatorBase::STOP_AT);
 	if ((stopAt > 0.0) && (stopAt < TimeManager::getCurrent()->getTime()))
+	{
+		finishPipelinedStep();
 		return false;
+	}
 
 	// Simulation code
-	Simulation *sim = Simulation::getCurrent();
-	const bool sim2D = sim->is2DSimulation();
-
-	START_TIMING("SimStep");
-	SPH::Simulation::getCurrent()->getTimeStep()->step();
-	STOP_TIMING_AVG;
-
-	updateBoundaryForces();
-
-	//////////////////////////////////////////////////////////////////////////
-	// PBD
-	//////////////////////////////////////////////////////////////////////////
-	START_TIMING("SimStep - PBD");
-	pbdWrapper.timeStep();
-	STOP_TIMING_AVG;
-
-	updateBoundaryParticles(false);
-
-	base->step();
+	simulationStep();
 
 	INCREASE_COUNTER("Time step size", TimeManager::getCurrent()->getTimeStepSize());
-
-	// Make sure that particles stay in xy-plane in a 2D simulation
-	if (sim2D)
-	{
-		for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
-		{
-			FluidModel *model = sim->getFluidModel(i);
-			for (unsigned int i = 0; i < model->numActiveParticles(); i++)
-			{
-				model->getPosition(i)[2] = 0.0;
-				model->getVelocity(i)[2] = 0.0;
-			}
-		}
-	}
 	return true;
 }
 
@@ -381,6 +334,13 @@ void renderBoundary()
 
 	if ((renderWalls == 1) || (renderWalls == 2))
 	{
+		// body-local models only transform the particles with fluid neighbors
+		for (unsigned int body = 0; body < sim->numberOfBoundaryModels(); body++)
+		{
+			if (sim->getBoundaryModel(body)->isBodyLocal())
+				sim->getBoundaryModel(body)->updateParticles();
+		}
+
 		if (context_major_version > 3)
 		{
 			shader.begin();
@@ -491,24 +451,11 @@ void initBoundaryData()
 	std::string scene_path = FileSystem::getFilePath(base->getSceneFile());
 	std::string scene_file_name = FileSystem::getFileName(base->getSceneFile());
 	SceneLoader::Scene &scene = base->getScene();
-	const bool useCache = base->getUseParticleCaching();
-
-	string cachePath = scene_path + "/Cache";
 
 	for (unsigned int i = 0; i < scene.boundaryModels.size(); i++)
 	{
 		string meshFileName = FileSystem::normalizePath(scene_path + "/" + scene.boundaryModels[i]->meshFile);
 
-		// check if mesh file has changed
-		std::string md5FileName = FileSystem::normalizePath(cachePath + "/" + FileSystem::getFileNameWithExt(meshFileName) + ".md5");
-		bool md5 = false;
-		if (useCache)
-		{
-			string md5Str = FileSystem::getFileMD5(meshFileName);
-			if (FileSystem::fileExists(md5FileName))
-				md5 = FileSystem::checkMD5(md5Str, md5FileName);
-		}
-
 		// if a samples file is given, use this one
 		std::vector<Vector3r> boundaryParticles;
 
@@ -530,26 +477,30 @@ void initBoundaryData()
 		}
 		else		// if no samples file is given, sample the surface model
 		{
-			// Cache sampling
-			std::string mesh_base_path = FileSystem::getFilePath(scene.boundaryModels[i]->meshFile);
-			std::string mesh_file_name = FileSystem::getFileName(scene.boundaryModels[i]->meshFile);
-			
-			const string resStr = base->real2String(scene.boundaryModels[i]->scale[0]) + "_" + base->real2String(scene.boundaryModels[i]->scale[1]) + "_" + base->real2String(scene.boundaryModels[i]->scale[2]);
-			const string particleFileName = FileSystem::normalizePath(cachePath + "/" + mesh_file_name + "_dbd_" + base->real2String(scene.particleRadius) + "_" + resStr + ".bgeo");
-
-			// check MD5 if cache file is available
+			// Cache sampling, the samples are stored in local coordinates which depend on the initial transformation
+			Utilities::PreprocessingCache &cache = base->getPreprocessingCache();
+			const Vector3r &scale = scene.boundaryModels[i]->scale;
+			const Vector3r &t = scene.boundaryModels[i]->translation;
+			const Quaternionr q(scene.boundaryModels[i]->rotation);
+			const string params = base->real2String(scene.particleRadius) + " " + base->real2String(scale[0]) + " " + base->real2String(scale[1]) + " " + base->real2String(scale[2]) + " " +
+				base->real2String(t[0]) + " " + base->real2String(t[1]) + " " + base->real2String(t[2]) + " " +
+				base->real2String(q.w()) + " " + base->real2String(q.x()) + " " + base->real2String(q.y()) + " " + base->real2String(q.z()) + " 10 1";
+			string key, particleFileName;
 			bool foundCacheFile = false;
-
-			if (useCache)
-				foundCacheFile = FileSystem::fileExists(particleFileName);
-
-			if (useCache && foundCacheFile && md5)
+			if (cache.isEnabled())
 			{
-				PartioReaderWriter::readParticles(particleFileName, Vector3r::Zero(), Matrix3r::Identity(), 1.0, boundaryParticles);
-				LOG_INFO << "Loaded cached boundary sampling: " << particleFileName;
+				key = cache.getKey("dbd_samples", { meshFileName }, params);
+				if (cache.find(key, "bgeo", particleFileName))
+				{
+					foundCacheFile = PartioReaderWriter::readParticles(particleFileName, Vector3r::Zero(), Matrix3r::Identity(), 1.0, boundaryParticles);
+					if (foundCacheFile)
+						LOG_INFO << "Loaded cached boundary sampling: " << particleFileName;
+					else
+						boundaryParticles.clear();
+				}
 			}
 
-			if (!useCache || !foundCacheFile || !md5)
+			if (!foundCacheFile)
 			{
 				LOG_INFO << "Surface sampling of " << scene.boundaryModels[i]->meshFile;
 				START_TIMING("Poisson disk sampling");
@@ -562,11 +513,12 @@ void initBoundaryData()
 					boundaryParticles[j] = rb->getRotation().transpose() * (boundaryParticles[j] - rb->getPosition());
 
 				// Cache sampling
-				if (useCache && (FileSystem::makeDir(cachePath) == 0))
+				if (cache.isEnabled())
 				{
-					LOG_INFO << "Save particle sampling: " << particleFileName;
-					PartioReaderWriter::writeParticles(particleFileName, (unsigned int)boundaryParticles.size(), boundaryParticles.data(), nullptr, 0.0);
-					FileSystem::writeMD5File(meshFileName, md5FileName);
+					const string tmpFileName = cache.beginWrite(key, "bgeo");
+					LOG_INFO << "Save particle sampling: " << cache.getFileName(key, "bgeo");
+					PartioReaderWriter::writeParticles(tmpFileName, (unsigned int)boundaryParticles.size(), boundaryParticles.data(), nullptr, 0.0);
+					cache.endWrite(tmpFileName, key, "bgeo");
 				}
 			}
 		}
@@ -589,19 +541,15 @@ void updateBoundaryParticles(const bool forceUpdate = false)
 		BoundaryModel *bm = sim->getBoundaryModel(i);
 		RigidBodyObject *rbo = bm->getRigidBodyObject();
 		if (rbo->isDynamic() || forceUpdate)
-		{			
-			#pragma omp parallel default(shared)
-			{
-				#pragma omp for schedule(static)  
-				for (int j = 0; j < (int)bm->numberOfParticles(); j++)
-				{
-					bm->getPosition(j) = rbo->getRotation() * bm->getPosition0(j) + rbo->getPosition();
-					if (rbo->isDynamic())
-						bm->getVelocity(j) = rbo->getAngularVelocity().cross(bm->getPosition(j) - rbo->getPosition()) + rbo->getVelocity();
-					else
-						bm->getVelocity(j).setZero();
-				}
-			}
+		{
+			if (rbo->isDynamic())
+				bm->setTransformation(rbo->getRotation(), rbo->getPosition(), rbo->getVelocity(), rbo->getAngularVelocity());
+			else
+				bm->setTransformation(rbo->getRotation(), rbo->getPosition(), Vector3r::Zero(), Vector3r::Zero());
+
+			// body-local models transform the particles with fluid neighbors during the neighborhood search
+			if (!bm->isBodyLocal() || forceUpdate)
+				bm->updateParticles();
 #ifdef GPU_NEIGHBORHOOD_SEARCH
 			// copy the particle data to the GPU
 			if (forceUpdate)
@@ -611,6 +559,95 @@ void updateBoundaryParticles(const bool forceUpdate = false)
 	}
 }
 
+/** Perform one simulation step. In the pipelined mode the rigid body step is
+* performed in a separate thread while the next fluid step is computed. The
+* fluid step uses the boundary particles which are predicted by the velocities
+* of the rigid bodies, i.e. the rigid bodies are one step behind the fluid
+* until finishPipelinedStep() is called. The fluid step is not split, so the
+* only synchronization point is before the fluid forces are applied to the
+* bodies. Contacts of the bodies are seen by the fluid one step later. Therefore,
+* the mode is disabled by default.
+*/
+void simulationStep()
+{
+	START_TIMING("SimStep");
+	SPH::Simulation::getCurrent()->getTimeStep()->step();
+	STOP_TIMING_AVG;
+
+	if (pbdWrapper.getPipelinedStep())
+	{
+		// synchronization point: the rigid body step of the last simulation step
+		// must be finished before the fluid forces are applied to the bodies
+		START_TIMING("SimStep - PBD wait");
+		pbdWrapper.waitForTimeStep();
+		STOP_TIMING_AVG;
+
+		updateBoundaryForces();
+		predictBoundaryParticles();
+
+		// the export reads the rigid bodies, so it must be done before the next PBD step starts
+		base->step();
+
+		pbdWrapper.startTimeStep();
+	}
+	else
+	{
+		updateBoundaryForces();
+
+		//////////////////////////////////////////////////////////////////////////
+		// PBD
+		//////////////////////////////////////////////////////////////////////////
+		START_TIMING("SimStep - PBD");
+		pbdWrapper.timeStep();
+		STOP_TIMING_AVG;
+
+		updateBoundaryParticles(false);
+
+		base->step();
+	}
+}
+
+/** Wait for a running rigid body step and replace the predicted boundary
+* particles by the ones of the simulated rigid bodies.
+*/
+void finishPipelinedStep()
+{
+	if (pbdWrapper.isTimeStepRunning())
+	{
+		pbdWrapper.waitForTimeStep();
+		updateBoundaryParticles(false);
+	}
+}
+
+/** Set the boundary particles of the dynamic bodies to the state at the end
+* of the next time step which is predicted by the current velocities of the bodies.
+*/
+void predictBoundaryParticles()
+{
+	Simulation *sim = Simulation::getCurrent();
+	const Real h = TimeManager::getCurrent()->getTimeStepSize();
+	const unsigned int nObjects = sim->numberOfBoundaryModels();
+	for (unsigned int i = 0; i < nObjects; i++)
+	{
+		BoundaryModel *bm = sim->getBoundaryModel(i);
+		RigidBodyObject *rbo = bm->getRigidBodyObject();
+		if (rbo->isDynamic())
+		{
+			const Vector3r &v = rbo->getVelocity();
+			const Vector3r &omega = rbo->getAngularVelocity();
+			const Vector3r x = rbo->getPosition() + h * v;
+			Matrix3r R = rbo->getRotation();
+			const Real angle = h * omega.norm();
+			if (angle > static_cast<Real>(1.0e-10))
+				R = AngleAxisr(angle, omega.normalized()).toRotationMatrix() * R;
+
+			bm->setTransformation(R, x, v, omega);
+			if (!bm->isBodyLocal())
+				bm->updateParticles();
+		}
+	}
+}
+
 void updateBoundaryForces()
 {
 	Real h = TimeManager::getCurrent()->getTimeStepSize();
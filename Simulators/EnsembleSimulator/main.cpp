@@ -0,0 +1,620 @@
+#include "SPlisHSPlasH/Common.h"
+#include <Eigen/Dense>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "SPlisHSPlasH/TimeManager.h"
+#include "SPlisHSPlasH/TimeStep.h"
+#include "SPlisHSPlasH/Simulation.h"
+#include "SPlisHSPlasH/StaticRigidBody.h"
+#include "SPlisHSPlasH/EmitterSystem.h"
+#include "SPlisHSPlasH/Utilities/PoissonDiskSampling.h"
+#include "Simulators/Common/SimulatorBase.h"
+#include "Utilities/Timing.h"
+#include "Utilities/PartioReaderWriter.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/Version.h"
+#include "Utilities/Logger.h"
+#include "extern/cxxopts/cxxopts.hpp"
+#include "extern/json/json.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Enable memory leak detection
+#ifdef _DEBUG
+#ifndef EIGEN_ALIGN
+	#define new DEBUG_NEW
+#endif
+#endif
+
+using namespace SPH;
+using namespace Eigen;
+using namespace std;
+using namespace Utilities;
+using namespace GenParam;
+
+/** \brief Data of the scene which is computed once and shared by all runs:
+* the initial fluid particles, the boundary samples and the boundary volumes.
+*/
+struct SharedSceneData
+{
+	std::vector<std::string> fluidIds;
+	std::vector<std::vector<Vector3r>> fluidParticles;
+	std::vector<std::vector<Vector3r>> fluidVelocities;
+	std::vector<unsigned int> maxEmitterParticles;
+	std::vector<std::vector<Vector3r>> boundaryParticles;
+	std::vector<std::vector<Real>> boundaryVolumes;
+	int kernelMethod;
+};
+
+void initBoundaryData();
+void createSharedSceneData(SharedSceneData &data);
+void createVariants(const nlohmann::json &parameters, std::vector<nlohmann::json> &variants);
+void createEmitters(Simulation *sim);
+void readParameters(SceneLoader *sceneLoader, Simulation *sim);
+nlohmann::json runVariant(const unsigned int runIndex, const nlohmann::json &variant, const SharedSceneData &data, const Real stopAt, const int numThreads);
+void writeResults(const nlohmann::json &results);
+
+SimulatorBase *base;
+std::string outputPath;
+std::mutex setupMutex;
+std::mutex resultsMutex;
+
+// main
+int main( int argc, char **argv )
+{
+	REPORT_MEMORY_LEAKS;
+
+	std::string sweepFile;
+	unsigned int numJobs = 1;
+	int numThreads = 0;
+	std::vector<std::string> baseArgs = { argv[0], "--no-gui" };
+
+	try
+	{
+		cxxopts::Options options(argv[0], "EnsembleSimulator - Run variants of a scene with different parameters.");
+		options
+			.positional_help("[sweep file]")
+			.show_positional_help();
+
+		options.add_options()
+			("h,help", "Print help")
+			("no-cache", "Disable caching of boundary samples/maps.")
+			("cache-dir", "Directory of the preprocessing cache which is shared by all runs (default: Cache directory of the scene).", cxxopts::value<std::string>())
+			("cache-size", "Size budget of the preprocessing cache in MB, the least recently used entries are removed (default: 0 = unlimited).", cxxopts::value<unsigned int>())
+			("data-path", "Path of the data directory.", cxxopts::value<std::string>())
+			("output-dir", "Output directory for the log file, the results and the files of the runs.", cxxopts::value<std::string>())
+			("j,jobs", "Number of runs which are performed concurrently.", cxxopts::value<unsigned int>()->default_value("1"))
+			("threads", "Number of threads of each run (default: maximum number of threads / jobs).", cxxopts::value<int>())
+			;
+
+		options.add_options("invisible")
+			("sweep-file", "Sweep file", cxxopts::value<std::string>());
+
+		options.parse_positional("sweep-file");
+		auto result = options.parse(argc, argv);
+
+		if (result.count("help") || !result.count("sweep-file"))
+		{
+			std::cout << options.help({ "" }) << std::endl;
+			exit(0);
+		}
+
+		sweepFile = result["sweep-file"].as<std::string>();
+		if (FileSystem::isRelativePath(sweepFile))
+			sweepFile = FileSystem::normalizePath(FileSystem::getProgramPath() + "/" + sweepFile);
+
+		outputPath = FileSystem::normalizePath(FileSystem::getProgramPath() + "/output/" + FileSystem::getFileName(sweepFile));
+		if (result.count("output-dir"))
+			outputPath = result["output-dir"].as<std::string>();
+
+		if (result.count("no-cache"))
+			baseArgs.push_back("--no-cache");
+		if (result.count("cache-dir"))
+		{
+			baseArgs.push_back("--cache-dir");
+			baseArgs.push_back(result["cache-dir"].as<std::string>());
+		}
+		if (result.count("cache-size"))
+		{
+			baseArgs.push_back("--cache-size");
+			baseArgs.push_back(std::to_string(result["cache-size"].as<unsigned int>()));
+		}
+		if (result.count("data-path"))
+		{
+			baseArgs.push_back("--data-path");
+			baseArgs.push_back(result["data-path"].as<std::string>());
+		}
+
+		numJobs = std::max(result["jobs"].as<unsigned int>(), 1u);
+#ifdef _OPENMP
+		numThreads = std::max(omp_get_max_threads() / (int) numJobs, 1);
+#else
+		numThreads = 1;
+#endif
+		if (result.count("threads"))
+			numThreads = result["threads"].as<int>();
+	}
+	catch (const cxxopts::OptionException& e)
+	{
+		std::cout << "error parsing options: " << e.what() << std::endl;
+		exit(1);
+	}
+
+	// read sweep file
+	nlohmann::json sweep;
+	std::ifstream input(sweepFile);
+	if (!input.is_open())
+	{
+		std::cout << "Cannot open sweep file: " << sweepFile << std::endl;
+		exit(1);
+	}
+	try
+	{
+		input >> sweep;
+	}
+	catch (const std::exception &e)
+	{
+		std::cout << "Cannot read sweep file: " << e.what() << std::endl;
+		exit(1);
+	}
+
+	std::string sceneFile = sweep.value("scene", "");
+	if (FileSystem::isRelativePath(sceneFile))
+		sceneFile = FileSystem::normalizePath(FileSystem::getFilePath(sweepFile) + "/" + sceneFile);
+
+	// The scene is loaded once by the simulator base which is shared by all runs.
+	baseArgs.push_back("--output-dir");
+	baseArgs.push_back(outputPath);
+	baseArgs.push_back(sceneFile);
+	std::vector<char*> baseArgv;
+	for (auto &arg : baseArgs)
+		baseArgv.push_back(&arg[0]);
+
+	base = new SimulatorBase();
+	base->init((int)baseArgv.size(), baseArgv.data(), "EnsembleSimulator");
+
+	// All runs use static rigid bodies for the boundaries. A dynamic boundary
+	// would silently become static, so such scenes are rejected.
+	for (unsigned int i = 0; i < base->getScene().boundaryModels.size(); i++)
+	{
+		if (base->getScene().boundaryModels[i]->dynamic)
+		{
+			LOG_ERR << "The EnsembleSimulator only supports static boundaries, but boundary " << i << " is dynamic.";
+			exit(1);
+		}
+	}
+
+	std::vector<nlohmann::json> variants;
+	createVariants(sweep.value("parameters", nlohmann::json::object()), variants);
+	LOG_INFO << "Number of runs: " << variants.size();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Preprocessing: sample the fluid and the boundaries and compute the
+	// boundary volumes once.
+	//////////////////////////////////////////////////////////////////////////
+	START_TIMING("Preprocessing");
+	Simulation *sim = Simulation::getCurrent();
+	sim->init(base->getScene().particleRadius, base->getScene().sim2D);
+	base->buildModel();
+	initBoundaryData();
+	base->readParameters();
+
+	SharedSceneData data;
+	createSharedSceneData(data);
+	STOP_TIMING_PRINT;
+
+	Real stopAt = base->getValue<Real>(SimulatorBase::STOP_AT);
+	if (sweep.find("stopAt") != sweep.end())
+		stopAt = sweep["stopAt"].get<Real>();
+	if (stopAt <= 0.0)
+	{
+		LOG_ERR << "StopAt must be set in the sweep file or in the scene.";
+		exit(1);
+	}
+
+	nlohmann::json results;
+	results["sweepFile"] = sweepFile;
+	results["sceneFile"] = sceneFile;
+	results["gitSHA1"] = GIT_SHA1;
+	results["jobs"] = numJobs;
+	results["threads"] = numThreads;
+	results["runs"] = nlohmann::json::array();
+	for (unsigned int i = 0; i < variants.size(); i++)
+		results["runs"].push_back(nlohmann::json::object());
+
+	//////////////////////////////////////////////////////////////////////////
+	// Perform the runs. Each job is a thread with its own simulation and
+	// its own OpenMP thread team.
+	//////////////////////////////////////////////////////////////////////////
+	std::atomic<unsigned int> nextRun(0);
+	auto job = [&]()
+	{
+		unsigned int runIndex;
+		while ((runIndex = nextRun++) < variants.size())
+		{
+			nlohmann::json res = runVariant(runIndex, variants[runIndex], data, stopAt, numThreads);
+			std::lock_guard<std::mutex> lock(resultsMutex);
+			results["runs"][runIndex] = res;
+			writeResults(results);
+		}
+	};
+
+	std::vector<std::thread> jobs;
+	for (unsigned int i = 0; i < std::min(numJobs, (unsigned int)variants.size()); i++)
+		jobs.push_back(std::thread(job));
+	for (auto &t : jobs)
+		t.join();
+
+	LOG_INFO << "Results written to " << FileSystem::normalizePath(outputPath + "/results.json");
+
+	base->cleanup();
+	delete Simulation::getCurrent();
+	delete base;
+
+	return 0;
+}
+
+/** Create the cartesian product of all parameter values. The parameters are
+* given per parameter object, e.g. { "Fluid": { "viscosity": [0.01, 0.1] } },
+* where a single value is treated as a list with one entry.
+*/
+void createVariants(const nlohmann::json &parameters, std::vector<nlohmann::json> &variants)
+{
+	variants.clear();
+	variants.push_back(nlohmann::json::object());
+	for (auto obj = parameters.begin(); obj != parameters.end(); obj++)
+	{
+		for (auto param = obj.value().begin(); param != obj.value().end(); param++)
+		{
+			if ((param.key() == "particleRadius") || (param.key() == "sim2D"))
+			{
+				LOG_ERR << "The parameter " << param.key() << " cannot be varied, since the preprocessed data depends on it.";
+				exit(1);
+			}
+
+			nlohmann::json values = param.value();
+			if (!values.is_array())
+				values = nlohmann::json::array({ values });
+
+			std::vector<nlohmann::json> newVariants;
+			for (auto &v : variants)
+			{
+				for (auto &value : values)
+				{
+					nlohmann::json newVariant = v;
+					newVariant[obj.key()][param.key()] = value;
+					newVariants.push_back(newVariant);
+				}
+			}
+			variants.swap(newVariants);
+		}
+	}
+}
+
+void createSharedSceneData(SharedSceneData &data)
+{
+	Simulation *sim = Simulation::getCurrent();
+	for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
+	{
+		FluidModel *model = sim->getFluidModel(i);
+		const unsigned int numParticles = model->getNumActiveParticles0();
+		data.fluidIds.push_back(model->getId());
+		data.fluidParticles.push_back(std::vector<Vector3r>(numParticles));
+		data.fluidVelocities.push_back(std::vector<Vector3r>(numParticles));
+		for (unsigned int j = 0; j < numParticles; j++)
+		{
+			data.fluidParticles.back()[j] = model->getPosition0(j);
+			data.fluidVelocities.back()[j] = model->getVelocity0(j);
+		}
+		data.maxEmitterParticles.push_back(model->numParticles() - numParticles);
+	}
+
+	for (unsigned int i = 0; i < sim->numberOfBoundaryModels(); i++)
+	{
+		BoundaryModel *bm = sim->getBoundaryModel(i);
+		const unsigned int numParticles = bm->numberOfParticles();
+		data.boundaryParticles.push_back(std::vector<Vector3r>(numParticles));
+		data.boundaryVolumes.push_back(std::vector<Real>(numParticles));
+		for (unsigned int j = 0; j < numParticles; j++)
+		{
+			data.boundaryParticles.back()[j] = bm->getPosition0(j);
+			data.boundaryVolumes.back()[j] = bm->getVolume(j);
+		}
+	}
+	data.kernelMethod = sim->getKernel();
+}
+
+void readParameters(SceneLoader *sceneLoader, Simulation *sim)
+{
+	sceneLoader->readParameterObject("Configuration", sim);
+	sceneLoader->readParameterObject("Configuration", sim->getTimeStep());
+
+	for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
+	{
+		FluidModel *model = sim->getFluidModel(i);
+		const std::string &key = model->getId();
+		sceneLoader->readParameterObject(key, model);
+		sceneLoader->readParameterObject(key, (ParameterObject*) model->getDragBase());
+		sceneLoader->readParameterObject(key, (ParameterObject*) model->getSurfaceTensionBase());
+		sceneLoader->readParameterObject(key, (ParameterObject*) model->getViscosityBase());
+		sceneLoader->readParameterObject(key, (ParameterObject*) model->getVorticityBase());
+		sceneLoader->readParameterObject(key, (ParameterObject*) model->getElasticityBase());
+	}
+}
+
+nlohmann::json runVariant(const unsigned int runIndex, const nlohmann::json &variant, const SharedSceneData &data, const Real stopAt, const int numThreads)
+{
+	const std::string runName = "run_" + std::to_string(runIndex);
+	const std::string runPath = FileSystem::normalizePath(outputPath + "/" + runName);
+	FileSystem::makeDirs(runPath);
+	{
+		std::ofstream parameterFile(runPath + "/parameters.json");
+		parameterFile << variant.dump(4);
+	}
+	LOG_INFO << "[" << runName << "] Parameters: " << variant.dump();
+
+#ifdef _OPENMP
+	omp_set_num_threads(numThreads);
+#endif
+	SceneLoader::Scene &scene = base->getScene();
+	Simulation *sim = nullptr;
+
+	// The parameter objects register their parameters in static members,
+	// so the setup of the simulations is serialized.
+	{
+		std::lock_guard<std::mutex> lock(setupMutex);
+		sim = Simulation::getCurrent();
+		sim->init(scene.particleRadius, scene.sim2D);
+		TimeManager::getCurrent()->setTimeStepSize(scene.timeStepSize);
+
+		for (unsigned int i = 0; i < data.fluidIds.size(); i++)
+		{
+			sim->addFluidModel(data.fluidIds[i], (unsigned int)data.fluidParticles[i].size(),
+				const_cast<Vector3r*>(data.fluidParticles[i].data()), const_cast<Vector3r*>(data.fluidVelocities[i].data()),
+				data.maxEmitterParticles[i]);
+		}
+		createEmitters(sim);
+		base->createAnimationFields();
+
+		if (!sim->is2DSimulation())
+		{
+			sim->setValue(Simulation::KERNEL_METHOD, Simulation::ENUM_KERNEL_PRECOMPUTED_CUBIC);
+			sim->setValue(Simulation::GRAD_KERNEL_METHOD, Simulation::ENUM_GRADKERNEL_PRECOMPUTED_CUBIC);
+		}
+		else
+		{
+			sim->setValue(Simulation::KERNEL_METHOD, Simulation::ENUM_KERNEL_CUBIC_2D);
+			sim->setValue(Simulation::GRAD_KERNEL_METHOD, Simulation::ENUM_GRADKERNEL_CUBIC_2D);
+		}
+
+		// parameters of the scene and of the variant
+		readParameters(base->getSceneLoader(), sim);
+		SceneLoader variantLoader;
+		variantLoader.getJSONData() = variant;
+		readParameters(&variantLoader, sim);
+
+		// The boundary models are added after the parameters are set, so that
+		// a change of the kernel does not trigger the computation of the boundary volume.
+		for (unsigned int i = 0; i < data.boundaryParticles.size(); i++)
+		{
+			StaticRigidBody *rb = new StaticRigidBody();
+			rb->setWorldSpacePosition(scene.boundaryModels[i]->translation);
+			rb->setWorldSpaceRotation(scene.boundaryModels[i]->rotation);
+			sim->addBoundaryModel(rb, (unsigned int)data.boundaryParticles[i].size(), const_cast<Vector3r*>(data.boundaryParticles[i].data()));
+		}
+		sim->performNeighborhoodSearchSort();
+
+		if (sim->getKernel() == data.kernelMethod)
+		{
+			for (unsigned int i = 0; i < sim->numberOfBoundaryModels(); i++)
+			{
+				BoundaryModel *bm = sim->getBoundaryModel(i);
+				for (unsigned int j = 0; j < bm->numberOfParticles(); j++)
+					bm->setVolume(j, data.boundaryVolumes[i][j]);
+			}
+		}
+		else
+			sim->updateBoundaryVolume();
+
+#ifdef GPU_NEIGHBORHOOD_SEARCH
+		// copy the particle data to the GPU
+		sim->getNeighborhoodSearch()->update_point_sets();
+#endif
+	}
+
+	unsigned int numFluidParticles = 0;
+	for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
+		numFluidParticles += sim->getFluidModel(i)->numActiveParticles();
+
+	// particle export
+	const bool partioExport = base->getValue<bool>(SimulatorBase::PARTIO_EXPORT);
+	const Real exportFPS = base->getValue<Real>(SimulatorBase::PARTICLE_EXPORT_FPS);
+	const std::string partioExportPath = FileSystem::normalizePath(runPath + "/partio");
+	if (partioExport)
+		FileSystem::makeDirs(partioExportPath);
+	Real nextFrameTime = 0.0;
+	unsigned int frameCounter = 1;
+
+	TimeManager *tm = TimeManager::getCurrent();
+	TimeStep *timeStep = sim->getTimeStep();
+	unsigned int numSteps = 0;
+	unsigned int iterations = 0;
+	const auto t0 = std::chrono::high_resolution_clock::now();
+	while (tm->getTime() < stopAt)
+	{
+		if (partioExport && (tm->getTime() >= nextFrameTime))
+		{
+			nextFrameTime += static_cast<Real>(1.0) / exportFPS;
+			for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
+			{
+				FluidModel *model = sim->getFluidModel(i);
+				const std::string fileName = "ParticleData_" + model->getId() + "_" + std::to_string(frameCounter) + ".bgeo";
+				base->writeParticlesPartio(FileSystem::normalizePath(partioExportPath + "/" + fileName), model);
+			}
+			frameCounter++;
+		}
+
+		timeStep->step();
+		iterations += timeStep->getValue<unsigned int>(TimeStep::SOLVER_ITERATIONS);
+		numSteps++;
+	}
+	const auto t1 = std::chrono::high_resolution_clock::now();
+	const double totalTime = std::chrono::duration<double>(t1 - t0).count();
+
+	nlohmann::json res;
+	res["run"] = runIndex;
+	res["directory"] = runName;
+	res["parameters"] = variant;
+	res["numFluidParticles"] = numFluidParticles;
+	res["numSteps"] = numSteps;
+	res["simulatedTime"] = tm->getTime();
+	res["wallTime"] = totalTime;
+	res["msPerStep"] = 1000.0 * totalTime / (double)std::max(numSteps, 1u);
+	res["solverIterations"] = (double)iterations / (double)std::max(numSteps, 1u);
+	{
+		std::ofstream resultFile(runPath + "/result.json");
+		resultFile << res.dump(4);
+	}
+	LOG_INFO << "[" << runName << "] Finished: " << numSteps << " steps, " << totalTime << " s, " << res["msPerStep"].get<double>() << " ms/step";
+
+	{
+		std::lock_guard<std::mutex> lock(setupMutex);
+		delete sim;
+	}
+	return res;
+}
+
+void writeResults(const nlohmann::json &results)
+{
+	std::ofstream output(FileSystem::normalizePath(outputPath + "/results.json"));
+	output << results.dump(4);
+}
+
+/** Add the emitters of the scene to the fluid models. In contrast to
+* SimulatorBase::createEmitters() no boundary models are created, since the
+* boundary samples of the emitters are part of the preprocessed data.
+*/
+void createEmitters(Simulation *sim)
+{
+	SceneLoader::Scene &scene = base->getScene();
+	SceneLoader *sceneLoader = base->getSceneLoader();
+	for (unsigned int i = 0; i < scene.emitters.size(); i++)
+	{
+		SceneLoader::EmitterData *ed = scene.emitters[i];
+		for (unsigned int j = 0; j < sim->numberOfFluidModels(); j++)
+		{
+			FluidModel *model = sim->getFluidModel(j);
+			if (model->getId() != ed->id)
+				continue;
+
+			// the emitters were converted to box emitters in 2D by SimulatorBase::createEmitters()
+			model->getEmitterSystem()->addEmitter(
+				ed->width, ed->height,
+				ed->x, ed->rotation,
+				ed->velocity,
+				ed->type);
+			Emitter *emitter = model->getEmitterSystem()->getEmitters().back();
+
+			bool emitterReuseParticles = false;
+			sceneLoader->readValue(model->getId(), "emitterReuseParticles", emitterReuseParticles);
+			if (emitterReuseParticles)
+			{
+				Vector3r emitterBoxMin(-1.0, -1.0, -1.0);
+				sceneLoader->readVector(model->getId(), "emitterBoxMin", emitterBoxMin);
+				Vector3r emitterBoxMax(1.0, 1.0, 1.0);
+				sceneLoader->readVector(model->getId(), "emitterBoxMax", emitterBoxMax);
+				model->getEmitterSystem()->enableReuseParticles(emitterBoxMin, emitterBoxMax);
+			}
+			emitter->setEmitStartTime(ed->emitStartTime);
+			emitter->setEmitEndTime(ed->emitEndTime);
+			break;
+		}
+	}
+}
+
+void initBoundaryData()
+{
+	std::string scene_path = FileSystem::getFilePath(base->getSceneFile());
+	SceneLoader::Scene &scene = base->getScene();
+
+	for (unsigned int i = 0; i < scene.boundaryModels.size(); i++)
+	{
+		string meshFileName = scene.boundaryModels[i]->meshFile;
+		if (FileSystem::isRelativePath(meshFileName))
+			meshFileName = FileSystem::normalizePath(scene_path + "/" + scene.boundaryModels[i]->meshFile);
+
+		std::vector<Vector3r> boundaryParticles;
+		if (scene.boundaryModels[i]->samplesFile != "")
+		{
+			string particleFileName = scene_path + "/" + scene.boundaryModels[i]->samplesFile;
+			PartioReaderWriter::readParticles(particleFileName, scene.boundaryModels[i]->translation, scene.boundaryModels[i]->rotation, scene.boundaryModels[i]->scale[0], boundaryParticles);
+		}
+
+		StaticRigidBody *rb = new StaticRigidBody();
+		TriangleMesh &geo = rb->getGeometry();
+		SimulatorBase::loadObj(meshFileName, geo, scene.boundaryModels[i]->scale);
+
+		if (scene.boundaryModels[i]->samplesFile == "")
+		{
+			// Cache sampling
+			Utilities::PreprocessingCache &cache = base->getPreprocessingCache();
+			const Vector3r &scale = scene.boundaryModels[i]->scale;
+			const string params = base->real2String(scene.particleRadius) + " " + base->real2String(scale[0]) + " " + base->real2String(scale[1]) + " " + base->real2String(scale[2]) + " 10 1";
+			string key, particleFileName;
+			bool foundCacheFile = false;
+			if (cache.isEnabled())
+			{
+				key = cache.getKey("sbd_samples", { meshFileName }, params);
+				if (cache.find(key, "bgeo", particleFileName))
+				{
+					foundCacheFile = PartioReaderWriter::readParticles(particleFileName, scene.boundaryModels[i]->translation, scene.boundaryModels[i]->rotation, 1.0, boundaryParticles);
+					if (foundCacheFile)
+						LOG_INFO << "Loaded cached boundary sampling: " << particleFileName;
+					else
+						boundaryParticles.clear();
+				}
+			}
+
+			if (!foundCacheFile)
+			{
+				LOG_INFO << "Surface sampling of " << meshFileName;
+				START_TIMING("Poisson disk sampling");
+				PoissonDiskSampling sampling;
+				sampling.sampleMesh(geo.numVertices(), geo.getVertices().data(), geo.numFaces(), geo.getFaces().data(), scene.particleRadius, 10, 1, boundaryParticles);
+				STOP_TIMING_AVG;
+
+				// Cache sampling
+				if (cache.isEnabled())
+				{
+					const string tmpFileName = cache.beginWrite(key, "bgeo");
+					LOG_INFO << "Save particle sampling: " << cache.getFileName(key, "bgeo");
+					PartioReaderWriter::writeParticles(tmpFileName, (unsigned int)boundaryParticles.size(), boundaryParticles.data(), nullptr, scene.particleRadius);
+					cache.endWrite(tmpFileName, key, "bgeo");
+				}
+
+				// transform particles
+				for (unsigned int j = 0; j < (unsigned int)boundaryParticles.size(); j++)
+					boundaryParticles[j] = scene.boundaryModels[i]->rotation * boundaryParticles[j] + scene.boundaryModels[i]->translation;
+			}
+		}
+		// the mesh is only required for the sampling
+		geo.release();
+
+		rb->setWorldSpacePosition(scene.boundaryModels[i]->translation);
+		rb->setWorldSpaceRotation(scene.boundaryModels[i]->rotation);
+
+		Simulation::getCurrent()->addBoundaryModel(rb, static_cast<unsigned int>(boundaryParticles.size()), &boundaryParticles[0]);
+	}
+	Simulation::getCurrent()->performNeighborhoodSearchSort();
+	Simulation::getCurrent()->updateBoundaryVolume();
+
+#ifdef GPU_NEIGHBORHOOD_SEARCH
+	// copy the particle data to the GPU
+	Simulation::getCurrent()->getNeighborhoodSearch()->update_point_sets();
+#endif
+}
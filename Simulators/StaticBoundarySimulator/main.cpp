@@ -95,6 +95,7 @@ int main( int argc, char **argv )
 		Simulation::getCurrent()->setSimulationMethodChangedCallback([&]() { reset(); initParameters(); base->getSceneLoader()->readParameterObject("Configuration", Simulation::getCurrent()->getTimeStep()); });
 	}
 	base->readParameters();
+	Simulation::getCurrent()->printMemoryUsage();
 
 	if (!useGUI)
 	{
@@ -123,6 +124,7 @@ int main( int argc, char **argv )
 
 	base->cleanup ();
 
+	Simulation::getCurrent()->printMemoryUsage();
 	Utilities::Timing::printAverageTimes();
 	Utilities::Timing::printTimeSums();
 
@@ -211,6 +213,7 @@ void initParameters()
 
 void reset()
 {
+	Simulation::getCurrent()->printMemoryUsage();
 	Utilities::Timing::printAverageTimes();
 	Utilities::Timing::reset();
 
@@ -236,8 +239,6 @@ void timeStep ()
 		return;
 
 	// Simulation code
-	Simulation *sim = Simulation::getCurrent();
-	const bool sim2D = sim->is2DSimulation();
 	const unsigned int numSteps = base->getValue<unsigned int>(SimulatorBase::NUM_STEPS_PER_RENDER);
 	for (unsigned int i = 0; i < numSteps; i++)
 	{
@@ -248,20 +249,6 @@ void timeStep ()
 		base->step();
 
 		INCREASE_COUNTER("Time step size", TimeManager::getCurrent()->getTimeStepSize());
-
-		// Make sure that particles stay in xy-plane in a 2D simulation
-		if (sim2D)
-		{
-			for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
-			{
-				FluidModel *model = sim->getFluidModel(i);
-				for (unsigned int i = 0; i < model->numActiveParticles(); i++)
-				{
-					model->getPosition(i)[2] = 0.0;
-					model->getVelocity(i)[2] = 0.0;
-				}
-			}
-		}
 	}
 }
 bool timeStepNoGUI()
@@ -271,9 +258,6 @@ bool timeStepNoGUI()
 		return false;
 
 	// Simulation code
-	Simulation *sim = Simulation::getCurrent();
-	const bool sim2D = sim->is2DSimulation();
-
 	START_TIMING("SimStep");
 	Simulation::getCurrent()->getTimeStep()->step();
 	STOP_TIMING_AVG;
@@ -281,20 +265,6 @@ bool timeStepNoGUI()
 	base->step();
 
 	INCREASE_COUNTER("Time step size", TimeManager::getCurrent()->getTimeStepSize());
-
-	// Make sure that particles stay in xy-plane in a 2D simulation
-	if (sim2D)
-	{
-		for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
-		{
-			FluidModel *model = sim->getFluidModel(i);
-			for (unsigned int i = 0; i < model->numActiveParticles(); i++)
-			{
-				model->getPosition(i)[2] = 0.0;
-				model->getVelocity(i)[2] = 0.0;
-			}
-		}
-	}
 	return true;
 }
 
@@ -436,9 +406,6 @@ void initBoundaryData()
 	std::string scene_path = FileSystem::getFilePath(base->getSceneFile());
 	std::string scene_file_name = FileSystem::getFileName(base->getSceneFile());
 	SceneLoader::Scene &scene = base->getScene();
-	const bool useCache = base->getUseParticleCaching();
-
-	string cachePath = scene_path + "/Cache";
 
 	for (unsigned int i = 0; i < scene.boundaryModels.size(); i++)
 	{
@@ -446,16 +413,6 @@ void initBoundaryData()
 		if (FileSystem::isRelativePath(meshFileName))
 			meshFileName = FileSystem::normalizePath(scene_path + "/" + scene.boundaryModels[i]->meshFile);
 
-		// check if mesh file has changed
-		std::string md5FileName = FileSystem::normalizePath(cachePath + "/" + FileSystem::getFileNameWithExt(meshFileName) + ".md5");
-		bool md5 = false;
-		if (useCache)
-		{
-			string md5Str = FileSystem::getFileMD5(meshFileName);
-			if (FileSystem::fileExists(md5FileName))
-				md5 = FileSystem::checkMD5(md5Str, md5FileName);
-		}
-
 		std::vector<Vector3r> boundaryParticles;
 		if (scene.boundaryModels[i]->samplesFile != "")
 		{
@@ -470,25 +427,25 @@ void initBoundaryData()
 		if (scene.boundaryModels[i]->samplesFile == "")
 		{
 			// Cache sampling
-			std::string mesh_base_path = FileSystem::getFilePath(scene.boundaryModels[i]->meshFile);
-			std::string mesh_file_name = FileSystem::getFileName(scene.boundaryModels[i]->meshFile);
-
-			const string resStr = base->real2String(scene.boundaryModels[i]->scale[0]) + "_" + base->real2String(scene.boundaryModels[i]->scale[1]) + "_" + base->real2String(scene.boundaryModels[i]->scale[2]);
-			const string particleFileName = FileSystem::normalizePath(cachePath + "/" + mesh_file_name + "_sbd_" + base->real2String(scene.particleRadius) + "_" + resStr + ".bgeo");
-
-			// check MD5 if cache file is available
+			Utilities::PreprocessingCache &cache = base->getPreprocessingCache();
+			const Vector3r &scale = scene.boundaryModels[i]->scale;
+			const string params = base->real2String(scene.particleRadius) + " " + base->real2String(scale[0]) + " " + base->real2String(scale[1]) + " " + base->real2String(scale[2]) + " 10 1";
+			string key, particleFileName;
 			bool foundCacheFile = false;
-
-			if (useCache)
-				foundCacheFile = FileSystem::fileExists(particleFileName);
-
-			if (useCache && foundCacheFile && md5)
+			if (cache.isEnabled())
 			{
-				PartioReaderWriter::readParticles(particleFileName, scene.boundaryModels[i]->translation, scene.boundaryModels[i]->rotation, 1.0, boundaryParticles);
-				LOG_INFO << "Loaded cached boundary sampling: " << particleFileName;
+				key = cache.getKey("sbd_samples", { meshFileName }, params);
+				if (cache.find(key, "bgeo", particleFileName))
+				{
+					foundCacheFile = PartioReaderWriter::readParticles(particleFileName, scene.boundaryModels[i]->translation, scene.boundaryModels[i]->rotation, 1.0, boundaryParticles);
+					if (foundCacheFile)
+						LOG_INFO << "Loaded cached boundary sampling: " << particleFileName;
+					else
+						boundaryParticles.clear();
+				}
 			}
 
-			if (!useCache || !foundCacheFile || !md5)
+			if (!foundCacheFile)
 			{
 				LOG_INFO << "Surface sampling of " << meshFileName;
 				START_TIMING("Poisson disk sampling");
@@ -497,11 +454,12 @@ void initBoundaryData()
 				STOP_TIMING_AVG;
 
 				// Cache sampling
-				if (useCache && (FileSystem::makeDir(cachePath) == 0))
+				if (cache.isEnabled())
 				{
-					LOG_INFO << "Save particle sampling: " << particleFileName;
-					PartioReaderWriter::writeParticles(particleFileName, (unsigned int)boundaryParticles.size(), boundaryParticles.data(), nullptr, scene.particleRadius);
-					FileSystem::writeMD5File(meshFileName, md5FileName);
+					const string tmpFileName = cache.beginWrite(key, "bgeo");
+					LOG_INFO << "Save particle sampling: " << cache.getFileName(key, "bgeo");
+					PartioReaderWriter::writeParticles(tmpFileName, (unsigned int)boundaryParticles.size(), boundaryParticles.data(), nullptr, scene.particleRadius);
+					cache.endWrite(tmpFileName, key, "bgeo");
 				}
 
 				// transform particles
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Compare the results of SPlisHSPlasH_benchmarks with a stored baseline.
+
+Usage: compare_benchmarks.py baseline.json current.json [--threshold 0.1] [--scopes]
+
+A run is flagged as regression if its time per step (or the time of one of
+its timing scopes with --scopes) exceeds the baseline by more than the
+threshold. The exit code is 1 if a regression was found.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_results(file_name):
+    with open(file_name) as f:
+        data = json.load(f)
+    results = {}
+    for r in data["results"]:
+        key = (r["scene"], r["requestedParticles"], r["methodName"], r["threads"])
+        results[key] = r
+    return data, results
+
+
+def relative_change(baseline, current):
+    if baseline <= 0.0:
+        return 0.0
+    return (current - baseline) / baseline
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare SPlisHSPlasH benchmark results with a baseline.")
+    parser.add_argument("baseline", help="baseline result file (json)")
+    parser.add_argument("current", help="current result file (json)")
+    parser.add_argument("--threshold", type=float, default=0.1, help="relative slowdown which is reported as regression (default: 0.1)")
+    parser.add_argument("--scopes", action="store_true", help="compare the times of the individual timing scopes")
+    parser.add_argument("--min-time", type=float, default=0.1, help="ignore scopes which need less ms per step in the baseline (default: 0.1)")
+    args = parser.parse_args()
+
+    baseline_data, baseline = load_results(args.baseline)
+    current_data, current = load_results(args.current)
+
+    print("Baseline: %s (%s)" % (baseline_data.get("gitSHA1", "?"), baseline_data.get("hostName", "?")))
+    print("Current:  %s (%s)" % (current_data.get("gitSHA1", "?"), current_data.get("hostName", "?")))
+    print()
+    print("%-12s %10s %-8s %7s %12s %12s %8s %10s %10s" % ("scene", "particles", "method", "threads",
+                                                          "base ms", "curr ms", "change", "base it.", "curr it."))
+
+    regressions = []
+    for key in sorted(current.keys()):
+        if key not in baseline:
+            continue
+        b = baseline[key]
+        c = current[key]
+        change = relative_change(b["msPerStep"], c["msPerStep"])
+        flag = " <-- regression" if change > args.threshold else ""
+        print("%-12s %10d %-8s %7d %12.3f %12.3f %+7.1f%% %10.2f %10.2f%s" % (key[0], key[1], key[2], key[3],
+              b["msPerStep"], c["msPerStep"], 100.0 * change, b["solverIterations"], c["solverIterations"], flag))
+        if change > args.threshold:
+            regressions.append((key, "step", change))
+
+        if args.scopes:
+            for name, bs in sorted(b["scopes"].items()):
+                if (name not in c["scopes"]) or (bs["msPerStep"] < args.min_time):
+                    continue
+                cs = c["scopes"][name]
+                scope_change = relative_change(bs["msPerStep"], cs["msPerStep"])
+                if scope_change > args.threshold:
+                    print("    %-40s %12.3f %12.3f %+7.1f%% <-- regression" % (name, bs["msPerStep"], cs["msPerStep"], 100.0 * scope_change))
+                    regressions.append((key, name, scope_change))
+
+    missing = [key for key in baseline.keys() if key not in current]
+    if len(missing) > 0:
+        print()
+        print("%d runs of the baseline are missing in the current results." % len(missing))
+
+    print()
+    if len(regressions) > 0:
+        print("%d regressions found (threshold: %.1f%%)." % (len(regressions), 100.0 * args.threshold))
+        return 1
+    print("No regressions found (threshold: %.1f%%)." % (100.0 * args.threshold))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,416 @@
+#include "SPlisHSPlasH/Common.h"
+#include <Eigen/Dense>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include "SPlisHSPlasH/Simulation.h"
+#include "SPlisHSPlasH/TimeManager.h"
+#include "SPlisHSPlasH/TimeStep.h"
+#include "SPlisHSPlasH/StaticRigidBody.h"
+#include "SPlisHSPlasH/Viscosity/ViscosityBase.h"
+#include "Utilities/Timing.h"
+#include "Utilities/Counting.h"
+#include "Utilities/Logger.h"
+#include "Utilities/StringTools.h"
+#include "Utilities/SystemInfo.h"
+#include "Utilities/Version.h"
+#include "extern/cxxopts/cxxopts.hpp"
+#include "extern/json/json.hpp"
+#include <omp.h>
+
+// Enable memory leak detection
+#ifdef _DEBUG
+#ifndef EIGEN_ALIGN
+	#define new DEBUG_NEW
+#endif
+#endif
+
+using namespace SPH;
+using namespace Eigen;
+using namespace std;
+using namespace Utilities;
+
+INIT_TIMING
+INIT_LOGGING
+INIT_COUNTING
+
+const Real particleRadius = static_cast<Real>(0.025);
+const char* methodNames[] = { "WCSPH", "PCISPH", "PBF", "IISPH", "DFSPH", "PF" };
+
+/** \brief Configuration of a single benchmark run.
+*/
+struct BenchmarkCase
+{
+	std::string scene;
+	unsigned int numParticles;
+	int method;
+	int threads;
+};
+
+void addBlock(const Vector3r &start, const unsigned int nx, const unsigned int ny, const unsigned int nz, std::vector<Vector3r> &x);
+void addBox(const Vector3r &minX, const Vector3r &maxX, std::vector<Vector3r> &x);
+void createScene(const std::string &scene, const unsigned int numParticles);
+nlohmann::json runBenchmark(const BenchmarkCase &bc, const unsigned int numSteps, const unsigned int numWarmupSteps);
+void parseList(const std::string &str, std::vector<std::string> &values);
+
+
+// main
+int main(int argc, char **argv)
+{
+	REPORT_MEMORY_LEAKS;
+
+	Utilities::logger.addSink(unique_ptr<Utilities::ConsoleSink>(new Utilities::ConsoleSink(Utilities::LogLevel::INFO)));
+	Timing::m_dontPrintTimes = true;
+
+	std::vector<std::string> scenes = { "dambreak", "multiphase", "viscous" };
+	std::vector<unsigned int> sizes = { 50000, 200000 };
+	std::vector<int> methods = { 0, 1, 2, 3, 4, 5 };
+	std::vector<int> threads = { omp_get_max_threads() };
+	unsigned int numSteps = 100;
+	unsigned int numWarmupSteps = 5;
+	std::string outputFile = "benchmark_results.json";
+
+	try
+	{
+		cxxopts::Options options(argv[0], "SPlisHSPlasH_benchmarks - Run the headless benchmark scenes and write the results to a JSON file.");
+
+		options.add_options()
+			("h,help", "Print help")
+			("scenes", "Comma separated list of scenes (dambreak, multiphase, viscous)", cxxopts::value<std::string>()->default_value("dambreak,multiphase,viscous"))
+			("sizes", "Comma separated list of fluid particle counts (e.g. 50000,200000,1000000,5000000)", cxxopts::value<std::string>()->default_value("50000,200000"))
+			("methods", "Comma separated list of simulation methods (0: WCSPH, 1: PCISPH, 2: PBF, 3: IISPH, 4: DFSPH, 5: PF)", cxxopts::value<std::string>()->default_value("0,1,2,3,4,5"))
+			("threads", "Comma separated list of thread counts (default: maximum number of threads)", cxxopts::value<std::string>())
+			("steps", "Number of measured simulation steps", cxxopts::value<unsigned int>()->default_value("100"))
+			("warmup", "Number of simulation steps before the measurement", cxxopts::value<unsigned int>()->default_value("5"))
+			("o,output", "Output file (json)", cxxopts::value<std::string>()->default_value("benchmark_results.json"))
+#ifdef USE_PERF_COUNTERS
+			("perf-counters", "Measure hardware performance counters for all timing scopes")
+#endif
+			;
+
+		auto result = options.parse(argc, argv);
+
+		if (result.count("help"))
+		{
+			LOG_INFO << options.help({ "", "Group" });
+			exit(0);
+		}
+
+		std::vector<std::string> values;
+		parseList(result["scenes"].as<std::string>(), scenes);
+
+		parseList(result["sizes"].as<std::string>(), values);
+		sizes.clear();
+		for (auto &v : values)
+			sizes.push_back(static_cast<unsigned int>(std::stoul(v)));
+
+		parseList(result["methods"].as<std::string>(), values);
+		methods.clear();
+		for (auto &v : values)
+			methods.push_back(std::stoi(v));
+
+		if (result.count("threads"))
+		{
+			parseList(result["threads"].as<std::string>(), values);
+			threads.clear();
+			for (auto &v : values)
+				threads.push_back(std::stoi(v));
+		}
+
+		numSteps = result["steps"].as<unsigned int>();
+		numWarmupSteps = result["warmup"].as<unsigned int>();
+		outputFile = result["output"].as<std::string>();
+
+#ifdef USE_PERF_COUNTERS
+		if (result.count("perf-counters"))
+			Timing::enablePerfCounters();
+#endif
+	}
+	catch (const cxxopts::OptionException& e)
+	{
+		LOG_ERR << "error parsing options: " << e.what();
+		exit(1);
+	}
+	catch (const std::invalid_argument& e)
+	{
+		LOG_ERR << "error parsing options: " << e.what();
+		exit(1);
+	}
+
+	for (auto &s : scenes)
+	{
+		if ((s != "dambreak") && (s != "multiphase") && (s != "viscous"))
+		{
+			LOG_ERR << "Unknown scene: " << s;
+			exit(1);
+		}
+	}
+	for (auto m : methods)
+	{
+		if ((m < 0) || (m >= static_cast<int>(SimulationMethods::NumSimulationMethods)))
+		{
+			LOG_ERR << "Unknown simulation method: " << m;
+			exit(1);
+		}
+	}
+
+	// The peak memory of the process can only grow. Therefore, the runs are
+	// performed in the order of increasing particle counts, so that the
+	// reported peak memory is determined by the current run.
+	std::sort(sizes.begin(), sizes.end());
+	std::vector<BenchmarkCase> cases;
+	for (auto n : sizes)
+		for (auto &s : scenes)
+			for (auto m : methods)
+				for (auto t : threads)
+					cases.push_back({ s, n, m, t });
+
+	nlohmann::json output;
+	output["gitSHA1"] = GIT_SHA1;
+	output["gitRefspec"] = GIT_REFSPEC;
+	output["hostName"] = SystemInfo::getHostName();
+	output["maxThreads"] = omp_get_max_threads();
+	output["steps"] = numSteps;
+	output["warmupSteps"] = numWarmupSteps;
+	output["results"] = nlohmann::json::array();
+
+	for (size_t i = 0; i < cases.size(); i++)
+	{
+		LOG_INFO << "Benchmark " << (i + 1) << "/" << cases.size() << ": " << cases[i].scene << ", " << cases[i].numParticles
+			<< " particles, " << methodNames[cases[i].method] << ", " << cases[i].threads << " threads";
+		output["results"].push_back(runBenchmark(cases[i], numSteps, numWarmupSteps));
+
+		// write results after each run so that a crash does not lose all data
+		std::ofstream file(outputFile);
+		if (!file.is_open())
+		{
+			LOG_ERR << "Cannot open file: " << outputFile;
+			exit(1);
+		}
+		file << std::setw(4) << output << std::endl;
+		file.close();
+	}
+	LOG_INFO << "Results written to " << outputFile;
+
+	return 0;
+}
+
+void parseList(const std::string &str, std::vector<std::string> &values)
+{
+	values.clear();
+	StringTools::tokenize(str, values, ",");
+	for (auto &v : values)
+		v.erase(std::remove(v.begin(), v.end(), ' '), v.end());
+	values.erase(std::remove(values.begin(), values.end(), ""), values.end());
+}
+
+void addBlock(const Vector3r &start, const unsigned int nx, const unsigned int ny, const unsigned int nz, std::vector<Vector3r> &x)
+{
+	const Real diam = static_cast<Real>(2.0)*particleRadius;
+	const size_t offset = x.size();
+	x.resize(offset + (size_t)nx*(size_t)ny*(size_t)nz);
+
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)nx; i++)
+		{
+			for (unsigned int j = 0; j < ny; j++)
+			{
+				for (unsigned int k = 0; k < nz; k++)
+				{
+					const size_t index = offset + ((size_t)i*ny + j)*nz + k;
+					x[index] = start + diam*Vector3r((Real)i, (Real)j, (Real)k);
+				}
+			}
+		}
+	}
+}
+
+/** Sample the faces of an axis-aligned box with a regular grid. */
+void addBox(const Vector3r &minX, const Vector3r &maxX, std::vector<Vector3r> &x)
+{
+	const Real diam = static_cast<Real>(2.0)*particleRadius;
+	const unsigned int nx = (unsigned int)std::ceil((maxX[0] - minX[0]) / diam);
+	const unsigned int ny = (unsigned int)std::ceil((maxX[1] - minX[1]) / diam);
+	const unsigned int nz = (unsigned int)std::ceil((maxX[2] - minX[2]) / diam);
+
+	for (unsigned int i = 0; i <= nx; i++)
+	{
+		for (unsigned int j = 0; j <= ny; j++)
+		{
+			const bool border = (i == 0) || (i == nx) || (j == 0) || (j == ny);
+			for (unsigned int k = 0; k <= nz; k += (border ? 1 : nz))
+			{
+				x.push_back(minX + diam*Vector3r((Real)i, (Real)j, (Real)k));
+				if (nz == 0)
+					break;
+			}
+		}
+	}
+}
+
+/** Create the fluid and boundary models of a benchmark scene in the current simulation.
+* The fluid is a block with the dimensions a x 2a x a in a box of the size 4a x 3a x a.
+*/
+void createScene(const std::string &scene, const unsigned int numParticles)
+{
+	Simulation *sim = Simulation::getCurrent();
+	const Real diam = static_cast<Real>(2.0)*particleRadius;
+
+	const unsigned int numBlocks = (scene == "multiphase") ? 2 : 1;
+	const unsigned int n = std::max(1u, (unsigned int)std::round(std::cbrt((Real)numParticles / (Real)(2 * numBlocks))));
+	const Real blockWidth = diam * (Real) n;
+	const Real width = (scene == "multiphase") ? std::cbrt((Real) 2.0) * blockWidth : blockWidth;
+
+	std::vector<std::vector<Vector3r>> fluidParticles(numBlocks);
+	for (unsigned int i = 0; i < numBlocks; i++)
+	{
+		const Vector3r start = Vector3r(diam, diam, diam) + Vector3r((Real)i * (blockWidth + diam), 0, 0);
+		addBlock(start, n, 2 * n, n, fluidParticles[i]);
+
+		std::vector<Vector3r> fluidVelocities(fluidParticles[i].size(), Vector3r::Zero());
+		sim->addFluidModel("Fluid" + std::to_string(i), (unsigned int)fluidParticles[i].size(), fluidParticles[i].data(), fluidVelocities.data(), 0);
+	}
+
+	FluidModel *model = sim->getFluidModel(0);
+	if (scene == "dambreak")
+	{
+		model->setViscosityMethod(static_cast<int>(ViscosityMethods::Standard));
+		model->getViscosityBase()->setValue<Real>(ViscosityBase::VISCOSITY_COEFFICIENT, static_cast<Real>(0.01));
+	}
+	else if (scene == "multiphase")
+	{
+		model->setDensity0(static_cast<Real>(1000.0));
+		sim->getFluidModel(1)->setDensity0(static_cast<Real>(100.0));
+		for (unsigned int i = 0; i < numBlocks; i++)
+		{
+			sim->getFluidModel(i)->setViscosityMethod(static_cast<int>(ViscosityMethods::Standard));
+			sim->getFluidModel(i)->getViscosityBase()->setValue<Real>(ViscosityBase::VISCOSITY_COEFFICIENT, static_cast<Real>(0.01));
+		}
+	}
+	else if (scene == "viscous")
+	{
+		model->setViscosityMethod(static_cast<int>(ViscosityMethods::Weiler2018));
+		model->getViscosityBase()->setValue<Real>(ViscosityBase::VISCOSITY_COEFFICIENT, static_cast<Real>(1000.0));
+	}
+
+	std::vector<Vector3r> boundaryParticles;
+	const Vector3r boxMax = Vector3r(4.0*width, 3.0*width, width) + Vector3r(2.0*diam, 2.0*diam, 2.0*diam);
+	addBox(Vector3r::Zero(), boxMax, boundaryParticles);
+
+	StaticRigidBody *rb = new StaticRigidBody();
+	rb->setWorldSpacePosition(Vector3r::Zero());
+	rb->setWorldSpaceRotation(Matrix3r::Identity());
+	sim->addBoundaryModel(rb, static_cast<unsigned int>(boundaryParticles.size()), boundaryParticles.data());
+
+	sim->performNeighborhoodSearchSort();
+	sim->updateBoundaryVolume();
+}
+
+nlohmann::json runBenchmark(const BenchmarkCase &bc, const unsigned int numSteps, const unsigned int numWarmupSteps)
+{
+	omp_set_num_threads(bc.threads);
+#ifdef USE_PERF_COUNTERS
+	// register the counters of threads which are added to the thread pool
+	if (Timing::isPerfCountersEnabled())
+		Timing::enablePerfCounters();
+#endif
+
+	Simulation *sim = Simulation::getCurrent();
+	sim->init(particleRadius, false);
+	TimeManager::getCurrent()->setTimeStepSize(static_cast<Real>(0.001));
+	createScene(bc.scene, bc.numParticles);
+	sim->setValue<int>(Simulation::SIMULATION_METHOD, bc.method);
+
+	unsigned int numFluidParticles = 0;
+	for (unsigned int i = 0; i < sim->numberOfFluidModels(); i++)
+		numFluidParticles += sim->getFluidModel(i)->numActiveParticles();
+	unsigned int numBoundaryParticles = 0;
+	for (unsigned int i = 0; i < sim->numberOfBoundaryModels(); i++)
+		numBoundaryParticles += sim->getBoundaryModel(i)->numberOfParticles();
+
+	TimeStep *timeStep = sim->getTimeStep();
+	for (unsigned int i = 0; i < numWarmupSteps; i++)
+		timeStep->step();
+
+	Timing::reset();
+	Counting::reset();
+	unsigned int iterations = 0;
+	const Real startTime = TimeManager::getCurrent()->getTime();
+	const auto t0 = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < numSteps; i++)
+	{
+		START_TIMING("SimStep");
+		timeStep->step();
+		STOP_TIMING_AVG;
+		iterations += timeStep->getValue<unsigned int>(TimeStep::SOLVER_ITERATIONS);
+	}
+	const auto t1 = std::chrono::high_resolution_clock::now();
+	const double totalTime = std::chrono::duration<double>(t1 - t0).count();
+	const double msPerStep = 1000.0 * totalTime / (double)std::max(numSteps, 1u);
+
+	nlohmann::json res;
+	res["scene"] = bc.scene;
+	res["requestedParticles"] = bc.numParticles;
+	res["method"] = bc.method;
+	res["methodName"] = methodNames[bc.method];
+	res["threads"] = bc.threads;
+	res["numFluidParticles"] = numFluidParticles;
+	res["numBoundaryParticles"] = numBoundaryParticles;
+	res["msPerStep"] = msPerStep;
+	res["solverIterations"] = (double)iterations / (double)std::max(numSteps, 1u);
+	res["particlesPerSecond"] = (totalTime > 0.0) ? (double)numFluidParticles * (double)numSteps / totalTime : 0.0;
+	res["simulatedTime"] = TimeManager::getCurrent()->getTime() - startTime;
+	res["peakMemory"] = SystemInfo::getPeakMemoryUsage();
+
+	// Memory of the individual components of the simulation
+	std::vector<MemoryUsageEntry> memoryEntries;
+	sim->getMemoryUsage(memoryEntries);
+	nlohmann::json memory = nlohmann::json::object();
+	size_t perParticleBytes = 0;
+	for (unsigned int i = 0; i < memoryEntries.size(); i++)
+	{
+		memory[memoryEntries[i].name] = memoryEntries[i].bytes;
+		if (memoryEntries[i].perParticle)
+			perParticleBytes += memoryEntries[i].bytes;
+	}
+	res["memory"] = memory;
+	res["bytesPerParticle"] = (numFluidParticles > 0) ? (double)perParticleBytes / (double)numFluidParticles : 0.0;
+
+	// Times of all scopes summed over all threads.
+	// Scopes with the same name are merged.
+	unsigned int startCounter, stopCounter;
+	Timing::mergeAverageTimes(startCounter, stopCounter);
+	nlohmann::json scopes = nlohmann::json::object();
+	for (auto &iter : Timing::m_averageTimes)
+	{
+		const AverageTime &at = iter.second;
+		nlohmann::json &scope = scopes[at.name];
+		const double total = scope.value("msPerStep", 0.0) + at.totalTime / (double)std::max(numSteps, 1u);
+		const double self = scope.value("selfMsPerStep", 0.0) + at.selfTime / (double)std::max(numSteps, 1u);
+		const unsigned int calls = scope.value("calls", 0u) + at.counter;
+		scope["msPerStep"] = total;
+		scope["selfMsPerStep"] = self;
+		scope["calls"] = calls;
+#ifdef USE_PERF_COUNTERS
+		if (Timing::isPerfCountersEnabled())
+		{
+			for (unsigned int i = 0; i < PerfCounterValues::NumCounters; i++)
+			{
+				const std::string counterName = PerfCounterValues::getName(i);
+				scope[counterName] = scope.value(counterName, 0.0) + (double)at.perfCounters.values[i] / (double)std::max(numSteps, 1u);
+			}
+		}
+#endif
+	}
+	res["scopes"] = scopes;
+
+	LOG_INFO << "  " << msPerStep << " ms/step, " << res["solverIterations"].get<double>() << " iterations/step, "
+		<< res["particlesPerSecond"].get<double>() << " particles/s";
+
+	delete sim;
+	return res;
+}
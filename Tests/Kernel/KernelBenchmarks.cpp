@@ -0,0 +1,302 @@
+#include "SPlisHSPlasH/Common.h"
+
+// Let Catch provide main():
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "SPlisHSPlasH/SPHKernels.h"
+#include "SPlisHSPlasH/NeighborhoodSearch.h"
+#include "SPlisHSPlasH/Simulation.h"
+#include "SPlisHSPlasH/TimeManager.h"
+#include "SPlisHSPlasH/Viscosity/Viscosity_Weiler2018.h"
+#include "SPlisHSPlasH/Viscosity/Viscosity_Takahashi2015.h"
+#include "SPlisHSPlasH/Viscosity/Viscosity_Peer2015.h"
+#include "SPlisHSPlasH/Elasticity/Elasticity_Peer2018.h"
+#include "SPlisHSPlasH/PF/TimeStepPF.h"
+#include "Utilities/Timing.h"
+#include "Utilities/Counting.h"
+#include "Utilities/Logger.h"
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <functional>
+
+using namespace SPH;
+
+INIT_TIMING
+INIT_LOGGING
+INIT_COUNTING
+
+// Catch's BENCHMARK only reports the time per iteration. Each benchmark loop
+// is therefore timed again to report the time per particle pair and the
+// estimated memory bandwidth.
+#define BENCHMARK_PAIRS(name, numPairs, numBytes) \
+	for (BenchmarkTimer benchmarkTimer(numPairs, numBytes); !benchmarkTimer.finished(); benchmarkTimer.finish()) \
+		for (Catch::BenchmarkLooper looper(name); looper; looper.increment(), benchmarkTimer.increment())
+
+/** \brief Measures the total time of a benchmark loop and prints the time per
+* pair and the bandwidth which results from the estimated number of bytes
+* read and written per iteration.
+*/
+class BenchmarkTimer
+{
+protected:
+	double m_numPairs;
+	double m_numBytes;
+	size_t m_iterations;
+	bool m_finished;
+	std::chrono::high_resolution_clock::time_point m_start;
+
+public:
+	BenchmarkTimer(const size_t numPairs, const size_t numBytes) :
+		m_numPairs((double)numPairs), m_numBytes((double)numBytes), m_iterations(0), m_finished(false)
+	{
+		m_start = std::chrono::high_resolution_clock::now();
+	}
+
+	void increment() { m_iterations++; }
+	bool finished() const { return m_finished; }
+
+	void finish()
+	{
+		const double t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_start).count();
+		const double iterations = (double)std::max<size_t>(m_iterations, 1);
+		// Catch's console reporter has not finished the line of the benchmark yet
+		std::ostringstream oss;
+		oss << std::fixed << std::setw(10) << std::setprecision(3) << 1.0e9 * t / (iterations * m_numPairs) << " ns/pair"
+			<< std::setw(10) << std::setprecision(2) << m_numBytes * iterations / t * 1.0e-9 << " GB/s";
+		std::cout << oss.str() << std::endl;
+		m_finished = true;
+	}
+};
+
+const Real particleRadius = static_cast<Real>(0.025);
+const Real supportRadius = static_cast<Real>(4.0) * particleRadius;
+
+/** Random vectors in the support radius of the kernels. */
+const std::vector<Vector3r> &getSamples()
+{
+	static std::vector<Vector3r> samples;
+	if (samples.empty())
+	{
+		const unsigned int numSamples = 1u << 20;
+		std::mt19937 gen(42);
+		std::uniform_real_distribution<Real> dist(-supportRadius, supportRadius);
+		samples.reserve(numSamples);
+		while (samples.size() < numSamples)
+		{
+			const Vector3r r(dist(gen), dist(gen), dist(gen));
+			if (r.squaredNorm() <= supportRadius*supportRadius)
+				samples.push_back(r);
+		}
+	}
+	return samples;
+}
+
+template<typename KernelType>
+void benchmarkW(const std::string &name)
+{
+	const std::vector<Vector3r> &samples = getSamples();
+	const size_t n = samples.size();
+	KernelType::setRadius(supportRadius);
+	Real sum = 0.0;
+	for (size_t i = 0; i < n; i++)
+		sum += KernelType::W(samples[i]);
+	BENCHMARK_PAIRS(name + "::W", n, n * sizeof(Vector3r))
+	{
+		for (size_t i = 0; i < n; i++)
+			sum += KernelType::W(samples[i]);
+	}
+	REQUIRE(sum > 0.0);
+}
+
+template<typename KernelType>
+void benchmarkGradW(const std::string &name)
+{
+	const std::vector<Vector3r> &samples = getSamples();
+	const size_t n = samples.size();
+	KernelType::setRadius(supportRadius);
+	Vector3r sum = Vector3r::Zero();
+	for (size_t i = 0; i < n; i++)
+		sum += KernelType::gradW(samples[i]);
+	BENCHMARK_PAIRS(name + "::gradW", n, n * sizeof(Vector3r))
+	{
+		for (size_t i = 0; i < n; i++)
+			sum += KernelType::gradW(samples[i]);
+	}
+	REQUIRE(std::isfinite(sum.norm()));
+}
+
+void createLattice(const unsigned int n, std::vector<Vector3r> &x)
+{
+	const Real diam = static_cast<Real>(2.0)*particleRadius;
+	x.resize((size_t)n*n*n);
+	for (unsigned int i = 0; i < n; i++)
+		for (unsigned int j = 0; j < n; j++)
+			for (unsigned int k = 0; k < n; k++)
+				x[((size_t)i*n + j)*n + k] = diam*Vector3r((Real)i, (Real)j, (Real)k);
+}
+
+TEST_CASE("Kernel evaluation", "[benchmark]")
+{
+	std::cout << "Kernel evaluation (" << getSamples().size() << " samples)" << std::endl;
+	benchmarkW<CubicKernel>("CubicKernel");
+	benchmarkGradW<CubicKernel>("CubicKernel");
+	benchmarkW<Poly6Kernel>("Poly6Kernel");
+	benchmarkGradW<Poly6Kernel>("Poly6Kernel");
+	benchmarkW<SpikyKernel>("SpikyKernel");
+	benchmarkGradW<SpikyKernel>("SpikyKernel");
+	benchmarkW<WendlandQuinticC2Kernel>("WendlandQuinticC2Kernel");
+	benchmarkGradW<WendlandQuinticC2Kernel>("WendlandQuinticC2Kernel");
+	benchmarkW<CohesionKernel>("CohesionKernel");
+	benchmarkW<AdhesionKernel>("AdhesionKernel");
+	benchmarkW<CubicKernel2D>("CubicKernel2D");
+	benchmarkGradW<CubicKernel2D>("CubicKernel2D");
+	benchmarkW<WendlandQuinticC2Kernel2D>("WendlandQuinticC2Kernel2D");
+	benchmarkGradW<WendlandQuinticC2Kernel2D>("WendlandQuinticC2Kernel2D");
+}
+
+TEST_CASE("Precomputed kernel resolutions", "[benchmark]")
+{
+	std::cout << "Precomputed cubic kernel" << std::endl;
+	benchmarkW<PrecomputedKernel<CubicKernel, 1000>>("PrecomputedKernel<CubicKernel, 1000>");
+	benchmarkGradW<PrecomputedKernel<CubicKernel, 1000>>("PrecomputedKernel<CubicKernel, 1000>");
+	benchmarkW<PrecomputedKernel<CubicKernel, 10000>>("PrecomputedKernel<CubicKernel, 10000>");
+	benchmarkGradW<PrecomputedKernel<CubicKernel, 10000>>("PrecomputedKernel<CubicKernel, 10000>");
+	benchmarkW<PrecomputedKernel<CubicKernel, 100000>>("PrecomputedKernel<CubicKernel, 100000>");
+	benchmarkGradW<PrecomputedKernel<CubicKernel, 100000>>("PrecomputedKernel<CubicKernel, 100000>");
+}
+
+TEST_CASE("Density computation on a lattice", "[benchmark]")
+{
+	typedef PrecomputedKernel<CubicKernel> Kernel;
+	Kernel::setRadius(supportRadius);
+
+	std::vector<Vector3r> x;
+	createLattice(50, x);
+	const unsigned int numParticles = (unsigned int)x.size();
+	std::vector<Real> density(numParticles);
+	const Real mass = static_cast<Real>(0.8) * pow(static_cast<Real>(2.0)*particleRadius, 3) * static_cast<Real>(1000.0);
+
+	NeighborhoodSearch nsearch(supportRadius, false);
+	nsearch.add_point_set(&x[0][0], numParticles, false, true);
+	nsearch.find_neighbors();
+	const CompactNSearch::PointSet &ps = nsearch.point_set(0);
+
+	size_t numPairs = 0;
+	for (unsigned int i = 0; i < numParticles; i++)
+		numPairs += ps.n_neighbors(0, i);
+	REQUIRE(numPairs > 0);
+
+	// per pair: neighbor index and position, per particle: position and density
+	const size_t numBytes = numPairs * (sizeof(unsigned int) + sizeof(Vector3r)) + numParticles * (sizeof(Vector3r) + sizeof(Real));
+
+	std::cout << "Density computation (" << numParticles << " particles, " << numPairs << " pairs)" << std::endl;
+	BENCHMARK_PAIRS("Density", numPairs, numBytes)
+	{
+		#pragma omp parallel default(shared)
+		{
+			#pragma omp for schedule(static)
+			for (int i = 0; i < (int)numParticles; i++)
+			{
+				const Vector3r &xi = x[i];
+				Real rho = mass * Kernel::W_zero();
+				const size_t numNeighbors = ps.n_neighbors(0, i);
+				for (size_t j = 0; j < numNeighbors; j++)
+				{
+					const unsigned int neighborIndex = ps.neighbor(0, i, (unsigned int)j);
+					rho += mass * Kernel::W(xi - x[neighborIndex]);
+				}
+				density[i] = rho;
+			}
+		}
+	}
+	REQUIRE(density[numParticles / 2] > 0.0);
+}
+
+/** Create a simulation with a lattice of fluid particles and perform one time
+* step, so that the neighborhoods and all fields used by the matrix-vector
+* products are initialized.
+*/
+Simulation *createMatVecSimulation(const unsigned int n, const SimulationMethods method, std::function<void(FluidModel*)> initModel)
+{
+	Simulation *sim = Simulation::getCurrent();
+	sim->init(particleRadius, false);
+
+	std::vector<Vector3r> x;
+	createLattice(n, x);
+	std::vector<Vector3r> v(x.size(), Vector3r::Zero());
+	sim->addFluidModel("Fluid", (unsigned int)x.size(), x.data(), v.data(), 0);
+	sim->performNeighborhoodSearchSort();
+	sim->setValue<int>(Simulation::SIMULATION_METHOD, static_cast<int>(method));
+	initModel(sim->getFluidModel(0));
+	sim->getTimeStep()->step();
+	return sim;
+}
+
+void benchmarkMatVec(const std::string &name, const unsigned int dim, MatrixReplacement::MatrixVecProdFct fct, void *userData)
+{
+	Simulation *sim = Simulation::getCurrent();
+	FluidModel *model = sim->getFluidModel(0);
+	const unsigned int numParticles = model->numActiveParticles();
+	const unsigned int blockSize = dim / numParticles;
+
+	size_t numPairs = 0;
+	for (unsigned int i = 0; i < numParticles; i++)
+		numPairs += sim->numberOfNeighbors(0, 0, i);
+	REQUIRE(numPairs > 0);
+
+	// per pair: neighbor index, position, density and vector entries,
+	// per particle: position, density, vector and result entries
+	const size_t numBytes = numPairs * (sizeof(unsigned int) + sizeof(Vector3r) + (1 + blockSize) * sizeof(Real))
+		+ numParticles * (sizeof(Vector3r) + (1 + 2 * blockSize) * sizeof(Real));
+
+	VectorXs vec(dim);
+	VectorXs result(dim);
+	vec.setOnes();
+	result.setZero();
+	BENCHMARK_PAIRS(name, numPairs, numBytes)
+	{
+		fct(vec.data(), result.data(), userData);
+	}
+	REQUIRE(std::isfinite(result.norm()));
+}
+
+TEST_CASE("Matrix-vector products", "[benchmark]")
+{
+	const unsigned int n = 30;
+	std::cout << "Matrix-vector products (" << n*n*n << " particles)" << std::endl;
+
+	{
+		createMatVecSimulation(n, SimulationMethods::DFSPH, [](FluidModel *model) { model->setViscosityMethod(static_cast<int>(ViscosityMethods::Weiler2018)); });
+		FluidModel *model = Simulation::getCurrent()->getFluidModel(0);
+		benchmarkMatVec("Viscosity_Weiler2018::matrixVecProd", 3 * model->numActiveParticles(), Viscosity_Weiler2018::matrixVecProd, model->getViscosityBase());
+		delete Simulation::getCurrent();
+	}
+	{
+		createMatVecSimulation(n, SimulationMethods::DFSPH, [](FluidModel *model) { model->setViscosityMethod(static_cast<int>(ViscosityMethods::Takahashi2015)); });
+		FluidModel *model = Simulation::getCurrent()->getFluidModel(0);
+		benchmarkMatVec("Viscosity_Takahashi2015::matrixVecProd", 3 * model->numActiveParticles(), Viscosity_Takahashi2015::matrixVecProd, model->getViscosityBase());
+		delete Simulation::getCurrent();
+	}
+	{
+		createMatVecSimulation(n, SimulationMethods::DFSPH, [](FluidModel *model) { model->setViscosityMethod(static_cast<int>(ViscosityMethods::Peer2015)); });
+		FluidModel *model = Simulation::getCurrent()->getFluidModel(0);
+		benchmarkMatVec("Viscosity_Peer2015::matrixVecProd", model->numActiveParticles(), Viscosity_Peer2015::matrixVecProd, model);
+		delete Simulation::getCurrent();
+	}
+	{
+		createMatVecSimulation(n, SimulationMethods::DFSPH, [](FluidModel *model) { model->setElasticityMethod(static_cast<int>(ElasticityMethods::Peer2018)); });
+		FluidModel *model = Simulation::getCurrent()->getFluidModel(0);
+		benchmarkMatVec("Elasticity_Peer2018::matrixVecProd", 3 * model->numActiveParticles(), Elasticity_Peer2018::matrixVecProd, model->getElasticityBase());
+		delete Simulation::getCurrent();
+	}
+	{
+		createMatVecSimulation(n, SimulationMethods::PF, [](FluidModel *model) {});
+		FluidModel *model = Simulation::getCurrent()->getFluidModel(0);
+		benchmarkMatVec("TimeStepPF::matrixVecProd", 3 * model->numActiveParticles(), TimeStepPF::matrixVecProd, Simulation::getCurrent()->getTimeStep());
+		delete Simulation::getCurrent();
+	}
+}
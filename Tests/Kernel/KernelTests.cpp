@@ -5,9 +5,26 @@
 
 #include "catch.hpp"
 #include "SPlisHSPlasH/SPHKernels.h"
+#include "SPlisHSPlasH/Simulation.h"
+#include "SPlisHSPlasH/TimeManager.h"
+#include "SPlisHSPlasH/TimeStep.h"
+#include "SPlisHSPlasH/Viscosity/ViscosityBase.h"
+#include "SPlisHSPlasH/SurfaceTension/SurfaceTensionBase.h"
+#include "SPlisHSPlasH/Drag/DragBase.h"
+#include "Utilities/Timing.h"
+#include "Utilities/Counting.h"
+#include "Utilities/Logger.h"
+#include <functional>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace SPH;
 
+INIT_TIMING
+INIT_LOGGING
+INIT_COUNTING
+
 TEMPLATE_TEST_CASE("3D Kernel is normalized, positive", "", CubicKernel, Poly6Kernel, SpikyKernel, WendlandQuinticC2Kernel, PrecomputedKernel<CubicKernel>)
 {
 	const Real supportRadius = 4.0*0.025;
@@ -59,4 +76,243 @@ TEMPLATE_TEST_CASE("2D Kernel is normalized, positive", "", CubicKernel2D, Wendl
 	}
 	REQUIRE(fabs(sum - 1.0) < 1.0e-5);
 	REQUIRE(positive);
-}
\ No newline at end of file
+}
+TEMPLATE_TEST_CASE("Kernel contexts are independent", "", CubicKernelT<1>, PrecomputedKernel<CubicKernelT<1>>)
+{
+	const Real supportRadius = 4.0*0.025;
+	CubicKernel::setRadius(supportRadius);
+	TestType::setRadius(2.0*supportRadius);
+	const Vector3r r(0.5*supportRadius, 0.0, 0.0);
+	const Real W = CubicKernel::W(r);
+
+	REQUIRE(CubicKernel::getRadius() == supportRadius);
+	REQUIRE(TestType::getRadius() == 2.0*supportRadius);
+	REQUIRE(TestType::W(2.0*r) != W);
+	REQUIRE(fabs(TestType::W(2.0*r) - W / 8.0) < 1.0e-3 * W);
+}
+
+const Real particleRadius = static_cast<Real>(0.025);
+
+void createLattice(const unsigned int n, std::vector<Vector3r> &x)
+{
+	const Real diam = static_cast<Real>(2.0)*particleRadius;
+	x.resize((size_t)n*n*n);
+	for (unsigned int i = 0; i < n; i++)
+		for (unsigned int j = 0; j < n; j++)
+			for (unsigned int k = 0; k < n; k++)
+				x[((size_t)i*n + j)*n + k] = diam*Vector3r((Real)i, (Real)j, (Real)k);
+}
+
+/** Simulate a sheared block of fluid for a few time steps with the given
+* number of threads and return the final velocities.
+*/
+std::vector<Vector3r> simulateShear(const int numThreads, const SimulationMethods method, std::function<void(FluidModel*)> initModel)
+{
+#ifdef _OPENMP
+	omp_set_num_threads(numThreads);
+#endif
+	Simulation *sim = Simulation::getCurrent();
+	sim->init(particleRadius, false);
+
+	std::vector<Vector3r> x;
+	createLattice(12, x);
+	std::vector<Vector3r> v(x.size());
+	for (size_t i = 0; i < x.size(); i++)
+		v[i] = Vector3r(x[i][1], 0.0, 0.0);
+	sim->addFluidModel("Fluid", (unsigned int)x.size(), x.data(), v.data(), 0);
+	sim->performNeighborhoodSearchSort();
+	sim->setValue<int>(Simulation::SIMULATION_METHOD, static_cast<int>(method));
+	FluidModel *model = sim->getFluidModel(0);
+	initModel(model);
+	for (unsigned int i = 0; i < 3; i++)
+		sim->getTimeStep()->step();
+
+	std::vector<Vector3r> result(model->numActiveParticles());
+	for (unsigned int i = 0; i < model->numActiveParticles(); i++)
+		result[i] = model->getVelocity(i);
+	delete sim;
+
+#ifdef _OPENMP
+	// the worker threads must not have created a simulation of their own
+	int numWorkerSimulations = 0;
+	#pragma omp parallel default(shared) reduction(+:numWorkerSimulations)
+	{
+		if ((omp_get_thread_num() != 0) && (Simulation::hasCurrent() || TimeManager::hasCurrent()))
+			numWorkerSimulations++;
+	}
+	REQUIRE(numWorkerSimulations == 0);
+#endif
+	return result;
+}
+
+void compareThreads(const SimulationMethods method, std::function<void(FluidModel*)> initModel)
+{
+#ifdef _OPENMP
+	const int maxThreads = omp_get_max_threads();
+#endif
+	const std::vector<Vector3r> v1 = simulateShear(1, method, initModel);
+	const std::vector<Vector3r> v4 = simulateShear(4, method, initModel);
+#ifdef _OPENMP
+	omp_set_num_threads(maxThreads);
+#endif
+	REQUIRE(v1.size() == v4.size());
+	Real maxDiff = 0.0;
+	for (size_t i = 0; i < v1.size(); i++)
+		maxDiff = std::max(maxDiff, (v1[i] - v4[i]).norm());
+	REQUIRE(maxDiff < static_cast<Real>(1.0e-3));
+}
+
+TEST_CASE("Implicit solvers with several threads", "[solver]")
+{
+	SECTION("Viscosity_Peer2015")
+	{
+		compareThreads(SimulationMethods::DFSPH, [](FluidModel *model)
+		{
+			model->setViscosityMethod(static_cast<int>(ViscosityMethods::Peer2015));
+			model->getViscosityBase()->setValue<Real>(ViscosityBase::VISCOSITY_COEFFICIENT, static_cast<Real>(0.5));
+		});
+	}
+	SECTION("Viscosity_Peer2016")
+	{
+		compareThreads(SimulationMethods::DFSPH, [](FluidModel *model)
+		{
+			model->setViscosityMethod(static_cast<int>(ViscosityMethods::Peer2016));
+			model->getViscosityBase()->setValue<Real>(ViscosityBase::VISCOSITY_COEFFICIENT, static_cast<Real>(0.5));
+		});
+	}
+	SECTION("Viscosity_Weiler2018")
+	{
+		compareThreads(SimulationMethods::DFSPH, [](FluidModel *model)
+		{
+			model->setViscosityMethod(static_cast<int>(ViscosityMethods::Weiler2018));
+			model->getViscosityBase()->setValue<Real>(ViscosityBase::VISCOSITY_COEFFICIENT, static_cast<Real>(0.5));
+		});
+	}
+	SECTION("TimeStepPF")
+	{
+		compareThreads(SimulationMethods::PF, [](FluidModel *model) {});
+	}
+}
+
+TEST_CASE("Surface classification of a block", "[surface]")
+{
+	const Real diam = static_cast<Real>(2.0)*particleRadius;
+	REQUIRE(SurfaceClassification::latticeNeighbors(static_cast<Real>(2.0)*diam, diam, false) == 26);
+	REQUIRE(SurfaceClassification::latticeNeighbors(static_cast<Real>(2.0)*diam, diam, true) == 8);
+
+	Simulation *sim = Simulation::getCurrent();
+	sim->init(particleRadius, false);
+
+	const unsigned int n = 10;
+	std::vector<Vector3r> x;
+	createLattice(n, x);
+	std::vector<Vector3r> v(x.size(), Vector3r::Zero());
+	sim->addFluidModel("Fluid", (unsigned int)x.size(), x.data(), v.data(), 0);
+	sim->performNeighborhoodSearchSort();
+	sim->performNeighborhoodSearch();
+
+	FluidModel *model = sim->getFluidModel(0);
+	SurfaceClassification &sc = model->getSurfaceClassification();
+	sc.update(0);
+
+	// distance of each particle to the nearest face of the block
+	const Real extent = static_cast<Real>(n - 1)*diam;
+	unsigned int numInterior = 0;
+	unsigned int numInteriorSurface = 0;
+	unsigned int numOuterLayer = 0;
+	unsigned int numOuterLayerSurface = 0;
+	for (unsigned int i = 0; i < model->numActiveParticles(); i++)
+	{
+		const Vector3r &xi = model->getPosition(i);
+		const Real d = std::min(xi.minCoeff(), extent - xi.maxCoeff());
+		if (d > static_cast<Real>(1.5)*diam)
+		{
+			numInterior++;
+			if (sc.isSurfaceParticle(i))
+				numInteriorSurface++;
+		}
+		else if (d < static_cast<Real>(0.5)*diam)
+		{
+			numOuterLayer++;
+			if (sc.isSurfaceParticle(i))
+				numOuterLayerSurface++;
+		}
+	}
+	delete sim;
+
+	REQUIRE(numInterior == (n - 4)*(n - 4)*(n - 4));
+	REQUIRE(numInteriorSurface == 0);
+	REQUIRE(numOuterLayerSurface == numOuterLayer);
+}
+
+std::vector<Vector3r> computeNonPressureAccelerations(const bool fused, const SurfaceTensionMethods surfaceTension, const ViscosityMethods viscosity, const DragMethods drag)
+{
+	Simulation *sim = Simulation::getCurrent();
+	sim->init(particleRadius, false);
+
+	std::vector<Vector3r> x;
+	createLattice(8, x);
+	std::vector<Vector3r> v(x.size());
+	for (size_t i = 0; i < x.size(); i++)
+		v[i] = Vector3r(x[i][1], -x[i][0], x[i][0] * x[i][2]);
+	sim->addFluidModel("Fluid", (unsigned int)x.size(), x.data(), v.data(), 0);
+	sim->performNeighborhoodSearchSort();
+	sim->performNeighborhoodSearch();
+	sim->setValue<bool>(Simulation::FUSED_NON_PRESSURE_FORCES, fused);
+
+	FluidModel *model = sim->getFluidModel(0);
+	model->setSurfaceTensionMethod(static_cast<int>(surfaceTension));
+	model->getSurfaceTensionBase()->setValue<Real>(SurfaceTensionBase::SURFACE_TENSION_COEFFICIENT, static_cast<Real>(0.2));
+	model->setViscosityMethod(static_cast<int>(viscosity));
+	model->getViscosityBase()->setValue<Real>(ViscosityBase::VISCOSITY_COEFFICIENT, static_cast<Real>(0.1));
+	model->setDragMethod(static_cast<int>(drag));
+	model->getDragBase()->setValue<Real>(DragBase::DRAG_COEFFICIENT, static_cast<Real>(1.0));
+
+	const unsigned int fluidModelIndex = model->getPointSetIndex();
+	const unsigned int nFluids = sim->numberOfFluidModels();
+	for (unsigned int i = 0; i < model->numActiveParticles(); i++)
+	{
+		const Vector3r &xi = model->getPosition(i);
+		Real &density = model->getDensity(i);
+		density = model->getMass(i) * sim->W_zero();
+		forall_fluid_neighbors(
+			density += fm_neighbor->getMass(neighborIndex) * sim->W(xi - xj);
+		)
+		model->getAcceleration(i).setZero();
+	}
+	sim->computeNonPressureForces();
+
+	std::vector<Vector3r> result(model->numActiveParticles());
+	for (unsigned int i = 0; i < model->numActiveParticles(); i++)
+		result[i] = model->getAcceleration(i);
+	delete sim;
+	return result;
+}
+
+void compareFusedForces(const SurfaceTensionMethods surfaceTension, const ViscosityMethods viscosity, const DragMethods drag)
+{
+	const std::vector<Vector3r> a1 = computeNonPressureAccelerations(false, surfaceTension, viscosity, drag);
+	const std::vector<Vector3r> a2 = computeNonPressureAccelerations(true, surfaceTension, viscosity, drag);
+	REQUIRE(a1.size() == a2.size());
+	Real maxAcc = 0.0;
+	Real maxDiff = 0.0;
+	for (size_t i = 0; i < a1.size(); i++)
+	{
+		maxAcc = std::max(maxAcc, a1[i].norm());
+		maxDiff = std::max(maxDiff, (a1[i] - a2[i]).norm());
+	}
+	REQUIRE(maxAcc > 0.0);
+	REQUIRE(maxDiff <= static_cast<Real>(1.0e-5) * maxAcc);
+}
+
+TEST_CASE("Fused non-pressure forces", "[solver]")
+{
+	SECTION("Becker2007, Standard, Macklin2014")
+	{
+		compareFusedForces(SurfaceTensionMethods::Becker2007, ViscosityMethods::Standard, DragMethods::Macklin2014);
+	}
+	SECTION("Akinci2013, XSPH, Gissler2017")
+	{
+		compareFusedForces(SurfaceTensionMethods::Akinci2013, ViscosityMethods::XSPH, DragMethods::Gissler2017);
+	}
+}
@@ -0,0 +1,70 @@
+#include "SPlisHSPlasH/Common.h"
+
+// Let Catch provide main():
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "Utilities/Timing.h"
+#include "Utilities/Counting.h"
+#include "Utilities/Logger.h"
+#include "Utilities/OBJLoader.h"
+#include "Utilities/FileSystem.h"
+#include "SPlisHSPlasH/Utilities/PoissonDiskSampling.h"
+#include <iostream>
+#include <string>
+
+using namespace SPH;
+
+INIT_TIMING
+INIT_LOGGING
+INIT_COUNTING
+
+void loadMesh(const std::string &fileName, std::vector<Vector3r> &vertices, std::vector<unsigned int> &faces)
+{
+	std::vector<Utilities::OBJLoader::Vec3f> x;
+	std::vector<Utilities::MeshFaceIndices> f;
+	const Utilities::OBJLoader::Vec3f scale = { 1.0f, 1.0f, 1.0f };
+	Utilities::OBJLoader::loadObj(fileName, &x, &f, nullptr, nullptr, scale);
+
+	vertices.resize(x.size());
+	for (size_t i = 0; i < x.size(); i++)
+		vertices[i] = Vector3r(x[i][0], x[i][1], x[i][2]);
+	faces.resize(3 * f.size());
+	for (size_t i = 0; i < f.size(); i++)
+		for (unsigned int j = 0; j < 3; j++)
+			faces[3 * i + j] = f[i].posIndices[j] - 1;
+}
+
+TEST_CASE("Poisson disk surface sampling", "[benchmark]")
+{
+	const std::string dataPath = Utilities::FileSystem::normalizePath(Utilities::FileSystem::getProgramPath() + "/" + std::string(SPH_DATA_PATH));
+	const std::string meshes[] = { "models/Dragon_50k.obj", "models/torus.obj" };
+	const Real radii[] = { 0.02, 0.01, 0.005 };
+	for (const std::string &mesh : meshes)
+	{
+		const std::string fileName = Utilities::FileSystem::normalizePath(dataPath + "/" + mesh);
+		if (!Utilities::FileSystem::fileExists(fileName))
+		{
+			WARN("Mesh not found: " << fileName);
+			continue;
+		}
+		std::vector<Vector3r> vertices;
+		std::vector<unsigned int> faces;
+		loadMesh(fileName, vertices, faces);
+
+		for (const Real radius : radii)
+		{
+			PoissonDiskSampling sampling;
+			sampling.setSeed(0);
+			std::vector<Vector3r> samples;
+			sampling.sampleMesh((unsigned int)vertices.size(), vertices.data(), (unsigned int)faces.size() / 3, faces.data(), radius, 10, 1, samples);
+			REQUIRE(samples.size() > 0);
+
+			std::cout << "Poisson disk sampling of " << mesh << " (radius " << radius << ", " << samples.size() << " samples)" << std::endl;
+			BENCHMARK("PoissonDiskSampling " + mesh + " r=" + std::to_string(radius))
+			{
+				sampling.sampleMesh((unsigned int)vertices.size(), vertices.data(), (unsigned int)faces.size() / 3, faces.data(), radius, 10, 1, samples);
+			}
+		}
+	}
+}
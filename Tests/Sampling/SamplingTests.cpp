@@ -0,0 +1,127 @@
+#include "SPlisHSPlasH/Common.h"
+
+// Let Catch provide main():
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "Utilities/Timing.h"
+#include "Utilities/Counting.h"
+#include "Utilities/Logger.h"
+#include "SPlisHSPlasH/Utilities/PoissonDiskSampling.h"
+#include "SPlisHSPlasH/Utilities/WindingNumbers.h"
+
+using namespace SPH;
+
+INIT_TIMING
+INIT_LOGGING
+INIT_COUNTING
+
+/** Triangulated unit sphere with n rings and 2n segments. The triangles are
+* oriented counter-clockwise seen from the outside.
+*/
+void createSphereMesh(const unsigned int n, std::vector<Vector3r> &vertices, std::vector<unsigned int> &faces)
+{
+	const unsigned int m = 2 * n;
+	vertices.clear();
+	faces.clear();
+	vertices.push_back(Vector3r(0.0, 0.0, 1.0));
+	for (unsigned int i = 1; i < n; i++)
+	{
+		const Real theta = static_cast<Real>(M_PI) * static_cast<Real>(i) / static_cast<Real>(n);
+		for (unsigned int j = 0; j < m; j++)
+		{
+			const Real phi = static_cast<Real>(2.0 * M_PI) * static_cast<Real>(j) / static_cast<Real>(m);
+			vertices.push_back(Vector3r(sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta)));
+		}
+	}
+	vertices.push_back(Vector3r(0.0, 0.0, -1.0));
+
+	const unsigned int south = (unsigned int)vertices.size() - 1;
+	auto ring = [m](const unsigned int i, const unsigned int j) { return 1 + (i - 1) * m + (j % m); };
+	for (unsigned int j = 0; j < m; j++)
+	{
+		faces.insert(faces.end(), { 0, ring(1, j), ring(1, j + 1) });
+		for (unsigned int i = 1; i < n - 1; i++)
+		{
+			faces.insert(faces.end(), { ring(i, j), ring(i + 1, j), ring(i + 1, j + 1) });
+			faces.insert(faces.end(), { ring(i, j), ring(i + 1, j + 1), ring(i, j + 1) });
+		}
+		faces.insert(faces.end(), { south, ring(n - 1, j + 1), ring(n - 1, j) });
+	}
+}
+
+TEST_CASE("Poisson disk samples keep the minimum distance", "[sampling]")
+{
+	std::vector<Vector3r> vertices;
+	std::vector<unsigned int> faces;
+	createSphereMesh(32, vertices, faces);
+
+	const Real radii[] = { 0.2, 0.1, 0.05 };
+	for (const Real radius : radii)
+	{
+		PoissonDiskSampling sampling;
+		sampling.setSeed(0);
+		std::vector<Vector3r> samples;
+		// the minimum distance is guaranteed for the euclidean norm
+		sampling.sampleMesh((unsigned int)vertices.size(), vertices.data(), (unsigned int)faces.size() / 3, faces.data(), radius, 10, 0, samples);
+
+		// at least a quarter of the densest packing of disks on the sphere
+		const Real sphereArea = static_cast<Real>(4.0 * M_PI);
+		const Real diskArea = static_cast<Real>(M_PI) * static_cast<Real>(0.25) * radius * radius;
+		REQUIRE(samples.size() > (size_t)(static_cast<Real>(0.25 * 0.9069) * sphereArea / diskArea));
+
+		Real minDist = std::numeric_limits<Real>::max();
+		for (size_t i = 0; i < samples.size(); i++)
+			for (size_t j = i + 1; j < samples.size(); j++)
+				minDist = std::min(minDist, (samples[i] - samples[j]).norm());
+		REQUIRE(minDist >= radius);
+	}
+}
+
+TEST_CASE("Fast winding numbers match the exact winding numbers", "[sampling]")
+{
+	std::vector<Vector3r> vertices;
+	std::vector<unsigned int> faces;
+	createSphereMesh(32, vertices, faces);
+	const unsigned int numFaces = (unsigned int)faces.size() / 3;
+
+	// points on a grid inside and outside of the sphere (not close to the surface)
+	std::vector<Vector3r> points;
+	std::vector<Real> exact;
+	unsigned int numInside = 0;
+	for (int i = -7; i <= 7; i++)
+		for (int j = -7; j <= 7; j++)
+			for (int k = -7; k <= 7; k++)
+			{
+				const Vector3r p = static_cast<Real>(0.2) * Vector3r((Real)i, (Real)j, (Real)k) + Vector3r(0.013, 0.007, -0.011);
+				const Real r = p.norm();
+				if ((r > 0.9) && (r < 1.1))
+					continue;
+				Real w = 0.0;
+				for (unsigned int f = 0; f < numFaces; f++)
+					w += Utilities::WindingNumbers::computeGeneralizedWindingNumber(p, vertices[faces[3 * f]], vertices[faces[3 * f + 1]], vertices[faces[3 * f + 2]]);
+				REQUIRE(w == Approx((r < 0.9) ? 1.0 : 0.0).margin(1.0e-6));
+				if (r < 0.9)
+					numInside++;
+				points.push_back(p);
+				exact.push_back(w);
+			}
+	REQUIRE(numInside > 0);
+	REQUIRE(numInside < points.size());
+
+	// The far field of a node is approximated by a dipole, so the error decreases
+	// with the accuracy. The default accuracy separates inside and outside points.
+	Utilities::FastWindingNumbers fwn((unsigned int)vertices.size(), vertices.data(), numFaces, faces.data());
+	const Real accuracies[] = { 2.0, 8.0 };
+	const Real tolerances[] = { 0.1, 1.0e-3 };
+	for (unsigned int a = 0; a < 2; a++)
+	{
+		fwn.setAccuracy(accuracies[a]);
+		std::vector<Real> fast;
+		fwn.computeWindingNumbers((unsigned int)points.size(), points.data(), fast);
+		Real maxDiff = 0.0;
+		for (size_t i = 0; i < points.size(); i++)
+			maxDiff = std::max(maxDiff, std::abs(fast[i] - exact[i]));
+		REQUIRE(maxDiff < tolerances[a]);
+	}
+}
@@ -6,6 +6,7 @@
 #include "GL/glut.h"
 #include "Utilities/Timing.h"
 #include "Utilities/PartioReaderWriter.h"
+#include "Utilities/ParticleCache.h"
 #include "Utilities/OBJLoader.h"
 #include "SPlisHSPlasH/Utilities/PoissonDiskSampling.h"
 #include "Utilities/FileSystem.h"
@@ -71,6 +72,7 @@ bool readParticles(const std::string &fileName, const Vector3r &translation, con
 string inputFile = "";
 string exePath, dataPath;
 Real particleRadius = 0.025;
+unsigned int cacheFrame = 0;
 std::vector<Vector3r> x;
 std::vector<Vector3r> v;
 AABB fluidBoundingBox;
@@ -97,7 +99,7 @@ int main( int argc, char **argv )
 	if (argc < 2)
 	{
 		std::cerr << "Not enough parameters!\n";
-		std::cerr << "Usage: PartioViewer.exe [-r radius] particles.bgeo\n";
+		std::cerr << "Usage: PartioViewer.exe [-r radius] [-f frame] particles.bgeo|particles.sphc\n";
 		return -1;
 	}
 
@@ -111,6 +113,8 @@ int main( int argc, char **argv )
 			particleRadius = stof(argv[++i]);
 			particleRadiusParam = true;
 		}
+		else if ((type_str == "-f") && (i + 1 < argc))
+			cacheFrame = stoi(argv[++i]);
 		else
 			inputFile = argv[i];
 	}
@@ -385,7 +389,20 @@ bool readParticles(const std::string &fileName, const Vector3r &translation, con
 	if (!FileSystem::fileExists(fileName))
 		return false;
 
-	partioData = Partio::read(fileName.c_str());
+	if (ParticleCacheReader::isParticleCacheFile(fileName))
+	{
+		// read a single frame of a particle cache file
+		ParticleCacheReader reader;
+		if (!reader.open(fileName))
+			return false;
+		std::cout << "Number of frames: " << reader.numFrames() << "\n";
+		if (cacheFrame >= reader.numFrames())
+			return false;
+		std::cout << "Frame " << cacheFrame << ", time: " << reader.getFrameTime(cacheFrame) << "\n";
+		partioData = reader.readFramePartio(cacheFrame);
+	}
+	else
+		partioData = Partio::read(fileName.c_str());
 
 	if (!partioData)
 		return false;
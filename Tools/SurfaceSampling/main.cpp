@@ -32,6 +32,8 @@ string inputFile = "";
 string outputFile = "";
 Real particleRadius = 0.025;
 Vector3r scale = Vector3r::Ones();
+bool useSeed = false;
+unsigned int seed = 0;
 
 std::istream& operator >> (std::istream& istream, Vector3r& v)
 {
@@ -58,6 +60,7 @@ int main( int argc, char **argv )
 			("o,output", "Output file (bgeo)", cxxopts::value<std::string>())
 			("r,radius", "Particle radius", cxxopts::value<Real>()->default_value("0.025"))
 			("s,scale", "Scaling of input geometry (e.g. --scale \"1 2 3\")", cxxopts::value<Vector3r>())
+			("seed", "Seed of the random number generator (for a reproducible sampling)", cxxopts::value<unsigned int>())
 			;
 
 		auto result = options.parse(argc, argv);
@@ -89,6 +92,13 @@ int main( int argc, char **argv )
 		if (result.count("scale"))
 			scale = result["scale"].as<Vector3r>();
 		cout << "Scale: " << scale << endl;
+
+		if (result.count("seed"))
+		{
+			seed = result["seed"].as<unsigned int>();
+			useSeed = true;
+			cout << "Seed: " << seed << endl;
+		}
 	}
 	catch (const cxxopts::OptionException& e)
 	{
@@ -103,6 +113,8 @@ int main( int argc, char **argv )
 	std::cout << "Surface sampling of " << inputFile << "\n";
 	START_TIMING("Poisson disk sampling");
 	PoissonDiskSampling sampling;
+	if (useSeed)
+		sampling.setSeed(seed);
 	std::vector<Vector3r> samplePoints;
 	sampling.sampleMesh(mesh.numVertices(), mesh.getVertices().data(), mesh.numFaces(), mesh.getFaces().data(), particleRadius, 10, 1, samplePoints);
 	STOP_TIMING_AVG;
@@ -3,11 +3,13 @@
 #include "extern/cxxopts/cxxopts.hpp"
 #include "Utilities/Timing.h"
 #include "Utilities/OBJLoader.h"
+#include "Utilities/FileSystem.h"
 #include "SPlisHSPlasH/Utilities/VolumeSampling.h"
 #include "Utilities/PartioReaderWriter.h"
 #include "Utilities/Version.h"
 #include "SPlisHSPlasH/TriangleMesh.h"
 #include "Discregrid/All"
+#include <sstream>
 
 using namespace SPH;
 using namespace Eigen;
@@ -40,6 +42,9 @@ std::array<unsigned int, 3> resolutionSDF = { 30, 30, 30 };
 Vector3r bbmin, bbmax;
 std::shared_ptr<Discregrid::CubicLagrangeDiscreteGrid> distanceField;
 bool invert = false;
+std::string sdfCachePath = "";
+bool useWindingNumbers = false;
+Real windingNumberAccuracy = 2.0;
 
 std::istream& operator >> (std::istream& istream, AlignedBox3r &r)
 {
@@ -97,6 +102,9 @@ int main(int argc, char **argv)
 			("region", "Region to fill with particles (e.g. --region \"0 0 0 1 1 1\"", cxxopts::value<AlignedBox3r>())
 			("res", "Resolution of the Signed Distance Field (e.g. --res \"30 30 30\"", cxxopts::value<std::array<unsigned int, 3>>())
 			("invert", "Invert the SDF to sample the outside of the object in the bounding box/region")
+			("sdfcache", "Directory to cache the Signed Distance Field", cxxopts::value<std::string>())
+			("winding", "Use fast winding numbers instead of the Signed Distance Field for the inside test (for meshes which are not closed)")
+			("accuracy", "Accuracy of the fast winding numbers", cxxopts::value<Real>()->default_value("2.0"))
 			;
 
 		auto result = options.parse(argc, argv);
@@ -150,6 +158,21 @@ int main(int argc, char **argv)
 		{
 			invert = true;
 		}
+
+		if (result.count("winding"))
+		{
+			useWindingNumbers = true;
+			LOG_INFO << "Use fast winding numbers";
+		}
+
+		if (result.count("accuracy"))
+			windingNumberAccuracy = result["accuracy"].as<Real>();
+
+		if (result.count("sdfcache"))
+		{
+			sdfCachePath = result["sdfcache"].as<std::string>();
+			LOG_INFO << "SDF cache: " << sdfCachePath;
+		}
 	}
 	catch (const cxxopts::OptionException& e)
 	{
@@ -160,18 +183,35 @@ int main(int argc, char **argv)
 	TriangleMesh mesh;
 	loadObj(inputFile, mesh, scale*Vector3r::Ones());
 
+	// the SDF depends on the mesh, its scaling, the region, the resolution and the invert flag
+	std::string sdfFileName = "";
+	if ((sdfCachePath != "") && (FileSystem::makeDirs(sdfCachePath) == 0))
+	{
+		std::ostringstream key;
+		key << FileSystem::getFileName(inputFile) << "_" << FileSystem::getFileMD5(inputFile) << "_s" << scale
+			<< "_r" << resolutionSDF[0] << "_" << resolutionSDF[1] << "_" << resolutionSDF[2];
+		if (useRegion)
+			key << "_reg" << region.min()[0] << "_" << region.min()[1] << "_" << region.min()[2] << "_" << region.max()[0] << "_" << region.max()[1] << "_" << region.max()[2];
+		if (invert)
+			key << "_inv";
+		sdfFileName = FileSystem::normalizePath(sdfCachePath + "/" + key.str() + ".cdf");
+	}
+
 	START_TIMING("Volume sampling");
 	if (useRegion)
 	{
 		region.min() = scale * region.min();
 		region.max() = scale * region.max();
-		Utilities::VolumeSampling::sampleMesh(mesh.numVertices(), mesh.getVertices().data(), mesh.numFaces(), mesh.getFaces().data(),
-			radius, &region, resolutionSDF, invert, mode, particles);
+	}
+	if (useWindingNumbers)
+	{
+		Utilities::VolumeSampling::sampleMeshWindingNumbers(mesh.numVertices(), mesh.getVertices().data(), mesh.numFaces(), mesh.getFaces().data(),
+			radius, useRegion ? &region : nullptr, invert, mode, particles, windingNumberAccuracy);
 	}
 	else
 	{
 		Utilities::VolumeSampling::sampleMesh(mesh.numVertices(), mesh.getVertices().data(), mesh.numFaces(), mesh.getFaces().data(),
-			radius, nullptr, resolutionSDF, invert, mode, particles);
+			radius, useRegion ? &region : nullptr, resolutionSDF, invert, mode, particles, sdfFileName);
 	}
 	STOP_TIMING_PRINT;
 	PartioReaderWriter::writeParticles(outputFile, (unsigned int)particles.size(), particles.data(), NULL, radius);
@@ -3,17 +3,19 @@
 #include <iostream>
 #include "Utilities/Timing.h"
 #include "Utilities/PartioReaderWriter.h"
+#include "Utilities/ParticleCache.h"
 #include "Utilities/FileSystem.h"
 #include "Utilities/Version.h"
 #include "extern/partio/src/lib/Partio.h"
 #include "extern/cxxopts/cxxopts.hpp"
 
 #include <regex>
+#include <omp.h>
 
 // Enable memory leak detection
 #ifdef _DEBUG
 #ifndef EIGEN_ALIGN
-	#define new DEBUG_NEW 
+	#define new DEBUG_NEW
 #endif
 #endif
 
@@ -23,11 +25,35 @@ INIT_LOGGING
 using namespace Utilities;
 using Vector3f = Eigen::Vector3f;
 
-void saveParticleCloudVTK(const std::string & path, const Partio::ParticlesDataMutable * partioData);
+/** Frame which has to be converted. */
+struct FrameInfo
+{
+	std::string inputFile;
+	std::string outputName;
+	unsigned int frame;
+	Real time;
+};
+
+/** Error codes of the conversion of a frame. The frames are converted in
+* parallel, so the writers do not log but return a code which is reported
+* by the main thread.
+*/
+enum ConversionError { CONVERSION_OK = 0, CANNOT_READ_FRAME, CANNOT_OPEN_OUTPUT, NO_POSITIONS };
+
+int saveParticleCloudVTK(const std::string & path, const Partio::ParticlesDataMutable * partioData);
+int saveParticleCloudVTU(const std::string & path, const Partio::ParticlesDataMutable * partioData);
+const char *conversionErrorMessage(const int error);
+bool isSupportedAttribute(const Partio::ParticleAttribute &attr);
+void savePVD(const std::string & path, const std::vector<FrameInfo> &frames);
+Partio::ParticlesDataMutable *readFrame(const FrameInfo &frameInfo, ParticleCacheReader &reader);
+size_t estimateFrameMemory(const Partio::ParticlesDataMutable * partioData);
 
 std::string inputFile = "";
 int startFrame = -1;
 int endFrame = -1;
+int numThreads = -1;
+unsigned int memoryLimit = 4096;
+bool writeVTU = false;
 std::string exePath, dataPath, outDir;
 
 template<typename T>
@@ -40,7 +66,35 @@ inline void swapByteOrder(T*v)
 	std::memcpy(v, out, n);
 }
 
-// main 
+template<typename T>
+inline void swapByteOrder(std::vector<T> &v)
+{
+	for (size_t i = 0; i < v.size(); i++)
+		swapByteOrder(&v[i]);
+}
+
+/** Copy an attribute to a contiguous buffer. Partio stores the attributes of
+* ParticlesSimple in separate arrays, so in general a single copy is sufficient.
+*/
+template<typename T>
+void copyAttribute(const Partio::ParticlesDataMutable * partioData, const Partio::ParticleAttribute &attr, std::vector<T> &data)
+{
+	const unsigned int numParticles = partioData->numParticles();
+	const unsigned int count = attr.count;
+	data.resize(numParticles * count);
+	if (numParticles == 0)
+		return;
+	const T *first = partioData->data<T>(attr, 0);
+	if ((numParticles == 1) || (partioData->data<T>(attr, 1) == first + count))
+		std::memcpy(data.data(), first, data.size() * sizeof(T));
+	else
+	{
+		for (unsigned int i = 0u; i < numParticles; i++)
+			std::memcpy(&data[i * count], partioData->data<T>(attr, i), count * sizeof(T));
+	}
+}
+
+// main
 int main(int argc, char **argv)
 {
 	REPORT_MEMORY_LEAKS;
@@ -58,7 +112,7 @@ int main(int argc, char **argv)
 	{
 		cxxopts::Options options(argv[0], "partio2vtk - Converts partio to vtk files");
 		options
-			.positional_help("[single-file or sequence, e.g. particles_#.bgeo]")
+			.positional_help("[single-file, sequence, e.g. particles_#.bgeo, or particle cache, e.g. particles.sphc]")
 			.show_positional_help();
 
 		options.add_options()
@@ -66,6 +120,9 @@ int main(int argc, char **argv)
 			("s,startFrame", "Start frame (only used if value is >= 0)", cxxopts::value<int>()->default_value("-1"))
 			("e,endFrame", "End frame (only used if value is >= 0)", cxxopts::value<int>()->default_value("-1"))
 			("o,outputDir", "Output directory", cxxopts::value<std::string>())
+			("t,threads", "Maximum number of frames which are converted in parallel (only used if value is > 0)", cxxopts::value<int>()->default_value("-1"))
+			("m,memoryLimit", "Memory budget in MB for the frames which are converted in parallel", cxxopts::value<unsigned int>()->default_value("4096"))
+			("vtu", "Write XML vtu files and a pvd file for the sequence instead of legacy vtk files")
 			;
 
 		options.add_options("invisible")
@@ -101,44 +158,63 @@ int main(int argc, char **argv)
 		if (result.count("endFrame"))
 			endFrame = result["endFrame"].as<int>();
 		LOG_INFO << "End frame: " << endFrame;
-		
+
+		if (result.count("threads"))
+			numThreads = result["threads"].as<int>();
+
+		if (result.count("memoryLimit"))
+			memoryLimit = result["memoryLimit"].as<unsigned int>();
+		LOG_INFO << "Memory limit: " << memoryLimit << " MB";
+
+		if (result.count("vtu"))
+			writeVTU = true;
+		LOG_INFO << "Output format: " << (writeVTU ? "vtu" : "vtk");
 	}
 	catch (const cxxopts::OptionException& e)
 	{
 		LOG_INFO << "error parsing options: " << e.what();
 		exit(1);
 	}
-	
+
 	const std::string fileName = FileSystem::getFileName(inputFile);
 	const std::string filePath = FileSystem::getFilePath(inputFile);
 	const std::string fileExt = FileSystem::getFileExt(inputFile);
+	const bool isCache = ParticleCacheReader::isParticleCacheFile(inputFile);
 
 	FileSystem::makeDirs(outDir);
 
+	//////////////////////////////////////////////////////////////////////////
+	// determine the frames to convert
+	std::vector<FrameInfo> frames;
 	const auto hashPos = fileName.find_first_of('#');
-	// convert single file
-	if (std::string::npos == hashPos)
+	if (isCache)
 	{
-		LOG_INFO << "Converting a single file";
-		Partio::ParticlesDataMutable * partioData = Partio::read(inputFile.c_str());
-		if (nullptr == partioData)
+		LOG_INFO << "Converting a particle cache file";
+		ParticleCacheReader reader;
+		if (!reader.open(inputFile))
 		{
 			LOG_ERR << "Could not read file " << inputFile;
 			return -1;
 		}
-		LOG_INFO << "Successfully read file " << inputFile;
-		std::string outputFile = outDir + "/" + fileName + ".vtk";
-		LOG_INFO << "Writing file " << outputFile;
-		saveParticleCloudVTK(outputFile, partioData);
-		LOG_INFO << "Freeing data";
-		partioData->release();
-		LOG_INFO << "Done";
+		LOG_INFO << "Number of frames: " << reader.numFrames();
+		// frames are numbered starting with 1 like the partio export of the simulator
+		unsigned int start = 1;
+		if (startFrame >= 0)
+			start = std::max(1, startFrame);
+		unsigned int end = reader.numFrames();
+		if (endFrame >= 0)
+			end = std::min(end, (unsigned int)endFrame);
+		for (unsigned int i = start; i <= end; i++)
+			frames.push_back({ inputFile, fileName + "_" + std::to_string(i), i - 1, reader.getFrameTime(i - 1) });
+	}
+	else if (std::string::npos == hashPos)
+	{
+		LOG_INFO << "Converting a single file";
+		frames.push_back({ inputFile, fileName, 0, 0.0 });
 	}
-	// convert files that match the pattern
 	else
 	{
 		LOG_INFO << "Converting a range of files";
-		const auto hashesEnd = fileName.find_last_of('#');
 		unsigned int start = 1;
 		if (startFrame >= 0)
 			start = startFrame;
@@ -156,41 +232,171 @@ int main(int argc, char **argv)
 				LOG_INFO << "File " << inputFileWithNumber << " does not exist. Assuming the last file has been read.";
 				break;
 			}
-			Partio::ParticlesDataMutable * partioData = Partio::read(inputFileWithNumber.c_str());
-			if (nullptr == partioData)
-				break;
+			frames.push_back({ inputFileWithNumber, fileNameWithNumber, i, static_cast<Real>(i) });
+		}
+	}
+	if (frames.size() == 0)
+	{
+		LOG_INFO << "No frames found";
+		return 0;
+	}
+
+	START_TIMING("Converting files");
+	const std::string outputExt = writeVTU ? ".vtu" : ".vtk";
 
-			LOG_INFO << "Successfully read file " << inputFileWithNumber;
-			std::string outputFile = outDir + "/" + fileNameWithNumber + ".vtk";
-			LOG_INFO << "Writing file " << outputFile;
-			saveParticleCloudVTK(outputFile, partioData);
-			LOG_INFO << "Freeing data";
-			partioData->release();
+	//////////////////////////////////////////////////////////////////////////
+	// The first frame is converted alone. Its memory consumption determines
+	// how many frames can be converted in parallel.
+	size_t frameMemory = 0;
+	{
+		ParticleCacheReader reader;
+		if (isCache)
+			reader.open(inputFile);
+		Partio::ParticlesDataMutable * partioData = readFrame(frames[0], reader);
+		if (nullptr == partioData)
+		{
+			LOG_ERR << "Could not read file " << frames[0].inputFile;
+			return -1;
+		}
+		LOG_INFO << "Successfully read file " << frames[0].inputFile;
+		for (int i = 0; i < partioData->numAttributes(); i++)
+		{
+			Partio::ParticleAttribute attr;
+			partioData->attributeInfo(i, attr);
+			LOG_INFO << "Found attribute: " << attr.name;
+			if (!isSupportedAttribute(attr))
+				LOG_WARN << "Skipping attribute " << attr.name << ", because it is of unsupported type " << (attr.type == Partio::ParticleAttributeType::INDEXEDSTR ? "INDEXEDSTR" : "NONE");
+		}
+		frameMemory = estimateFrameMemory(partioData);
+		const std::string outputFile = outDir + "/" + frames[0].outputName + outputExt;
+		LOG_INFO << "Writing file " << outputFile;
+		int error;
+		if (writeVTU)
+			error = saveParticleCloudVTU(outputFile, partioData);
+		else
+			error = saveParticleCloudVTK(outputFile, partioData);
+		partioData->release();
+		if (CONVERSION_OK != error)
+		{
+			LOG_ERR << conversionErrorMessage(error) << " (" << outputFile << ")";
+			return -1;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// convert the remaining frames in parallel
+	if (frames.size() > 1)
+	{
+		int maxThreads = omp_get_max_threads();
+		if (numThreads > 0)
+			maxThreads = std::min(maxThreads, numThreads);
+		const size_t budget = static_cast<size_t>(memoryLimit) * 1024u * 1024u;
+		const int threads = std::max(1, std::min(maxThreads, static_cast<int>(std::min(budget / std::max(frameMemory, (size_t) 1), (size_t) maxThreads))));
+		LOG_INFO << "Converting " << frames.size() - 1 << " frames with " << threads << " threads (estimated memory per frame: " << frameMemory / (1024 * 1024) << " MB)";
+
+		// each frame has its own error code, the errors are reported after the parallel region
+		std::vector<int> errors(frames.size(), CONVERSION_OK);
+		bool success = true;
+		#pragma omp parallel default(shared) num_threads(threads) reduction(&&:success)
+		{
+			// each thread reads a contiguous block of frames, so that a particle cache is decoded sequentially
+			ParticleCacheReader reader;
+			if (isCache)
+				reader.open(inputFile);
+
+			#pragma omp for schedule(static)
+			for (int i = 1; i < (int)frames.size(); i++)
+			{
+				// a thread stops converting its block after the first error
+				if (!success)
+					continue;
+				Partio::ParticlesDataMutable * partioData = readFrame(frames[i], reader);
+				if (nullptr == partioData)
+				{
+					errors[i] = CANNOT_READ_FRAME;
+					success = false;
+					continue;
+				}
+				const std::string outputFile = outDir + "/" + frames[i].outputName + outputExt;
+				if (writeVTU)
+					errors[i] = saveParticleCloudVTU(outputFile, partioData);
+				else
+					errors[i] = saveParticleCloudVTK(outputFile, partioData);
+				partioData->release();
+
+				if (CONVERSION_OK != errors[i])
+				{
+					success = false;
+					continue;
+				}
+				#pragma omp critical (log)
+				LOG_INFO << "Written file " << outputFile;
+			}
+		}
+
+		if (!success)
+		{
+			for (size_t i = 1; i < frames.size(); i++)
+			{
+				if (CONVERSION_OK != errors[i])
+					LOG_ERR << conversionErrorMessage(errors[i]) << " (" << frames[i].inputFile << ", frame " << frames[i].frame << ")";
+			}
+			return -1;
 		}
 	}
 
+	if (writeVTU && ((frames.size() > 1) || isCache))
+	{
+		std::string pvdName;
+		std::regex_replace(std::back_inserter(pvdName), fileName.begin(), fileName.end(), std::regex("_?#+"), "");
+		const std::string pvdFile = outDir + "/" + pvdName + ".pvd";
+		LOG_INFO << "Writing file " << pvdFile;
+		savePVD(pvdFile, frames);
+	}
+	STOP_TIMING_AVG;
+
 	Timing::printAverageTimes();
 	Timing::printTimeSums();
-	
+
 	return 0;
 }
 
+Partio::ParticlesDataMutable *readFrame(const FrameInfo &frameInfo, ParticleCacheReader &reader)
+{
+	if (reader.isOpen())
+		return reader.readFramePartio(frameInfo.frame);
+	return Partio::read(frameInfo.inputFile.c_str());
+}
+
+/** Estimate the memory which is required to convert a frame: the partio data,
+* the output buffers and the cells.
+*/
+size_t estimateFrameMemory(const Partio::ParticlesDataMutable * partioData)
+{
+	const size_t numParticles = partioData->numParticles();
+	size_t bytes = 0;
+	for (int i = 0; i < partioData->numAttributes(); i++)
+	{
+		Partio::ParticleAttribute attr;
+		partioData->attributeInfo(i, attr);
+		bytes += numParticles * attr.count * sizeof(float);
+	}
+	return 2 * bytes + 3 * numParticles * sizeof(int);
+}
+
 /*
 Note: Binary VTK works with big endianness.
 */
-void saveParticleCloudVTK(const std::string & path, const Partio::ParticlesDataMutable * partioData)
+int saveParticleCloudVTK(const std::string & path, const Partio::ParticlesDataMutable * partioData)
 {
 	const unsigned int numParticles = partioData->numParticles();
 	if (0 == numParticles)
-		return;
+		return CONVERSION_OK;
 
-	START_TIMING("Writing VTK file");
 	// Open the file
 	std::ofstream outfile{ path, std::ios::binary };
-	if (!outfile.is_open()) {
-		LOG_ERR << "Cannot open a file to save a VTK mesh.";
-		exit(-1);
-	}
+	if (!outfile.is_open())
+		return CANNOT_OPEN_OUTPUT;
 
 	outfile << "# vtk DataFile Version 4.1\n";
 	outfile << "\n";
@@ -209,8 +415,6 @@ void saveParticleCloudVTK(const std::string & path, const Partio::ParticlesDataM
 			posIndex = i;
 		else if (attr.name == "id")
 			idIndex = i;
-
-		LOG_INFO << "Found attribute: " << attr.name;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -218,61 +422,53 @@ void saveParticleCloudVTK(const std::string & path, const Partio::ParticlesDataM
 	if (0xffffffff != posIndex)
 	{
 		// copy from partio data
-		std::vector<Vector3f> positions;
-		positions.reserve(numParticles);
+		std::vector<float> positions;
 		Partio::ParticleAttribute attr;
 		partioData->attributeInfo(posIndex, attr);
-		for (unsigned int i = 0u; i < numParticles; i++)
-			positions.emplace_back(partioData->data<float>(attr, i));
+		copyAttribute(partioData, attr, positions);
 		// swap endianess
-		for (unsigned int i = 0; i < numParticles; i++)
-			for (unsigned int c = 0; c < 3; c++)
-				swapByteOrder(&positions[i][c]);
+		swapByteOrder(positions);
 		// export to vtk
 		outfile << "POINTS " << numParticles << " float\n";
-		outfile.write(reinterpret_cast<char*>(positions[0].data()), 3 * numParticles * sizeof(float));
+		outfile.write(reinterpret_cast<char*>(positions.data()), 3 * numParticles * sizeof(float));
 		outfile << "\n";
 	}
 	else
-	{
-		LOG_ERR << "No particle positions found!";
-		STOP_TIMING_AVG;
-		return;
-	}
+		return NO_POSITIONS;
 
 	//////////////////////////////////////////////////////////////////////////
 	// export particle IDs as CELLS
 	{
-		std::vector<Eigen::Vector2i> cells;
-		cells.reserve(numParticles);
-		int nodes_per_cell_swapped = 1;
-		swapByteOrder(&nodes_per_cell_swapped);
+		std::vector<int> ids;
 		if (0xffffffff != idIndex)
 		{
 			// load IDs from partio
 			Partio::ParticleAttribute attr;
 			partioData->attributeInfo(idIndex, attr);
-			for (unsigned int i = 0u; i < numParticles; i++)
-			{
-				int idSwapped = *partioData->data<int>(attr, i);
-				swapByteOrder(&idSwapped);
-				cells.emplace_back(nodes_per_cell_swapped, idSwapped);
-			}
+			copyAttribute(partioData, attr, ids);
 		}
 		else
 		{
 			// generate IDs
+			ids.resize(numParticles);
 			for (unsigned int i = 0u; i < numParticles; i++)
-			{
-				int idSwapped = i;
-				swapByteOrder(&idSwapped);
-				cells.emplace_back(nodes_per_cell_swapped, idSwapped);
-			}
+				ids[i] = i;
+		}
+
+		int nodes_per_cell_swapped = 1;
+		swapByteOrder(&nodes_per_cell_swapped);
+		std::vector<int> cells(2 * numParticles);
+		for (unsigned int i = 0u; i < numParticles; i++)
+		{
+			int idSwapped = ids[i];
+			swapByteOrder(&idSwapped);
+			cells[2 * i] = nodes_per_cell_swapped;
+			cells[2 * i + 1] = idSwapped;
 		}
 
 		// particles are cells with one element and the index of the particle
 		outfile << "CELLS " << numParticles << " " << 2 * numParticles << "\n";
-		outfile.write(reinterpret_cast<char*>(cells[0].data()), 2 * numParticles * sizeof(int));
+		outfile.write(reinterpret_cast<char*>(cells.data()), 2 * numParticles * sizeof(int));
 		outfile << "\n";
 	}
 	//////////////////////////////////////////////////////////////////////////
@@ -306,57 +502,212 @@ void saveParticleCloudVTK(const std::string & path, const Partio::ParticlesDataM
 		// write header information
 		outfile << attrNameVTK << " " << attr.count << " " << numParticles;
 		// write depending on data type
-		if (attr.type == Partio::ParticleAttributeType::FLOAT)
+		if ((attr.type == Partio::ParticleAttributeType::FLOAT) || (attr.type == Partio::ParticleAttributeType::VECTOR))
 		{
 			outfile << " float\n";
 			// copy from partio data
 			std::vector<float> attrData;
-			attrData.reserve(partioData->numParticles());
-			for (unsigned int i = 0u; i < numParticles; i++)
-				attrData.emplace_back(*partioData->data<float>(attr, i));
-			// swap endianess
-			for (unsigned int i = 0; i < numParticles; i++)
-				swapByteOrder(&attrData[i]);
-			// export to vtk
-			outfile.write(reinterpret_cast<char*>(attrData.data()), numParticles * sizeof(float));
-		}
-		else if (attr.type == Partio::ParticleAttributeType::VECTOR)
-		{
-			outfile << " float\n";
-			// copy from partio data
-			std::vector<Vector3f> attrData;
-			attrData.reserve(partioData->numParticles());
-			for (unsigned int i = 0u; i < numParticles; i++)
-				attrData.emplace_back(partioData->data<float>(attr, i));
+			copyAttribute(partioData, attr, attrData);
 			// swap endianess
-			for (unsigned int i = 0; i < numParticles; i++)
-				for (unsigned int c = 0; c < 3; c++)
-					swapByteOrder(&attrData[i][c]);
+			swapByteOrder(attrData);
 			// export to vtk
-			outfile.write(reinterpret_cast<char*>(attrData[0].data()), 3 * numParticles * sizeof(float));
+			outfile.write(reinterpret_cast<char*>(attrData.data()), attrData.size() * sizeof(float));
 		}
 		else if (attr.type == Partio::ParticleAttributeType::INT)
 		{
 			outfile << " int\n";
 			// copy from partio data
 			std::vector<int> attrData;
-			attrData.reserve(partioData->numParticles());
-			for (unsigned int i = 0u; i < numParticles; i++)
-				attrData.emplace_back(*partioData->data<int>(attr, i));
+			copyAttribute(partioData, attr, attrData);
 			// swap endianess
-			for (unsigned int i = 0; i < numParticles; i++)
-				swapByteOrder(&attrData[i]);
+			swapByteOrder(attrData);
 			// export to vtk
-			outfile.write(reinterpret_cast<char*>(attrData.data()), numParticles * sizeof(int));
+			outfile.write(reinterpret_cast<char*>(attrData.data()), attrData.size() * sizeof(int));
 		}
 		else
-		{
-			LOG_WARN << "Skipping attribute " << attr.name << ", because it is of unsupported type " << (attr.type == Partio::ParticleAttributeType::INDEXEDSTR ? "INDEXEDSTR" : "NONE") << "\n";
 			continue;
-		}
 		// end of block
 		outfile << "\n";
 	}
 	outfile.close();
-	STOP_TIMING_AVG;
-}
\ No newline at end of file
+	return CONVERSION_OK;
+}
+
+/** Data array which is written to the appended data section of a vtu file. */
+struct AppendedArray
+{
+	std::string name;
+	std::string type;
+	unsigned int numComponents;
+	std::vector<char> data;
+};
+
+template<typename T>
+void setArrayData(AppendedArray &array, const std::vector<T> &data)
+{
+	array.data.resize(data.size() * sizeof(T));
+	if (data.size() > 0)
+		std::memcpy(array.data.data(), data.data(), array.data.size());
+}
+
+void writeDataArrayHeader(std::ofstream &outfile, const AppendedArray &array, const uint64_t offset)
+{
+	outfile << "        <DataArray type=\"" << array.type << "\"";
+	if (!array.name.empty())
+		outfile << " Name=\"" << array.name << "\"";
+	outfile << " NumberOfComponents=\"" << array.numComponents << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+}
+
+/*
+Note: The XML format uses the byte order of the machine and stores all arrays
+as raw binary data in the appended section. Each array is preceded by its size
+in bytes (UInt64).
+*/
+int saveParticleCloudVTU(const std::string & path, const Partio::ParticlesDataMutable * partioData)
+{
+	const unsigned int numParticles = partioData->numParticles();
+
+	std::ofstream outfile{ path, std::ios::binary };
+	if (!outfile.is_open())
+		return CANNOT_OPEN_OUTPUT;
+
+	// collect arrays
+	AppendedArray points{ "", "Float32", 3, {} };
+	std::vector<AppendedArray> pointData;
+	bool hasPositions = false;
+	for (int a = 0; a < partioData->numAttributes(); a++)
+	{
+		Partio::ParticleAttribute attr;
+		partioData->attributeInfo(a, attr);
+		if (attr.name == "position")
+		{
+			std::vector<float> data;
+			copyAttribute(partioData, attr, data);
+			setArrayData(points, data);
+			hasPositions = true;
+			continue;
+		}
+
+		std::string attrNameVTK;
+		std::regex_replace(std::back_inserter(attrNameVTK), attr.name.begin(), attr.name.end(), std::regex("\\s+"), "_");
+		if ((attr.type == Partio::ParticleAttributeType::FLOAT) || (attr.type == Partio::ParticleAttributeType::VECTOR))
+		{
+			pointData.push_back({ attrNameVTK, "Float32", (unsigned int)attr.count, {} });
+			std::vector<float> data;
+			copyAttribute(partioData, attr, data);
+			setArrayData(pointData.back(), data);
+		}
+		else if (attr.type == Partio::ParticleAttributeType::INT)
+		{
+			pointData.push_back({ attrNameVTK, "Int32", (unsigned int)attr.count, {} });
+			std::vector<int> data;
+			copyAttribute(partioData, attr, data);
+			setArrayData(pointData.back(), data);
+		}
+	}
+	if (!hasPositions)
+		return NO_POSITIONS;
+
+	// each particle is a vertex cell
+	AppendedArray connectivity{ "connectivity", "Int32", 1, {} };
+	AppendedArray offsets{ "offsets", "Int32", 1, {} };
+	AppendedArray types{ "types", "UInt8", 1, {} };
+	{
+		std::vector<int> indices(numParticles);
+		for (unsigned int i = 0u; i < numParticles; i++)
+			indices[i] = i;
+		setArrayData(connectivity, indices);
+		for (unsigned int i = 0u; i < numParticles; i++)
+			indices[i] = i + 1;
+		setArrayData(offsets, indices);
+		types.data.resize(numParticles, 1);
+	}
+
+	const uint16_t endianTest = 1;
+	const bool littleEndian = *reinterpret_cast<const uint8_t*>(&endianTest) == 1;
+
+	// header
+	uint64_t offset = 0;
+	outfile << "<?xml version=\"1.0\"?>\n";
+	outfile << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << (littleEndian ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\">\n";
+	outfile << "  <UnstructuredGrid>\n";
+	outfile << "    <Piece NumberOfPoints=\"" << numParticles << "\" NumberOfCells=\"" << numParticles << "\">\n";
+	outfile << "      <PointData>\n";
+	for (size_t i = 0; i < pointData.size(); i++)
+	{
+		writeDataArrayHeader(outfile, pointData[i], offset);
+		offset += sizeof(uint64_t) + pointData[i].data.size();
+	}
+	outfile << "      </PointData>\n";
+	outfile << "      <Points>\n";
+	writeDataArrayHeader(outfile, points, offset);
+	offset += sizeof(uint64_t) + points.data.size();
+	outfile << "      </Points>\n";
+	outfile << "      <Cells>\n";
+	writeDataArrayHeader(outfile, connectivity, offset);
+	offset += sizeof(uint64_t) + connectivity.data.size();
+	writeDataArrayHeader(outfile, offsets, offset);
+	offset += sizeof(uint64_t) + offsets.data.size();
+	writeDataArrayHeader(outfile, types, offset);
+	outfile << "      </Cells>\n";
+	outfile << "    </Piece>\n";
+	outfile << "  </UnstructuredGrid>\n";
+
+	// appended raw data
+	outfile << "  <AppendedData encoding=\"raw\">\n   _";
+	auto writeArray = [&outfile](const AppendedArray &array)
+	{
+		const uint64_t size = array.data.size();
+		outfile.write(reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+		outfile.write(array.data.data(), array.data.size());
+	};
+	for (size_t i = 0; i < pointData.size(); i++)
+		writeArray(pointData[i]);
+	writeArray(points);
+	writeArray(connectivity);
+	writeArray(offsets);
+	writeArray(types);
+	outfile << "\n  </AppendedData>\n";
+	outfile << "</VTKFile>\n";
+	outfile.close();
+	return CONVERSION_OK;
+}
+
+/** Write a ParaView data file which defines the time series of the converted frames.
+*/
+void savePVD(const std::string & path, const std::vector<FrameInfo> &frames)
+{
+	std::ofstream outfile{ path };
+	if (!outfile.is_open()) {
+		LOG_ERR << "Cannot open file " << path;
+		return;
+	}
+
+	outfile << "<?xml version=\"1.0\"?>\n";
+	outfile << "<VTKFile type=\"Collection\" version=\"0.1\">\n";
+	outfile << "  <Collection>\n";
+	for (size_t i = 0; i < frames.size(); i++)
+		outfile << "    <DataSet timestep=\"" << frames[i].time << "\" group=\"\" part=\"0\" file=\"" << frames[i].outputName << ".vtu\"/>\n";
+	outfile << "  </Collection>\n";
+	outfile << "</VTKFile>\n";
+	outfile.close();
+}
+
+const char *conversionErrorMessage(const int error)
+{
+	switch (error)
+	{
+	case CANNOT_READ_FRAME: return "Could not read file";
+	case CANNOT_OPEN_OUTPUT: return "Cannot open the output file";
+	case NO_POSITIONS: return "No particle positions found";
+	default: return "Unknown error";
+	}
+}
+
+/** Return true if the attribute can be written to a VTK or VTU file. */
+bool isSupportedAttribute(const Partio::ParticleAttribute &attr)
+{
+	return (attr.type == Partio::ParticleAttributeType::FLOAT) ||
+		(attr.type == Partio::ParticleAttributeType::VECTOR) ||
+		(attr.type == Partio::ParticleAttributeType::INT);
+}
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <unordered_map>
+#include <mutex>
 #include "SPlisHSPlasH/Common.h"
 #include "Logger.h"
 #include "Timing.h"
@@ -13,7 +14,8 @@ namespace Utilities
 		Utilities::Counting::increaseCounter(counterName, increaseBy);
 
 #define INIT_COUNTING \
-		std::unordered_map<std::string, Utilities::AverageCount> Utilities::Counting::m_averageCounts; 
+		std::unordered_map<std::string, Utilities::AverageCount> Utilities::Counting::m_averageCounts; \
+		std::mutex Utilities::Counting::m_mutex;
 
 	struct AverageCount
 	{
@@ -25,14 +27,18 @@ namespace Utilities
 	{
 	public:
 		static std::unordered_map<std::string, AverageCount> m_averageCounts;
+		/** Counters can be increased by several simulations which run in different threads. */
+		static std::mutex m_mutex;
 
 		static void reset()
 		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 			m_averageCounts.clear();
 		}
 
 		FORCE_INLINE static void increaseCounter(const std::string& name, const Real increaseBy)
 		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 			std::unordered_map<std::string, AverageCount>::iterator iter;
 			iter = Counting::m_averageCounts.find(name);
 			if (iter != Counting::m_averageCounts.end())
@@ -51,6 +57,7 @@ namespace Utilities
 
 		FORCE_INLINE static void printAverageCounts()
 		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 			std::unordered_map <std::string, AverageCount>::iterator iter;
 			for (iter = Counting::m_averageCounts.begin(); iter != Counting::m_averageCounts.end(); iter++)
 			{
@@ -63,6 +70,7 @@ namespace Utilities
 
 		FORCE_INLINE static void printCounterSums()
 		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 			std::unordered_map <std::string, AverageCount>::iterator iter;
 			for (iter = Counting::m_averageCounts.begin(); iter != Counting::m_averageCounts.end(); iter++)
 			{
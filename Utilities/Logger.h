@@ -8,6 +8,16 @@
 #include <iomanip>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#ifndef _WIN32
+#include <time.h>
+#endif
 
 
 namespace Utilities
@@ -22,6 +32,7 @@ namespace Utilities
 		LogSink(const LogLevel minLevel) : m_minLevel(minLevel) {}
 		virtual ~LogSink() {}
 		virtual void write(const LogLevel level, const std::string &str) = 0;
+		virtual void flush() {}
 	};
 
 	class ConsoleSink : public LogSink
@@ -42,7 +53,12 @@ namespace Utilities
 			else if (level == LogLevel::ERR)
 				std::cerr << "Error: ";
 
-			std::cout << str << std::endl;
+			std::cout << str << "\n";
+		}
+
+		virtual void flush()
+		{
+			std::cout.flush();
 		}
 	};
 
@@ -95,36 +111,331 @@ namespace Utilities
 			else if (level == LogLevel::ERR)
 				m_file << "Error:   ";
 
-			m_file << str << std::endl;
+			m_file << str << "\n";
+		}
+
+		virtual void flush()
+		{
 			m_file.flush();
 		}
 	};
 
+	/** \brief Bounded lock-free ring buffer for log messages with multiple producers
+	* and a single consumer (see D. Vyukov, bounded MPMC queue).
+	*/
+	class LogRingBuffer
+	{
+	protected:
+		struct Cell
+		{
+			std::atomic<size_t> m_sequence;
+			LogLevel m_level;
+			std::string m_message;
+		};
+
+		std::unique_ptr<Cell[]> m_buffer;
+		size_t m_mask;
+		std::atomic<size_t> m_enqueuePos;
+		size_t m_dequeuePos;
+
+	public:
+		/** The size is rounded up to a power of two. */
+		LogRingBuffer(const size_t size)
+		{
+			size_t n = 2;
+			while (n < size)
+				n *= 2;
+			m_buffer.reset(new Cell[n]);
+			m_mask = n - 1;
+			for (size_t i = 0; i < n; i++)
+				m_buffer[i].m_sequence.store(i, std::memory_order_relaxed);
+			m_enqueuePos.store(0, std::memory_order_relaxed);
+			m_dequeuePos = 0;
+		}
+
+		/** Add a message. Returns false if the buffer is full. Can be called by any thread. */
+		bool push(const LogLevel level, std::string &&message)
+		{
+			Cell *cell;
+			size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				cell = &m_buffer[pos & m_mask];
+				const size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+				const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+				if (diff == 0)
+				{
+					if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false;
+				else
+					pos = m_enqueuePos.load(std::memory_order_relaxed);
+			}
+			cell->m_level = level;
+			cell->m_message = std::move(message);
+			cell->m_sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Remove the oldest message. Returns false if the buffer is empty. Must only be called by one thread at a time. */
+		bool pop(LogLevel &level, std::string &message)
+		{
+			Cell *cell = &m_buffer[m_dequeuePos & m_mask];
+			const size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+			if ((intptr_t)seq - (intptr_t)(m_dequeuePos + 1) < 0)
+				return false;
+			level = cell->m_level;
+			message.swap(cell->m_message);
+			cell->m_message.clear();
+			cell->m_sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+			m_dequeuePos++;
+			return true;
+		}
+	};
+
+	/** \brief Logger which passes the messages to all sinks.
+	* In the asynchronous mode the messages are stored in a ring buffer and
+	* written by a background thread, so that the calling thread never waits
+	* for the sinks. If the buffer is full, messages are dropped and counted.
+	* The remaining messages are written when the asynchronous mode is
+	* deactivated or the logger is destroyed (also by exit()). If the program
+	* is terminated by a signal, the signal handler only sets a flag and the
+	* background thread writes the messages before the signal is raised again
+	* with the previous handler.
+	*/
 	class Logger
 	{
 	public: 
-		Logger() {}
+		Logger() : m_dropped(0), m_reportedDropped(0), m_running(false), m_ownsSignalHandlers(false) {}
 		~Logger() 
 		{ 
+			deactivateAsyncMode();
 			m_sinks.clear();  
 		}
 
 	protected:
 		std::vector<std::unique_ptr<LogSink>> m_sinks;
+		std::mutex m_sinkMutex;
+		std::unique_ptr<LogRingBuffer> m_buffer;
+		std::thread m_thread;
+		std::mutex m_wakeMutex;
+		std::condition_variable m_wakeCondition;
+		std::atomic<unsigned int> m_dropped;
+		unsigned int m_reportedDropped;
+		std::atomic<bool> m_running;
+		bool m_ownsSignalHandlers;
+
+		typedef void (*SignalHandler)(int);
+		static const unsigned int NumSignals = 6;
+
+		/** State which is shared with the signal handler. It only contains
+		* lock-free atomics and the previous handlers, so it is zero-initialized.
+		*/
+		struct SignalState
+		{
+			/** signal which was received, 0 if none */
+			std::atomic<int> m_signal;
+			/** set by the background thread when the messages are written */
+			std::atomic<bool> m_drained;
+			SignalHandler m_previousHandlers[NumSignals];
+		};
+
+		static Logger *&asyncLogger() { static Logger *l = nullptr; return l; }
+		static SignalState &signalState() { static SignalState s; return s; }
+
+		static int getSignal(const unsigned int i)
+		{
+			static const int signals[NumSignals] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGTERM, SIGINT };
+			return signals[i];
+		}
+
+		/** The program cannot continue after these signals, so the handler must not return. */
+		static bool isFatalSignal(const int sig) { return (sig != SIGTERM) && (sig != SIGINT); }
+
+		static SignalHandler getPreviousHandler(const int sig)
+		{
+			for (unsigned int i = 0; i < NumSignals; i++)
+			{
+				if (getSignal(i) == sig)
+				{
+					SignalHandler h = signalState().m_previousHandlers[i];
+					if ((h == SIG_ERR) || ((h == SIG_IGN) && isFatalSignal(sig)))
+						return SIG_DFL;
+					return h;
+				}
+			}
+			return SIG_DFL;
+		}
+
+		static void restoreSignalHandlers()
+		{
+			for (unsigned int i = 0; i < NumSignals; i++)
+				std::signal(getSignal(i), getPreviousHandler(getSignal(i)));
+		}
+
+		void writeToSinks(const LogLevel level, const std::string &str)
+		{
+			for (unsigned int i = 0; i < m_sinks.size(); i++)
+				m_sinks[i]->write(level, str);
+		}
+
+		void flushSinks()
+		{
+			for (unsigned int i = 0; i < m_sinks.size(); i++)
+				m_sinks[i]->flush();
+		}
+
+		/** Write all buffered messages. Called by the background thread and, after 
+		* it has stopped, by deactivateAsyncMode(), so there is only one consumer.
+		*/
+		void drain()
+		{
+			LogLevel level;
+			std::string message;
+			bool written = false;
+			{
+				std::lock_guard<std::mutex> lock(m_sinkMutex);
+				while (m_buffer->pop(level, message))
+				{
+					writeToSinks(level, message);
+					written = true;
+				}
+				const unsigned int dropped = m_dropped.load();
+				if (dropped != m_reportedDropped)
+				{
+					writeToSinks(LogLevel::WARN, "Logger: " + std::to_string(dropped - m_reportedDropped) + " messages dropped (buffer full).");
+					m_reportedDropped = dropped;
+					written = true;
+				}
+				if (written)
+					flushSinks();
+			}
+		}
+
+		/** Write the buffered messages. If a signal was received before, raise it 
+		* again with the previous handler.
+		*/
+		void drainAndHandleSignal()
+		{
+			const int sig = m_ownsSignalHandlers ? signalState().m_signal.load() : 0;
+			drain();
+			if (sig == 0)
+				return;
+			signalState().m_drained = true;
+			// the handler of a fatal signal waits for the flag and terminates the program
+			if (!isFatalSignal(sig))
+			{
+				restoreSignalHandlers();
+				signalState().m_signal = 0;
+				std::raise(sig);
+			}
+		}
+
+		void run()
+		{
+			while (m_running.load())
+			{
+				drainAndHandleSignal();
+				std::unique_lock<std::mutex> lock(m_wakeMutex);
+				m_wakeCondition.wait_for(lock, std::chrono::milliseconds(50));
+			}
+			drainAndHandleSignal();
+		}
+
+		/** Only uses async-signal-safe operations. The buffered messages are written
+		* by the background thread, which polls the flag at least every 50 ms.
+		*/
+		static void signalHandler(int sig)
+		{
+			SignalState &s = signalState();
+			int expected = 0;
+			s.m_signal.compare_exchange_strong(expected, sig);
+			if (!isFatalSignal(sig))
+				return;
+
+			// wait up to 200 ms for the background thread and terminate with the previous handler
+#ifndef _WIN32
+			for (unsigned int i = 0; (i < 200) && !s.m_drained.load(); i++)
+			{
+				struct timespec ts = { 0, 1000000 };
+				nanosleep(&ts, nullptr);
+			}
+#endif
+			std::signal(sig, getPreviousHandler(sig));
+			std::raise(sig);
+		}
 
 	public:
 		// Todo: format
 
 		void addSink(std::unique_ptr<LogSink> sink)
 		{
+			std::lock_guard<std::mutex> lock(m_sinkMutex);
 			m_sinks.push_back(std::move(sink));
 		}
 
 		void write(const LogLevel level, const std::string &str)
 		{
-			for (unsigned int i = 0; i < m_sinks.size(); i++)
-				m_sinks[i]->write(level, str);
+			if (m_running.load())
+			{
+				std::string message(str);
+				if (m_buffer->push(level, std::move(message)))
+					m_wakeCondition.notify_one();
+				else
+					m_dropped++;
+				return;
+			}
+			std::lock_guard<std::mutex> lock(m_sinkMutex);
+			writeToSinks(level, str);
+			flushSinks();
+		}
+
+		/** Start a background thread which writes the messages to the sinks.
+		* bufferSize is the maximum number of messages which are buffered.
+		*/
+		void activateAsyncMode(const unsigned int bufferSize = 8192)
+		{
+			if (m_running.load())
+				return;
+			m_buffer.reset(new LogRingBuffer(bufferSize));
+			// only one logger installs the signal handlers
+			m_ownsSignalHandlers = (asyncLogger() == nullptr);
+			if (m_ownsSignalHandlers)
+			{
+				asyncLogger() = this;
+				SignalState &s = signalState();
+				s.m_signal = 0;
+				s.m_drained = false;
+				for (unsigned int i = 0; i < NumSignals; i++)
+					s.m_previousHandlers[i] = std::signal(getSignal(i), signalHandler);
+			}
+			m_running = true;
+			m_thread = std::thread(&Logger::run, this);
 		}
+
+		/** Write all buffered messages and stop the background thread. */
+		void deactivateAsyncMode()
+		{
+			if (!m_running.load())
+				return;
+			m_running = false;
+			m_wakeCondition.notify_one();
+			m_thread.join();
+			drain();
+			if (m_ownsSignalHandlers)
+			{
+				restoreSignalHandlers();
+				asyncLogger() = nullptr;
+				m_ownsSignalHandlers = false;
+			}
+		}
+
+		bool isAsync() const { return m_running.load(); }
+
+		/** Number of messages which were dropped in asynchronous mode since the buffer was full. */
+		unsigned int getNumDroppedMessages() const { return m_dropped.load(); }
 	};
 
 	class LogStream
@@ -0,0 +1,129 @@
+#ifndef __MemoryMappedFile_h__
+#define __MemoryMappedFile_h__
+
+#include <string>
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "windows.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Utilities
+{
+	/** \brief Read-only memory mapping of a file. The pages are loaded by the
+	* operating system when they are accessed, so a file can be parsed in parallel
+	* without reading it into a buffer first.
+	*/
+	class MemoryMappedFile
+	{
+	protected:
+		const char *m_data;
+		size_t m_size;
+#ifdef WIN32
+		HANDLE m_file;
+		HANDLE m_mapping;
+#else
+		int m_file;
+#endif
+
+	public:
+		MemoryMappedFile() :
+			m_data(nullptr),
+			m_size(0),
+#ifdef WIN32
+			m_file(INVALID_HANDLE_VALUE),
+			m_mapping(NULL)
+#else
+			m_file(-1)
+#endif
+		{
+		}
+
+		~MemoryMappedFile()
+		{
+			close();
+		}
+
+		bool open(const std::string &fileName)
+		{
+			close();
+#ifdef WIN32
+			m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (m_file == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_file, &size))
+			{
+				close();
+				return false;
+			}
+			m_size = (size_t)size.QuadPart;
+			// an empty file cannot be mapped
+			if (m_size == 0)
+				return true;
+			m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (m_mapping != NULL)
+				m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+			m_file = ::open(fileName.c_str(), O_RDONLY);
+			if (m_file < 0)
+				return false;
+			struct stat st;
+			if (fstat(m_file, &st) != 0)
+			{
+				close();
+				return false;
+			}
+			m_size = (size_t)st.st_size;
+			// an empty file cannot be mapped
+			if (m_size == 0)
+				return true;
+			void *ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+			if (ptr != MAP_FAILED)
+			{
+				m_data = (const char*)ptr;
+				madvise(ptr, m_size, MADV_SEQUENTIAL);
+			}
+#endif
+			if (m_data == nullptr)
+			{
+				close();
+				return false;
+			}
+			return true;
+		}
+
+		void close()
+		{
+#ifdef WIN32
+			if (m_data != nullptr)
+				UnmapViewOfFile(m_data);
+			if (m_mapping != NULL)
+				CloseHandle(m_mapping);
+			if (m_file != INVALID_HANDLE_VALUE)
+				CloseHandle(m_file);
+			m_mapping = NULL;
+			m_file = INVALID_HANDLE_VALUE;
+#else
+			if (m_data != nullptr)
+				munmap((void*)m_data, m_size);
+			if (m_file >= 0)
+				::close(m_file);
+			m_file = -1;
+#endif
+			m_data = nullptr;
+			m_size = 0;
+		}
+
+		const char *data() const { return m_data; }
+		size_t size() const { return m_size; }
+	};
+}
+
+#endif
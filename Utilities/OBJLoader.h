@@ -4,7 +4,19 @@
 #include <string>
 #include "Logger.h"
 #include "StringTools.h"
+#include "MemoryMappedFile.h"
 #include <array>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace Utilities
 {
@@ -25,133 +37,344 @@ namespace Utilities
 		using Vec3f = std::array<float, 3>;
 		using Vec2f = std::array<float, 2>;
 
+	protected:
+		struct ChunkCounts
+		{
+			size_t numVertices;
+			size_t numTexCoords;
+			size_t numNormals;
+			size_t numFaces;
+		};
+
+		static const char *skipSpaces(const char *p, const char *end)
+		{
+			while ((p < end) && ((*p == ' ') || (*p == '\t')))
+				p++;
+			return p;
+		}
+
+		static const char *nextLine(const char *p, const char *end)
+		{
+			const char *n = (const char*)memchr(p, '\n', end - p);
+			return (n != nullptr) ? n + 1 : end;
+		}
+
+		static bool isDigit(const char c) { return (c >= '0') && (c <= '9'); }
+
+		/** Parse a float without locale and without copying the token. Tokens which
+		* are not plain decimal numbers (e.g. nan, inf) are passed to strtof.
+		*/
+		static const char *parseFloat(const char *p, const char *end, float &val)
+		{
+			static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+			p = skipSpaces(p, end);
+			const char *start = p;
+			bool negative = false;
+			if ((p < end) && ((*p == '-') || (*p == '+')))
+			{
+				negative = (*p == '-');
+				p++;
+			}
+			unsigned long long mantissa = 0;
+			int exponent = 0;
+			int numDigits = 0;
+			bool valid = false;
+			for (; (p < end) && isDigit(*p); p++)
+			{
+				// further digits do not change the float value
+				if (numDigits < 18)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					if (mantissa != 0)
+						numDigits++;
+				}
+				else
+					exponent++;
+				valid = true;
+			}
+			if ((p < end) && (*p == '.'))
+			{
+				for (p++; (p < end) && isDigit(*p); p++)
+				{
+					if (numDigits < 18)
+					{
+						mantissa = mantissa * 10 + (*p - '0');
+						if (mantissa != 0)
+							numDigits++;
+						exponent--;
+					}
+					valid = true;
+				}
+			}
+			if (valid && (p < end) && ((*p == 'e') || (*p == 'E')))
+			{
+				const char *q = p + 1;
+				bool negativeExp = false;
+				if ((q < end) && ((*q == '-') || (*q == '+')))
+				{
+					negativeExp = (*q == '-');
+					q++;
+				}
+				if ((q < end) && isDigit(*q))
+				{
+					int e = 0;
+					for (; (q < end) && isDigit(*q); q++)
+					{
+						if (e < 10000)
+							e = e * 10 + (*q - '0');
+					}
+					exponent += negativeExp ? -e : e;
+					p = q;
+				}
+			}
+			if (!valid)
+			{
+				const char *tokenEnd = start;
+				while ((tokenEnd < end) && !isspace((unsigned char)*tokenEnd))
+					tokenEnd++;
+				const std::string token(start, tokenEnd);
+				val = strtof(token.c_str(), nullptr);
+				return tokenEnd;
+			}
+
+			double v = (double)mantissa;
+			if ((exponent >= 0) && (exponent <= 22))
+				v *= pow10[exponent];
+			else if ((exponent < 0) && (exponent >= -22))
+				v /= pow10[-exponent];
+			else
+				v *= std::pow(10.0, (double)exponent);
+			val = (float)(negative ? -v : v);
+			return p;
+		}
+
+		static const char *parseInt(const char *p, const char *end, int &val)
+		{
+			bool negative = false;
+			if ((p < end) && ((*p == '-') || (*p == '+')))
+			{
+				negative = (*p == '-');
+				p++;
+			}
+			int v = 0;
+			for (; (p < end) && isDigit(*p); p++)
+				v = v * 10 + (*p - '0');
+			val = negative ? -v : v;
+			return p;
+		}
+
+		/** Relative (negative) indices refer to the elements before the current line. */
+		static int resolveIndex(const int index, const size_t count)
+		{
+			return (index < 0) ? (int)count + index + 1 : index;
+		}
+
+		/** Return the type of the line: 'v', 't' (texture coordinates), 'n' (normal), 'f' or 0. */
+		static char lineType(const char *&p, const char *end)
+		{
+			p = skipSpaces(p, end);
+			if (end - p < 2)
+				return 0;
+			if ((p[0] == 'v') && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				p += 1;
+				return 'v';
+			}
+			if ((p[0] == 'f') && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				p += 1;
+				return 'f';
+			}
+			if ((end - p >= 3) && (p[0] == 'v') && ((p[2] == ' ') || (p[2] == '\t')))
+			{
+				if (p[1] == 't')
+				{
+					p += 2;
+					return 't';
+				}
+				if (p[1] == 'n')
+				{
+					p += 2;
+					return 'n';
+				}
+			}
+			return 0;
+		}
+
+	public:
 		/** This function loads an OBJ file.
 		  * Only triangulated meshes are supported.
+		  * The file is mapped to memory and split into chunks at line breaks which
+		  * are parsed in parallel. In a first pass the elements of each chunk are counted,
+		  * so the second pass can write them directly to their final position.
 		  */
-
 		static void loadObj(const std::string &filename, std::vector<Vec3f> *x, std::vector<MeshFaceIndices> *faces, std::vector<Vec3f> *normals, std::vector<Vec2f> *texcoords, const Vec3f &scale)
 		{
 			LOG_INFO << "Loading " << filename;
-			
-			std::ifstream filestream;
-			filestream.open(filename.c_str());
-			if (filestream.fail())
+			const auto startTime = std::chrono::high_resolution_clock::now();
+
+			MemoryMappedFile file;
+			if (!file.open(filename))
 			{
 				LOG_ERR << "Failed to open file: " << filename;
 				return;
 			}
+			const char *data = file.data();
+			const size_t size = file.size();
 
-			std::string line_stream;
-			bool vt = false;
-			bool vn = false;
-
-			std::vector<std::string> pos_buffer;
-			std::vector<std::string> f_buffer;
-
-			while (getline(filestream, line_stream))
+#ifdef _OPENMP
+			const int maxThreads = omp_get_max_threads();
+#else
+			const int maxThreads = 1;
+#endif
+			// chunks of at least 1 MB, several chunks per thread for load balancing
+			const size_t minChunkSize = 1 << 20;
+			const int numChunks = (int)std::max((size_t)1, std::min((size_t)(4 * maxThreads), size / minChunkSize));
+			std::vector<const char*> chunkStart(numChunks + 1);
+			chunkStart[0] = data;
+			chunkStart[numChunks] = data + size;
+			for (int c = 1; c < numChunks; c++)
 			{
-				std::stringstream str_stream(line_stream);
-				std::string type_str;
-				str_stream >> type_str;
+				const char *p = data + (size * c) / numChunks;
+				if (p[-1] != '\n')
+					p = nextLine(p, data + size);
+				chunkStart[c] = std::max(p, chunkStart[c - 1]);
+			}
 
-				if (type_str == "v")
-				{
-					Vec3f pos;
-					pos_buffer.clear();
-					std::string parse_str = line_stream.substr(line_stream.find("v") + 1);
-					StringTools::tokenize(parse_str, pos_buffer);
-					for (unsigned int i = 0; i < 3; i++)
-						pos[i] = stof(pos_buffer[i]) * scale[i];
-
-					x->push_back(pos);
-				}
-				else if (type_str == "vt")
-				{
-					if (texcoords != nullptr)
-					{
-						Vec2f tex;
-						pos_buffer.clear();
-						std::string parse_str = line_stream.substr(line_stream.find("vt") + 2);
-						StringTools::tokenize(parse_str, pos_buffer);
-						for (unsigned int i = 0; i < 2; i++)
-							tex[i] = stof(pos_buffer[i]);
-
-						texcoords->push_back(tex);
-						vt = true;
-					}
-				}
-				else if (type_str == "vn")
+			// first pass: count the elements of each chunk
+			std::vector<ChunkCounts> counts(numChunks + 1);
+			#pragma omp parallel default(shared)
+			{
+				#pragma omp for schedule(static)
+				for (int c = 0; c < numChunks; c++)
 				{
-					if (normals != nullptr)
+					ChunkCounts cc = { 0, 0, 0, 0 };
+					const char *end = chunkStart[c + 1];
+					for (const char *p = chunkStart[c]; p < end; p = nextLine(p, end))
 					{
-						Vec3f nor;
-						pos_buffer.clear();
-						std::string parse_str = line_stream.substr(line_stream.find("vn") + 2);
-						StringTools::tokenize(parse_str, pos_buffer);
-						for (unsigned int i = 0; i < 3; i++)
-							nor[i] = stof(pos_buffer[i]);
-
-						normals->push_back(nor);
-						vn = true;
+						const char *q = p;
+						const char type = lineType(q, end);
+						if (type == 'v')
+							cc.numVertices++;
+						else if (type == 't')
+							cc.numTexCoords++;
+						else if (type == 'n')
+							cc.numNormals++;
+						else if (type == 'f')
+							cc.numFaces++;
 					}
+					counts[c + 1] = cc;
 				}
-				else if (type_str == "f")
+			}
+
+			// prefix sums give the first element of each chunk
+			counts[0] = { 0, 0, 0, 0 };
+			for (int c = 0; c < numChunks; c++)
+			{
+				counts[c + 1].numVertices += counts[c].numVertices;
+				counts[c + 1].numTexCoords += counts[c].numTexCoords;
+				counts[c + 1].numNormals += counts[c].numNormals;
+				counts[c + 1].numFaces += counts[c].numFaces;
+			}
+			const ChunkCounts &total = counts[numChunks];
+			const size_t vOffset = x->size();
+			const size_t fOffset = faces->size();
+			const size_t nOffset = (normals != nullptr) ? normals->size() : 0;
+			const size_t tOffset = (texcoords != nullptr) ? texcoords->size() : 0;
+			x->resize(vOffset + total.numVertices);
+			faces->resize(fOffset + total.numFaces);
+			if (normals != nullptr)
+				normals->resize(nOffset + total.numNormals);
+			if (texcoords != nullptr)
+				texcoords->resize(tOffset + total.numTexCoords);
+
+			// second pass: parse the elements
+			std::atomic<unsigned int> numInvalidFaces(0);
+			#pragma omp parallel default(shared)
+			{
+				#pragma omp for schedule(static)
+				for (int c = 0; c < numChunks; c++)
 				{
-					MeshFaceIndices faceIndex;
-					if (vn && vt)
+					ChunkCounts cc = counts[c];
+					const char *end = chunkStart[c + 1];
+					for (const char *p = chunkStart[c]; p < end; p = nextLine(p, end))
 					{
-						f_buffer.clear();
-						std::string parse_str = line_stream.substr(line_stream.find("f") + 1);
-						StringTools::tokenize(parse_str, f_buffer);
-						for (int i = 0; i < 3; ++i)
+						const char type = lineType(p, end);
+						if (type == 'v')
 						{
-							pos_buffer.clear();
-							StringTools::tokenize(f_buffer[i], pos_buffer, "/");
-							faceIndex.posIndices[i] = stoi(pos_buffer[0]);
-							faceIndex.texIndices[i] = stoi(pos_buffer[1]);
-							faceIndex.normalIndices[i] = stoi(pos_buffer[2]);
+							Vec3f &pos = (*x)[vOffset + cc.numVertices++];
+							for (unsigned int i = 0; i < 3; i++)
+							{
+								p = parseFloat(p, end, pos[i]);
+								pos[i] *= scale[i];
+							}
 						}
-					}
-					else if (vn)
-					{
-						f_buffer.clear();
-						std::string parse_str = line_stream.substr(line_stream.find("f") + 1);
-						StringTools::tokenize(parse_str, f_buffer);
-						for (int i = 0; i < 3; ++i)
+						else if (type == 't')
 						{
-							pos_buffer.clear();
-							StringTools::tokenize(f_buffer[i], pos_buffer, "/");
-							faceIndex.posIndices[i] = stoi(pos_buffer[0]);
-							faceIndex.normalIndices[i] = stoi(pos_buffer[1]);
+							if (texcoords != nullptr)
+							{
+								Vec2f &tex = (*texcoords)[tOffset + cc.numTexCoords];
+								for (unsigned int i = 0; i < 2; i++)
+									p = parseFloat(p, end, tex[i]);
+							}
+							cc.numTexCoords++;
 						}
-					}
-					else if (vt)
-					{
-						f_buffer.clear();
-						std::string parse_str = line_stream.substr(line_stream.find("f") + 1);
-						StringTools::tokenize(parse_str, f_buffer);
-						for (int i = 0; i < 3; ++i)
+						else if (type == 'n')
 						{
-							pos_buffer.clear();
-							StringTools::tokenize(f_buffer[i], pos_buffer, "/");
-							faceIndex.posIndices[i] = stoi(pos_buffer[0]);
-							faceIndex.texIndices[i] = stoi(pos_buffer[1]);
+							if (normals != nullptr)
+							{
+								Vec3f &nor = (*normals)[nOffset + cc.numNormals];
+								for (unsigned int i = 0; i < 3; i++)
+									p = parseFloat(p, end, nor[i]);
+							}
+							cc.numNormals++;
 						}
-					}
-					else
-					{
-						f_buffer.clear();
-						std::string parse_str = line_stream.substr(line_stream.find("f") + 1);
-						StringTools::tokenize(parse_str, f_buffer);
-						for (int i = 0; i < 3; ++i)
+						else if (type == 'f')
 						{
-							faceIndex.posIndices[i] = stoi(f_buffer[i]);
+							// supported formats: v, v/t, v//n, v/t/n
+							MeshFaceIndices &faceIndex = (*faces)[fOffset + cc.numFaces++];
+							for (int i = 0; i < 3; ++i)
+							{
+								faceIndex.posIndices[i] = 0;
+								faceIndex.texIndices[i] = 0;
+								faceIndex.normalIndices[i] = 0;
+								p = skipSpaces(p, end);
+								if ((p >= end) || !(isDigit(*p) || (*p == '-') || (*p == '+')))
+								{
+									numInvalidFaces++;
+									break;
+								}
+								int index;
+								p = parseInt(p, end, index);
+								faceIndex.posIndices[i] = resolveIndex(index, cc.numVertices);
+								if ((p < end) && (*p == '/'))
+								{
+									p++;
+									if ((p < end) && (*p != '/'))
+									{
+										p = parseInt(p, end, index);
+										faceIndex.texIndices[i] = resolveIndex(index, cc.numTexCoords);
+									}
+									if ((p < end) && (*p == '/'))
+									{
+										p = parseInt(p + 1, end, index);
+										faceIndex.normalIndices[i] = resolveIndex(index, cc.numNormals);
+									}
+								}
+							}
 						}
 					}
-					faces->push_back(faceIndex);
 				}
 			}
-			filestream.close();
+
+			if (numInvalidFaces > 0)
+				LOG_WARN << "Number of faces with less than three vertices: " << numInvalidFaces;
+
+			const double t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+			const double mb = (double)size / (1024.0 * 1024.0);
+			LOG_INFO << "Loaded " << total.numVertices << " vertices and " << total.numFaces << " faces (" << mb << " MB in " << t << " s, " << ((t > 0.0) ? mb / t : 0.0) << " MB/s)";
 		}
 
 	};
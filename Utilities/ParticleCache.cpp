@@ -0,0 +1,688 @@
+#include "ParticleCache.h"
+#include "FileSystem.h"
+#include "Logger.h"
+#include "extern/partio/src/lib/Partio.h"
+#include "extern/zlib/src/zlib.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace Utilities;
+
+/*
+File layout (little endian):
+	"SPHC", uint32 version, uint32 keyFrameInterval
+	frame 0, frame 1, ...
+	index: uint32 numFrames, numFrames x (uint64 offset, double time)
+	trailer: uint64 indexOffset, "SPHI"
+
+Frame layout:
+	"FRME", uint32 numParticles, uint32 flags, uint32 positionBits, uint32 chunkSize, uint32 numChunks,
+	double time, double bboxMin[3], double bboxMax[3]
+	numChunks x (uint32 rawSize, uint32 compressedSize)
+	compressed chunk data
+
+A chunk contains chunkSize consecutive particles. Each attribute is stored
+component-wise with shuffled bytes (all first bytes, all second bytes, ...) which
+makes the quantized and delta-encoded data compress well. The raw data of a chunk
+with count particles is:
+	3 x count quantized position components (positionBits / 8 bytes each),
+	count ids as differences to the previous id in the chunk (if HAS_IDS),
+	3 x count velocity components as float bits (if HAS_VELOCITIES)
+
+If the frame has ids, the particles are stored in the order of their ids. The
+neighborhood search reorders the particles, so the index of a particle is not
+stable between frames but its id is. In a frame which is not a key frame the
+velocity bits are xor'ed with the ones of the particle with the same id in the
+previous frame (if there is such a particle).
+*/
+
+static const char *FILE_MAGIC = "SPHC";
+static const char *INDEX_MAGIC = "SPHI";
+static const char *FRAME_MAGIC = "FRME";
+static const uint32_t FILE_VERSION = 2;
+static const uint32_t CHUNK_SIZE = 65536;
+
+enum FrameFlags { KEY_FRAME = 1, HAS_VELOCITIES = 2, HAS_IDS = 4 };
+
+template<typename T>
+static void writeValue(std::ostream &s, const T &v)
+{
+	s.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template<typename T>
+static void readValue(std::istream &s, T &v)
+{
+	s.read(reinterpret_cast<char*>(&v), sizeof(T));
+}
+
+static void shuffleBytes(const char *src, char *dst, const size_t count, const size_t elemSize)
+{
+	for (size_t b = 0; b < elemSize; b++)
+		for (size_t i = 0; i < count; i++)
+			dst[b*count + i] = src[i*elemSize + b];
+}
+
+static void unshuffleBytes(const char *src, char *dst, const size_t count, const size_t elemSize)
+{
+	for (size_t b = 0; b < elemSize; b++)
+		for (size_t i = 0; i < count; i++)
+			dst[i*elemSize + b] = src[b*count + i];
+}
+
+static uint32_t floatBits(const Real v)
+{
+	const float f = static_cast<float>(v);
+	uint32_t bits;
+	std::memcpy(&bits, &f, sizeof(float));
+	return bits;
+}
+
+static Real bitsToReal(const uint32_t bits)
+{
+	float f;
+	std::memcpy(&f, &bits, sizeof(float));
+	return static_cast<Real>(f);
+}
+
+/** Find the particles of a chunk with the ids sortedIds[start,...,start+count-1] in the
+* sorted ids of the previous frame. prevIndex[i] is -1 if there is no such particle.
+*/
+static void matchPreviousIds(const std::vector<uint32_t> &sortedIds, const unsigned int start, const unsigned int count,
+	const std::vector<uint32_t> &lastIds, std::vector<int> &prevIndex)
+{
+	prevIndex.resize(count);
+	size_t j = std::lower_bound(lastIds.begin(), lastIds.end(), sortedIds[start]) - lastIds.begin();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const uint32_t id = sortedIds[start + i];
+		while ((j < lastIds.size()) && (lastIds[j] < id))
+			j++;
+		prevIndex[i] = ((j < lastIds.size()) && (lastIds[j] == id)) ? static_cast<int>(j) : -1;
+	}
+}
+
+/** Return the number of bytes of the raw data of a chunk. */
+static uint64_t rawChunkSize(const uint64_t count, const size_t posSize, const bool hasVelocities, const bool hasIds)
+{
+	return count * (3 * posSize + (hasVelocities ? 3 * sizeof(uint32_t) : 0) + (hasIds ? sizeof(uint32_t) : 0));
+}
+
+
+ParticleCacheWriter::ParticleCacheWriter()
+{
+	m_keyFrameInterval = 16;
+	m_positionBits = 16;
+	m_indexPos = 0;
+}
+
+ParticleCacheWriter::~ParticleCacheWriter()
+{
+	close();
+}
+
+bool ParticleCacheWriter::open(const std::string &fileName, const unsigned int keyFrameInterval, const unsigned int positionBits)
+{
+	close();
+	m_file.open(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open())
+	{
+		LOG_ERR << "Cannot open particle cache file: " << fileName;
+		return false;
+	}
+
+	m_keyFrameInterval = std::max(1u, keyFrameInterval);
+	m_positionBits = (positionBits > 16) ? 32 : 16;
+	m_frameOffsets.clear();
+	m_frameTimes.clear();
+	m_lastVelocities.clear();
+	m_lastIds.clear();
+
+	m_file.write(FILE_MAGIC, 4);
+	writeValue(m_file, FILE_VERSION);
+	writeValue(m_file, static_cast<uint32_t>(m_keyFrameInterval));
+	m_indexPos = static_cast<uint64_t>(m_file.tellp());
+	writeIndex();
+	return true;
+}
+
+void ParticleCacheWriter::close()
+{
+	if (m_file.is_open())
+		m_file.close();
+}
+
+void ParticleCacheWriter::writeIndex()
+{
+	// The index is always written behind the last frame, so the file is valid after each frame.
+	// The next frame overwrites the index.
+	m_file.seekp(m_indexPos);
+	writeValue(m_file, static_cast<uint32_t>(m_frameOffsets.size()));
+	for (size_t i = 0; i < m_frameOffsets.size(); i++)
+	{
+		writeValue(m_file, m_frameOffsets[i]);
+		writeValue(m_file, m_frameTimes[i]);
+	}
+	writeValue(m_file, m_indexPos);
+	m_file.write(INDEX_MAGIC, 4);
+	m_file.flush();
+}
+
+void ParticleCacheWriter::writeFrame(const Real time, const unsigned int numParticles, const Vector3r *positions,
+	const Vector3r *velocities, const unsigned int *ids)
+{
+	if (!m_file.is_open())
+		return;
+
+	const bool keyFrame = (m_frameOffsets.size() % m_keyFrameInterval) == 0;
+	uint32_t flags = 0;
+	if (keyFrame)
+		flags |= KEY_FRAME;
+	if (velocities != nullptr)
+		flags |= HAS_VELOCITIES;
+	if (ids != nullptr)
+		flags |= HAS_IDS;
+
+	// bounding box of the frame
+	AlignedBox3r box;
+	box.setEmpty();
+	#pragma omp parallel default(shared)
+	{
+		AlignedBox3r localBox;
+		localBox.setEmpty();
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)numParticles; i++)
+			localBox.extend(positions[i]);
+		#pragma omp critical
+		box.extend(localBox);
+	}
+	if (numParticles == 0)
+		box = AlignedBox3r(Vector3r::Zero(), Vector3r::Zero());
+
+	const double maxQ = (m_positionBits == 16) ? 65535.0 : 4294967295.0;
+	const Eigen::Vector3d boxMin = box.min().template cast<double>();
+	const Eigen::Vector3d extent = (box.max() - box.min()).template cast<double>();
+	Eigen::Vector3d scale;
+	for (unsigned int c = 0; c < 3; c++)
+		scale[c] = (extent[c] > 0.0) ? maxQ / extent[c] : 0.0;
+
+	const unsigned int numChunks = (numParticles + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	const size_t posSize = m_positionBits / 8;
+
+	// store the particles in the order of their ids
+	std::vector<unsigned int> order;
+	std::vector<uint32_t> currentVelocities;
+	std::vector<uint32_t> currentIds;
+	if (ids != nullptr)
+	{
+		order.resize(numParticles);
+		for (unsigned int i = 0; i < numParticles; i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [ids](const unsigned int a, const unsigned int b) { return ids[a] < ids[b]; });
+		currentIds.resize(numParticles);
+		for (unsigned int i = 0; i < numParticles; i++)
+			currentIds[i] = ids[order[i]];
+	}
+	if (velocities != nullptr)
+		currentVelocities.resize(3 * numParticles);
+	const bool velocityDeltas = !keyFrame && (ids != nullptr) && (velocities != nullptr) &&
+		!m_lastIds.empty() && (m_lastVelocities.size() == 3 * m_lastIds.size());
+
+	std::vector<std::vector<char>> compressed(numChunks);
+	std::vector<uint32_t> rawSizes(numChunks);
+
+	#pragma omp parallel default(shared)
+	{
+		std::vector<char> plane;
+		std::vector<char> raw;
+		std::vector<int> prevIndex;
+
+		#pragma omp for schedule(dynamic)
+		for (int chunk = 0; chunk < (int)numChunks; chunk++)
+		{
+			const unsigned int start = chunk * CHUNK_SIZE;
+			const unsigned int count = std::min(CHUNK_SIZE, numParticles - start);
+			raw.clear();
+
+			// quantized positions
+			plane.resize(count * posSize);
+			for (unsigned int c = 0; c < 3; c++)
+			{
+				for (unsigned int i = 0; i < count; i++)
+				{
+					const unsigned int index = order.empty() ? start + i : order[start + i];
+					const double q = std::round((static_cast<double>(positions[index][c]) - boxMin[c]) * scale[c]);
+					if (m_positionBits == 16)
+					{
+						const uint16_t v = static_cast<uint16_t>(std::min(std::max(q, 0.0), maxQ));
+						std::memcpy(&plane[i * posSize], &v, posSize);
+					}
+					else
+					{
+						const uint32_t v = static_cast<uint32_t>(std::min(std::max(q, 0.0), maxQ));
+						std::memcpy(&plane[i * posSize], &v, posSize);
+					}
+				}
+				const size_t offset = raw.size();
+				raw.resize(offset + plane.size());
+				shuffleBytes(plane.data(), &raw[offset], count, posSize);
+			}
+
+			// sorted ids as difference to the previous id in the chunk
+			if (ids != nullptr)
+			{
+				plane.resize(count * sizeof(uint32_t));
+				for (unsigned int i = 0; i < count; i++)
+				{
+					const uint32_t v = (i > 0) ? (currentIds[start + i] - currentIds[start + i - 1]) : currentIds[start];
+					std::memcpy(&plane[i * sizeof(uint32_t)], &v, sizeof(uint32_t));
+				}
+				const size_t offset = raw.size();
+				raw.resize(offset + plane.size());
+				shuffleBytes(plane.data(), &raw[offset], count, sizeof(uint32_t));
+			}
+
+			// velocities as float bits xor'ed with the same particle in the previous frame
+			if (velocities != nullptr)
+			{
+				if (velocityDeltas)
+					matchPreviousIds(currentIds, start, count, m_lastIds, prevIndex);
+				plane.resize(count * sizeof(uint32_t));
+				for (unsigned int c = 0; c < 3; c++)
+				{
+					for (unsigned int i = 0; i < count; i++)
+					{
+						const unsigned int index = order.empty() ? start + i : order[start + i];
+						const uint32_t bits = floatBits(velocities[index][c]);
+						currentVelocities[3 * (start + i) + c] = bits;
+						const uint32_t v = (velocityDeltas && (prevIndex[i] >= 0)) ? (bits ^ m_lastVelocities[3 * prevIndex[i] + c]) : bits;
+						std::memcpy(&plane[i * sizeof(uint32_t)], &v, sizeof(uint32_t));
+					}
+					const size_t offset = raw.size();
+					raw.resize(offset + plane.size());
+					shuffleBytes(plane.data(), &raw[offset], count, sizeof(uint32_t));
+				}
+			}
+
+			uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+			compressed[chunk].resize(compressedSize);
+			compress2(reinterpret_cast<Bytef*>(compressed[chunk].data()), &compressedSize,
+				reinterpret_cast<const Bytef*>(raw.data()), static_cast<uLong>(raw.size()), Z_BEST_SPEED);
+			compressed[chunk].resize(compressedSize);
+			rawSizes[chunk] = static_cast<uint32_t>(raw.size());
+		}
+	}
+
+	m_lastVelocities.swap(currentVelocities);
+	m_lastIds.swap(currentIds);
+
+	// write frame
+	const uint64_t frameOffset = m_indexPos;
+	m_file.seekp(frameOffset);
+	m_file.write(FRAME_MAGIC, 4);
+	writeValue(m_file, static_cast<uint32_t>(numParticles));
+	writeValue(m_file, flags);
+	writeValue(m_file, static_cast<uint32_t>(m_positionBits));
+	writeValue(m_file, CHUNK_SIZE);
+	writeValue(m_file, static_cast<uint32_t>(numChunks));
+	writeValue(m_file, static_cast<double>(time));
+	for (unsigned int c = 0; c < 3; c++)
+		writeValue(m_file, boxMin[c]);
+	for (unsigned int c = 0; c < 3; c++)
+		writeValue(m_file, static_cast<double>(box.max()[c]));
+	for (unsigned int chunk = 0; chunk < numChunks; chunk++)
+	{
+		writeValue(m_file, rawSizes[chunk]);
+		writeValue(m_file, static_cast<uint32_t>(compressed[chunk].size()));
+	}
+	for (unsigned int chunk = 0; chunk < numChunks; chunk++)
+		m_file.write(compressed[chunk].data(), compressed[chunk].size());
+
+	m_indexPos = static_cast<uint64_t>(m_file.tellp());
+	m_frameOffsets.push_back(frameOffset);
+	m_frameTimes.push_back(static_cast<double>(time));
+	writeIndex();
+}
+
+
+ParticleCacheReader::ParticleCacheReader()
+{
+	m_keyFrameInterval = 1;
+	m_lastFrame = -1;
+	m_hasVelocities = false;
+	m_hasIds = false;
+	m_fileSize = 0;
+}
+
+ParticleCacheReader::~ParticleCacheReader()
+{
+	close();
+}
+
+bool ParticleCacheReader::isParticleCacheFile(const std::string &fileName)
+{
+	std::string ext = FileSystem::getFileExt(fileName);
+	std::transform(ext.begin(), ext.end(), ext.begin(), ::toupper);
+	return ext == "SPHC";
+}
+
+bool ParticleCacheReader::open(const std::string &fileName)
+{
+	close();
+	m_file.open(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!m_file.is_open())
+		return false;
+	m_file.seekg(0, std::ios::end);
+	m_fileSize = static_cast<uint64_t>(m_file.tellg());
+	m_file.seekg(0);
+
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t keyFrameInterval = 1;
+	m_file.read(magic, 4);
+	readValue(m_file, version);
+	readValue(m_file, keyFrameInterval);
+	if (!m_file || (std::strncmp(magic, FILE_MAGIC, 4) != 0) || (version != FILE_VERSION))
+	{
+		LOG_ERR << "Invalid particle cache file: " << fileName;
+		close();
+		return false;
+	}
+	m_keyFrameInterval = std::max(1u, keyFrameInterval);
+
+	// read trailer and frame index
+	uint64_t indexPos = 0;
+	m_file.seekg(-static_cast<std::streamoff>(sizeof(uint64_t) + 4), std::ios::end);
+	readValue(m_file, indexPos);
+	m_file.read(magic, 4);
+	if (!m_file || (std::strncmp(magic, INDEX_MAGIC, 4) != 0))
+	{
+		LOG_ERR << "Particle cache file has no frame index: " << fileName;
+		close();
+		return false;
+	}
+
+	uint32_t numFrames = 0;
+	if (indexPos + sizeof(uint32_t) <= m_fileSize)
+	{
+		m_file.seekg(indexPos);
+		readValue(m_file, numFrames);
+	}
+	const uint64_t entrySize = sizeof(uint64_t) + sizeof(double);
+	if (!m_file || (indexPos + sizeof(uint32_t) + numFrames * entrySize > m_fileSize))
+	{
+		LOG_ERR << "Particle cache file has an invalid frame index: " << fileName;
+		close();
+		return false;
+	}
+	m_frameOffsets.resize(numFrames);
+	m_frameTimes.resize(numFrames);
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		readValue(m_file, m_frameOffsets[i]);
+		readValue(m_file, m_frameTimes[i]);
+		if (m_frameOffsets[i] >= indexPos)
+		{
+			LOG_ERR << "Particle cache file has an invalid frame index: " << fileName;
+			close();
+			return false;
+		}
+	}
+	m_lastFrame = -1;
+	return static_cast<bool>(m_file);
+}
+
+void ParticleCacheReader::close()
+{
+	if (m_file.is_open())
+		m_file.close();
+	m_frameOffsets.clear();
+	m_frameTimes.clear();
+	m_lastVelocities.clear();
+	m_lastIds.clear();
+	m_lastFrame = -1;
+	m_fileSize = 0;
+}
+
+bool ParticleCacheReader::decodeFrame(const unsigned int frame, std::vector<Vector3r> *positions)
+{
+	m_file.clear();
+	m_file.seekg(m_frameOffsets[frame]);
+
+	char magic[4];
+	uint32_t numParticles, flags, positionBits, chunkSize, numChunks;
+	double time;
+	Eigen::Vector3d boxMin, boxMax;
+	m_file.read(magic, 4);
+	readValue(m_file, numParticles);
+	readValue(m_file, flags);
+	readValue(m_file, positionBits);
+	readValue(m_file, chunkSize);
+	readValue(m_file, numChunks);
+	readValue(m_file, time);
+	for (unsigned int c = 0; c < 3; c++)
+		readValue(m_file, boxMin[c]);
+	for (unsigned int c = 0; c < 3; c++)
+		readValue(m_file, boxMax[c]);
+	if (!m_file || (std::strncmp(magic, FRAME_MAGIC, 4) != 0))
+		return false;
+
+	// The header fields are not trusted: a truncated or corrupt file must not
+	// lead to reads behind the decoded data.
+	const bool hasVelocities = (flags & HAS_VELOCITIES) != 0;
+	const bool hasIds = (flags & HAS_IDS) != 0;
+	if (((positionBits != 16) && (positionBits != 32)) || (chunkSize == 0) ||
+		(numChunks != (static_cast<uint64_t>(numParticles) + chunkSize - 1) / chunkSize))
+		return false;
+	const uint64_t headerEnd = static_cast<uint64_t>(m_file.tellg());
+	if (headerEnd + static_cast<uint64_t>(numChunks) * 2 * sizeof(uint32_t) > m_fileSize)
+		return false;
+
+	const size_t posSize = positionBits / 8;
+	std::vector<uint32_t> rawSizes(numChunks);
+	std::vector<uint32_t> compressedSizes(numChunks);
+	std::vector<size_t> compressedOffsets(numChunks + 1, 0);
+	for (unsigned int chunk = 0; chunk < numChunks; chunk++)
+	{
+		readValue(m_file, rawSizes[chunk]);
+		readValue(m_file, compressedSizes[chunk]);
+		compressedOffsets[chunk + 1] = compressedOffsets[chunk] + compressedSizes[chunk];
+
+		const uint64_t count = std::min(static_cast<uint64_t>(chunkSize), static_cast<uint64_t>(numParticles) - static_cast<uint64_t>(chunk) * chunkSize);
+		if (rawSizes[chunk] != rawChunkSize(count, posSize, hasVelocities, hasIds))
+			return false;
+	}
+	if (!m_file || (static_cast<uint64_t>(m_file.tellg()) + compressedOffsets[numChunks] > m_fileSize))
+		return false;
+	std::vector<char> data(compressedOffsets[numChunks]);
+	m_file.read(data.data(), data.size());
+	if (!m_file)
+		return false;
+
+	const bool keyFrame = (flags & KEY_FRAME) != 0;
+	const bool velocityDeltas = !keyFrame && hasIds && hasVelocities &&
+		!m_lastIds.empty() && (m_lastVelocities.size() == 3 * m_lastIds.size());
+	const double maxQ = (positionBits == 16) ? 65535.0 : 4294967295.0;
+	const Eigen::Vector3d extent = boxMax - boxMin;
+
+	std::vector<uint32_t> currentVelocities;
+	std::vector<uint32_t> currentIds;
+	if (hasVelocities)
+		currentVelocities.resize(3 * static_cast<size_t>(numParticles));
+	if (hasIds)
+		currentIds.resize(numParticles);
+	if (positions != nullptr)
+		positions->resize(numParticles);
+
+	bool success = true;
+	#pragma omp parallel default(shared) reduction(&&:success)
+	{
+		std::vector<char> raw;
+		std::vector<char> plane;
+		std::vector<int> prevIndex;
+
+		#pragma omp for schedule(dynamic)
+		for (int chunk = 0; chunk < (int)numChunks; chunk++)
+		{
+			const unsigned int start = chunk * chunkSize;
+			const unsigned int count = std::min(chunkSize, numParticles - start);
+			raw.resize(rawSizes[chunk]);
+			uLongf rawSize = rawSizes[chunk];
+			if ((uncompress(reinterpret_cast<Bytef*>(raw.data()), &rawSize,
+				reinterpret_cast<const Bytef*>(data.data() + compressedOffsets[chunk]), compressedSizes[chunk]) != Z_OK) ||
+				(rawSize != rawSizes[chunk]))
+			{
+				success = false;
+				continue;
+			}
+			size_t offset = 0;
+
+			plane.resize(count * posSize);
+			for (unsigned int c = 0; c < 3; c++)
+			{
+				if (positions != nullptr)
+				{
+					unshuffleBytes(&raw[offset], plane.data(), count, posSize);
+					for (unsigned int i = 0; i < count; i++)
+					{
+						double q;
+						if (positionBits == 16)
+						{
+							uint16_t v;
+							std::memcpy(&v, &plane[i * posSize], posSize);
+							q = v;
+						}
+						else
+						{
+							uint32_t v;
+							std::memcpy(&v, &plane[i * posSize], posSize);
+							q = v;
+						}
+						(*positions)[start + i][c] = static_cast<Real>(boxMin[c] + q / maxQ * extent[c]);
+					}
+				}
+				offset += count * posSize;
+			}
+
+			if (hasIds)
+			{
+				plane.resize(count * sizeof(uint32_t));
+				unshuffleBytes(&raw[offset], plane.data(), count, sizeof(uint32_t));
+				for (unsigned int i = 0; i < count; i++)
+				{
+					uint32_t v;
+					std::memcpy(&v, &plane[i * sizeof(uint32_t)], sizeof(uint32_t));
+					currentIds[start + i] = (i > 0) ? (v + currentIds[start + i - 1]) : v;
+				}
+				offset += count * sizeof(uint32_t);
+			}
+
+			if (hasVelocities)
+			{
+				if (velocityDeltas)
+					matchPreviousIds(currentIds, start, count, m_lastIds, prevIndex);
+				plane.resize(count * sizeof(uint32_t));
+				for (unsigned int c = 0; c < 3; c++)
+				{
+					unshuffleBytes(&raw[offset], plane.data(), count, sizeof(uint32_t));
+					for (unsigned int i = 0; i < count; i++)
+					{
+						uint32_t v;
+						std::memcpy(&v, &plane[i * sizeof(uint32_t)], sizeof(uint32_t));
+						currentVelocities[3 * (start + i) + c] = (velocityDeltas && (prevIndex[i] >= 0)) ? (v ^ m_lastVelocities[3 * prevIndex[i] + c]) : v;
+					}
+					offset += count * sizeof(uint32_t);
+				}
+			}
+		}
+	}
+
+	if (!success)
+	{
+		m_lastVelocities.clear();
+		m_lastIds.clear();
+		m_lastFrame = -1;
+		return false;
+	}
+	m_hasVelocities = hasVelocities;
+	m_hasIds = hasIds;
+	m_lastVelocities.swap(currentVelocities);
+	m_lastIds.swap(currentIds);
+	m_lastFrame = static_cast<int>(frame);
+	return true;
+}
+
+bool ParticleCacheReader::readFrame(const unsigned int frame, std::vector<Vector3r> &positions,
+	std::vector<Vector3r> &velocities, std::vector<unsigned int> &ids)
+{
+	if (frame >= numFrames())
+		return false;
+
+	// decode the frames since the last key frame unless the previous frame is already decoded
+	unsigned int start = frame - (frame % m_keyFrameInterval);
+	if ((m_lastFrame >= static_cast<int>(start)) && (m_lastFrame < static_cast<int>(frame)))
+		start = m_lastFrame + 1;
+	for (unsigned int f = start; f < frame; f++)
+	{
+		if (!decodeFrame(f, nullptr))
+			return false;
+	}
+	if (!decodeFrame(frame, &positions))
+		return false;
+
+	const unsigned int numParticles = static_cast<unsigned int>(positions.size());
+	velocities.resize(numParticles);
+	ids.resize(numParticles);
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			if (m_hasVelocities)
+				velocities[i] = Vector3r(bitsToReal(m_lastVelocities[3 * i]), bitsToReal(m_lastVelocities[3 * i + 1]), bitsToReal(m_lastVelocities[3 * i + 2]));
+			else
+				velocities[i].setZero();
+			ids[i] = m_hasIds ? m_lastIds[i] : i;
+		}
+	}
+	return true;
+}
+
+Partio::ParticlesDataMutable* ParticleCacheReader::readFramePartio(const unsigned int frame)
+{
+	std::vector<Vector3r> positions;
+	std::vector<Vector3r> velocities;
+	std::vector<unsigned int> ids;
+	if (!readFrame(frame, positions, velocities, ids))
+		return nullptr;
+
+	const unsigned int numParticles = static_cast<unsigned int>(positions.size());
+	Partio::ParticlesDataMutable* partioData = Partio::create();
+	Partio::ParticleAttribute posAttr = partioData->addAttribute("position", Partio::VECTOR, 3);
+	Partio::ParticleAttribute velAttr;
+	if (m_hasVelocities)
+		velAttr = partioData->addAttribute("velocity", Partio::VECTOR, 3);
+	Partio::ParticleAttribute idAttr = partioData->addAttribute("id", Partio::INT, 1);
+	if (numParticles == 0)
+		return partioData;
+
+	partioData->addParticles((int)numParticles);
+	float *pos = partioData->dataWrite<float>(posAttr, 0);
+	float *vel = m_hasVelocities ? partioData->dataWrite<float>(velAttr, 0) : nullptr;
+	int *id = partioData->dataWrite<int>(idAttr, 0);
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)numParticles; i++)
+		{
+			for (unsigned int c = 0; c < 3; c++)
+			{
+				pos[3 * i + c] = static_cast<float>(positions[i][c]);
+				if (vel != nullptr)
+					vel[3 * i + c] = static_cast<float>(velocities[i][c]);
+			}
+			id[i] = static_cast<int>(ids[i]);
+		}
+	}
+	return partioData;
+}
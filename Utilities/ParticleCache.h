@@ -0,0 +1,104 @@
+#ifndef __ParticleCache_h__
+#define __ParticleCache_h__
+
+#include "SPlisHSPlasH/Common.h"
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+namespace Partio
+{
+	class ParticlesDataMutable;
+}
+
+namespace Utilities
+{
+	/** \brief Writer for the compact particle cache format (.sphc).
+	* All frames of a particle set are appended to a single file.
+	* Positions are quantized relative to the bounding box of the frame.
+	* The particles are stored in the order of their ids, so that the velocities
+	* can be delta-encoded against the same particle in the previous frame.
+	* The data is compressed in chunks with zlib. A frame index at the end of
+	* the file allows a random access to each frame. Every keyFrameInterval-th
+	* frame is stored without deltas, so reading a frame never has to decode
+	* more than keyFrameInterval frames.
+	*/
+	class ParticleCacheWriter
+	{
+	protected:
+		std::fstream m_file;
+		unsigned int m_keyFrameInterval;
+		unsigned int m_positionBits;
+		uint64_t m_indexPos;
+		std::vector<uint64_t> m_frameOffsets;
+		std::vector<double> m_frameTimes;
+		std::vector<uint32_t> m_lastVelocities;
+		std::vector<uint32_t> m_lastIds;
+
+		void writeIndex();
+
+	public:
+		ParticleCacheWriter();
+		~ParticleCacheWriter();
+
+		/** Create a new cache file. An existing file is overwritten.
+		* positionBits defines the quantization of the positions (16 or 32 bits per component).
+		*/
+		bool open(const std::string &fileName, const unsigned int keyFrameInterval = 16, const unsigned int positionBits = 16);
+		void close();
+		bool isOpen() const { return m_file.is_open(); }
+		unsigned int numFrames() const { return static_cast<unsigned int>(m_frameOffsets.size()); }
+
+		/** Append a frame to the cache file. velocities and ids are optional.
+		*/
+		void writeFrame(const Real time, const unsigned int numParticles, const Vector3r *positions,
+			const Vector3r *velocities, const unsigned int *ids);
+	};
+
+	/** \brief Reader for the compact particle cache format (.sphc).
+	*/
+	class ParticleCacheReader
+	{
+	protected:
+		std::ifstream m_file;
+		unsigned int m_keyFrameInterval;
+		std::vector<uint64_t> m_frameOffsets;
+		std::vector<double> m_frameTimes;
+		int m_lastFrame;
+		std::vector<uint32_t> m_lastVelocities;
+		std::vector<uint32_t> m_lastIds;
+		bool m_hasVelocities;
+		bool m_hasIds;
+		uint64_t m_fileSize;
+
+		/** Decode a frame. The sizes in the frame header are validated, so false is
+		* returned for a truncated or corrupt file.
+		*/
+		bool decodeFrame(const unsigned int frame, std::vector<Vector3r> *positions);
+
+	public:
+		ParticleCacheReader();
+		~ParticleCacheReader();
+
+		bool open(const std::string &fileName);
+		void close();
+		bool isOpen() const { return m_file.is_open(); }
+
+		unsigned int numFrames() const { return static_cast<unsigned int>(m_frameOffsets.size()); }
+		Real getFrameTime(const unsigned int frame) const { return static_cast<Real>(m_frameTimes[frame]); }
+
+		/** Read a frame of the cache. Sequential reads only decode one frame each.
+		* If the frame has ids, the particles are returned in the order of their ids.
+		*/
+		bool readFrame(const unsigned int frame, std::vector<Vector3r> &positions, std::vector<Vector3r> &velocities, std::vector<unsigned int> &ids);
+
+		/** Read a frame and return it as partio data with the attributes position, velocity and id.
+		* The caller has to release the data.
+		*/
+		Partio::ParticlesDataMutable* readFramePartio(const unsigned int frame);
+
+		static bool isParticleCacheFile(const std::string &fileName);
+	};
+}
+
+#endif
@@ -1,193 +1,117 @@
 #include "PartioReaderWriter.h"
 #include "extern/partio/src/lib/Partio.h"
 #include "FileSystem.h"
+#include "Logger.h"
+#include <chrono>
 
 using namespace Utilities;
 
-
-bool PartioReaderWriter::readParticles(const std::string &fileName, const Vector3r &translation, const Matrix3r &rotation, const Real scale,
-	std::vector<Vector3r> &positions, std::vector<Vector3r> &velocities)
+namespace
 {
-	if (!FileSystem::fileExists(fileName))
-		return false;
-
-	Partio::ParticlesDataMutable* data = Partio::read(fileName.c_str());
-	if (!data)
-		return false;
-
-	unsigned int posIndex = 0xffffffff;
-	unsigned int velIndex = 0xffffffff;
-
-	for (int i = 0; i < data->numAttributes(); i++)
+	int findAttribute(Partio::ParticlesDataMutable *data, const char *name)
 	{
-		Partio::ParticleAttribute attr;
-		data->attributeInfo(i, attr);
-		if (attr.name == "position")
-			posIndex = i;
-		else if (attr.name == "velocity")
-			velIndex = i;
-	}
-
-	Partio::ParticleAttribute attr;
-
-	if (posIndex != 0xffffffff)
-	{
-		unsigned int fSize = (unsigned int) positions.size();
-		positions.resize(fSize + data->numParticles());
-		data->attributeInfo(posIndex, attr);
-		for (int i = 0; i < data->numParticles(); i++)
+		for (int i = 0; i < data->numAttributes(); i++)
 		{
-			const float *pos = data->data<float>(attr, i);
-			Vector3r x(pos[0], pos[1], pos[2]);
-			x = rotation * (x*scale) + translation;
-			positions[i + fSize] = x;
+			Partio::ParticleAttribute attr;
+			data->attributeInfo(i, attr);
+			if (attr.name == name)
+				return i;
 		}
+		return -1;
 	}
 
-	if (velIndex != 0xffffffff)
+	/** Convert n vectors to Real and transform them in parallel. Partio stores
+	* each attribute in a contiguous array, so the whole attribute is processed
+	* at once instead of accessing the particles one by one.
+	*/
+	void transformVectors(const float *src, const int n, const Vector3r &translation, const Matrix3r &rotation, const Real scale, Vector3r *dst)
 	{
-		unsigned int fSize = (unsigned int) velocities.size();
-		velocities.resize(fSize + data->numParticles());
-		data->attributeInfo(velIndex, attr);
-		for (int i = 0; i < data->numParticles(); i++)
+		#pragma omp parallel default(shared)
 		{
-			const float *vel = data->data<float>(attr, i);
-			Vector3r v(vel[0], vel[1], vel[2]);
-			velocities[i + fSize] = v;
+			#pragma omp for schedule(static)
+			for (int i = 0; i < n; i++)
+			{
+				const Vector3r x(src[3 * i], src[3 * i + 1], src[3 * i + 2]);
+				dst[i] = rotation * (x*scale) + translation;
+			}
 		}
 	}
-	else
-	{
-		unsigned int fSize = (unsigned int) velocities.size();
-		velocities.resize(fSize + data->numParticles());
-		for (int i = 0; i < data->numParticles(); i++)
-			velocities[i + fSize].setZero();
-	}
-
-	data->release();
-	return true;
-}
-
-bool PartioReaderWriter::readParticles(const std::string &fileName, const Vector3r &translation, const Matrix3r &rotation, const Real scale,
-	std::vector<Vector3r> &positions, std::vector<Vector3r> &velocities, Real &particleRadius)
-{
-	if (!FileSystem::fileExists(fileName))
-		return false;
 
-	Partio::ParticlesDataMutable* data = Partio::read(fileName.c_str());
-
-	if (!data)
-		return false;
+	/** Read the positions (and velocities, radius) of a partio file and append them. */
+	bool readPartioFile(const std::string &fileName, const Vector3r &translation, const Matrix3r &rotation, const Real scale,
+		std::vector<Vector3r> &positions, std::vector<Vector3r> *velocities, Real *particleRadius)
+	{
+		if (!FileSystem::fileExists(fileName))
+			return false;
 
-	unsigned int posIndex = 0xffffffff;
-	unsigned int velIndex = 0xffffffff;
-	unsigned int radiusIndex = 0xffffffff;
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		Partio::ParticlesDataMutable* data = Partio::read(fileName.c_str());
+		if (!data)
+			return false;
 
-	for (int i = 0; i < data->numAttributes(); i++)
-	{
+		const int numParticles = data->numParticles();
+		const int posIndex = findAttribute(data, "position");
 		Partio::ParticleAttribute attr;
-		data->attributeInfo(i, attr);
-		if (attr.name == "position")
-			posIndex = i;
-		else if (attr.name == "velocity")
-			velIndex = i;
-		else if (attr.name == "pscale")
-			radiusIndex = i;
-	}
 
-	Partio::ParticleAttribute attr;
+		if (posIndex != -1)
+		{
+			const size_t fSize = positions.size();
+			positions.resize(fSize + numParticles);
+			data->attributeInfo(posIndex, attr);
+			if (numParticles > 0)
+				transformVectors(data->data<float>(attr, 0), numParticles, translation, rotation, scale, &positions[fSize]);
+		}
 
-	if (posIndex != 0xffffffff)
-	{
-		unsigned int fSize = (unsigned int)positions.size();
-		positions.resize(fSize + data->numParticles());
-		data->attributeInfo(posIndex, attr);
-		for (int i = 0; i < data->numParticles(); i++)
+		if (velocities != nullptr)
 		{
-			const float *pos = data->data<float>(attr, i);
-			Vector3r x(pos[0], pos[1], pos[2]);
-			x = rotation * (x*scale) + translation;
-			positions[i + fSize] = x;
+			const int velIndex = findAttribute(data, "velocity");
+			const size_t fSize = velocities->size();
+			velocities->resize(fSize + numParticles, Vector3r::Zero());
+			if ((velIndex != -1) && (numParticles > 0))
+			{
+				data->attributeInfo(velIndex, attr);
+				transformVectors(data->data<float>(attr, 0), numParticles, Vector3r::Zero(), Matrix3r::Identity(), 1.0, &(*velocities)[fSize]);
+			}
 		}
-	}
 
-	if (velIndex != 0xffffffff)
-	{
-		unsigned int fSize = (unsigned int)velocities.size();
-		velocities.resize(fSize + data->numParticles());
-		data->attributeInfo(velIndex, attr);
-		for (int i = 0; i < data->numParticles(); i++)
+		if (particleRadius != nullptr)
 		{
-			const float *vel = data->data<float>(attr, i);
-			Vector3r v(vel[0], vel[1], vel[2]);
-			velocities[i + fSize] = v;
+			const int radiusIndex = findAttribute(data, "pscale");
+			if ((radiusIndex != -1) && (numParticles > 0))
+			{
+				data->attributeInfo(radiusIndex, attr);
+				const float *radius = data->data<float>(attr, 0);
+				*particleRadius = radius[0];
+			}
 		}
-	}
-	else
-	{
-		unsigned int fSize = (unsigned int)velocities.size();
-		velocities.resize(fSize + data->numParticles());
-		for (int i = 0; i < data->numParticles(); i++)
-			velocities[i + fSize].setZero();
-	}
 
-	if (radiusIndex != 0xffffffff)
-	{
-		data->attributeInfo(radiusIndex, attr);
-		const float *radius = data->data<float>(attr, 0);
-		particleRadius = radius[0];
+		data->release();
+
+		const double t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+		LOG_INFO << "Read " << numParticles << " particles from " << fileName << " (" << t << " s, " << ((t > 0.0) ? (double) numParticles / t * 1.0e-6 : 0.0) << " million particles/s)";
+		return true;
 	}
+}
+
 
-	data->release();
+bool PartioReaderWriter::readParticles(const std::string &fileName, const Vector3r &translation, const Matrix3r &rotation, const Real scale,
+	std::vector<Vector3r> &positions, std::vector<Vector3r> &velocities)
+{
+	return readPartioFile(fileName, translation, rotation, scale, positions, &velocities, nullptr);
+}
 
-	return true;
+bool PartioReaderWriter::readParticles(const std::string &fileName, const Vector3r &translation, const Matrix3r &rotation, const Real scale,
+	std::vector<Vector3r> &positions, std::vector<Vector3r> &velocities, Real &particleRadius)
+{
+	return readPartioFile(fileName, translation, rotation, scale, positions, &velocities, &particleRadius);
 }
 
 bool PartioReaderWriter::readParticles(const std::string &fileName, const Vector3r &translation, const Matrix3r &rotation, const Real scale,
 	std::vector<Vector3r> &positions)
 {
-	if (!FileSystem::fileExists(fileName))
-		return false;
-
-	Partio::ParticlesDataMutable* data = Partio::read(fileName.c_str());
-
-	if (!data)
-		return false;
-
-	unsigned int posIndex = 0xffffffff;
-
-	for (int i = 0; i < data->numAttributes(); i++)
-	{
-		Partio::ParticleAttribute attr;
-		data->attributeInfo(i, attr);
-		if (attr.name == "position")
-		{
-			posIndex = i;
-			break;
-		}
-	}
-
-	Partio::ParticleAttribute attr;
-	if (posIndex != 0xffffffff)
-	{
-		unsigned int fSize = (unsigned int)positions.size();
-		positions.resize(fSize + data->numParticles());
-		data->attributeInfo(posIndex, attr);
-		for (int i = 0; i < data->numParticles(); i++)
-		{
-			const float *pos = data->data<float>(attr, i);
-			Vector3r x(pos[0], pos[1], pos[2]);
-			x = rotation * (x*scale) + translation;
-			positions[i + fSize] = x;
-		}
-	}
-
-	data->release();
-
-	return true;
+	return readPartioFile(fileName, translation, rotation, scale, positions, nullptr, nullptr);
 }
 
-
 void PartioReaderWriter::writeParticles(const std::string &fileName, const unsigned int numParticles, const Vector3r *particlePositions,
 	const Vector3r *particleVelocities, const Real particleRadius)
 {
@@ -204,34 +128,47 @@ void PartioReaderWriter::writeParticles(const std::string &fileName, const unsig
 		scaleAttr = particleData.addAttribute("pscale", Partio::FLOAT, 1);
 	Partio::ParticleAttribute idAttr = particleData.addAttribute("id", Partio::INT, 1);
 
-	for (unsigned int i = 0; i < numParticles; i++)
-	{
-		Partio::ParticleIndex index = particleData.addParticle();
-		float* pos = particleData.dataWrite<float>(posAttr, index);
-		int* id = particleData.dataWrite<int>(idAttr, index);
+	// allocate all particles at once, partio stores each attribute in a contiguous array
+	particleData.addParticles((int)numParticles);
 
-		const Vector3r &x = particlePositions[i];
-		pos[0] = (float)x[0];
-		pos[1] = (float)x[1];
-		pos[2] = (float)x[2];
+	convertToFloat(&particlePositions[0][0], particleData.dataWrite<float>(posAttr, 0), 3 * numParticles);
 
-		if (particleVelocities != NULL)
-		{
-			float* vel = particleData.dataWrite<float>(velAttr, index);
-			const Vector3r &v = particleVelocities[i];
-			vel[0] = (float)v[0];
-			vel[1] = (float)v[1];
-			vel[2] = (float)v[2];
-		}
+	if (particleVelocities != NULL)
+		convertToFloat(&particleVelocities[0][0], particleData.dataWrite<float>(velAttr, 0), 3 * numParticles);
+
+	float *scale = nullptr;
+	if (particleRadius != 0.0)
+		scale = particleData.dataWrite<float>(scaleAttr, 0);
+	int *id = particleData.dataWrite<int>(idAttr, 0);
 
-		if (particleRadius != 0.0)
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int i = 0; i < (int)numParticles; i++)
 		{
-			float* scale = particleData.dataWrite<float>(scaleAttr, index);
-			scale[0] = (float)particleRadius;
+			if (scale != nullptr)
+				scale[i] = (float)particleRadius;
+			id[i] = i;
 		}
-		id[0] = i;
 	}
 
 	Partio::write(fileName.c_str(), particleData, true);
 	particleData.release();
 }
+
+void PartioReaderWriter::convertToFloat(const Real *src, float *dst, const unsigned int n)
+{
+	const unsigned int blockSize = 4096;
+	const int numBlocks = (int)((n + blockSize - 1) / blockSize);
+
+	#pragma omp parallel default(shared)
+	{
+		#pragma omp for schedule(static)
+		for (int b = 0; b < numBlocks; b++)
+		{
+			const unsigned int start = b * blockSize;
+			const unsigned int count = std::min(blockSize, n - start);
+			Eigen::Map<Eigen::VectorXf>(&dst[start], count) = Eigen::Map<const VectorXr>(&src[start], count).template cast<float>();
+		}
+	}
+}
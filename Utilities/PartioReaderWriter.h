@@ -22,6 +22,11 @@ namespace Utilities
 
 		static void writeParticles(const std::string &fileName, const unsigned int numParticles, const Vector3r *particlePositions,
 			const Vector3r *particleVelocities, const Real particleRadius);
+
+		/** Convert n contiguous Real values to float. The conversion is done in parallel 
+		* in blocks which are vectorized by Eigen.
+		*/
+		static void convertToFloat(const Real *src, float *dst, const unsigned int n);
 	};
 
 }
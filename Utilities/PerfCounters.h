@@ -0,0 +1,140 @@
+#ifndef __PerfCounters_h__
+#define __PerfCounters_h__
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace Utilities
+{
+	/** \brief Values of the hardware performance counters.
+	*/
+	struct PerfCounterValues
+	{
+		enum { Cycles = 0, Instructions, LLCMisses, BranchMisses, NumCounters };
+		uint64_t values[NumCounters];
+
+		PerfCounterValues() { reset(); }
+
+		void reset()
+		{
+			for (unsigned int i = 0; i < NumCounters; i++)
+				values[i] = 0;
+		}
+
+		PerfCounterValues& operator+=(const PerfCounterValues &v)
+		{
+			for (unsigned int i = 0; i < NumCounters; i++)
+				values[i] += v.values[i];
+			return *this;
+		}
+
+		PerfCounterValues operator-(const PerfCounterValues &v) const
+		{
+			PerfCounterValues res;
+			for (unsigned int i = 0; i < NumCounters; i++)
+				res.values[i] = values[i] - v.values[i];
+			return res;
+		}
+
+		static const char* getName(const unsigned int i)
+		{
+			static const char* names[] = { "cycles", "instructions", "LLC misses", "branch misses" };
+			return names[i];
+		}
+	};
+
+	/** \brief Hardware performance counters (cycles, instructions, last level
+	* cache misses and branch misses) of the calling thread. The counters are
+	* opened as one group with perf_event_open (Linux only), so they are
+	* scheduled together and read by a single system call. The counters of a
+	* thread can be read by any other thread.
+	*/
+	class PerfCounterGroup
+	{
+	protected:
+		int m_fd[PerfCounterValues::NumCounters];
+
+	public:
+		PerfCounterGroup()
+		{
+			for (unsigned int i = 0; i < PerfCounterValues::NumCounters; i++)
+				m_fd[i] = -1;
+		}
+
+		~PerfCounterGroup() { close(); }
+
+		/** Open and start the counters for the calling thread. Returns false if
+		* the counters are not supported or not permitted (see /proc/sys/kernel/perf_event_paranoid).
+		*/
+		bool open()
+		{
+#ifdef __linux__
+			const uint64_t configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+			for (unsigned int i = 0; i < PerfCounterValues::NumCounters; i++)
+			{
+				perf_event_attr attr;
+				memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = configs[i];
+				attr.disabled = (i == 0) ? 1 : 0;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_GROUP;
+				m_fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, (i == 0) ? -1 : m_fd[0], 0);
+				if (m_fd[i] < 0)
+				{
+					close();
+					return false;
+				}
+			}
+			ioctl(m_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(m_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		void close()
+		{
+#ifdef __linux__
+			for (int i = PerfCounterValues::NumCounters - 1; i >= 0; i--)
+			{
+				if (m_fd[i] >= 0)
+					::close(m_fd[i]);
+				m_fd[i] = -1;
+			}
+#endif
+		}
+
+		bool isOpen() const { return m_fd[0] >= 0; }
+
+		/** Read the current values of all counters of the group. */
+		bool read(PerfCounterValues &v) const
+		{
+#ifdef __linux__
+			if (m_fd[0] < 0)
+				return false;
+			// PERF_FORMAT_GROUP: number of counters followed by the values
+			uint64_t buffer[1 + PerfCounterValues::NumCounters];
+			if (::read(m_fd[0], buffer, sizeof(buffer)) != (ssize_t) sizeof(buffer))
+				return false;
+			for (unsigned int i = 0; i < PerfCounterValues::NumCounters; i++)
+				v.values[i] = buffer[1 + i];
+			return true;
+#else
+			return false;
+#endif
+		}
+	};
+}
+
+#endif
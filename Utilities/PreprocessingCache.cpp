@@ -0,0 +1,310 @@
+#include "PreprocessingCache.h"
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include "FileSystem.h"
+#include "Logger.h"
+#include "Version.h"
+#include <ctime>
+#ifdef WIN32
+#include <process.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+using namespace Utilities;
+
+/** Version of the cache layout. Increment it if the format of an entry changes. */
+#define PREPROCESSING_CACHE_VERSION "1"
+
+namespace
+{
+	bool getFileStat(const std::string &fileName, long long &size, long long &modificationTime)
+	{
+#ifdef WIN32
+		struct _stat64 st;
+		if (_stat64(fileName.c_str(), &st) != 0)
+			return false;
+#else
+		struct stat st;
+		if (stat(fileName.c_str(), &st) != 0)
+			return false;
+#endif
+		size = (long long)st.st_size;
+		modificationTime = (long long)st.st_mtime;
+		return true;
+	}
+
+	int getProcessId()
+	{
+#ifdef WIN32
+		return _getpid();
+#else
+		return (int)getpid();
+#endif
+	}
+
+	bool moveFile(const std::string &source, const std::string &dest)
+	{
+#ifdef WIN32
+		return MoveFileExA(source.c_str(), dest.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return rename(source.c_str(), dest.c_str()) == 0;
+#endif
+	}
+
+	void listFiles(const std::string &path, std::vector<std::string> &files)
+	{
+#ifdef WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE h = FindFirstFileA((path + "/*").c_str(), &data);
+		if (h == INVALID_HANDLE_VALUE)
+			return;
+		do
+		{
+			if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+				files.push_back(data.cFileName);
+		} while (FindNextFileA(h, &data));
+		FindClose(h);
+#else
+		DIR *dir = opendir(path.c_str());
+		if (dir == nullptr)
+			return;
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != nullptr)
+		{
+			const std::string name(entry->d_name);
+			if ((name != ".") && (name != ".."))
+				files.push_back(name);
+		}
+		closedir(dir);
+#endif
+	}
+
+	/** Entries are named <type>_<32 hex digits>.<ext>, temporary files <key>.tmp<pid>_<counter>.<ext>. */
+	bool isEntry(const std::string &name)
+	{
+		const size_t dot = name.find('.');
+		const size_t us = name.rfind('_', dot);
+		if ((dot == std::string::npos) || (us == std::string::npos) || (dot - us - 1 != 32))
+			return false;
+		for (size_t i = us + 1; i < dot; i++)
+		{
+			if (!isxdigit((unsigned char)name[i]))
+				return false;
+		}
+		return true;
+	}
+}
+
+
+PreprocessingCache::PreprocessingCache() :
+	m_path(),
+	m_enabled(false),
+	m_sizeBudget(0),
+	m_tempCounter(0)
+{
+}
+
+void PreprocessingCache::init(const std::string &path, const unsigned long long sizeBudget)
+{
+	m_path = FileSystem::normalizePath(path);
+	m_sizeBudget = sizeBudget;
+	FileSystem::makeDirs(m_path);
+	m_enabled = true;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_index.clear();
+	loadIndex();
+}
+
+std::string PreprocessingCache::getIndexFileName() const
+{
+	return FileSystem::normalizePath(m_path + "/index.txt");
+}
+
+void PreprocessingCache::loadIndex()
+{
+	std::ifstream file(getIndexFileName());
+	if (!file)
+		return;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream ss(line);
+		IndexEntry e;
+		std::string fileName;
+		if (!(ss >> e.size >> e.modificationTime >> e.hash))
+			continue;
+		std::getline(ss >> std::ws, fileName);
+		if (!fileName.empty())
+			m_index[fileName] = e;
+	}
+}
+
+void PreprocessingCache::saveIndex()
+{
+	// Other processes could use the index at the same time, so it is written
+	// to a temporary file first. Lost updates only lead to rehashing a file.
+	std::ostringstream tmpName;
+	tmpName << getIndexFileName() << ".tmp" << getProcessId() << "_" << m_tempCounter++;
+	std::ofstream file(tmpName.str());
+	if (!file)
+		return;
+	for (auto it = m_index.begin(); it != m_index.end(); it++)
+		file << it->second.size << " " << it->second.modificationTime << " " << it->second.hash << " " << it->first << "\n";
+	file.close();
+	if (file.fail() || !moveFile(tmpName.str(), getIndexFileName()))
+		remove(tmpName.str().c_str());
+}
+
+std::string PreprocessingCache::hashData(const void *data, const size_t numBytes)
+{
+	MD5 context;
+	const unsigned char *ptr = static_cast<const unsigned char*>(data);
+	size_t remaining = numBytes;
+	while (remaining > 0)
+	{
+		const unsigned int len = (unsigned int)std::min(remaining, (size_t)(1u << 30));
+		context.update(const_cast<unsigned char*>(ptr), len);
+		ptr += len;
+		remaining -= len;
+	}
+	context.finalize();
+	char *md5hex = context.hex_digest();
+	std::string res(md5hex);
+	delete[] md5hex;
+	return res;
+}
+
+std::string PreprocessingCache::getFileHash(const std::string &fileName)
+{
+	const std::string name = FileSystem::normalizePath(fileName);
+	long long size, modificationTime;
+	if (!getFileStat(name, size, modificationTime))
+		return "";
+
+	if (m_enabled)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_index.find(name);
+		if ((it != m_index.end()) && (it->second.size == size) && (it->second.modificationTime == modificationTime))
+			return it->second.hash;
+	}
+
+	const std::string hash = FileSystem::getFileMD5(name);
+	if (m_enabled && (hash != ""))
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		IndexEntry &e = m_index[name];
+		e.size = size;
+		e.modificationTime = modificationTime;
+		e.hash = hash;
+		saveIndex();
+	}
+	return hash;
+}
+
+std::string PreprocessingCache::getKey(const std::string &type, const std::vector<std::string> &inputFiles, const std::string &parameters)
+{
+	std::string str = type + "|" + PREPROCESSING_CACHE_VERSION + "|" + GIT_SHA1 + "|";
+	for (size_t i = 0; i < inputFiles.size(); i++)
+		str += getFileHash(inputFiles[i]) + "|";
+	str += parameters;
+	return type + "_" + hashString(str);
+}
+
+std::string PreprocessingCache::getFileName(const std::string &key, const std::string &ext) const
+{
+	return FileSystem::normalizePath(m_path + "/" + key + "." + ext);
+}
+
+bool PreprocessingCache::find(const std::string &key, const std::string &ext, std::string &fileName)
+{
+	if (!m_enabled)
+		return false;
+	fileName = getFileName(key, ext);
+	if (!FileSystem::fileExists(fileName))
+		return false;
+	// mark the entry as recently used
+	utime(fileName.c_str(), nullptr);
+	return true;
+}
+
+std::string PreprocessingCache::beginWrite(const std::string &key, const std::string &ext)
+{
+	if (!m_enabled)
+		return "";
+	std::ostringstream tmpName;
+	tmpName << m_path << "/" << key << ".tmp" << getProcessId() << "_" << m_tempCounter++ << "." << ext;
+	return FileSystem::normalizePath(tmpName.str());
+}
+
+bool PreprocessingCache::endWrite(const std::string &tempFileName, const std::string &key, const std::string &ext)
+{
+	if (!m_enabled || !FileSystem::fileExists(tempFileName))
+		return false;
+	// If another job has written the same entry in the meantime, it is replaced by an identical one.
+	if (!moveFile(tempFileName, getFileName(key, ext)))
+	{
+		LOG_WARN << "Cannot write cache entry: " << getFileName(key, ext);
+		remove(tempFileName.c_str());
+		return false;
+	}
+	evict();
+	return true;
+}
+
+void PreprocessingCache::evict()
+{
+	if (!m_enabled)
+		return;
+
+	struct Entry
+	{
+		std::string fileName;
+		long long size;
+		long long modificationTime;
+	};
+	std::vector<std::string> files;
+	listFiles(m_path, files);
+
+	const long long now = (long long)time(nullptr);
+	std::vector<Entry> entries;
+	unsigned long long totalSize = 0;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		if (!isEntry(files[i]))
+			continue;
+		Entry e;
+		e.fileName = FileSystem::normalizePath(m_path + "/" + files[i]);
+		if (!getFileStat(e.fileName, e.size, e.modificationTime))
+			continue;
+		if (files[i].find(".tmp") != std::string::npos)
+		{
+			// remove temporary files of crashed jobs
+			if (now - e.modificationTime > 3600)
+				remove(e.fileName.c_str());
+			continue;
+		}
+		entries.push_back(e);
+		totalSize += (unsigned long long) e.size;
+	}
+
+	if ((m_sizeBudget == 0) || (totalSize <= m_sizeBudget))
+		return;
+
+	std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.modificationTime < b.modificationTime; });
+	for (size_t i = 0; (i < entries.size()) && (totalSize > m_sizeBudget); i++)
+	{
+		if (remove(entries[i].fileName.c_str()) == 0)
+		{
+			LOG_INFO << "Removed cache entry: " << entries[i].fileName;
+			totalSize -= (unsigned long long) entries[i].size;
+		}
+	}
+}
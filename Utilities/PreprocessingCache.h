@@ -0,0 +1,96 @@
+#ifndef __PreprocessingCache_h__
+#define __PreprocessingCache_h__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+
+namespace Utilities
+{
+	/** \brief Content-addressed cache for preprocessed data (boundary and fluid
+	* samplings, SDFs, boundary volumes).
+	*
+	* The key of an entry is the hash of the type of the data, the content of
+	* all input files, all parameters which influence the result and the code
+	* version. So an entry never has to be validated and different scenes can
+	* share the same cache directory.
+	*
+	* The content hashes of the input files are stored in an index together with
+	* the size and modification time of the files. A file is only hashed again
+	* if its size or modification time has changed.
+	*
+	* Entries are written to a temporary file which is renamed when it is complete,
+	* so concurrent jobs which use the same cache directory never read incomplete
+	* entries. If a size budget is set, the least recently used entries are
+	* removed when the cache exceeds the budget.
+	*/
+	class PreprocessingCache
+	{
+	protected:
+		struct IndexEntry
+		{
+			long long size;
+			long long modificationTime;
+			std::string hash;
+		};
+
+		std::string m_path;
+		bool m_enabled;
+		unsigned long long m_sizeBudget;
+		/** fast-path index: file name -> size, modification time and content hash */
+		std::map<std::string, IndexEntry> m_index;
+		std::mutex m_mutex;
+		std::atomic<unsigned int> m_tempCounter;
+
+		std::string getIndexFileName() const;
+		void loadIndex();
+		void saveIndex();
+
+	public:
+		PreprocessingCache();
+
+		/** Use the given directory as cache. A size budget of 0 means that the
+		* cache is not limited.
+		*/
+		void init(const std::string &path, const unsigned long long sizeBudget = 0);
+		void disable() { m_enabled = false; }
+		bool isEnabled() const { return m_enabled; }
+		const std::string &getPath() const { return m_path; }
+		unsigned long long getSizeBudget() const { return m_sizeBudget; }
+
+		/** Return the MD5 hash of the content of a file (see fast-path index). */
+		std::string getFileHash(const std::string &fileName);
+		static std::string hashData(const void *data, const size_t numBytes);
+		static std::string hashString(const std::string &str) { return hashData(str.data(), str.size()); }
+
+		/** Return the key of an entry of the given type. The parameters must contain
+		* all values which influence the result besides the input files.
+		*/
+		std::string getKey(const std::string &type, const std::vector<std::string> &inputFiles, const std::string &parameters);
+
+		/** Return the file name of the entry with the given key and extension. */
+		std::string getFileName(const std::string &key, const std::string &ext) const;
+
+		/** Find an entry. If it exists, its file name is returned and the entry is
+		* marked as recently used.
+		*/
+		bool find(const std::string &key, const std::string &ext, std::string &fileName);
+
+		/** Return a temporary file name to write an entry ("" if the cache is disabled).
+		* The file has the extension ext, so the writers can determine the format.
+		*/
+		std::string beginWrite(const std::string &key, const std::string &ext);
+
+		/** Move a completely written temporary file to its entry and remove the
+		* least recently used entries if the cache exceeds the size budget.
+		*/
+		bool endWrite(const std::string &tempFileName, const std::string &key, const std::string &ext);
+
+		/** Remove the least recently used entries until the cache fits into the size budget. */
+		void evict();
+	};
+}
+
+#endif
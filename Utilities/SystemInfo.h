@@ -5,9 +5,11 @@
 #if WIN32
 #define NOMINMAX
 #include "windows.h"
+#include <psapi.h>
 #else
 #include <unistd.h>
 #include <limits.h>
+#include <sys/resource.h>
 #endif
 
 namespace Utilities
@@ -31,6 +33,27 @@ namespace Utilities
 			char hostname[bufferSize];
 			gethostname(hostname, bufferSize);
 			return hostname;
+#endif
+		}
+
+		/** Return the peak resident memory (working set) of the process in bytes.
+		*/
+		static size_t getPeakMemoryUsage()
+		{
+#ifdef WIN32
+			PROCESS_MEMORY_COUNTERS info;
+			if (!GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+				return 0;
+			return (size_t)info.PeakWorkingSetSize;
+#else
+			struct rusage usage;
+			if (getrusage(RUSAGE_SELF, &usage) != 0)
+				return 0;
+#ifdef __APPLE__
+			return (size_t)usage.ru_maxrss;
+#else
+			return (size_t)usage.ru_maxrss * 1024;
+#endif
 #endif
 		}
 	};
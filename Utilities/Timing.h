@@ -2,15 +2,25 @@
 #define __Timing_H__
 
 #include <iostream>
-#include <stack>
+#include <fstream>
+#include <vector>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include "Logger.h"
 #include <chrono>
+#ifdef USE_PERF_COUNTERS
+#include "PerfCounters.h"
+#endif
 
 namespace Utilities
 {
 	#define START_TIMING(timerName) \
-	Utilities::Timing::startTiming(timerName);
+	{ \
+	static const int timing_nameId = Utilities::Timing::getNameId(timerName); \
+	Utilities::Timing::startTiming(timing_nameId); \
+	}
 
 	#define STOP_TIMING \
 	Utilities::Timing::stopTiming(false);
@@ -20,23 +30,38 @@ namespace Utilities
 
 	#define STOP_TIMING_AVG \
 	{ \
-	static int timing_timerId = -1; \
+	static const int timing_timerId = Utilities::IDFactory::getId(); \
 	Utilities::Timing::stopTiming(false, timing_timerId); \
 	}
 
 	#define STOP_TIMING_AVG_PRINT \
 	{ \
-	static int timing_timerId = -1; \
+	static const int timing_timerId = Utilities::IDFactory::getId(); \
 	Utilities::Timing::stopTiming(true, timing_timerId); \
 	}
 
 	#define INIT_TIMING \
-		int Utilities::IDFactory::id = 0; \
+		std::atomic<int> Utilities::IDFactory::id(0); \
 		std::unordered_map<int, Utilities::AverageTime> Utilities::Timing::m_averageTimes; \
-		std::stack<Utilities::TimingHelper> Utilities::Timing::m_timingStack; \
 		bool Utilities::Timing::m_dontPrintTimes = false; \
-		unsigned int Utilities::Timing::m_startCounter = 0; \
-		unsigned int Utilities::Timing::m_stopCounter = 0;
+		bool Utilities::Timing::m_profiling = false; \
+		unsigned int Utilities::Timing::m_eventBufferSize = 0; \
+		std::vector<std::string> Utilities::Timing::m_names; \
+		std::unordered_map<std::string, int> Utilities::Timing::m_nameIds; \
+		std::vector<std::shared_ptr<Utilities::TimingThreadData>> Utilities::Timing::m_threadData; \
+		std::vector<std::vector<double>> Utilities::Timing::m_stepTimes; \
+		std::mutex Utilities::Timing::m_mutex; \
+		std::chrono::time_point<std::chrono::high_resolution_clock> Utilities::Timing::m_startTime = std::chrono::high_resolution_clock::now(); \
+		INIT_PERF_COUNTERS
+
+#ifdef USE_PERF_COUNTERS
+	#define INIT_PERF_COUNTERS \
+		bool Utilities::Timing::m_perfCounters = false; \
+		std::vector<std::shared_ptr<Utilities::PerfCounterGroup>> Utilities::Timing::m_perfCounterGroups; \
+		std::mutex Utilities::Timing::m_perfCounterMutex;
+#else
+	#define INIT_PERF_COUNTERS
+#endif
 
 
 	/** \brief Struct to store a time measurement.
@@ -44,16 +69,58 @@ namespace Utilities
 	struct TimingHelper
 	{
 		std::chrono::time_point<std::chrono::high_resolution_clock> start;
-		std::string name;
+		int nameId;
+		/** time of the nested measurements in ms */
+		double childTime;
+#ifdef USE_PERF_COUNTERS
+		PerfCounterValues perfStart;
+#endif
 	};
 
-	/** \brief Struct to store the total time and the number of steps in order to compute the average time. 
+	/** \brief Struct to store the total time and the number of steps in order to compute the average time.
+	* selfTime is the total time without the nested measurements.
 	*/
 	struct AverageTime
 	{
 		double totalTime;
+		double selfTime;
 		unsigned int counter;
 		std::string name;
+		int parentNameId;
+#ifdef USE_PERF_COUNTERS
+		/** hardware counters of all threads during the measurements */
+		PerfCounterValues perfCounters;
+#endif
+	};
+
+	/** \brief Measurement which is recorded for the trace export.
+	*/
+	struct TimingEvent
+	{
+		int nameId;
+		unsigned int depth;
+		/** start time in microseconds since program start */
+		double start;
+		/** duration in microseconds */
+		double duration;
+	};
+
+	/** \brief Measurements of a single thread. Each thread only writes its own data.
+	* The mutex protects the data which is read by other threads (average times, 
+	* counters and profiling data). It is only contended while the times are merged.
+	*/
+	struct TimingThreadData
+	{
+		std::mutex mutex;
+		unsigned int threadIndex;
+		unsigned int startCounter;
+		unsigned int stopCounter;
+		std::vector<TimingHelper> stack;
+		std::unordered_map<int, AverageTime> averageTimes;
+		std::vector<TimingEvent> events;
+		unsigned int numDroppedEvents;
+		/** time in ms per name id in the current step */
+		std::vector<double> stepTimes;
 	};
 
 	/** \brief Factory for unique ids.
@@ -62,115 +129,350 @@ namespace Utilities
 	{
 	private:
 		/** Current id */
-		static int id;
+		static std::atomic<int> id;
 
 	public:
 		static int getId() { return id++; }
 	};
 
 	/** \brief Class for time measurements.
+	* The measurements are stored per thread, so timing can be used in parallel
+	* regions. Names are interned once per call site of START_TIMING.
+	* If profiling is enabled, all measurements are additionally recorded in a
+	* fixed-size buffer per thread (Chrome trace export) and summed up per
+	* simulation step (CSV export).
+	* If the code is compiled with USE_PERF_COUNTERS and the counters are
+	* enabled, the hardware performance counters of all registered threads
+	* are summed up for each measurement.
 	*/
 	class Timing
 	{
 	public:
 		static bool m_dontPrintTimes;
-		static unsigned int m_startCounter;
-		static unsigned int m_stopCounter;
-		static std::stack<TimingHelper> m_timingStack;
 		static std::unordered_map<int, AverageTime> m_averageTimes;
+		static bool m_profiling;
+		static unsigned int m_eventBufferSize;
+		static std::vector<std::string> m_names;
+		static std::unordered_map<std::string, int> m_nameIds;
+		static std::vector<std::shared_ptr<TimingThreadData>> m_threadData;
+		static std::vector<std::vector<double>> m_stepTimes;
+		static std::mutex m_mutex;
+		static std::chrono::time_point<std::chrono::high_resolution_clock> m_startTime;
+#ifdef USE_PERF_COUNTERS
+		static bool m_perfCounters;
+		static std::vector<std::shared_ptr<PerfCounterGroup>> m_perfCounterGroups;
+		static std::mutex m_perfCounterMutex;
+#endif
+
+		static TimingThreadData &getThreadData()
+		{
+			static thread_local std::shared_ptr<TimingThreadData> data;
+			if (!data)
+			{
+				data = std::make_shared<TimingThreadData>();
+				data->startCounter = 0;
+				data->stopCounter = 0;
+				data->numDroppedEvents = 0;
+				std::lock_guard<std::mutex> lock(m_mutex);
+				data->threadIndex = (unsigned int)m_threadData.size();
+				if (m_profiling)
+					data->events.reserve(m_eventBufferSize);
+				m_threadData.push_back(data);
+			}
+			return *data;
+		}
+
+		static int getNameId(const std::string& name)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto iter = m_nameIds.find(name);
+			if (iter != m_nameIds.end())
+				return iter->second;
+			const int id = (int)m_names.size();
+			m_names.push_back(name);
+			m_nameIds[name] = id;
+			return id;
+		}
+
+		static std::string getName(const int nameId)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_names[nameId];
+		}
 
 		static void reset()
 		{
-			while (!m_timingStack.empty())
-				m_timingStack.pop();
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (auto &data : m_threadData)
+			{
+				std::lock_guard<std::mutex> dataLock(data->mutex);
+				data->stack.clear();
+				data->averageTimes.clear();
+				data->events.clear();
+				data->stepTimes.clear();
+				data->numDroppedEvents = 0;
+				data->startCounter = 0;
+				data->stopCounter = 0;
+			}
 			m_averageTimes.clear();
-			m_startCounter = 0;
-			m_stopCounter = 0;
+			m_stepTimes.clear();
 		}
 
-		FORCE_INLINE static void startTiming(const std::string& name = std::string(""))
+		/** Enable the recording of all measurements. eventBufferSize is the
+		* maximum number of measurements per thread for the trace export.
+		*/
+		static void enableProfiling(const unsigned int eventBufferSize = 1000000)
 		{
-			TimingHelper h;
-			h.start = std::chrono::high_resolution_clock::now();
-			h.name = name;
-			Timing::m_timingStack.push(h);
-			Timing::m_startCounter++;
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_eventBufferSize = eventBufferSize;
+			for (auto &data : m_threadData)
+			{
+				std::lock_guard<std::mutex> dataLock(data->mutex);
+				data->events.reserve(m_eventBufferSize);
+			}
+			m_profiling = true;
 		}
 
-		FORCE_INLINE static double stopTiming(bool print = true)
+		static bool isProfiling() { return m_profiling; }
+
+#ifdef USE_PERF_COUNTERS
+		/** Open the hardware performance counters for the calling thread and all
+		* threads of the OpenMP thread pool. Threads which are created later
+		* are not measured. Returns false if the counters are not available.
+		*/
+		static bool enablePerfCounters()
 		{
-			if (!Timing::m_timingStack.empty())
+			bool success = registerPerfCounterThread();
+			#pragma omp parallel default(shared)
 			{
-				Timing::m_stopCounter++;
-				std::chrono::time_point<std::chrono::high_resolution_clock> stop = std::chrono::high_resolution_clock::now();
-				TimingHelper h = Timing::m_timingStack.top();
-				Timing::m_timingStack.pop();
-				std::chrono::duration<double> elapsed_seconds = stop - h.start;
-				double t = elapsed_seconds.count() * 1000.0;
+				if (!registerPerfCounterThread())
+				{
+					#pragma omp critical
+					success = false;
+				}
+			}
+			m_perfCounters = success;
+			if (!success)
+				LOG_WARN << "Hardware performance counters are not available (see /proc/sys/kernel/perf_event_paranoid).";
+			return success;
+		}
 
-				if (print)
-					LOG_INFO << "time " << h.name.c_str() << ": " << t << " ms";
-				return t;
+		static bool isPerfCountersEnabled() { return m_perfCounters; }
+
+		static bool registerPerfCounterThread()
+		{
+			static thread_local std::shared_ptr<PerfCounterGroup> group;
+			if (group)
+				return true;
+			std::shared_ptr<PerfCounterGroup> g = std::make_shared<PerfCounterGroup>();
+			if (!g->open())
+				return false;
+			group = g;
+			std::lock_guard<std::mutex> lock(m_perfCounterMutex);
+			m_perfCounterGroups.push_back(g);
+			return true;
+		}
+
+		/** Sum of the counters of all registered threads. */
+		static void readPerfCounters(PerfCounterValues &values)
+		{
+			values.reset();
+			PerfCounterValues v;
+			std::lock_guard<std::mutex> lock(m_perfCounterMutex);
+			for (auto &g : m_perfCounterGroups)
+			{
+				if (g->read(v))
+					values += v;
 			}
-			return 0;
 		}
 
-		FORCE_INLINE static double stopTiming(bool print, int &id)
+		/** Return a string with the average counter values per call of a measurement. */
+		static std::string perfCountersToString(const AverageTime &at)
+		{
+			const PerfCounterValues &pc = at.perfCounters;
+			std::ostringstream oss;
+			oss << " (per call: ";
+			for (unsigned int i = 0; i < PerfCounterValues::NumCounters; i++)
+				oss << (double)pc.values[i] / at.counter << " " << PerfCounterValues::getName(i) << ", ";
+			oss << "IPC: " << ((pc.values[PerfCounterValues::Cycles] > 0) ? (double)pc.values[PerfCounterValues::Instructions] / pc.values[PerfCounterValues::Cycles] : 0.0) << ")";
+			return oss.str();
+		}
+#endif
+
+		FORCE_INLINE static void startTiming(const int nameId)
+		{
+			TimingThreadData &data = getThreadData();
+			TimingHelper h;
+#ifdef USE_PERF_COUNTERS
+			if (m_perfCounters)
+				readPerfCounters(h.perfStart);
+#endif
+			h.start = std::chrono::high_resolution_clock::now();
+			h.nameId = nameId;
+			h.childTime = 0.0;
+			data.stack.push_back(h);
+			std::lock_guard<std::mutex> lock(data.mutex);
+			data.startCounter++;
+		}
+
+		static void startTiming(const std::string& name = std::string(""))
+		{
+			startTiming(getNameId(name));
+		}
+
+		FORCE_INLINE static double stopTiming(bool print = true)
+		{
+			return stopTiming(print, -1);
+		}
+
+		/** Stop the last measurement of the current thread. The time is added to
+		* the average time with the given id if id >= 0 (see IDFactory).
+		*/
+		FORCE_INLINE static double stopTiming(bool print, const int id)
 		{
-			if (id == -1)
-				id = IDFactory::getId();
-			if (!Timing::m_timingStack.empty())
+			TimingThreadData &data = getThreadData();
+			if (!data.stack.empty())
 			{
-				Timing::m_stopCounter++;
 				std::chrono::time_point<std::chrono::high_resolution_clock> stop = std::chrono::high_resolution_clock::now();
-				TimingHelper h = Timing::m_timingStack.top();
-				Timing::m_timingStack.pop();
+				const TimingHelper h = data.stack.back();
+				data.stack.pop_back();
+#ifdef USE_PERF_COUNTERS
+				PerfCounterValues perfCounters;
+				if (m_perfCounters)
+				{
+					readPerfCounters(perfCounters);
+					perfCounters = perfCounters - h.perfStart;
+				}
+#endif
 
 				std::chrono::duration<double> elapsed_seconds = stop - h.start;
 				double t = elapsed_seconds.count() * 1000.0;
+				int parentNameId = -1;
+				if (!data.stack.empty())
+				{
+					data.stack.back().childTime += t;
+					parentNameId = data.stack.back().nameId;
+				}
 
 				if (print && !Timing::m_dontPrintTimes)
-					LOG_INFO << "time " << h.name.c_str() << ": " << t << " ms";
+					LOG_INFO << "time " << getName(h.nameId).c_str() << ": " << t << " ms";
 
+				// getName() locks m_mutex, so it is not called while the lock of the 
+				// thread data is held (mergeAverageTimes() locks in the other order)
+				std::unique_lock<std::mutex> lock(data.mutex);
+				data.stopCounter++;
 				if (id >= 0)
 				{
 					std::unordered_map<int, AverageTime>::iterator iter;
-					iter = Timing::m_averageTimes.find(id);
-					if (iter != Timing::m_averageTimes.end())
+					iter = data.averageTimes.find(id);
+					if (iter != data.averageTimes.end())
 					{
-						Timing::m_averageTimes[id].totalTime += t;
-						Timing::m_averageTimes[id].counter++;
+						iter->second.totalTime += t;
+						iter->second.selfTime += t - h.childTime;
+						iter->second.counter++;
+#ifdef USE_PERF_COUNTERS
+						iter->second.perfCounters += perfCounters;
+#endif
 					}
 					else
 					{
+						// only this thread inserts into its map, so it can be unlocked meanwhile
+						lock.unlock();
 						AverageTime at;
 						at.counter = 1;
 						at.totalTime = t;
-						at.name = h.name;
-						Timing::m_averageTimes[id] = at;
+						at.selfTime = t - h.childTime;
+						at.name = getName(h.nameId);
+						at.parentNameId = parentNameId;
+#ifdef USE_PERF_COUNTERS
+						at.perfCounters = perfCounters;
+#endif
+						lock.lock();
+						data.averageTimes[id] = at;
 					}
 				}
+
+				if (m_profiling)
+				{
+					if (data.events.size() < data.events.capacity())
+					{
+						std::chrono::duration<double, std::micro> start = h.start - m_startTime;
+						TimingEvent e;
+						e.nameId = h.nameId;
+						e.depth = (unsigned int)data.stack.size();
+						e.start = start.count();
+						e.duration = t * 1000.0;
+						data.events.push_back(e);
+					}
+					else
+						data.numDroppedEvents++;
+
+					if (data.stepTimes.size() <= (size_t)h.nameId)
+						data.stepTimes.resize(h.nameId + 1, 0.0);
+					data.stepTimes[h.nameId] += t;
+				}
 				return t;
 			}
 			return 0;
 		}
 
+		/** Merge the average times of all threads into m_averageTimes. */
+		static void mergeAverageTimes(unsigned int &startCounter, unsigned int &stopCounter)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_averageTimes.clear();
+			startCounter = 0;
+			stopCounter = 0;
+			for (auto &data : m_threadData)
+			{
+				std::lock_guard<std::mutex> dataLock(data->mutex);
+				startCounter += data->startCounter;
+				stopCounter += data->stopCounter;
+				for (auto &iter : data->averageTimes)
+				{
+					auto at = m_averageTimes.find(iter.first);
+					if (at == m_averageTimes.end())
+						m_averageTimes[iter.first] = iter.second;
+					else
+					{
+						at->second.totalTime += iter.second.totalTime;
+						at->second.selfTime += iter.second.selfTime;
+						at->second.counter += iter.second.counter;
+#ifdef USE_PERF_COUNTERS
+						at->second.perfCounters += iter.second.perfCounters;
+#endif
+					}
+				}
+			}
+		}
+
 		FORCE_INLINE static void printAverageTimes()
 		{
+			unsigned int startCounter, stopCounter;
+			mergeAverageTimes(startCounter, stopCounter);
 			std::unordered_map<int, AverageTime>::iterator iter;
 			for (iter = Timing::m_averageTimes.begin(); iter != Timing::m_averageTimes.end(); iter++)
 			{
 				AverageTime &at = iter->second;
 				const double avgTime = at.totalTime / at.counter;
+#ifdef USE_PERF_COUNTERS
+				if (m_perfCounters)
+				{
+					LOG_INFO << "Average time: " << at.name.c_str() << ": " << avgTime << " ms" << perfCountersToString(at);
+					continue;
+				}
+#endif
 				LOG_INFO << "Average time: " << at.name.c_str() << ": " << avgTime << " ms";
 			}
-			if (Timing::m_startCounter != Timing::m_stopCounter)
-				LOG_INFO << "Problem: " << Timing::m_startCounter << " calls of startTiming and " << Timing::m_stopCounter << " calls of stopTiming. ";
+			if (startCounter != stopCounter)
+				LOG_INFO << "Problem: " << startCounter << " calls of startTiming and " << stopCounter << " calls of stopTiming. ";
 			LOG_INFO << "---------------------------------------------------------------------------\n";
 		}
 
 		FORCE_INLINE static void printTimeSums()
 		{
+			unsigned int startCounter, stopCounter;
+			mergeAverageTimes(startCounter, stopCounter);
 			std::unordered_map<int, AverageTime>::iterator iter;
 			for (iter = Timing::m_averageTimes.begin(); iter != Timing::m_averageTimes.end(); iter++)
 			{
@@ -178,11 +480,138 @@ namespace Utilities
 				const double timeSum = at.totalTime;
 				LOG_INFO << "Time sum: " << at.name.c_str() << ": " << timeSum << " ms";
 			}
-			if (Timing::m_startCounter != Timing::m_stopCounter)
-				LOG_INFO << "Problem: " << Timing::m_startCounter << " calls of startTiming and " << Timing::m_stopCounter << " calls of stopTiming. ";
+			if (startCounter != stopCounter)
+				LOG_INFO << "Problem: " << startCounter << " calls of startTiming and " << stopCounter << " calls of stopTiming. ";
 			LOG_INFO << "---------------------------------------------------------------------------\n";
 		}
+
+		/** Store the times of all threads since the last call as one step for the CSV export.
+		* Must be called when no other thread measures times, e.g. after a simulation step.
+		*/
+		static void finishStep()
+		{
+			if (!m_profiling)
+				return;
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::vector<double> times(m_names.size(), 0.0);
+			for (auto &data : m_threadData)
+			{
+				std::lock_guard<std::mutex> dataLock(data->mutex);
+				for (size_t i = 0; i < data->stepTimes.size(); i++)
+				{
+					times[i] += data->stepTimes[i];
+					data->stepTimes[i] = 0.0;
+				}
+			}
+			m_stepTimes.push_back(times);
+		}
+
+		/** Export the recorded measurements in the Chrome trace event format
+		* (chrome://tracing, Perfetto). Each thread is shown as a separate track.
+		*/
+		static bool writeChromeTrace(const std::string &fileName)
+		{
+			std::ofstream file(fileName.c_str());
+			if (!file.is_open())
+			{
+				LOG_ERR << "Cannot open file: " << fileName;
+				return false;
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::vector<std::string> names(m_names.size());
+			for (size_t i = 0; i < m_names.size(); i++)
+			{
+				for (const char c : m_names[i])
+				{
+					if ((c == '"') || (c == '\\'))
+						names[i] += '\\';
+					names[i] += c;
+				}
+			}
+
+			file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+			bool first = true;
+			unsigned int numDropped = 0;
+			for (auto &data : m_threadData)
+			{
+				std::lock_guard<std::mutex> dataLock(data->mutex);
+				numDropped += data->numDroppedEvents;
+				for (const TimingEvent &e : data->events)
+				{
+					if (!first)
+						file << ",\n";
+					first = false;
+					file << "{\"name\": \"" << names[e.nameId] << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << data->threadIndex
+						<< ", \"ts\": " << std::fixed << e.start << ", \"dur\": " << e.duration << ", \"args\": {\"depth\": " << e.depth << "}}";
+				}
+			}
+			file << "\n]}\n";
+			file.close();
+			if (numDropped > 0)
+				LOG_WARN << "Trace export: " << numDropped << " measurements were not recorded (event buffer full).";
+			return true;
+		}
+
+		/** Export the time of each measurement name per step (sum over all threads in ms) as CSV file.
+		*/
+		static bool writeStepCSV(const std::string &fileName)
+		{
+			std::ofstream file(fileName.c_str());
+			if (!file.is_open())
+			{
+				LOG_ERR << "Cannot open file: " << fileName;
+				return false;
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			file << "step";
+			for (size_t i = 0; i < m_names.size(); i++)
+				file << ",\"" << m_names[i] << "\"";
+			file << "\n";
+			for (size_t s = 0; s < m_stepTimes.size(); s++)
+			{
+				file << s + 1;
+				for (size_t i = 0; i < m_names.size(); i++)
+					file << "," << ((i < m_stepTimes[s].size()) ? m_stepTimes[s][i] : 0.0);
+				file << "\n";
+			}
+			file.close();
+			return true;
+		}
+
+#ifdef USE_PERF_COUNTERS
+		/** Export the hardware counters of each measurement (sum over all threads
+		* and calls) as CSV file.
+		*/
+		static bool writePerfCounterCSV(const std::string &fileName)
+		{
+			std::ofstream file(fileName.c_str());
+			if (!file.is_open())
+			{
+				LOG_ERR << "Cannot open file: " << fileName;
+				return false;
+			}
+			unsigned int startCounter, stopCounter;
+			mergeAverageTimes(startCounter, stopCounter);
+			file << "name,calls,time [ms]";
+			for (unsigned int i = 0; i < PerfCounterValues::NumCounters; i++)
+				file << "," << PerfCounterValues::getName(i);
+			file << ",IPC,LLC misses per 1000 instructions\n";
+			for (auto &iter : m_averageTimes)
+			{
+				const AverageTime &at = iter.second;
+				const PerfCounterValues &pc = at.perfCounters;
+				file << "\"" << at.name << "\"," << at.counter << "," << at.totalTime;
+				for (unsigned int i = 0; i < PerfCounterValues::NumCounters; i++)
+					file << "," << pc.values[i];
+				const double instructions = (double)pc.values[PerfCounterValues::Instructions];
+				file << "," << ((pc.values[PerfCounterValues::Cycles] > 0) ? instructions / pc.values[PerfCounterValues::Cycles] : 0.0);
+				file << "," << ((instructions > 0.0) ? 1000.0 * pc.values[PerfCounterValues::LLCMisses] / instructions : 0.0) << "\n";
+			}
+			file.close();
+			return true;
+		}
+#endif
 	};
 }
 
-#endif
\ No newline at end of file
+#endif